@@ -165,6 +165,31 @@ VLC_API block_t *block_Alloc(size_t size) VLC_USED VLC_MALLOC;
 
 VLC_API block_t *block_TryRealloc(block_t *, ssize_t pre, size_t body) VLC_USED;
 
+/**
+ * Block allocator statistics.
+ */
+struct vlc_block_stats
+{
+    uint64_t hits; /**< Allocations served from the block cache */
+    uint64_t misses; /**< Cacheable allocations served by the heap */
+    uint64_t oversized; /**< Allocations too large to be cached */
+    size_t cached; /**< Bytes held in the shared block cache */
+};
+
+/**
+ * Gets the block allocator statistics.
+ *
+ * block_Alloc() recycles the memory of small blocks through per-thread caches
+ * and a shared depot. This can be disabled for debugging purposes by setting
+ * the VLC_BLOCK_CACHE environment variable to 0.
+ *
+ * @note Cache hits in other threads are accounted in batches, so the
+ * statistics are approximate.
+ *
+ * @param stats structure to fill with the statistics [OUT]
+ */
+VLC_API void block_GetStats(struct vlc_block_stats *stats);
+
 /**
  * Reallocates a block.
  *
@@ -539,6 +564,10 @@ static inline void vlc_fifo_Signal(vlc_fifo_t *fifo)
  * previously empty FIFO or by calling vlc_fifo_Signal() directly.
  * This function may also return spuriously at any moment.
  *
+ * In lock-less mode, blocks queued with vlc_fifo_QueueLockless() only signal
+ * the FIFO if it was empty, or after vlc_fifo_DequeueUnlocked() found no block
+ * to dequeue.
+ *
  * @note This function is a cancellation point. In case of cancellation, the
  * the FIFO will be locked before cancellation cleanup handlers are processed.
  */
@@ -575,6 +604,10 @@ VLC_API void vlc_fifo_QueueUnlocked(vlc_fifo_t *fifo, block_t *);
  * @warning The FIFO must be locked by the calling thread using
  * vlc_fifo_Lock(). Otherwise behaviour is undefined.
  *
+ * @note In lock-less mode, this function can return NULL while the FIFO is
+ * not empty, if a block is being queued by vlc_fifo_QueueLockless(). The
+ * caller should then wait with vlc_fifo_Wait() as if the FIFO were empty.
+ *
  * @return the first block in the FIFO or NULL if the FIFO is empty
  */
 VLC_API block_t *vlc_fifo_DequeueUnlocked(vlc_fifo_t *) VLC_USED;
@@ -602,7 +635,11 @@ VLC_API block_t *vlc_fifo_DequeueAllUnlocked(vlc_fifo_t *) VLC_USED;
  * @note This function is not cancellation point.
  *
  * @warning The FIFO must be locked by the calling thread using
- * vlc_fifo_Lock(). Otherwise behaviour is undefined.
+ * vlc_fifo_Lock(), unless it is in lock-less mode.
+ * Otherwise behaviour is undefined.
+ *
+ * @note In lock-less mode, the count includes blocks that are being queued,
+ * and may not be dequeued yet.
  *
  * @return the number of blocks in the FIFO (zero if it is empty)
  */
@@ -616,7 +653,8 @@ VLC_API size_t vlc_fifo_GetCount(const vlc_fifo_t *) VLC_USED;
  * @note This function is not cancellation point.
  *
  * @warning The FIFO must be locked by the calling thread using
- * vlc_fifo_Lock(). Otherwise behaviour is undefined.
+ * vlc_fifo_Lock(), unless it is in lock-less mode.
+ * Otherwise behaviour is undefined.
  *
  * @return the total number of bytes
  *
@@ -626,9 +664,44 @@ VLC_API size_t vlc_fifo_GetCount(const vlc_fifo_t *) VLC_USED;
  */
 VLC_API size_t vlc_fifo_GetBytes(const vlc_fifo_t *) VLC_USED;
 
+/**
+ * Enables the lock-less mode of a FIFO.
+ *
+ * In lock-less mode, a single producer thread can queue blocks with
+ * vlc_fifo_QueueLockless() without locking the FIFO nor waking up the
+ * consumer thread, unless the FIFO was empty. The blocks go
+ * through a fixed-size ring, which the consumer empties whenever it dequeues
+ * with the FIFO locked. The block and byte counts can then also be read
+ * without locking.
+ *
+ * @warning This function must be called right after block_FifoNew(), before
+ * the FIFO is used by any other thread.
+ */
+VLC_API void vlc_fifo_EnableLockless(vlc_fifo_t *);
+
+/**
+ * Queues a linked-list of blocks into a FIFO without locking it.
+ *
+ * The blocks are appended after any block previously queued, whether with
+ * or without locking.
+ *
+ * @param block the head of the list of blocks
+ *              (if NULL, this function has no effects)
+ *
+ * @note This function is not a cancellation point.
+ *
+ * @note If the ring is full, this function locks the FIFO and queues the
+ * blocks as vlc_fifo_QueueUnlocked() would.
+ *
+ * @warning The FIFO must be in lock-less mode (see vlc_fifo_EnableLockless())
+ * and must <b>not</b> be locked by the calling thread. Only one thread may
+ * call this function on a given FIFO.
+ */
+VLC_API void vlc_fifo_QueueLockless(vlc_fifo_t *fifo, block_t *block);
+
 VLC_USED static inline bool vlc_fifo_IsEmpty(const vlc_fifo_t *fifo)
 {
-    return vlc_queue_IsEmpty(vlc_fifo_queue(fifo));
+    return vlc_fifo_GetCount(fifo) == 0;
 }
 
 static inline void vlc_fifo_Cleanup(void *fifo)
@@ -642,7 +715,12 @@ static inline void vlc_fifo_Cleanup(void *fifo)
  */
 static inline void block_FifoEmpty(block_fifo_t *fifo)
 {
-    block_ChainRelease((block_t *)vlc_queue_DequeueAll(vlc_fifo_queue(fifo)));
+    block_t *block;
+
+    vlc_fifo_Lock(fifo);
+    block = vlc_fifo_DequeueAllUnlocked(fifo);
+    vlc_fifo_Unlock(fifo);
+    block_ChainRelease(block);
 }
 
 /**
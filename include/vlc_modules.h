@@ -70,6 +70,51 @@ VLC_API module_t *vlc_module_load(struct vlc_logger *log, const char *cap,
                             name, strict, __VA_ARGS__))
 #endif
 
+/**
+ * Module probing hints.
+ *
+ * Modules can declare the file extensions, MIME types and magic number that
+ * they handle (see set_probe_extensions(), set_probe_mime_types() and
+ * set_probe_magic()). Such modules are only probed if one of their hints
+ * matches, unless they are forced by name. An extension list is considered
+ * to match if no extension is known, and a magic number is considered to
+ * match if it lies beyond the peeked data.
+ */
+struct vlc_module_hint
+{
+    const char *extension; /**< File extension without dot (or NULL) */
+    const char *mime; /**< MIME type without parameters (or NULL) */
+    const uint8_t *peek; /**< Start of the data (or NULL) */
+    size_t peek_size; /**< Byte length of the peeked data */
+};
+
+/**
+ * Finds and instantiates the best module of a certain type, skipping the
+ * modules whose probing hints do not match.
+ *
+ * This function is the same as vlc_module_load() with probing hints.
+ *
+ * \param hint probing hints (or NULL to probe all candidates)
+ */
+VLC_API module_t *vlc_module_load_hinted(struct vlc_logger *log,
+                                         const char *cap, const char *name,
+                                         bool strict,
+                                         const struct vlc_module_hint *hint,
+                                         vlc_activate_t probe, ...) VLC_USED;
+#ifndef __cplusplus
+#define vlc_module_load_hinted(ctx, cap, name, strict, hint, ...) \
+    _Generic ((ctx), \
+        struct vlc_logger *: \
+            vlc_module_load_hinted((void *)(ctx), cap, name, strict, hint, \
+                                   __VA_ARGS__), \
+        void *: \
+            vlc_module_load_hinted((void *)(ctx), cap, name, strict, hint, \
+                                   __VA_ARGS__), \
+        default: \
+            vlc_module_load_hinted(vlc_object_logger((vlc_object_t *)(ctx)), \
+                                   cap, name, strict, hint, __VA_ARGS__))
+#endif
+
 VLC_API module_t * module_need( vlc_object_t *, const char *, const char *, bool ) VLC_USED;
 #define module_need(a,b,c,d) module_need(VLC_OBJECT(a),b,c,d)
 
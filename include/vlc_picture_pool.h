@@ -116,7 +116,12 @@ void picture_pool_Cancel( picture_pool_t *, bool canceled );
 /**
  * Reserves pictures from a pool and creates a new pool with those.
  *
- * When the new pool is released, pictures are returned to the master pool.
+ * The reserved pictures are taken off the master pool, and handed out by the
+ * new pool directly. This is meant for a consumer, e.g. a filter or a
+ * decoder, that needs a guaranteed share of a pool.
+ *
+ * When the new pool is released, and all its pictures are released,
+ * pictures are returned to the master pool.
  * If the master pool was already released, pictures will be destroyed.
  *
  * @param count number of picture to reserve
@@ -136,6 +141,31 @@ VLC_USED;
  */
 VLC_API unsigned picture_pool_GetSize(const picture_pool_t *);
 
+/**
+ * Picture pool statistics
+ */
+struct picture_pool_stats
+{
+    unsigned size; /**< Total number of pictures */
+    unsigned in_use; /**< Number of pictures allocated or reserved */
+    unsigned peak; /**< Highest number of pictures allocated or reserved */
+    uint64_t gets; /**< Number of picture requests */
+    uint64_t misses; /**< Number of requests that found no free picture */
+    uint64_t waits; /**< Number of requests that waited for a free picture */
+    vlc_tick_t wait_time; /**< Total time spent waiting */
+};
+
+/**
+ * Gets the usage statistics of a picture pool.
+ *
+ * The values are sampled without synchronization, so they may be slightly
+ * inconsistent with one another if the pool is in use.
+ *
+ * @note This function is thread-safe.
+ */
+VLC_API void picture_pool_GetStats(const picture_pool_t *,
+                                   struct picture_pool_stats *);
+
 
 #endif /* VLC_PICTURE_POOL_H */
 
@@ -48,6 +48,9 @@ enum vlc_module_properties
     VLC_MODULE_DESCRIPTION,
     VLC_MODULE_HELP,
     VLC_MODULE_TEXTDOMAIN,
+    VLC_MODULE_PROBE_EXTENSIONS,
+    VLC_MODULE_PROBE_MIME_TYPES,
+    VLC_MODULE_PROBE_MAGIC,
     /* Insert new VLC_MODULE_* here */
 
     /* DO NOT EVER REMOVE, INSERT OR REPLACE ANY ITEM! It would break the ABI!
@@ -317,6 +320,38 @@ VLC_METADATA_EXPORTS
                        (void (*)(vlc_object_t *)){ deactivate })) \
         goto error;
 
+/**
+ * Declares the file extensions handled by the module.
+ *
+ * Probing hints are used by vlc_module_load_hinted(): if a module declares
+ * hints and none of them match, the module is not probed (unless forced).
+ *
+ * \param exts comma-separated list of file extensions (without dots)
+ */
+#define set_probe_extensions( exts ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_EXTENSIONS, (const char *)(exts))) \
+        goto error;
+
+/**
+ * Declares the MIME types handled by the module.
+ *
+ * \param types comma-separated list of MIME types
+ */
+#define set_probe_mime_types( types ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_MIME_TYPES, (const char *)(types))) \
+        goto error;
+
+/**
+ * Declares the magic number that the module requires.
+ *
+ * \param offset byte offset of the magic number from the start of the data
+ * \param magic magic number (must be a string literal)
+ */
+#define set_probe_magic( offset, magic ) \
+    if (vlc_module_set (VLC_MODULE_PROBE_MAGIC, (unsigned)(offset), \
+                        (unsigned)(sizeof (magic) - 1), (const char *)(magic))) \
+        goto error;
+
 #define cannot_unload_broken_library( ) \
     if (vlc_module_set (VLC_MODULE_NO_UNLOAD)) \
         goto error;
@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * vlc_slices.h: slice-parallel processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_SLICES_H
+#define VLC_SLICES_H
+
+/**
+ * @defgroup slices Slice-parallel processing
+ * @ingroup cext
+ *
+ * Splits a piece of work, typically a picture, into independent slices, and
+ * processes them concurrently on a pool of worker threads shared by the whole
+ * LibVLC instance.
+ *
+ * This is intended for CPU-bound video filters: the filter callback splits
+ * each plane into horizontal bands, and returns once all bands are done. The
+ * filter interface and the filter chain semantics are unchanged.
+ * @{
+ * @file vlc_slices.h
+ */
+
+/**
+ * Slice processing callback.
+ *
+ * @param opaque data pointer as passed to vlc_slices_Run()
+ * @param slice index of the slice to process (from 0 to count - 1)
+ * @param count total number of slices
+ */
+typedef void (*vlc_slice_cb)(void *opaque, unsigned slice, unsigned count);
+
+/**
+ * Gets the preferred number of slices.
+ *
+ * This returns how many slices a piece of work of a given size should be
+ * split into, according to the number of worker threads.
+ *
+ * @param obj an object of the LibVLC instance
+ * @param lines number of lines of the picture or plane to process
+ * @return a number of slices, at least one
+ */
+VLC_API unsigned vlc_slices_Count(vlc_object_t *obj, unsigned lines);
+#define vlc_slices_Count(o, l) vlc_slices_Count(VLC_OBJECT(o), l)
+
+/**
+ * Processes slices in parallel.
+ *
+ * This function invokes the callback once for each slice index, from worker
+ * threads and from the calling thread, and waits for all invocations to
+ * return. The callback may be invoked concurrently, and may itself call
+ * vlc_slices_Run().
+ *
+ * If the worker threads are busy or unavailable, the calling thread processes
+ * the slices by itself, so this function cannot fail.
+ *
+ * @param obj an object of the LibVLC instance
+ * @param count number of slices
+ * @param cb slice processing callback
+ * @param opaque data pointer for the callback
+ */
+VLC_API void vlc_slices_Run(vlc_object_t *obj, unsigned count,
+                            vlc_slice_cb cb, void *opaque);
+#define vlc_slices_Run(o, n, cb, data) \
+    vlc_slices_Run(VLC_OBJECT(o), n, cb, data)
+
+/**
+ * Computes the lines of a slice.
+ *
+ * This splits a number of lines into bands of (nearly) equal height.
+ * Bands boundaries are aligned to a given number of lines, e.g. 2 to keep both
+ * fields of an interlaced picture or the luma lines of a chroma line together.
+ *
+ * @param slice slice index
+ * @param count number of slices
+ * @param lines total number of lines
+ * @param align band alignment in lines (must be a power of two)
+ * @param first [OUT] first line of the slice
+ * @param end [OUT] first line after the slice
+ */
+static inline void vlc_slice_Lines(unsigned slice, unsigned count,
+                                   unsigned lines, unsigned align,
+                                   unsigned *restrict first,
+                                   unsigned *restrict end)
+{
+    const unsigned mask = ~(align - 1);
+
+    *first = (slice == 0) ? 0 : ((lines * slice / count) & mask);
+    *end = (slice + 1 >= count) ? lines
+                                : ((lines * (slice + 1) / count) & mask);
+}
+
+/** @} */
+
+#endif
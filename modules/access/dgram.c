@@ -0,0 +1,345 @@
+/**
+ * @file dgram.c
+ * @brief Batched datagram receive ring shared by UDP-based access modules
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
+#ifdef __linux__
+# include <netinet/udp.h>
+#endif
+
+#include "dgram.h"
+
+/* Largest possible UDP payload (IPv6 jumbograms are ignored) */
+#define DGRAM_MAX_MRU 65507u
+
+#ifndef MSG_TRUNC
+# define MSG_TRUNC 0
+#endif
+#ifndef SOL_UDP
+# define SOL_UDP IPPROTO_UDP
+#endif
+
+#ifndef HAVE_RECVMMSG
+struct mmsghdr
+{
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+#endif
+
+#ifdef SO_RXQ_OVFL
+# define DGRAM_CMSG_SPACE CMSG_SPACE(sizeof (uint32_t))
+#else
+# define DGRAM_CMSG_SPACE 1
+#endif
+
+struct dgram_ring
+{
+    vlc_object_t *obj;
+    int fd;
+    unsigned count;
+    size_t mru;
+    size_t spill_size; /**< Overflow buffer size per slot */
+    uint32_t overflows; /**< Last kernel drop counter value */
+    struct dgram_stats stats;
+
+    struct mmsghdr *msgs;
+    struct iovec (*iov)[2];
+    unsigned char (*cmsg)[DGRAM_CMSG_SPACE];
+    unsigned char *spill; /**< Overflow buffers of datagrams above the MRU */
+    block_t *blocks[];
+};
+
+dgram_ring_t *dgram_ring_New(vlc_object_t *obj, int fd, unsigned count,
+                             size_t mru, bool gro)
+{
+    assert(count > 0);
+
+    dgram_ring_t *ring = malloc(sizeof (*ring) + count * sizeof (block_t *));
+    if (unlikely(ring == NULL))
+        return NULL;
+
+    ring->obj = obj;
+    ring->fd = fd;
+    ring->count = count;
+    ring->mru = (mru < DGRAM_MAX_MRU) ? mru : DGRAM_MAX_MRU;
+    ring->spill = NULL;
+    ring->overflows = 0;
+    memset(&ring->stats, 0, sizeof (ring->stats));
+    ring->msgs = calloc(count, sizeof (*ring->msgs));
+    ring->iov = calloc(count, sizeof (*ring->iov));
+    ring->cmsg = calloc(count, sizeof (*ring->cmsg));
+
+    if (unlikely(ring->msgs == NULL || ring->iov == NULL
+              || ring->cmsg == NULL))
+    {
+        free(ring->cmsg);
+        free(ring->iov);
+        free(ring->msgs);
+        free(ring);
+        return NULL;
+    }
+
+    for (unsigned i = 0; i < count; i++)
+        ring->blocks[i] = NULL;
+
+#ifdef SO_RXQ_OVFL
+    setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &(int){ 1 }, sizeof (int));
+#endif
+    if (gro)
+    {
+#ifdef UDP_GRO
+        if (setsockopt(fd, SOL_UDP, UDP_GRO, &(int){ 1 }, sizeof (int)) == 0)
+        {   /* Coalesced datagrams can be up to the maximum payload size. */
+            ring->mru = DGRAM_MAX_MRU;
+            msg_Dbg(obj, "generic receive offload enabled");
+        }
+        else
+#endif
+            msg_Dbg(obj, "generic receive offload not supported");
+    }
+
+    /* Each slot receives the part of a datagram beyond its block into an
+     * overflow buffer, so that no datagram is ever truncated. The buffers
+     * are only touched, and thus backed by memory, when used. */
+    ring->spill_size = DGRAM_MAX_MRU - ring->mru;
+    if (ring->spill_size > 0)
+    {
+        ring->spill = malloc(count * ring->spill_size);
+        if (unlikely(ring->spill == NULL))
+        {
+            dgram_ring_Delete(ring);
+            return NULL;
+        }
+    }
+    return ring;
+}
+
+void dgram_ring_Delete(dgram_ring_t *ring)
+{
+    for (unsigned i = 0; i < ring->count; i++)
+        if (ring->blocks[i] != NULL)
+            block_Release(ring->blocks[i]);
+
+    free(ring->spill);
+    free(ring->cmsg);
+    free(ring->iov);
+    free(ring->msgs);
+    free(ring);
+}
+
+/**
+ * Allocates the missing receive buffers.
+ * @return the number of consecutive slots ready to receive
+ */
+static unsigned dgram_ring_Refill(dgram_ring_t *ring)
+{
+    unsigned i;
+
+    for (i = 0; i < ring->count; i++)
+    {
+        block_t *block = ring->blocks[i];
+
+        if (block != NULL && block->i_buffer < ring->mru)
+        {   /* MRU was increased since this buffer was allocated. */
+            block_Release(block);
+            ring->blocks[i] = block = NULL;
+        }
+
+        if (block == NULL)
+        {
+            block = block_Alloc(ring->mru);
+            if (unlikely(block == NULL))
+                break;
+            ring->blocks[i] = block;
+        }
+
+        struct mmsghdr *mmsg = &ring->msgs[i];
+
+        /* The MRU only grows, so blocks are never smaller than the space
+         * left out of the overflow buffers. */
+        assert(block->i_buffer + ring->spill_size >= DGRAM_MAX_MRU);
+        ring->iov[i][0].iov_base = block->p_buffer;
+        ring->iov[i][0].iov_len = block->i_buffer;
+        ring->iov[i][1].iov_base = (ring->spill != NULL)
+                                 ? ring->spill + i * ring->spill_size : NULL;
+        ring->iov[i][1].iov_len = DGRAM_MAX_MRU - block->i_buffer;
+        mmsg->msg_hdr.msg_name = NULL;
+        mmsg->msg_hdr.msg_namelen = 0;
+        mmsg->msg_hdr.msg_iov = ring->iov[i];
+        mmsg->msg_hdr.msg_iovlen = (ring->iov[i][1].iov_len > 0) ? 2 : 1;
+#ifdef SO_RXQ_OVFL
+        mmsg->msg_hdr.msg_control = ring->cmsg[i];
+        mmsg->msg_hdr.msg_controllen = sizeof (ring->cmsg[i]);
+#else
+        mmsg->msg_hdr.msg_control = NULL;
+        mmsg->msg_hdr.msg_controllen = 0;
+#endif
+        mmsg->msg_hdr.msg_flags = 0;
+        mmsg->msg_len = 0;
+    }
+    return i;
+}
+
+static int dgram_ring_RecvMsgs(dgram_ring_t *ring, unsigned count)
+{
+#ifdef HAVE_RECVMMSG
+# ifdef MSG_WAITFORONE
+    const int flags = MSG_WAITFORONE | MSG_TRUNC;
+# else
+    const int flags = MSG_DONTWAIT | MSG_TRUNC;
+# endif
+    return recvmmsg(ring->fd, ring->msgs, count, flags, NULL);
+#else
+    VLC_UNUSED(count);
+    ssize_t val = recvmsg(ring->fd, &ring->msgs[0].msg_hdr, MSG_TRUNC);
+    if (val < 0)
+        return -1;
+
+    ring->msgs[0].msg_len = val;
+    return 1;
+#endif
+}
+
+static void dgram_ring_CheckOverflow(dgram_ring_t *ring,
+                                     const struct msghdr *msg)
+{
+#ifdef SO_RXQ_OVFL
+    for (const struct cmsghdr *cmsg = CMSG_FIRSTHDR(msg);
+         cmsg != NULL;
+         cmsg = CMSG_NXTHDR((struct msghdr *)msg, (struct cmsghdr *)cmsg))
+    {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SO_RXQ_OVFL)
+            continue;
+
+        uint32_t overflows;
+
+        memcpy(&overflows, CMSG_DATA(cmsg), sizeof (overflows));
+        if (overflows != ring->overflows)
+        {
+            uint32_t lost = overflows - ring->overflows;
+
+            msg_Warn(ring->obj, "%"PRIu32" datagram(s) dropped by the kernel",
+                     lost);
+            ring->stats.dropped += lost;
+            ring->overflows = overflows;
+        }
+    }
+#else
+    VLC_UNUSED(ring); VLC_UNUSED(msg);
+#endif
+}
+
+block_t *dgram_ring_Recv(dgram_ring_t *ring)
+{
+    unsigned count = dgram_ring_Refill(ring);
+    if (unlikely(count == 0))
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    int val = dgram_ring_RecvMsgs(ring, count);
+    if (val <= 0)
+        return NULL;
+
+    block_t *chain = NULL, **pp = &chain;
+
+    ring->stats.calls++;
+
+    for (int i = 0; i < val; i++)
+    {
+        const struct msghdr *msg = &ring->msgs[i].msg_hdr;
+        block_t *block = ring->blocks[i];
+        size_t len = ring->msgs[i].msg_len;
+
+        if (msg->msg_flags & MSG_TRUNC)
+        {   /* Only with GRO, or with IPv6 jumbograms */
+            msg_Err(ring->obj, "%zu bytes datagram truncated (MRU was %u)",
+                    len, DGRAM_MAX_MRU);
+            block->i_flags |= BLOCK_FLAG_CORRUPTED;
+            ring->stats.truncated++;
+            len = DGRAM_MAX_MRU;
+        }
+
+        dgram_ring_CheckOverflow(ring, msg);
+
+        if (len > block->i_buffer)
+        {   /* Append the overflow, and receive larger datagrams directly
+             * into the blocks from now on. */
+            size_t head = block->i_buffer;
+
+            ring->stats.oversized++;
+            if (len > ring->mru)
+                ring->mru = len;
+
+            block = block_Realloc(block, 0, len);
+            if (unlikely(block == NULL))
+            {
+                ring->blocks[i] = NULL;
+                continue;
+            }
+            memcpy(block->p_buffer + head, ring->iov[i][1].iov_base,
+                   len - head);
+        }
+
+        block->i_buffer = len;
+        ring->stats.datagrams++;
+        ring->stats.bytes += len;
+        ring->blocks[i] = NULL;
+        *pp = block;
+        pp = &block->p_next;
+    }
+
+    /* Move the unused buffers to the front of the ring. */
+    for (unsigned i = val; i < count; i++)
+    {
+        ring->blocks[i - val] = ring->blocks[i];
+        ring->blocks[i] = NULL;
+    }
+    return chain;
+}
+
+void dgram_ring_LogStats(const dgram_ring_t *ring)
+{
+    const struct dgram_stats *s = &ring->stats;
+
+    msg_Dbg(ring->obj, "received %"PRIu64" datagrams (%"PRIu64" bytes) in "
+            "%"PRIu64" calls, %.1f datagrams per call (ring size %u), "
+            "%"PRIu64" above the MRU, %"PRIu64" truncated, "
+            "%"PRIu64" dropped",
+            s->datagrams, s->bytes, s->calls,
+            s->calls ? (double)s->datagrams / s->calls : 0., ring->count,
+            s->oversized, s->truncated, s->dropped);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file dgram.h
+ * @brief Batched datagram receive ring shared by UDP-based access modules
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifndef VLC_ACCESS_DGRAM_H
+# define VLC_ACCESS_DGRAM_H
+
+typedef struct dgram_ring dgram_ring_t;
+
+/** Receive statistics of a datagram ring */
+struct dgram_stats
+{
+    uint64_t calls; /**< Receive system calls that returned data */
+    uint64_t datagrams; /**< Datagrams received */
+    uint64_t bytes; /**< Payload bytes received */
+    uint64_t oversized; /**< Datagrams received partly in overflow buffers */
+    uint64_t truncated; /**< Datagrams larger than the maximum size */
+    uint64_t dropped; /**< Datagrams dropped by the kernel (if known) */
+};
+
+/**
+ * Creates a receive ring of preallocated blocks for a datagram socket.
+ *
+ * @param fd socket to receive from
+ * @param count number of datagrams received per system call at most
+ * @param mru initial block size per datagram; larger datagrams are
+ *            received whole through an overflow buffer, and the block size
+ *            then grows to fit them
+ * @param gro whether to request UDP generic receive offload, in which case
+ *            a single block may contain several coalesced datagrams
+ */
+dgram_ring_t *dgram_ring_New(vlc_object_t *obj, int fd, unsigned count,
+                             size_t mru, bool gro);
+void dgram_ring_Delete(dgram_ring_t *);
+
+/**
+ * Receives pending datagrams.
+ *
+ * This function blocks until at least one datagram is received, and then
+ * returns all datagrams already queued on the socket, up to the ring size.
+ *
+ * @return a chain of blocks (one per datagram), or NULL on error (errno is
+ * set accordingly)
+ */
+block_t *dgram_ring_Recv(dgram_ring_t *);
+
+/**
+ * Prints the receive statistics to the debug log.
+ */
+void dgram_ring_LogStats(const dgram_ring_t *);
+
+#endif
@@ -50,6 +50,9 @@
 #else
 #   include <unistd.h>
 #endif
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
 #include <dirent.h>
 
 #include <vlc_common.h>
@@ -67,6 +70,10 @@ typedef struct
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    uint64_t offset; /**< Current read offset (memory-mapped mode) */
+    uint64_t size; /**< Last known file size (memory-mapped mode) */
+#endif
 } access_sys_t;
 
 #if !defined (_WIN32) && !defined (__OS2__)
@@ -128,6 +135,10 @@ static bool IsRemote (const char *path)
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *);
+static int MmapSeek (stream_t *, uint64_t);
+#endif
 
 /*****************************************************************************
  * FileOpen: open the file
@@ -228,6 +239,20 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Map local regular files rather than copying them. */
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            msg_Dbg (p_access, "using memory-mapped file access");
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+            p_sys->offset = 0;
+            p_sys->size = st.st_size;
+            posix_fadvise (fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        }
 #endif
     }
     else
@@ -250,7 +275,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_readdir != NULL)
     {
         DirClose (p_this);
         return;
@@ -296,6 +321,72 @@ static int FileSeek (stream_t *p_access, uint64_t i_pos)
     return VLC_SUCCESS;
 }
 
+#ifdef HAVE_MMAP
+/* Size of the memory mapping windows (a multiple of the huge page size) */
+#define MMAP_WINDOW (UINT64_C(4) << 20)
+
+/*****************************************************************************
+ * MmapBlock: map the next window of the file
+ *****************************************************************************/
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    if (sys->offset >= sys->size)
+    {   /* The file may be growing, e.g. while it is being recorded. */
+        struct stat st;
+
+        if (fstat (sys->fd, &st) == 0)
+            sys->size = st.st_size;
+        if (sys->offset >= sys->size)
+        {
+            *eof = true;
+            return NULL;
+        }
+    }
+
+    /* Windows are aligned so that they can be backed by huge pages. */
+    uint64_t start = sys->offset & ~(MMAP_WINDOW - 1);
+    size_t length = __MIN(MMAP_WINDOW, sys->size - start);
+    void *addr = mmap (NULL, length, PROT_READ, MAP_SHARED, sys->fd, start);
+
+    if (addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "memory mapping error: %s",
+                 vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+
+#ifdef HAVE_POSIX_MADVISE
+    posix_madvise (addr, length, POSIX_MADV_SEQUENTIAL);
+    posix_madvise (addr, length, POSIX_MADV_WILLNEED);
+#endif
+#ifdef MADV_HUGEPAGE
+    madvise (addr, length, MADV_HUGEPAGE); /* best effort */
+#endif
+
+    block_t *block = block_mmap_Alloc (addr, length);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    size_t skip = sys->offset - start;
+
+    block->p_buffer += skip;
+    block->i_buffer -= skip;
+    sys->offset += block->i_buffer;
+    return block;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *sys = p_access->p_sys;
+
+    sys->offset = i_pos;
+    return VLC_SUCCESS;
+}
+#endif
+
 /*****************************************************************************
  * Control:
  *****************************************************************************/
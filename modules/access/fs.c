@@ -40,6 +40,11 @@ vlc_module_begin ()
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
 
+    add_bool( "file-mmap", false, N_("Memory-map files"),
+              N_("Read local files through memory mappings instead of "
+                 "copying them. Files must not be truncated while they are "
+                 "being read, or VLC will crash."), true )
+
     add_submodule()
     set_section( N_("Directory" ), NULL )
     set_capability( "access", 55 )
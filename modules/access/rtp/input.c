@@ -35,11 +35,9 @@
 #ifdef HAVE_POLL
 # include <poll.h>
 #endif
-#ifdef HAVE_SYS_UIO_H
-# include <sys/uio.h>
-#endif
 
 #include "rtp.h"
+#include "../dgram.h"
 #ifdef HAVE_SRTP
 # include "srtp.h"
 #endif
@@ -100,6 +98,14 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+static void rtp_ring_cleanup (void *data)
+{
+    dgram_ring_t *ring = data;
+
+    dgram_ring_LogStats (ring);
+    dgram_ring_Delete (ring);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -109,26 +115,17 @@ void *rtp_dgram_thread (void *opaque)
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
     int rtp_fd = sys->fd;
-#ifdef __linux__
-    const int trunc_flag = MSG_TRUNC;
-#else
-    const int trunc_flag = 0;
-#endif
 
-    struct iovec iov =
-    {
-        .iov_len = DEFAULT_MRU,
-    };
-    struct msghdr msg =
-    {
-        .msg_iov = &iov,
-        .msg_iovlen = 1,
-    };
+    dgram_ring_t *ring = dgram_ring_New (VLC_OBJECT(demux), rtp_fd,
+                                         sys->batch, DEFAULT_MRU, false);
+    if (unlikely(ring == NULL))
+        return NULL;
 
     struct pollfd ufd[1];
     ufd[0].fd = rtp_fd;
     ufd[0].events = POLLIN;
 
+    vlc_cleanup_push (rtp_ring_cleanup, ring);
     for (;;)
     {
         int n = poll (ufd, 1, rtp_timeout (deadline));
@@ -143,40 +140,30 @@ void *rtp_dgram_thread (void *opaque)
         {
             n--;
             if (unlikely(ufd[0].revents & POLLHUP))
+            {
+                vlc_restorecancel (canc);
                 break; /* RTP socket dead (DCCP only) */
+            }
 
-            block_t *block = block_Alloc (iov.iov_len);
-            if (unlikely(block == NULL))
+            block_t *block = dgram_ring_Recv (ring);
+            if (block == NULL)
             {
-                if (iov.iov_len == DEFAULT_MRU)
+                if (errno == ENOMEM)
+                {
+                    vlc_restorecancel (canc);
                     break; /* we are totallly screwed */
-                iov.iov_len = DEFAULT_MRU;
-                continue; /* retry with shrunk MRU */
+                }
+                msg_Warn (demux, "RTP network error: %s",
+                          vlc_strerror_c(errno));
             }
 
-            iov.iov_base = block->p_buffer;
-            msg.msg_flags = trunc_flag;
-
-            ssize_t len = recvmsg (rtp_fd, &msg, trunc_flag);
-            if (len != -1)
+            while (block != NULL)
             {
-                if (msg.msg_flags & trunc_flag)
-                {
-                    msg_Err(demux, "%zd bytes packet truncated (MRU was %zu)",
-                            len, iov.iov_len);
-                    block->i_flags |= BLOCK_FLAG_CORRUPTED;
-                    iov.iov_len = len;
-                }
-                else
-                    block->i_buffer = len;
+                block_t *next = block->p_next;
 
+                block->p_next = NULL;
                 rtp_process (demux, block);
-            }
-            else
-            {
-                msg_Warn (demux, "RTP network error: %s",
-                          vlc_strerror_c(errno));
-                block_Release (block);
+                block = next;
             }
         }
 
@@ -185,5 +172,7 @@ void *rtp_dgram_thread (void *opaque)
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+    vlc_cleanup_pop ();
+    rtp_ring_cleanup (ring);
     return NULL;
 }
@@ -298,6 +298,7 @@ static int OpenSDP(vlc_object_t *obj)
     sys->timeout = vlc_tick_from_sec(var_InheritInteger(obj, "rtp-timeout"));
     sys->max_dropout  = var_InheritInteger(obj, "rtp-max-dropout");
     sys->max_misorder = var_InheritInteger(obj, "rtp-max-misorder");
+    sys->batch = var_InheritInteger(obj, "rtp-batch");
     sys->autodetect = true;
 
     demux->pf_demux = NULL;
@@ -423,6 +424,7 @@ static int OpenURL(vlc_object_t *obj)
     p_sys->timeout      = vlc_tick_from_sec( var_CreateGetInteger (obj, "rtp-timeout") );
     p_sys->max_dropout  = var_CreateGetInteger (obj, "rtp-max-dropout");
     p_sys->max_misorder = var_CreateGetInteger (obj, "rtp-max-misorder");
+    p_sys->batch        = var_InheritInteger (obj, "rtp-batch");
     p_sys->thread_ready = false;
     p_sys->autodetect   = true;
 
@@ -505,6 +507,11 @@ error:
     "RTP packets will be discarded if they are too far behind (i.e. in the " \
     "past) by this many packets from the last received packet." )
 
+#define RTP_BATCH_TEXT N_("Receive batch size")
+#define RTP_BATCH_LONGTEXT N_( \
+    "Maximum number of RTP packets received per system call. " \
+    "Larger values reduce the processing overhead of high bit rate streams." )
+
 #define RTP_DYNAMIC_PT_TEXT N_("RTP payload format assumed for dynamic " \
                                "payloads")
 #define RTP_DYNAMIC_PT_LONGTEXT N_( \
@@ -553,6 +560,9 @@ vlc_module_begin()
     add_integer("rtp-max-misorder", 100, RTP_MAX_MISORDER_TEXT,
                 RTP_MAX_MISORDER_LONGTEXT, true)
         change_integer_range (0, 32767)
+    add_integer("rtp-batch", 32, RTP_BATCH_TEXT,
+                RTP_BATCH_LONGTEXT, true)
+        change_integer_range (1, 1024)
     add_string("rtp-dynamic-pt", NULL, RTP_DYNAMIC_PT_TEXT,
                RTP_DYNAMIC_PT_LONGTEXT, true)
         change_string_list(dynamic_pt_list, dynamic_pt_list_text)
@@ -44,22 +44,21 @@
 #ifdef HAVE_POLL
 # include <poll.h>
 #endif
-#ifdef HAVE_SYS_UIO_H
-# include <sys/uio.h>
-#endif
 
-/* Buffer can be max theoretical datagram content minus anticipated MTU.
- * IPv6 headers are larger than IPv4, ignore IPv6 jumbograms.
+#include "dgram.h"
+
+/* Initial block size per datagram. Larger datagrams are received whole, and
+ * the block size grows to fit them. Most UDP streams use 7 TS packets per
+ * datagram within a 1500 bytes MTU.
  */
-#define MRU 65507u
+#define DEFAULT_MRU (1500u - (20 + 8))
 
 typedef struct {
     int fd;
     int timeout;
 
-    size_t length;
-    char *offset;
-    char buf[MRU];
+    dgram_ring_t *ring;
+    block_t *pending; /**< Datagrams received but not returned yet */
 } access_sys_t;
 
 static int Control(stream_t *access, int query, va_list args)
@@ -83,53 +82,41 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
-static ssize_t Read(stream_t *access, void *buf, size_t len)
+static block_t *BlockUDP(stream_t *access, bool *restrict eof)
 {
     access_sys_t *sys = access->p_sys;
 
-    if (sys->length > 0) {
-        if (len > sys->length)
-            len = sys->length;
-
-        memcpy(buf, sys->offset, len);
-        sys->offset += len;
-        sys->length -= len;
-        return len;
-    }
+    if (sys->pending == NULL) {
+        struct pollfd ufd[1];
 
-    struct pollfd ufd[1];
+        ufd[0].fd = sys->fd;
+        ufd[0].events = POLLIN;
 
-    ufd[0].fd = sys->fd;
-    ufd[0].events = POLLIN;
+        switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+            case 0:
+                msg_Err(access, "receive time-out");
+                *eof = true;
+                /* fall through */
+            case -1:
+                return NULL;
+        }
 
-    switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
-        case 0:
-            msg_Err(access, "receive time-out");
-            return 0;
-        case -1:
-            return -1;
+        sys->pending = dgram_ring_Recv(sys->ring);
+        if (sys->pending == NULL)
+            return NULL;
     }
 
-    struct iovec iov[] = {
-        { .iov_base = buf,      .iov_len = len, },
-        { .iov_base = sys->buf, .iov_len = MRU, },
-    };
-    struct msghdr msg = {
-        .msg_iov = iov,
-        .msg_iovlen = ARRAY_SIZE(iov),
-    };
-    ssize_t val = recvmsg(sys->fd, &msg, 0);
-
-    if (val <= 0) /* empty (0 bytes) payload does *not* mean EOF here */
-        return -1;
-
-    if (unlikely((size_t)val > len)) {
-        sys->offset = sys->buf;
-        sys->length = val - len;
-        val = len;
-    }
+    block_t *block = sys->pending;
 
-    return val;
+    sys->pending = block->p_next;
+    block->p_next = NULL;
+
+    if (block->i_buffer == 0) {
+        /* empty (0 bytes) payload does *not* mean EOF here */
+        block_Release(block);
+        return NULL;
+    }
+    return block;
 }
 
 /*****************************************************************************
@@ -147,10 +134,10 @@ static int Open( vlc_object_t *p_this )
     if( unlikely( sys == NULL ) )
         return VLC_ENOMEM;
 
-    sys->length = 0;
+    sys->pending = NULL;
     p_access->p_sys = sys;
-    p_access->pf_read = Read;
-    p_access->pf_block = NULL;
+    p_access->pf_read = NULL;
+    p_access->pf_block = BlockUDP;
     p_access->pf_control = Control;
     p_access->pf_seek = NULL;
 
@@ -217,6 +204,16 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+    sys->ring = dgram_ring_New( p_this, sys->fd,
+                                var_InheritInteger( p_access, "udp-batch" ),
+                                DEFAULT_MRU,
+                                var_InheritBool( p_access, "udp-gro" ) );
+    if( unlikely(sys->ring == NULL) )
+    {
+        net_Close( sys->fd );
+        return VLC_ENOMEM;
+    }
+
     return VLC_SUCCESS;
 }
 
@@ -228,10 +225,21 @@ static void Close( vlc_object_t *p_this )
     stream_t     *p_access = (stream_t*)p_this;
     access_sys_t *sys = p_access->p_sys;
 
+    block_ChainRelease( sys->pending );
+    dgram_ring_LogStats( sys->ring );
+    dgram_ring_Delete( sys->ring );
     net_Close( sys->fd );
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Receive batch size")
+#define BATCH_LONGTEXT N_( \
+    "Maximum number of datagrams received per system call. " \
+    "Larger values reduce the processing overhead of high bit rate streams.")
+#define GRO_TEXT N_("Generic receive offload")
+#define GRO_LONGTEXT N_( \
+    "Let the operating system coalesce consecutive datagrams " \
+    "of the same stream, if supported.")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -242,6 +250,9 @@ vlc_module_begin()
     add_obsolete_integer("server-port") /* since 2.0.0 */
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL, true)
+    add_integer("udp-batch", 32, BATCH_TEXT, BATCH_LONGTEXT, true)
+        change_integer_range(1, 1024)
+    add_bool("udp-gro", false, GRO_TEXT, GRO_LONGTEXT, true)
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
@@ -48,9 +48,20 @@
 #endif
 
 #include <vlc_network.h>
+#ifdef HAVE_SYS_UIO_H
+#   include <sys/uio.h>
+#endif
+#ifdef __linux__
+#   include <netinet/udp.h>
+#endif
 
 #define MAX_EMPTY_BLOCKS 200
 
+/* Maximum number of datagrams sent with a single system call */
+#define UDP_BATCH_MAX 64
+/* Maximum payload of a segmentation offload super-datagram */
+#define UDP_GSO_MAX_BYTES (65535 - 40 - 8)
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -71,6 +82,16 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define WINDOW_TEXT N_("Pacing window (ms)")
+#define WINDOW_LONGTEXT N_("Packets due within this time from the current " \
+                           "packet are sent together with a single system " \
+                           "call. Packets carrying a clock reference are " \
+                           "never sent ahead of time." )
+
+#define GSO_TEXT N_("Segmentation offload")
+#define GSO_LONGTEXT N_("Let the operating system or the network card split " \
+                        "batches of equally sized packets, if supported." )
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -79,6 +100,10 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+    add_integer( SOUT_CFG_PREFIX "window", 0, WINDOW_TEXT, WINDOW_LONGTEXT,
+                                 true )
+        change_integer_range( 0, 1000 )
+    add_bool( SOUT_CFG_PREFIX "gso", false, GSO_TEXT, GSO_LONGTEXT, true )
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -92,6 +117,8 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+    "window",
+    "gso",
     NULL
 };
 
@@ -111,8 +138,10 @@ static void* ThreadWrite( void * );
 typedef struct
 {
     vlc_tick_t    i_caching;
+    vlc_tick_t    i_window;
     int           i_handle;
     bool          b_mtu_warning;
+    bool          b_gso;
     bool          dead;
     size_t        i_mtu;
 
@@ -205,9 +234,12 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->i_caching = VLC_TICK_FROM_MS(
                      var_GetInteger( p_access, SOUT_CFG_PREFIX "caching") );
+    p_sys->i_window = VLC_TICK_FROM_MS(
+                     var_GetInteger( p_access, SOUT_CFG_PREFIX "window") );
     p_sys->i_handle = i_handle;
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
+    p_sys->b_gso = var_GetBool( p_access, SOUT_CFG_PREFIX "gso" );
     p_sys->dead = false;
     vlc_queue_Init(&p_sys->queue, offsetof (block_t, p_next));
     p_sys->p_buffer = NULL;
@@ -346,6 +378,134 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_len;
 }
 
+#ifdef UDP_SEGMENT
+/*****************************************************************************
+ * SendSegmented: send equally sized packets as one offloaded datagram
+ *****************************************************************************/
+static int SendSegmented( sout_access_out_t *p_access,
+                          block_t *const *pp_pk, unsigned i_count )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct iovec iov[UDP_BATCH_MAX];
+    const size_t i_segment = pp_pk[0]->i_buffer;
+    size_t i_total = 0;
+
+    /* Only the last segment may be shorter than the others */
+    for( unsigned i = 0; i < i_count; i++ )
+    {
+        if( pp_pk[i]->i_buffer > i_segment
+         || (pp_pk[i]->i_buffer < i_segment && i + 1 < i_count) )
+            return -1;
+        iov[i].iov_base = pp_pk[i]->p_buffer;
+        iov[i].iov_len = pp_pk[i]->i_buffer;
+        i_total += pp_pk[i]->i_buffer;
+    }
+    if( i_segment == 0 || i_total > UDP_GSO_MAX_BYTES )
+        return -1;
+
+    union {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {
+        .msg_iov = iov,
+        .msg_iovlen = i_count,
+        .msg_control = control.buf,
+        .msg_controllen = sizeof (control.buf),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+    uint16_t i_gso_size = i_segment;
+
+    cmsg->cmsg_level = SOL_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof (i_gso_size));
+    memcpy( CMSG_DATA(cmsg), &i_gso_size, sizeof (i_gso_size) );
+
+    if( sendmsg( p_sys->i_handle, &msg, 0 ) == -1 )
+    {
+        if( errno == EIO || errno == EINVAL || errno == ENOPROTOOPT )
+        {
+            msg_Warn( p_access, "segmentation offload not supported: %s",
+                      vlc_strerror_c(errno) );
+            p_sys->b_gso = false;
+            return -1;
+        }
+        msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    }
+    return 0;
+}
+#endif
+
+/*****************************************************************************
+ * SendBatch: send a batch of packets with as few system calls as possible
+ *****************************************************************************/
+static unsigned SendBatch( sout_access_out_t *p_access,
+                           block_t *const *pp_pk, unsigned i_count )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+#ifdef UDP_SEGMENT
+    if( p_sys->b_gso && i_count > 1
+     && SendSegmented( p_access, pp_pk, i_count ) == 0 )
+        return 1;
+#endif
+#ifdef HAVE_SENDMMSG
+    if( i_count > 1 )
+    {
+        struct mmsghdr msgs[UDP_BATCH_MAX];
+        struct iovec iov[UDP_BATCH_MAX];
+        unsigned i_calls = 0;
+
+        for( unsigned i = 0; i < i_count; i++ )
+        {
+            iov[i].iov_base = pp_pk[i]->p_buffer;
+            iov[i].iov_len = pp_pk[i]->i_buffer;
+            memset( &msgs[i], 0, sizeof (msgs[i]) );
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        for( unsigned i_done = 0; i_done < i_count; )
+        {
+            int i_sent = sendmmsg( p_sys->i_handle, msgs + i_done,
+                                   i_count - i_done, 0 );
+            i_calls++;
+            if( i_sent == -1 )
+            {   /* Skip the failed packet, as send() would */
+                msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+                i_sent = 1;
+            }
+            i_done += i_sent;
+        }
+        return i_calls;
+    }
+#endif
+    for( unsigned i = 0; i < i_count; i++ )
+        if( send( p_sys->i_handle, pp_pk[i]->p_buffer,
+                  pp_pk[i]->i_buffer, 0 ) == -1 )
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    return i_count;
+}
+
+/*****************************************************************************
+ * CanBatch: check if a packet may be sent along with the current batch
+ *****************************************************************************/
+static bool CanBatch( const sout_access_out_sys_t *p_sys,
+                      const block_t *p_pk, vlc_tick_t i_date_last,
+                      vlc_tick_t i_now )
+{
+    vlc_tick_t i_date = p_sys->i_caching + p_pk->i_dts;
+
+    /* Holes and discontinuities are handled one packet at a time */
+    if( i_date - i_date_last > VLC_TICK_FROM_SEC(2)
+     || i_date - i_date_last < VLC_TICK_FROM_MS(-1) )
+        return false;
+    /* Never send a clock reference ahead of time */
+    if( p_pk->i_flags & BLOCK_FLAG_CLOCK )
+        return i_date <= i_now;
+    return i_date <= i_now + p_sys->i_window;
+}
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
  *****************************************************************************/
@@ -358,13 +518,31 @@ static void* ThreadWrite( void *data )
                                              SOUT_CFG_PREFIX "group" );
     int i_to_send = i_group;
     unsigned i_dropped_packets = 0;
-    block_t *p_pk;
+    unsigned i_batch_max = UDP_BATCH_MAX;
+    uint64_t i_packets = 0, i_calls = 0;
+    block_t *p_pk, *p_lookahead = NULL;
+    block_t *batch[UDP_BATCH_MAX];
 
-    while ((p_pk = vlc_queue_DequeueKillable(&p_sys->queue,
-                                             &p_sys->dead)) != NULL)
+    if( p_sys->b_gso && p_sys->i_mtu > 0
+     && UDP_GSO_MAX_BYTES / p_sys->i_mtu < i_batch_max )
+        i_batch_max = __MAX( UDP_GSO_MAX_BYTES / p_sys->i_mtu, 1 );
+
+    for( ;; )
     {
         vlc_tick_t    i_date;
 
+        if( p_lookahead != NULL )
+        {
+            p_pk = p_lookahead;
+            p_lookahead = NULL;
+        }
+        else
+        {
+            p_pk = vlc_queue_DequeueKillable( &p_sys->queue, &p_sys->dead );
+            if( p_pk == NULL )
+                break;
+        }
+
         i_date = p_sys->i_caching + p_pk->i_dts;
         if( i_date_last > 0 )
         {
@@ -394,8 +572,6 @@ static void* ThreadWrite( void *data )
             vlc_tick_wait( i_date );
             i_to_send = i_group;
         }
-        if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
-            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
 
         if( i_dropped_packets )
         {
@@ -403,8 +579,38 @@ static void* ThreadWrite( void *data )
             i_dropped_packets = 0;
         }
 
+        /* Gather the queued packets that are due within the pacing window */
+        unsigned i_count = 0;
+        vlc_tick_t i_now = vlc_tick_now();
+
+        batch[i_count++] = p_pk;
         i_date_last = i_date;
 
+        while( i_count < i_batch_max )
+        {
+            block_t *p_next;
+
+            vlc_queue_Lock( &p_sys->queue );
+            p_next = vlc_queue_DequeueUnlocked( &p_sys->queue );
+            vlc_queue_Unlock( &p_sys->queue );
+            if( p_next == NULL )
+                break;
+
+            if( !CanBatch( p_sys, p_next, i_date_last, i_now ) )
+            {
+                p_lookahead = p_next;
+                break;
+            }
+            batch[i_count++] = p_next;
+            i_date_last = p_sys->i_caching + p_next->i_dts;
+            i_to_send--;
+        }
+        if( i_to_send <= 0 )
+            i_to_send = i_group;
+
+        i_calls += SendBatch( p_access, batch, i_count );
+        i_packets += i_count;
+
 #if 1
         i_date = vlc_tick_now() - i_date;
         if ( i_date > VLC_TICK_FROM_MS(20) )
@@ -414,8 +620,13 @@ static void* ThreadWrite( void *data )
         }
 #endif
 
-        block_Release( p_pk );
-
+        for( unsigned i = 0; i < i_count; i++ )
+            block_Release( batch[i] );
     }
+
+    if( p_lookahead != NULL )
+        block_Release( p_lookahead );
+    msg_Dbg( p_access, "sent %"PRIu64" packets with %"PRIu64" system calls",
+             i_packets, i_calls );
     return NULL;
 }
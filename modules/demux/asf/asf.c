@@ -60,6 +60,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("ASF/WMV demuxer") )
     set_capability( "demux", 200 )
+    set_probe_magic( 0, "\x30\x26\xB2\x75\x8E\x66\xCF\x11"
+                        "\xA6\xD9\x00\xAA\x00\x62\xCE\x6C" )
     set_callbacks( Open, Close )
     add_shortcut( "asf", "wmv" )
 vlc_module_end ()
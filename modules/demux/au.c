@@ -48,6 +48,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("AU demuxer") )
     set_capability( "demux", 10 )
+    set_probe_magic( 0, ".snd" )
     set_callback( Open )
     add_shortcut( "au" )
 vlc_module_end ()
@@ -475,5 +475,6 @@ vlc_module_begin()
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_DEMUX)
     set_capability("demux", 20)
+    set_probe_magic(0, "MUS\x1A")
     set_callbacks(Open, NULL)
 vlc_module_end()
@@ -50,6 +50,8 @@ static void Close ( vlc_object_t * );
 vlc_module_begin ()
     set_description( N_("FLAC demuxer") )
     set_capability( "demux", 155 )
+    set_probe_magic( 0, "fLaC" )
+    set_probe_mime_types( "audio/flac" )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_callbacks( Open, Close )
@@ -0,0 +1,225 @@
+/*****************************************************************************
+ * index_cache.c: demuxer index files in the user cache directory
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_strings.h>
+#include <vlc_hash.h>
+
+#include "index_cache.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#define INDEX_CACHE_DIR "seekindex"
+
+static char * GetDir( void )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_dir;
+
+    if( !psz_cachedir ||
+        asprintf( &psz_dir, "%s" DIR_SEP INDEX_CACHE_DIR, psz_cachedir ) == -1 )
+        psz_dir = NULL;
+    free( psz_cachedir );
+    return psz_dir;
+}
+
+int index_cache_GetIdentity( const char *psz_path, uint64_t *pi_size,
+                             int64_t *pi_mtime )
+{
+    struct stat st;
+
+    if( vlc_stat( psz_path, &st ) || !S_ISREG( st.st_mode ) )
+        return VLC_EGENERIC;
+    *pi_size = st.st_size;
+    *pi_mtime = st.st_mtime;
+    return VLC_SUCCESS;
+}
+
+char * index_cache_GetPath( const char *psz_path, const char *psz_tag )
+{
+    char *psz_dir = GetDir();
+    if( !psz_dir )
+        return NULL;
+
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, psz_path, strlen( psz_path ) );
+    vlc_hash_md5_Update( &md5, "\n", 1 );
+    vlc_hash_md5_Update( &md5, psz_tag, strlen( psz_tag ) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    char *psz_cache;
+    if( asprintf( &psz_cache, "%s" DIR_SEP "%s", psz_dir, psz_hash ) == -1 )
+        psz_cache = NULL;
+    free( psz_dir );
+    return psz_cache;
+}
+
+FILE * index_cache_OpenWrite( vlc_object_t *p_obj, const char *psz_cache,
+                              char **ppsz_tmp )
+{
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_dir = GetDir();
+    if( !psz_cachedir || !psz_dir )
+    {
+        free( psz_cachedir );
+        free( psz_dir );
+        return NULL;
+    }
+    vlc_mkdir( psz_cachedir, 0700 );
+    vlc_mkdir( psz_dir, 0700 );
+    free( psz_cachedir );
+    free( psz_dir );
+
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.tmp", psz_cache ) == -1 )
+        return NULL;
+
+    FILE *p_file = vlc_fopen( psz_tmp, "wb" );
+    if( !p_file )
+    {
+        msg_Dbg( p_obj, "cannot write index %s: %s", psz_tmp,
+                 vlc_strerror_c( errno ) );
+        free( psz_tmp );
+        return NULL;
+    }
+
+    *ppsz_tmp = psz_tmp;
+    return p_file;
+}
+
+typedef struct
+{
+    char    *psz_path;
+    time_t   i_mtime;
+    uint64_t i_size;
+} index_cache_entry_t;
+
+/* Most recently written first */
+static int CompareEntries( const void *a, const void *b )
+{
+    const index_cache_entry_t *p_a = a, *p_b = b;
+
+    return (p_a->i_mtime < p_b->i_mtime) - (p_a->i_mtime > p_b->i_mtime);
+}
+
+/* Removes the least recently written cache files beyond the limits, but
+ * never the one just written */
+static void Evict( vlc_object_t *p_obj, const char *psz_keep )
+{
+    char *psz_dir = GetDir();
+    if( !psz_dir )
+        return;
+
+    DIR *p_dir = vlc_opendir( psz_dir );
+    if( !p_dir )
+    {
+        free( psz_dir );
+        return;
+    }
+
+    index_cache_entry_t *p_entries = NULL;
+    size_t i_entries = 0, i_alloc = 0;
+    uint64_t i_total = 0;
+    const char *psz_name;
+
+    while( (psz_name = vlc_readdir( p_dir )) != NULL )
+    {
+        /* Skip "." and "..", and the temporary files being written */
+        if( strchr( psz_name, '.' ) )
+            continue;
+
+        index_cache_entry_t entry;
+        struct stat st;
+        if( asprintf( &entry.psz_path, "%s" DIR_SEP "%s", psz_dir, psz_name ) == -1 )
+            break;
+        if( vlc_stat( entry.psz_path, &st ) || !S_ISREG( st.st_mode ) )
+        {
+            free( entry.psz_path );
+            continue;
+        }
+        if( !strcmp( entry.psz_path, psz_keep ) )
+        {
+            i_total += st.st_size;
+            free( entry.psz_path );
+            continue;
+        }
+        entry.i_mtime = st.st_mtime;
+        entry.i_size = st.st_size;
+
+        if( i_entries == i_alloc )
+        {
+            const size_t i_new = i_alloc ? i_alloc * 2 : 64;
+            index_cache_entry_t *p_new =
+                vlc_reallocarray( p_entries, i_new, sizeof(*p_entries) );
+            if( !p_new )
+            {
+                free( entry.psz_path );
+                break;
+            }
+            p_entries = p_new;
+            i_alloc = i_new;
+        }
+        p_entries[i_entries++] = entry;
+    }
+    closedir( p_dir );
+    free( psz_dir );
+
+    if( i_entries > 0 )
+        qsort( p_entries, i_entries, sizeof(*p_entries), CompareEntries );
+
+    for( size_t i = 0; i < i_entries; i++ )
+    {
+        i_total += p_entries[i].i_size;
+        /* The kept file counts as the first one */
+        if( i + 1 >= INDEX_CACHE_MAX_FILES || i_total > INDEX_CACHE_MAX_SIZE )
+        {
+            msg_Dbg( p_obj, "removing index %s", p_entries[i].psz_path );
+            vlc_unlink( p_entries[i].psz_path );
+        }
+        free( p_entries[i].psz_path );
+    }
+    free( p_entries );
+}
+
+int index_cache_CloseWrite( vlc_object_t *p_obj, FILE *p_file, bool b_error,
+                            const char *psz_cache, char *psz_tmp )
+{
+    int i_ret = VLC_SUCCESS;
+
+    if( fclose( p_file ) || b_error || vlc_rename( psz_tmp, psz_cache ) )
+    {
+        msg_Dbg( p_obj, "cannot write index %s", psz_tmp );
+        vlc_unlink( psz_tmp );
+        i_ret = VLC_EGENERIC;
+    }
+    else
+        Evict( p_obj, psz_cache );
+    free( psz_tmp );
+    return i_ret;
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+ * index_cache.h: demuxer index files in the user cache directory
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_DEMUX_INDEX_CACHE_H
+#define VLC_DEMUX_INDEX_CACHE_H
+
+#include <stdio.h>
+
+/*
+ * Indexes built while demuxing large local files are kept in the
+ * "seekindex" subdirectory of the user cache directory, one file per
+ * indexed file and demuxer, named after the MD5 of the file path and a
+ * demuxer tag. The cache files record the size and modification time of
+ * the indexed file, so that outdated indexes are ignored.
+ *
+ * The least recently written cache files are removed beyond
+ * INDEX_CACHE_MAX_FILES files or INDEX_CACHE_MAX_SIZE bytes.
+ */
+
+#define INDEX_CACHE_MAX_FILES 256
+#define INDEX_CACHE_MAX_SIZE  (UINT64_C(32) << 20)
+
+/**
+ * Gets the size and modification time of a regular file.
+ */
+int index_cache_GetIdentity( const char *psz_path, uint64_t *pi_size,
+                             int64_t *pi_mtime );
+
+/**
+ * Gets the cache file path of an indexed file.
+ *
+ * \param psz_tag demuxer specific tag
+ * \return the path (to be freed), or NULL on error
+ */
+char * index_cache_GetPath( const char *psz_path, const char *psz_tag );
+
+/**
+ * Starts writing a cache file.
+ *
+ * The data is written to a temporary file, which replaces the cache file
+ * in index_cache_CloseWrite(), so that readers never see a partial index.
+ *
+ * \param ppsz_tmp [OUT] temporary file path, for index_cache_CloseWrite()
+ * \return the temporary file, or NULL on error
+ */
+FILE * index_cache_OpenWrite( vlc_object_t *, const char *psz_cache,
+                              char **ppsz_tmp );
+
+/**
+ * Finishes writing a cache file.
+ *
+ * \param b_error whether writing the data failed, in which case the
+ * temporary file is removed and the cache file is left unchanged
+ * \param psz_tmp temporary file path, freed by this function
+ * \return VLC_SUCCESS if the cache file was replaced
+ */
+int index_cache_CloseWrite( vlc_object_t *, FILE *, bool b_error,
+                            const char *psz_cache, char *psz_tmp );
+
+#endif
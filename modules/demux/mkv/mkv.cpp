@@ -52,6 +52,7 @@ vlc_module_begin ()
     set_shortname( "Matroska" )
     set_description( N_("Matroska stream demuxer" ) )
     set_capability( "demux", 50 )
+    set_probe_magic( 0, "\x1A\x45\xDF\xA3" )
     set_callbacks( Open, Close )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
@@ -21,9 +21,23 @@
 # include "config.h"
 #endif
 
+#include <vlc_common.h>
+#include <vlc_fs.h>
+
 #include "fragments.h"
+#include "../index_cache.h"
 #include <limits.h>
 
+/* Cache file layout, all integers big endian:
+ *  magic[8], version u32, file size u64, file mtime i64,
+ *  tracks u32, entries u32, last time i64
+ *  then entries times: moof position u64, tracks times i64 */
+#define FRAGMENTS_INDEX_MAGIC       "VLCMP4FI"
+#define FRAGMENTS_INDEX_VERSION     1
+#define FRAGMENTS_INDEX_HEADER_SIZE (8 + 4 + 8 + 8 + 4 + 4 + 8)
+#define FRAGMENTS_INDEX_MAX_TRACKS  256
+#define FRAGMENTS_INDEX_MAX_ENTRIES (1 << 20)
+
 void MP4_Fragments_Index_Delete( mp4_fragments_index_t *p_index )
 {
     if( p_index )
@@ -58,12 +72,20 @@ mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_n
 stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
                                               unsigned i_track_index, uint64_t i_moof_pos )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    /* first fragment at or after the moof, as positions are ordered */
+    size_t i_low = 0, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->pi_pos[i_mid] < i_moof_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
-    return 0;
+
+    if( i_low == p_index->i_entries )
+        return 0;
+    return p_index->p_times[i_low * p_index->i_tracks + i_track_index];
 }
 
 stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, unsigned i )
@@ -78,19 +100,161 @@ bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_tim
         i_track_index >= p_index->i_tracks )
         return false;
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    /* last fragment starting at or before the time, or the first one */
+    size_t i_low = 1, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_times[i_mid * p_index->i_tracks + i_track_index] <= *pi_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+
+    *pi_time = p_index->p_times[(i_low - 1) * p_index->i_tracks + i_track_index];
+    *pi_pos = p_index->pi_pos[i_low - 1];
+    return true;
+}
+
+/* Index cache file of a local file, or NULL if not to be cached */
+static char * GetCachePath( vlc_object_t *p_obj, const char *psz_path,
+                            uint64_t *pi_size, int64_t *pi_mtime )
+{
+    if( !psz_path || !var_InheritBool( p_obj, "demux-seek-index" ) ||
+        index_cache_GetIdentity( psz_path, pi_size, pi_mtime ) ||
+        *pi_size < MP4_FRAGMENTS_INDEX_MIN_FILESIZE )
+        return NULL;
+
+    return index_cache_GetPath( psz_path, "mp4frag" );
+}
+
+static bool ReadIndexEntries( FILE *p_file, mp4_fragments_index_t *p_index,
+                              uint64_t i_size )
+{
+    const size_t i_entry_size = 8 + 8 * (size_t)p_index->i_tracks;
+    uint8_t *p_entry = malloc( i_entry_size );
+    if( !p_entry )
+        return false;
+
+    bool b_ok = true;
+    for( unsigned i = 0; i < p_index->i_entries && b_ok; i++ )
+    {
+        if( fread( p_entry, 1, i_entry_size, p_file ) != i_entry_size )
         {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
-            return true;
+            b_ok = false;
+            break;
         }
+
+        p_index->pi_pos[i] = GetQWBE( p_entry );
+        for( unsigned j = 0; j < p_index->i_tracks; j++ )
+            p_index->p_times[(size_t)i * p_index->i_tracks + j] =
+                    GetQWBE( &p_entry[8 + 8 * j] );
+
+        /* positions are searched, and must be ordered */
+        b_ok = p_index->pi_pos[i] < i_size &&
+               ( i == 0 || p_index->pi_pos[i - 1] < p_index->pi_pos[i] );
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
-    return true;
+    free( p_entry );
+    return b_ok;
+}
+
+mp4_fragments_index_t * MP4_Fragments_Index_Load( vlc_object_t *p_obj,
+                                                  const char *psz_path,
+                                                  unsigned i_tracks )
+{
+    uint64_t i_size;
+    int64_t i_mtime;
+    char *psz_cache = GetCachePath( p_obj, psz_path, &i_size, &i_mtime );
+    if( !psz_cache )
+        return NULL;
+
+    FILE *p_file = vlc_fopen( psz_cache, "rb" );
+    free( psz_cache );
+    if( !p_file )
+        return NULL;
+
+    mp4_fragments_index_t *p_index = NULL;
+    uint8_t header[FRAGMENTS_INDEX_HEADER_SIZE];
+    if( fread( header, 1, sizeof(header), p_file ) != sizeof(header) ||
+        memcmp( header, FRAGMENTS_INDEX_MAGIC, 8 ) ||
+        GetDWBE( &header[8] ) != FRAGMENTS_INDEX_VERSION ||
+        GetDWBE( &header[28] ) != i_tracks ||
+        GetDWBE( &header[32] ) > FRAGMENTS_INDEX_MAX_ENTRIES )
+        goto end;
+
+    if( GetQWBE( &header[12] ) != i_size ||
+        (int64_t)GetQWBE( &header[20] ) != i_mtime )
+    {
+        msg_Dbg( p_obj, "outdated fragments index, file was modified" );
+        goto end;
+    }
+
+    p_index = MP4_Fragments_Index_New( i_tracks, GetDWBE( &header[32] ) );
+    if( !p_index )
+        goto end;
+    p_index->i_last_time = GetQWBE( &header[36] );
+
+    if( !ReadIndexEntries( p_file, p_index, i_size ) )
+    {
+        MP4_Fragments_Index_Delete( p_index );
+        p_index = NULL;
+        goto end;
+    }
+
+    msg_Dbg( p_obj, "loaded index of %u fragments", p_index->i_entries );
+
+end:
+    fclose( p_file );
+    return p_index;
+}
+
+void MP4_Fragments_Index_Save( vlc_object_t *p_obj, const char *psz_path,
+                               const mp4_fragments_index_t *p_index )
+{
+    if( p_index->i_tracks > FRAGMENTS_INDEX_MAX_TRACKS ||
+        p_index->i_entries > FRAGMENTS_INDEX_MAX_ENTRIES )
+        return;
+
+    uint64_t i_size;
+    int64_t i_mtime;
+    char *psz_cache = GetCachePath( p_obj, psz_path, &i_size, &i_mtime );
+    if( !psz_cache )
+        return;
+
+    char *psz_tmp;
+    FILE *p_file = index_cache_OpenWrite( p_obj, psz_cache, &psz_tmp );
+    if( !p_file )
+    {
+        free( psz_cache );
+        return;
+    }
+
+    uint8_t header[FRAGMENTS_INDEX_HEADER_SIZE];
+    memcpy( header, FRAGMENTS_INDEX_MAGIC, 8 );
+    SetDWBE( &header[8], FRAGMENTS_INDEX_VERSION );
+    SetQWBE( &header[12], i_size );
+    SetQWBE( &header[20], i_mtime );
+    SetDWBE( &header[28], p_index->i_tracks );
+    SetDWBE( &header[32], p_index->i_entries );
+    SetQWBE( &header[36], p_index->i_last_time );
+    bool b_error = fwrite( header, 1, sizeof(header), p_file ) != sizeof(header);
+
+    for( unsigned i = 0; i < p_index->i_entries && !b_error; i++ )
+    {
+        uint8_t entry[8 + 8 * FRAGMENTS_INDEX_MAX_TRACKS];
+        const size_t i_entry_size = 8 + 8 * (size_t)p_index->i_tracks;
+
+        SetQWBE( entry, p_index->pi_pos[i] );
+        for( unsigned j = 0; j < p_index->i_tracks; j++ )
+            SetQWBE( &entry[8 + 8 * j],
+                     p_index->p_times[(size_t)i * p_index->i_tracks + j] );
+        b_error = fwrite( entry, 1, i_entry_size, p_file ) != i_entry_size;
+    }
+
+    if( !index_cache_CloseWrite( p_obj, p_file, b_error, psz_cache, psz_tmp ) )
+        msg_Dbg( p_obj, "saved index of %u fragments", p_index->i_entries );
+    free( psz_cache );
 }
 
 #ifdef MP4_VERBOSE
@@ -42,6 +42,18 @@ stime_t MP4_Fragment_Index_GetTrackDuration( mp4_fragments_index_t *p_index, uns
 bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index,
                                  stime_t *pi_time, uint64_t *pi_pos, unsigned i_track_index );
 
+/* Files smaller than this are quick enough to probe without a cache */
+#define MP4_FRAGMENTS_INDEX_MIN_FILESIZE (INT64_C(64) << 20)
+
+/* The index built by probing the whole file is kept in the user cache
+ * directory, keyed by the local file path, and checked against the file
+ * size and modification time when loaded. */
+mp4_fragments_index_t * MP4_Fragments_Index_Load( vlc_object_t *p_obj,
+                                                  const char *psz_path,
+                                                  unsigned i_tracks );
+void MP4_Fragments_Index_Save( vlc_object_t *p_obj, const char *psz_path,
+                               const mp4_fragments_index_t *p_index );
+
 #ifdef MP4_VERBOSE
 void MP4_Fragments_Index_Dump( vlc_object_t *p_obj, const mp4_fragments_index_t *p_index,
                                 uint32_t i_movie_timescale );
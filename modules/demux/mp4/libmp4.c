@@ -1555,8 +1555,7 @@ static int MP4_ReadBox_LtdContainer( stream_t *p_stream, MP4_Box_t *p_box )
 
 static void MP4_FreeBox_stts( MP4_Box_t *p_box )
 {
-    free( p_box->data.p_stts->pi_sample_count );
-    free( p_box->data.p_stts->pi_sample_delta );
+    free( p_box->data.p_stts->p_buffer );
 }
 
 static int MP4_ReadBox_stts( stream_t *p_stream, MP4_Box_t *p_box )
@@ -1574,35 +1573,23 @@ static int MP4_ReadBox_stts( stream_t *p_stream, MP4_Box_t *p_box )
         MP4_READBOX_EXIT( 0 );
     }
 
-    p_box->data.p_stts->pi_sample_count = vlc_alloc( count, sizeof(uint32_t) );
-    p_box->data.p_stts->pi_sample_delta = vlc_alloc( count, sizeof(int32_t) );
     p_box->data.p_stts->i_entry_count = count;
 
-    if( p_box->data.p_stts->pi_sample_count == NULL
-     || p_box->data.p_stts->pi_sample_delta == NULL )
-    {
-        MP4_READBOX_EXIT( 0 );
-    }
-
-    for( uint32_t i = 0; i < count; i++ )
-    {
-        MP4_GET4BYTES( p_box->data.p_stts->pi_sample_count[i] );
-        MP4_GET4BYTES( p_box->data.p_stts->pi_sample_delta[i] );
-    }
-
 #ifdef MP4_VERBOSE
     msg_Dbg( p_stream, "read box: \"stts\" entry-count %d",
                       p_box->data.p_stts->i_entry_count );
 
 #endif
-    MP4_READBOX_EXIT( 1 );
+    /* entries are read in place when needed */
+    p_box->data.p_stts->p_entries = p_peek;
+    p_box->data.p_stts->p_buffer = p_buff;
+    return 1;
 }
 
 
 static void MP4_FreeBox_ctts( MP4_Box_t *p_box )
 {
-    free( p_box->data.p_ctts->pi_sample_count );
-    free( p_box->data.p_ctts->pi_sample_offset );
+    free( p_box->data.p_ctts->p_buffer );
 }
 
 static int MP4_ReadBox_ctts( stream_t *p_stream, MP4_Box_t *p_box )
@@ -1617,24 +1604,16 @@ static int MP4_ReadBox_ctts( stream_t *p_stream, MP4_Box_t *p_box )
     if( UINT64_C(8) * count > i_read )
         MP4_READBOX_EXIT( 0 );
 
-    p_box->data.p_ctts->pi_sample_count = vlc_alloc( count, sizeof(uint32_t) );
-    p_box->data.p_ctts->pi_sample_offset = vlc_alloc( count, sizeof(int32_t) );
-    if( unlikely(p_box->data.p_ctts->pi_sample_count == NULL
-              || p_box->data.p_ctts->pi_sample_offset == NULL) )
-        MP4_READBOX_EXIT( 0 );
     p_box->data.p_ctts->i_entry_count = count;
 
-    for( uint32_t i = 0; i < count; i++ )
-    {
-        MP4_GET4BYTES( p_box->data.p_ctts->pi_sample_count[i] );
-        MP4_GET4BYTES( p_box->data.p_ctts->pi_sample_offset[i] );
-    }
-
 #ifdef MP4_VERBOSE
     msg_Dbg( p_stream, "read box: \"ctts\" entry-count %"PRIu32, count );
 
 #endif
-    MP4_READBOX_EXIT( 1 );
+    /* entries are read in place when needed */
+    p_box->data.p_ctts->p_entries = p_peek;
+    p_box->data.p_ctts->p_buffer = p_buff;
+    return 1;
 }
 
 static int MP4_ReadBox_cslg( stream_t *p_stream, MP4_Box_t *p_box )
@@ -2907,7 +2886,7 @@ static int MP4_ReadBox_stsd( stream_t *p_stream, MP4_Box_t *p_box )
 
 static void MP4_FreeBox_stsz( MP4_Box_t *p_box )
 {
-    free( p_box->data.p_stsz->i_entry_size );
+    free( p_box->data.p_stsz->p_buffer );
 }
 
 static int MP4_ReadBox_stsz( stream_t *p_stream, MP4_Box_t *p_box )
@@ -2926,19 +2905,7 @@ static int MP4_ReadBox_stsz( stream_t *p_stream, MP4_Box_t *p_box )
     {
         if( UINT64_C(4) * count > i_read )
             MP4_READBOX_EXIT( 0 );
-
-        p_box->data.p_stsz->i_entry_size =
-            vlc_alloc( count, sizeof(uint32_t) );
-        if( unlikely( !p_box->data.p_stsz->i_entry_size ) )
-            MP4_READBOX_EXIT( 0 );
-
-        for( uint32_t i = 0; i < count; i++ )
-        {
-            MP4_GET4BYTES( p_box->data.p_stsz->i_entry_size[i] );
-        }
     }
-    else
-        p_box->data.p_stsz->i_entry_size = NULL;
 
 #ifdef MP4_VERBOSE
     msg_Dbg( p_stream, "read box: \"stsz\" sample-size %d sample-count %d",
@@ -2946,7 +2913,13 @@ static int MP4_ReadBox_stsz( stream_t *p_stream, MP4_Box_t *p_box )
                       p_box->data.p_stsz->i_sample_count );
 
 #endif
-    MP4_READBOX_EXIT( 1 );
+    if( p_box->data.p_stsz->i_sample_size != 0 )
+        MP4_READBOX_EXIT( 1 );
+
+    /* entries are read in place when needed */
+    p_box->data.p_stsz->p_entries = p_peek;
+    p_box->data.p_stsz->p_buffer = p_buff;
+    return 1;
 }
 
 static void MP4_FreeBox_stsc( MP4_Box_t *p_box )
@@ -3055,7 +3028,7 @@ static int MP4_ReadBox_tssy( stream_t *p_stream, MP4_Box_t *p_box )
 
 static void MP4_FreeBox_stco_co64( MP4_Box_t *p_box )
 {
-    free( p_box->data.p_co64->i_chunk_offset );
+    free( p_box->data.p_co64->p_buffer );
 }
 
 static int MP4_ReadBox_stco_co64( stream_t *p_stream, MP4_Box_t *p_box )
@@ -3071,25 +3044,18 @@ static int MP4_ReadBox_stco_co64( stream_t *p_stream, MP4_Box_t *p_box )
     if( (sixtyfour ? UINT64_C(8) : UINT64_C(4)) * count > i_read )
         MP4_READBOX_EXIT( 0 );
 
-    p_box->data.p_co64->i_chunk_offset = vlc_alloc( count, sizeof(uint64_t) );
-    if( unlikely(p_box->data.p_co64->i_chunk_offset == NULL) )
-        MP4_READBOX_EXIT( 0 );
     p_box->data.p_co64->i_entry_count = count;
-
-    for( uint32_t i = 0; i < count; i++ )
-    {
-        if( sixtyfour )
-            MP4_GET8BYTES( p_box->data.p_co64->i_chunk_offset[i] );
-        else
-            MP4_GET4BYTES( p_box->data.p_co64->i_chunk_offset[i] );
-    }
+    p_box->data.p_co64->b_64bits = sixtyfour;
 
 #ifdef MP4_VERBOSE
     msg_Dbg( p_stream, "read box: \"co64\" entry-count %d",
                       p_box->data.p_co64->i_entry_count );
 
 #endif
-    MP4_READBOX_EXIT( 1 );
+    /* entries are read in place when needed */
+    p_box->data.p_co64->p_entries = p_peek;
+    p_box->data.p_co64->p_buffer = p_buff;
+    return 1;
 }
 
 static void MP4_FreeBox_stss( MP4_Box_t *p_box )
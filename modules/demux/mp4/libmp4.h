@@ -664,8 +664,8 @@ typedef struct MP4_Box_data_stts_s
     uint32_t i_flags;
 
     uint32_t i_entry_count;
-    uint32_t *pi_sample_count; /* these are array */
-    int32_t  *pi_sample_delta;
+    const uint8_t *p_entries; /* sample count and delta pairs, as stored */
+    uint8_t *p_buffer;
 
 } MP4_Box_data_stts_t;
 
@@ -676,8 +676,8 @@ typedef struct MP4_Box_data_ctts_s
 
     uint32_t i_entry_count;
 
-    uint32_t *pi_sample_count; /* these are array */
-    int32_t *pi_sample_offset;
+    const uint8_t *p_entries; /* sample count and offset pairs, as stored */
+    uint8_t *p_buffer;
 
 } MP4_Box_data_ctts_t;
 
@@ -898,7 +898,8 @@ typedef struct MP4_Box_data_stsz_s
     uint32_t i_sample_size;
     uint32_t i_sample_count;
 
-    uint32_t *i_entry_size; /* array , empty if i_sample_size != 0 */
+    const uint8_t *p_entries; /* sizes as stored, NULL if i_sample_size != 0 */
+    uint8_t *p_buffer;
 
 } MP4_Box_data_stsz_t;
 
@@ -935,8 +936,10 @@ typedef struct MP4_Box_data_co64_s
     uint32_t i_flags;
 
     uint32_t i_entry_count;
+    bool     b_64bits; /* co64, or stco with 32 bits offsets */
 
-    uint64_t *i_chunk_offset;
+    const uint8_t *p_entries; /* offsets as stored */
+    uint8_t *p_buffer;
 
 } MP4_Box_data_co64_t;
 
@@ -1870,6 +1873,33 @@ static inline size_t mp4_box_headersize( MP4_Box_t *p_box )
         + ( p_box->i_type == ATOM_uuid ? 16 : 0 );
 }
 
+/* The sample tables are not expanded when read, as they can be huge and
+ * only a few entries are needed at a time: these read their entries. */
+static inline uint32_t MP4_xTTS_SampleCount( const uint8_t *p_entries,
+                                             uint32_t i )
+{
+    return GetDWBE( &p_entries[8 * i] );
+}
+
+static inline uint32_t MP4_xTTS_Value( const uint8_t *p_entries, uint32_t i )
+{
+    return GetDWBE( &p_entries[8 * i + 4] );
+}
+
+static inline uint32_t MP4_stsz_EntrySize( const MP4_Box_data_stsz_t *p_stsz,
+                                           uint32_t i )
+{
+    return GetDWBE( &p_stsz->p_entries[4 * i] );
+}
+
+static inline uint64_t MP4_co64_ChunkOffset( const MP4_Box_data_co64_t *p_co64,
+                                             uint32_t i )
+{
+    if( p_co64->b_64bits )
+        return GetQWBE( &p_co64->p_entries[8 * i] );
+    return GetDWBE( &p_co64->p_entries[4 * i] );
+}
+
 static inline int CmpUUID( const UUID_t *u1, const UUID_t *u2 )
 {
     return memcmp( u1, u2, 16 );
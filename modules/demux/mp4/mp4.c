@@ -335,33 +335,88 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-/* Return time in microsecond of a track */
-static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
+/* Advances a stts or ctts table position by up to i_samples, and returns
+ * the sum of the values of the samples passed */
+static uint64_t xTTS_Walk( const uint8_t *p_entries, uint32_t i_entry_count,
+                           mp4_xtts_pos_t *p_pos, uint32_t i_samples )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - p_chunk->i_sample_first;
-    int64_t sdts = p_chunk->i_first_dts;
+    uint64_t i_sum = 0;
 
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_samples > 0 && p_pos->i_index < i_entry_count )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        const uint32_t i_left = MP4_xTTS_SampleCount( p_entries, p_pos->i_index )
+                              - p_pos->i_skip;
+        const uint32_t i_value = MP4_xTTS_Value( p_entries, p_pos->i_index );
+        if( i_samples < i_left )
         {
-            sdts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            sdts += i_sample * p_chunk->p_sample_delta_dts[i_index];
+            i_sum += (uint64_t) i_samples * i_value;
+            p_pos->i_skip += i_samples;
             break;
         }
+        i_sum += (uint64_t) i_left * i_value;
+        i_samples -= i_left;
+        p_pos->i_index++;
+        p_pos->i_skip = 0;
+    }
+
+    /* point to the entry of the next sample, skipping empty ones */
+    while( p_pos->i_index < i_entry_count &&
+           p_pos->i_skip >= MP4_xTTS_SampleCount( p_entries, p_pos->i_index ) )
+    {
+        p_pos->i_index++;
+        p_pos->i_skip = 0;
     }
 
-    vlc_tick_t i_dts = MP4_rescale_mtime( sdts, p_track->i_timescale );
+    return i_sum;
+}
+
+/* Moves the tables lookup to the next sample to read, from the previous
+ * lookup when reading forward in the same chunk, else from the chunk start */
+static void MP4_TrackLookup( mp4_track_t *p_track )
+{
+    const mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+
+    if( p_track->lookup.i_chunk != p_track->i_chunk ||
+        p_track->lookup.i_sample > p_track->i_sample )
+    {
+        p_track->lookup.i_chunk = p_track->i_chunk;
+        p_track->lookup.i_sample = ck->i_sample_first;
+        p_track->lookup.dts = ck->dts;
+        p_track->lookup.pts = ck->pts;
+        p_track->lookup.i_dts = ck->i_first_dts;
+        p_track->lookup.i_offset = 0;
+    }
+
+    if( p_track->i_sample <= p_track->lookup.i_sample )
+        return;
+
+    const uint32_t i_samples = p_track->i_sample - p_track->lookup.i_sample;
+
+    p_track->lookup.i_dts += xTTS_Walk( p_track->p_stts->p_entries,
+                                        p_track->p_stts->i_entry_count,
+                                        &p_track->lookup.dts, i_samples );
+    if( p_track->p_ctts )
+        xTTS_Walk( p_track->p_ctts->p_entries, p_track->p_ctts->i_entry_count,
+                   &p_track->lookup.pts, i_samples );
+
+    if( p_track->i_sample_size == 0 )
+    {
+        for( uint32_t i = p_track->lookup.i_sample;
+             i < p_track->i_sample && i < p_track->p_stsz->i_sample_count; i++ )
+            p_track->lookup.i_offset += MP4_stsz_EntrySize( p_track->p_stsz, i );
+    }
+
+    p_track->lookup.i_sample = p_track->i_sample;
+}
+
+/* Return time in microsecond of a track */
+static inline vlc_tick_t MP4_TrackGetDTS( demux_t *p_demux, mp4_track_t *p_track )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    MP4_TrackLookup( p_track );
+
+    vlc_tick_t i_dts = MP4_rescale_mtime( p_track->lookup.i_dts, p_track->i_timescale );
 
     /* now handle elst */
     if( p_track->p_elst && p_track->BOXDATA(p_elst)->i_entry_count )
@@ -389,26 +444,21 @@ static inline bool MP4_TrackGetPTSDelta( demux_t *p_demux, mp4_track_t *p_track,
                                          vlc_tick_t *pi_delta )
 {
     VLC_UNUSED( p_demux );
-    mp4_chunk_t *ck = &p_track->chunk[p_track->i_chunk];
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
 
-    unsigned int i_index = 0;
-    unsigned int i_sample = p_track->i_sample - ck->i_sample_first;
-
-    if( ck->p_sample_count_pts == NULL || ck->p_sample_offset_pts == NULL )
+    if( ctts == NULL )
         return false;
 
-    for( i_index = 0; i_index < ck->i_entries_pts ; i_index++ )
-    {
-        if( i_sample < ck->p_sample_count_pts[i_index] )
-        {
-            *pi_delta = MP4_rescale_mtime( ck->p_sample_offset_pts[i_index],
-                                           p_track->i_timescale );
-            return true;
-        }
+    MP4_TrackLookup( p_track );
+    if( p_track->lookup.pts.i_index >= ctts->i_entry_count )
+        return false;
 
-        i_sample -= ck->p_sample_count_pts[i_index];
-    }
-    return false;
+    /* signed, even in version 0 tables */
+    const int32_t i_offset = (int32_t) MP4_xTTS_Value( ctts->p_entries,
+                                                       p_track->lookup.pts.i_index );
+    *pi_delta = MP4_rescale_mtime( i_offset + p_track->i_cts_shift,
+                                   p_track->i_timescale );
+    return true;
 }
 
 static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *p_track,
@@ -417,43 +467,20 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     VLC_UNUSED( p_demux );
 
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    stime_t i_duration = 0;
+    const uint32_t i_chunk_end = p_chunk->i_sample_first + p_chunk->i_sample_count;
 
-    /* Forward to right index, and set remaining count in that index */
-    unsigned i_index = 0;
-    unsigned i_remain = 0;
-    for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = p_track->i_sample - i;
-            break;
-        }
-    }
+    /* Only count the samples of the current chunk */
+    if( p_track->i_sample >= i_chunk_end )
+        return 0;
+    if( i_nb_samples > i_chunk_end - p_track->i_sample )
+        i_nb_samples = i_chunk_end - p_track->i_sample;
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    MP4_TrackLookup( p_track );
+
+    mp4_xtts_pos_t pos = p_track->lookup.dts;
+    stime_t i_duration = xTTS_Walk( p_track->p_stts->p_entries,
+                                    p_track->p_stts->i_entry_count,
+                                    &pos, i_nb_samples );
 
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
 }
@@ -2342,15 +2369,9 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     {
         mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
-        ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
+        ck->i_offset = MP4_co64_ChunkOffset( BOXDATA(p_co64), i_chunk );
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2412,54 +2433,6 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
-{
-    uint32_t i_array_offset;
-    while( i_sample_count > 0 )
-    {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EBADVAR;
-        }
-
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
-    }
-
-    return VLC_SUCCESS;
-}
-
 static int TrackCreateSamplesIndex( demux_t *p_demux,
                                     mp4_track_t *p_demux_track )
 {
@@ -2491,25 +2464,15 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 
     if( stsz->i_sample_size )
     {
-        /* 1: all sample have the same size, so no need to construct a table */
+        /* 1: all sample have the same size, so no need to read a table */
         p_demux_track->i_sample_size = stsz->i_sample_size;
-        p_demux_track->p_sample_size = NULL;
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, read from stsz */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
     }
+    p_demux_track->p_stsz = stsz;
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
     {
@@ -2521,16 +2484,13 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+    /* Use stts table to map sample numbers to dts.
+     * XXX: the tables can be huge, so they are not expanded: each chunk
+     *  only keeps its first dts and where its first sample is in the
+     *  stts and ctts tables, and the entries are read from there when
+     *  needed (see MP4_TrackLookup) */
 
-    int64_t i_next_dts = 0;
+    uint64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
@@ -2542,202 +2502,58 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        mp4_xtts_pos_t pos = { 0, 0 };
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        p_demux_track->p_stts = stts;
+        xTTS_Walk( stts->p_entries, stts->i_entry_count, &pos, 0 );
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
-            /* save first dts */
             ck->i_first_dts = i_next_dts;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            ck->dts = pos;
+            ck->i_duration = xTTS_Walk( stts->p_entries, stts->i_entry_count,
+                                        &pos, ck->i_sample_count );
+            i_next_dts += ck->i_duration;
         }
     }
 
-
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        mp4_xtts_pos_t pos = { 0, 0 };
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
-        int64_t i_cts_shift = 0;
+        p_demux_track->p_ctts = ctts;
+        p_demux_track->i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
         if( p_cslg && BOXDATA(p_cslg) )
-            i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
+            p_demux_track->i_cts_shift = BOXDATA(p_cslg)->ct_to_dts_shift;
 
-        /* Create pts-dts table per chunk */
-        uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        xTTS_Walk( ctts->p_entries, ctts->i_entry_count, &pos, 0 );
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( int32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
 
-
-            }
+            ck->pts = pos;
+            xTTS_Walk( ctts->p_entries, ctts->i_entry_count,
+                       &pos, ck->i_sample_count );
         }
     }
 
-    msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
+    p_demux_track->lookup.i_chunk = UINT32_MAX;
+
+    msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRIu64"s",
              p_demux_track->i_track_ID, p_demux_track->i_sample_count,
              i_next_dts / p_demux_track->i_timescale );
 
@@ -3074,52 +2890,49 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
         i_start = MP4_rescale_qtime( start, p_track->i_timescale );
     }
 
-    /* we start from sample 0/chunk 0, hope it won't take too much time */
     /* *** find good chunk *** */
-    for( i_chunk = 0; ; i_chunk++ )
-    {
-        if( i_chunk + 1 >= p_track->i_chunk_count )
-        {
-            /* at the end and can't check if i_start in this chunk,
-               it will be check while searching i_sample */
-            i_chunk = p_track->i_chunk_count - 1;
-            break;
-        }
-
-        if( (uint64_t)i_start >= p_track->chunk[i_chunk].i_first_dts &&
-            (uint64_t)i_start <  p_track->chunk[i_chunk + 1].i_first_dts )
-        {
-            break;
-        }
+    /* last chunk starting at or before i_start, as chunks dts are ordered,
+       i_start being after its end will be check while searching i_sample */
+    uint32_t i_low = 0, i_high = p_track->i_chunk_count;
+    while( i_high - i_low > 1 )
+    {
+        const uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_track->chunk[i_mid].i_first_dts <= (uint64_t)i_start )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
     }
+    i_chunk = i_low;
 
     /* *** find sample in the chunk *** */
-    i_sample = p_track->chunk[i_chunk].i_sample_first;
-    i_dts    = p_track->chunk[i_chunk].i_first_dts;
+    const mp4_chunk_t *ck = &p_track->chunk[i_chunk];
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
+    mp4_xtts_pos_t pos = ck->dts;
+    uint32_t i_left = ck->i_sample_count;
+
+    i_sample = ck->i_sample_first;
+    i_dts    = ck->i_first_dts;
 
-    for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
-         i_sample < p_track->chunk[i_chunk].i_sample_count;
-         i_index++ )
+    while( i_left > 0 && pos.i_index < stts->i_entry_count )
     {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
-        {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+        const uint32_t i_delta = MP4_xTTS_Value( stts->p_entries, pos.i_index );
+        uint32_t i_count = MP4_xTTS_SampleCount( stts->p_entries, pos.i_index )
+                         - pos.i_skip;
+        if( i_count > i_left )
+            i_count = i_left;
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+        if( i_dts + (uint64_t) i_count * i_delta < (uint64_t)i_start )
+        {
+            i_dts    += (uint64_t) i_count * i_delta;
+            i_sample += i_count;
+            i_left   -= i_count;
+            pos.i_index++;
+            pos.i_skip = 0;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
-            {
-                break;
-            }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            if( i_delta > 0 && (uint64_t)i_start > i_dts )
+                i_sample += ( i_start - i_dts ) / i_delta;
             break;
         }
     }
@@ -3530,15 +3343,6 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     p_track->b_ok = true;
 }
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
-}
-
 /****************************************************************************
  * MP4_TrackClean:
  ****************************************************************************
@@ -3551,16 +3355,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     if ( p_track->asfinfo.p_frame )
         block_ChainRelease( p_track->asfinfo.p_frame );
 
@@ -3729,7 +3525,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
         *pi_nb_samples = 1;
 
         if( p_track->i_sample_size == 0 ) /* all sizes are different */
-            return p_track->p_sample_size[p_track->i_sample];
+            return MP4_stsz_EntrySize( p_track->p_stsz, p_track->i_sample );
         else
             return p_track->i_sample_size;
     }
@@ -3767,7 +3563,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
         if( p_track->i_sample_size == 0 )
         {
             *pi_nb_samples = 1;
-            return p_track->p_sample_size[p_track->i_sample];
+            return MP4_stsz_EntrySize( p_track->p_stsz, p_track->i_sample );
         }
 
         /* If we are compressed but not v2 LPCM frames extensions */
@@ -3777,7 +3573,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
             if ( p_track->i_sample_size )
                 return p_track->i_sample_size;
             else
-                return p_track->p_sample_size[p_track->i_sample];
+                return MP4_stsz_EntrySize( p_track->p_stsz, p_track->i_sample );
         }
 
         /* More regular V0 cases */
@@ -3856,7 +3652,7 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
                  i<p_track->i_sample_count;
                  i++ )
             {
-                i_size += p_track->p_sample_size[i];
+                i_size += MP4_stsz_EntrySize( p_track->p_stsz, i );
                 (*pi_nb_samples)++;
 
                 /* Try to detect compression in ISO */
@@ -3877,7 +3673,6 @@ static uint32_t MP4_TrackGetReadSize( mp4_track_t *p_track, uint32_t *pi_nb_samp
 
 static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
 {
-    unsigned int i_sample;
     uint64_t i_pos;
 
     i_pos = p_track->chunk[p_track->i_chunk].i_offset;
@@ -3910,11 +3705,8 @@ static uint64_t MP4_TrackGetPos( mp4_track_t *p_track )
     }
     else
     {
-        for( i_sample = p_track->chunk[p_track->i_chunk].i_sample_first;
-             i_sample < p_track->i_sample; i_sample++ )
-        {
-            i_pos += p_track->p_sample_size[i_sample];
-        }
+        MP4_TrackLookup( p_track );
+        i_pos += p_track->lookup.i_offset;
     }
 
     return i_pos;
@@ -4222,7 +4014,19 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
     if( !p_vroot )
         return VLC_EGENERIC;
 
-    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    /* Same file as the last time, no need to read it whole again */
+    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) &&
+        !p_sys->p_fragsindex )
+        p_sys->p_fragsindex = MP4_Fragments_Index_Load( VLC_OBJECT(p_demux),
+                                                        p_demux->psz_filepath,
+                                                        p_sys->i_tracks );
+
+    if( p_sys->p_fragsindex )
+    {
+        p_sys->b_fragments_probed = true;
+        *pb_fragmented = true;
+    }
+    else if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
     {
         MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
         p_sys->b_fragments_probed = true;
@@ -4293,6 +4097,9 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
 #ifdef MP4_VERBOSE
             MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
 #endif
+            if( !p_demux->b_preparsing )
+                MP4_Fragments_Index_Save( VLC_OBJECT(p_demux), p_demux->psz_filepath,
+                                          p_sys->p_fragsindex );
         }
     }
     else
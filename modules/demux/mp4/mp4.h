@@ -30,6 +30,13 @@
 #include "fragments.h"
 #include "../asf/asfpacket.h"
 
+/* Position of a sample in a stts or ctts table */
+typedef struct
+{
+    uint32_t     i_index; /* table entry */
+    uint32_t     i_skip;  /* samples of that entry before this one */
+} mp4_xtts_pos_t;
+
 /* Contain all information about a chunk */
 typedef struct
 {
@@ -47,17 +54,9 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    int32_t      *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    /* where the tables entries of the first sample are */
+    mp4_xtts_pos_t dts;
+    mp4_xtts_pos_t pts;
 
 } mp4_chunk_t;
 
@@ -139,11 +138,26 @@ typedef struct
 
     mp4_chunk_t    *chunk; /* always defined  for each chunk */
 
-    /* sample size, p_sample_size defined only if i_sample_size == 0
+    /* sample size, p_stsz entries used only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+
+    /* sample tables, read on demand */
+    const MP4_Box_data_stsz_t *p_stsz;
+    const MP4_Box_data_stts_t *p_stts;
+    const MP4_Box_data_ctts_t *p_ctts; /* could be NULL */
+    int64_t          i_cts_shift;
+
+    /* tables lookup of the last sample, from its chunk start */
+    struct
+    {
+        uint32_t       i_chunk; /* UINT32_MAX if unset */
+        uint32_t       i_sample;
+        mp4_xtts_pos_t dts;
+        mp4_xtts_pos_t pts;
+        uint64_t       i_dts;
+        uint64_t       i_offset; /* sizes sum from the chunk start */
+    } lookup;
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
@@ -55,6 +55,8 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("MusePack demuxer") )
     set_capability( "demux", 145 )
+    set_probe_magic( 0, "MP+" )
+    set_probe_extensions( "mpc,mp+,mpp" )
 
     set_callbacks( Open, Close )
     add_shortcut( "mpc" )
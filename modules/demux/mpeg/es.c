@@ -41,6 +41,7 @@
 #include "../../meta_engine/ID3Tag.h"
 #include "../../meta_engine/ID3Text.h"
 #include "../../meta_engine/ID3Meta.h"
+#include "seekindex.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -142,6 +143,7 @@ typedef struct
     vlc_tick_t  i_pts;
     vlc_tick_t  i_time_offset;
     int64_t     i_bytes;
+    bool        b_exact_time; /* false after seeking by bitrate */
 
     bool        b_big_endian;
     bool        b_estimate_bitrate;
@@ -154,6 +156,9 @@ typedef struct
     uint64_t i_stream_offset;
     unsigned i_demux_flags;
 
+    seek_index_t *p_index;
+    uint64_t i_block_pos; /* last block read, relative to i_stream_offset */
+
     float   f_fps;
 
     /* Mpga specific */
@@ -236,6 +241,7 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->b_estimate_bitrate = true;
     p_sys->i_bitrate_avg = 0;
     p_sys->b_big_endian = false;
+    p_sys->b_exact_time = true;
     p_sys->f_fps = var_InheritFloat( p_demux, "es-fps" );
     p_sys->p_packetized_data = NULL;
     p_sys->chapters.i_current = 0;
@@ -280,6 +286,12 @@ static int OpenCommon( demux_t *p_demux,
         }
     }
 
+    bool b_seekable = false;
+    vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_seekable );
+    if( b_seekable && !p_demux->b_preparsing )
+        p_sys->p_index = seek_index_New( VLC_OBJECT(p_demux),
+                                         p_demux->psz_filepath, "es" );
+
     for( ;; )
     {
         if( Parse( p_demux, &p_sys->p_packetized_data ) )
@@ -389,6 +401,12 @@ static int Demux( demux_t *p_demux )
         {
             p_block_out->i_dts += p_sys->i_time_offset;
             es_out_SetPCR( p_demux->out, p_block_out->i_dts );
+
+            /* The frame was completed by the last block read, seeking
+             * there resumes within a frame of it */
+            if( p_sys->p_index && p_sys->b_exact_time )
+                seek_index_Add( p_sys->p_index, p_block_out->i_dts - VLC_TICK_0,
+                                p_sys->i_block_pos );
         }
         /* Re-estimate bitrate */
         if( p_sys->b_estimate_bitrate && p_sys->i_pts > VLC_TICK_FROM_MS(500) )
@@ -420,6 +438,8 @@ static void Close( vlc_object_t * p_this )
     TAB_CLEAN( p_sys->chapters.i_count, p_sys->chapters.p_entry );
     if( p_sys->mllt.p_bits )
         free( p_sys->mllt.p_bits );
+    if( p_sys->p_index )
+        seek_index_Delete( p_sys->p_index );
     demux_PacketizerDestroy( p_sys->p_packetizer );
     free( p_sys );
 }
@@ -434,6 +454,7 @@ static int MovetoTimePos( demux_t *p_demux, vlc_tick_t i_time, uint64_t i_pos )
     if( i_ret != VLC_SUCCESS )
         return i_ret;
     p_sys->i_time_offset = i_time - p_sys->i_pts;
+    p_sys->b_exact_time = true;
     /* And reset buffered data */
     if( p_sys->p_packetized_data )
         block_ChainRelease( p_sys->p_packetized_data );
@@ -494,15 +515,30 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         }
 
         case DEMUX_SET_TIME:
+        {
+            va_list ap;
+            vlc_tick_t i_time;
+            uint64_t i_pos;
+
+            va_copy( ap, args );
+            i_time = va_arg( ap, vlc_tick_t );
+            va_end( ap );
+
+            /* Position of an already played time */
+            vlc_tick_t i_index_time;
+            if( p_sys->p_index &&
+                !seek_index_Lookup( p_sys->p_index, i_time, &i_index_time, &i_pos ) )
+                return MovetoTimePos( p_demux, i_index_time, i_pos );
+
             if( p_sys->mllt.p_bits )
             {
-                vlc_tick_t i_time = va_arg(args, vlc_tick_t);
-                uint64_t i_pos = SeekByMlltTable( p_demux, &i_time );
+                i_pos = SeekByMlltTable( p_demux, &i_time );
                 return MovetoTimePos( p_demux, i_time, i_pos );
             }
             /* FIXME TODO: implement a high precision seek (with mp3 parsing)
              * needed for multi-input */
             break;
+        }
 
         case DEMUX_GET_TITLE_INFO:
         {
@@ -583,6 +619,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
     if( i_query == DEMUX_SET_POSITION || i_query == DEMUX_SET_TIME )
     {
+        p_sys->b_exact_time = false;
         if( p_sys->i_bitrate_avg > 0 )
         {
             int64_t i_time = INT64_C(8000000)
@@ -625,6 +662,7 @@ static bool Parse( demux_t *p_demux, block_t **pp_output )
             return true;
     }
 
+    p_sys->i_block_pos = vlc_stream_Tell( p_demux->s ) - p_sys->i_stream_offset;
     p_block_in = vlc_stream_Block( p_demux->s, p_sys->i_packet_size );
     bool b_eof = p_block_in == NULL;
 
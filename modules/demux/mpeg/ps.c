@@ -34,6 +34,7 @@
 
 #include "pes.h"
 #include "ps.h"
+#include "seekindex.h"
 
 /* TODO:
  *  - re-add pre-scanning.
@@ -96,6 +97,9 @@ typedef struct
     vlc_tick_t  i_current_pts;
     uint64_t    i_start_byte;
     uint64_t    i_lastpack_byte;
+    uint64_t    i_lastpack_start_byte;
+
+    seek_index_t *p_index; /* pack positions of the time track PTS */
 
     int         i_aob_mlp_count;
 
@@ -220,6 +224,7 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     p_sys->i_aob_mlp_count = 0;
     p_sys->i_start_byte = i_skip;
     p_sys->i_lastpack_byte = i_skip;
+    p_sys->i_lastpack_start_byte = i_skip;
 
     p_sys->b_lost_sync = false;
     p_sys->b_have_pack = false;
@@ -232,6 +237,10 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
 
     vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
 
+    p_sys->p_index = NULL;
+    if( p_sys->b_seekable && !p_demux->b_preparsing )
+        p_sys->p_index = seek_index_New( p_this, p_demux->psz_filepath, "ps" );
+
     ps_psm_init( &p_sys->psm );
     ps_track_init( p_sys->tk );
 
@@ -271,6 +280,9 @@ static void Close( vlc_object_t *p_this )
 
     ps_psm_destroy( &p_sys->psm );
 
+    if( p_sys->p_index )
+        seek_index_Delete( p_sys->p_index );
+
     free( p_sys );
 }
 
@@ -470,6 +482,7 @@ static int Demux( demux_t *p_demux )
             CheckPCR( p_sys, p_demux->out, p_sys->i_pack_scr );
             p_sys->i_scr = p_sys->i_pack_scr;
             p_sys->i_lastpack_byte = vlc_stream_Tell( p_demux->s );
+            p_sys->i_lastpack_start_byte = p_sys->i_lastpack_byte - p_pkt->i_buffer;
             if( !p_sys->b_have_pack ) p_sys->b_have_pack = true;
             /* done later on to work around bad vcd/svcd streams */
             /* es_out_SetPCR( p_demux->out, p_sys->i_scr ); */
@@ -644,6 +657,16 @@ static int Demux( demux_t *p_demux )
                     p_sys->i_current_pts = p_pkt->i_pts;
                 }
 
+                if( p_sys->p_index && p_sys->b_have_pack &&
+                    p_sys->i_time_track_index >= 0 &&
+                    tk == &p_sys->tk[p_sys->i_time_track_index] &&
+                    p_pkt->i_pts != VLC_TICK_INVALID )
+                {
+                    /* Same time base as DEMUX_GET_TIME */
+                    seek_index_Add( p_sys->p_index, p_pkt->i_pts - tk->i_first_pts,
+                                    p_sys->i_lastpack_start_byte );
+                }
+
                 if( tk->i_next_block_flags )
                 {
                     p_pkt->i_flags = tk->i_next_block_flags;
@@ -772,10 +795,24 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_SET_TIME:
         {
+            vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+            vlc_tick_t i_index_time;
+            uint64_t i_index_pos;
+
+            /* Exact position of an already played time */
+            if( p_sys->p_index && p_sys->i_time_track_index >= 0 &&
+                !seek_index_Lookup( p_sys->p_index, i_time, &i_index_time, &i_index_pos ) &&
+                vlc_stream_Seek( p_demux->s, i_index_pos ) == VLC_SUCCESS )
+            {
+                p_sys->i_current_pts = VLC_TICK_INVALID;
+                p_sys->i_scr = VLC_TICK_INVALID;
+                NotifyDiscontinuity( p_sys->tk, p_demux->out );
+                return VLC_SUCCESS;
+            }
+
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID &&
                 p_sys->i_length > VLC_TICK_0)
             {
-                vlc_tick_t i_time = va_arg( args, vlc_tick_t );
                 i_time -= p_sys->tk[p_sys->i_time_track_index].i_first_pts;
                 return demux_Control( p_demux, DEMUX_SET_POSITION, (double) i_time / p_sys->i_length );
             }
@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * seekindex.c: time to byte position index for MPEG demuxers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+
+#include "seekindex.h"
+#include "../index_cache.h"
+
+#include <assert.h>
+
+/* Cache file layout, all integers big endian:
+ *  magic[8], version u32, format[8], file size u64, file mtime i64, count u32
+ *  then count times: time i64, position u64 */
+#define SEEK_INDEX_MAGIC        "VLCSKIDX"
+#define SEEK_INDEX_VERSION      1
+#define SEEK_INDEX_HEADER_SIZE  (8 + 4 + 8 + 8 + 8 + 4)
+#define SEEK_INDEX_ENTRY_SIZE   (8 + 8)
+#define SEEK_INDEX_MAX_ENTRIES  (1 << 20)
+
+typedef struct
+{
+    vlc_tick_t i_time;
+    uint64_t   i_pos;
+} seek_index_entry_t;
+
+struct seek_index_t
+{
+    vlc_object_t *p_obj;
+
+    seek_index_entry_t *p_entries;
+    size_t i_entries;
+    size_t i_alloc;
+
+    char  psz_format[8];
+    char *psz_path;         /* indexed file, NULL if not cached */
+    char *psz_cache;        /* cache file */
+    bool  b_dirty;
+};
+
+static bool EntriesAreOrdered( const seek_index_entry_t *p_prev,
+                               const seek_index_entry_t *p_next )
+{
+    return p_prev->i_time < p_next->i_time && p_prev->i_pos <= p_next->i_pos;
+}
+
+static int Load( seek_index_t *p_index )
+{
+    uint64_t i_size;
+    int64_t i_mtime;
+    if( index_cache_GetIdentity( p_index->psz_path, &i_size, &i_mtime ) )
+        return VLC_EGENERIC;
+
+    FILE *p_file = vlc_fopen( p_index->psz_cache, "rb" );
+    if( !p_file )
+        return VLC_EGENERIC;
+
+    uint8_t header[SEEK_INDEX_HEADER_SIZE];
+    if( fread( header, 1, sizeof(header), p_file ) != sizeof(header) ||
+        memcmp( header, SEEK_INDEX_MAGIC, 8 ) ||
+        GetDWBE( &header[8] ) != SEEK_INDEX_VERSION ||
+        memcmp( &header[12], p_index->psz_format, 8 ) )
+        goto error;
+
+    if( GetQWBE( &header[20] ) != i_size ||
+        (int64_t)GetQWBE( &header[28] ) != i_mtime )
+    {
+        msg_Dbg( p_index->p_obj, "outdated seek index, file was modified" );
+        goto error;
+    }
+
+    const uint32_t i_count = GetDWBE( &header[36] );
+    if( i_count > SEEK_INDEX_MAX_ENTRIES )
+        goto error;
+
+    seek_index_entry_t *p_entries = vlc_alloc( i_count, sizeof(*p_entries) );
+    if( i_count && !p_entries )
+        goto error;
+
+    for( uint32_t i = 0; i < i_count; i++ )
+    {
+        uint8_t entry[SEEK_INDEX_ENTRY_SIZE];
+        if( fread( entry, 1, sizeof(entry), p_file ) != sizeof(entry) )
+        {
+            free( p_entries );
+            goto error;
+        }
+        p_entries[i].i_time = GetQWBE( &entry[0] );
+        p_entries[i].i_pos = GetQWBE( &entry[8] );
+        if( p_entries[i].i_pos > i_size ||
+            ( i > 0 && !EntriesAreOrdered( &p_entries[i - 1], &p_entries[i] ) ) )
+        {
+            free( p_entries );
+            goto error;
+        }
+    }
+    fclose( p_file );
+
+    free( p_index->p_entries );
+    p_index->p_entries = p_entries;
+    p_index->i_entries = p_index->i_alloc = i_count;
+    msg_Dbg( p_index->p_obj, "loaded %"PRIu32" seek index entries", i_count );
+    return VLC_SUCCESS;
+
+error:
+    fclose( p_file );
+    return VLC_EGENERIC;
+}
+
+static void Save( seek_index_t *p_index )
+{
+    /* Identity at the end of playback, as the file may have been growing */
+    uint64_t i_size;
+    int64_t i_mtime;
+    if( index_cache_GetIdentity( p_index->psz_path, &i_size, &i_mtime ) )
+        return;
+
+    char *psz_tmp;
+    FILE *p_file = index_cache_OpenWrite( p_index->p_obj, p_index->psz_cache,
+                                          &psz_tmp );
+    if( !p_file )
+        return;
+
+    uint8_t header[SEEK_INDEX_HEADER_SIZE];
+    memcpy( header, SEEK_INDEX_MAGIC, 8 );
+    SetDWBE( &header[8], SEEK_INDEX_VERSION );
+    memcpy( &header[12], p_index->psz_format, 8 );
+    SetQWBE( &header[20], i_size );
+    SetQWBE( &header[28], i_mtime );
+    SetDWBE( &header[36], p_index->i_entries );
+    bool b_error = fwrite( header, 1, sizeof(header), p_file ) != sizeof(header);
+
+    for( size_t i = 0; i < p_index->i_entries && !b_error; i++ )
+    {
+        uint8_t entry[SEEK_INDEX_ENTRY_SIZE];
+        SetQWBE( &entry[0], p_index->p_entries[i].i_time );
+        SetQWBE( &entry[8], p_index->p_entries[i].i_pos );
+        b_error = fwrite( entry, 1, sizeof(entry), p_file ) != sizeof(entry);
+    }
+
+    if( !index_cache_CloseWrite( p_index->p_obj, p_file, b_error,
+                                 p_index->psz_cache, psz_tmp ) )
+        msg_Dbg( p_index->p_obj, "saved %zu seek index entries",
+                 p_index->i_entries );
+}
+
+seek_index_t * seek_index_New( vlc_object_t *p_obj, const char *psz_path,
+                               const char *psz_format )
+{
+    assert( strlen( psz_format ) <= 8 );
+
+    if( !var_InheritBool( p_obj, "demux-seek-index" ) )
+        return NULL;
+
+    seek_index_t *p_index = malloc( sizeof(*p_index) );
+    if( !p_index )
+        return NULL;
+
+    p_index->p_obj = p_obj;
+    p_index->p_entries = NULL;
+    p_index->i_entries = 0;
+    p_index->i_alloc = 0;
+    p_index->b_dirty = false;
+    memset( p_index->psz_format, 0, 8 );
+    memcpy( p_index->psz_format, psz_format, strlen( psz_format ) );
+    p_index->psz_path = NULL;
+    p_index->psz_cache = NULL;
+
+    uint64_t i_size;
+    int64_t i_mtime;
+    if( psz_path &&
+        !index_cache_GetIdentity( psz_path, &i_size, &i_mtime ) &&
+        i_size >= SEEK_INDEX_MIN_FILESIZE )
+    {
+        p_index->psz_path = strdup( psz_path );
+        p_index->psz_cache = index_cache_GetPath( psz_path, psz_format );
+        if( !p_index->psz_path || !p_index->psz_cache )
+        {
+            free( p_index->psz_path );
+            free( p_index->psz_cache );
+            p_index->psz_path = p_index->psz_cache = NULL;
+        }
+        else
+            Load( p_index );
+    }
+
+    return p_index;
+}
+
+void seek_index_Delete( seek_index_t *p_index )
+{
+    if( p_index->b_dirty && p_index->psz_cache )
+        Save( p_index );
+    free( p_index->psz_path );
+    free( p_index->psz_cache );
+    free( p_index->p_entries );
+    free( p_index );
+}
+
+/* Returns the number of entries at or before i_time */
+static size_t UpperBound( const seek_index_t *p_index, vlc_tick_t i_time )
+{
+    size_t i_low = 0, i_high = p_index->i_entries;
+
+    while( i_low < i_high )
+    {
+        const size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_entries[i_mid].i_time <= i_time )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+void seek_index_Add( seek_index_t *p_index, vlc_tick_t i_time, uint64_t i_pos )
+{
+    const seek_index_entry_t entry = { i_time, i_pos };
+    size_t i;
+
+    /* Fast path while playing forward */
+    if( p_index->i_entries == 0 ||
+        p_index->p_entries[p_index->i_entries - 1].i_time <= i_time )
+        i = p_index->i_entries;
+    else
+        i = UpperBound( p_index, i_time );
+
+    if( i > 0 )
+    {
+        const seek_index_entry_t *p_prev = &p_index->p_entries[i - 1];
+        if( i_time - p_prev->i_time < SEEK_INDEX_SPACING ||
+            !EntriesAreOrdered( p_prev, &entry ) )
+            return;
+    }
+    if( i < p_index->i_entries )
+    {
+        const seek_index_entry_t *p_next = &p_index->p_entries[i];
+        if( p_next->i_time - i_time < SEEK_INDEX_SPACING ||
+            !EntriesAreOrdered( &entry, p_next ) )
+            return;
+    }
+
+    if( p_index->i_entries == p_index->i_alloc )
+    {
+        if( p_index->i_alloc >= SEEK_INDEX_MAX_ENTRIES )
+            return;
+        const size_t i_alloc = p_index->i_alloc ? p_index->i_alloc * 2 : 256;
+        seek_index_entry_t *p_entries =
+            vlc_reallocarray( p_index->p_entries, i_alloc, sizeof(*p_entries) );
+        if( !p_entries )
+            return;
+        p_index->p_entries = p_entries;
+        p_index->i_alloc = i_alloc;
+    }
+
+    memmove( &p_index->p_entries[i + 1], &p_index->p_entries[i],
+             (p_index->i_entries - i) * sizeof(entry) );
+    p_index->p_entries[i] = entry;
+    p_index->i_entries++;
+    p_index->b_dirty = true;
+}
+
+int seek_index_Lookup( const seek_index_t *p_index, vlc_tick_t i_time,
+                       vlc_tick_t *pi_time, uint64_t *pi_pos )
+{
+    const size_t i = UpperBound( p_index, i_time );
+    if( i == 0 )
+        return VLC_EGENERIC;
+
+    const seek_index_entry_t *p_entry = &p_index->p_entries[i - 1];
+    if( i_time - p_entry->i_time >= SEEK_INDEX_MAX_GAP )
+        return VLC_EGENERIC;
+
+    *pi_time = p_entry->i_time;
+    *pi_pos = p_entry->i_pos;
+    return VLC_SUCCESS;
+}
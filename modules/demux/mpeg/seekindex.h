@@ -0,0 +1,75 @@
+/*****************************************************************************
+ * seekindex.h: time to byte position index for MPEG demuxers
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_MPEG_SEEKINDEX_H
+#define VLC_MPEG_SEEKINDEX_H
+
+/* Minimum time between two index entries */
+#define SEEK_INDEX_SPACING      VLC_TICK_FROM_SEC(1)
+/* Maximum distance from the seek target to the entry used */
+#define SEEK_INDEX_MAX_GAP      VLC_TICK_FROM_SEC(2)
+/* Files smaller than this are quick enough to seek without a cache */
+#define SEEK_INDEX_MIN_FILESIZE (INT64_C(64) << 20)
+
+/**
+ * Time to byte position index, filled by the demuxer with the timestamps
+ * it reads while playing, and used for exact seeking to the places that
+ * have already been played.
+ *
+ * For large local files, the index is kept in the user cache directory,
+ * keyed by the file path, and checked against the file size and
+ * modification time, so that it is still available when the same file
+ * is played again.
+ */
+typedef struct seek_index_t seek_index_t;
+
+/**
+ * Creates an index, loading its cached copy if any.
+ *
+ * \param psz_path local file path, or NULL if the index is not to be cached
+ * \param psz_format demuxer specific tag, part of the cache key, and
+ * checked when loading (at most 8 characters)
+ * \return the index, or NULL if disabled or on error
+ */
+seek_index_t * seek_index_New( vlc_object_t *, const char *psz_path,
+                               const char *psz_format );
+
+/**
+ * Deletes the index, updating its cached copy if new entries were added.
+ */
+void seek_index_Delete( seek_index_t * );
+
+/**
+ * Adds an entry. Entries closer than SEEK_INDEX_SPACING to an existing one,
+ * or not consistent with the existing byte order, are ignored.
+ */
+void seek_index_Add( seek_index_t *, vlc_tick_t i_time, uint64_t i_pos );
+
+/**
+ * Finds the last entry at or before a time.
+ *
+ * \param pi_time [OUT] time of the entry
+ * \param pi_pos [OUT] byte position of the entry
+ * \return VLC_SUCCESS if an entry less than SEEK_INDEX_MAX_GAP before
+ * i_time exists
+ */
+int seek_index_Lookup( const seek_index_t *, vlc_tick_t i_time,
+                       vlc_tick_t *pi_time, uint64_t *pi_pos );
+
+#endif
@@ -34,6 +34,7 @@
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_modules.h> /* module_exists() */
 
 #include "ts_pid.h"
 #include "ts_streams.h"
@@ -407,6 +408,12 @@ static int Open( vlc_object_t *p_this )
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
+    if( ts_batch_Init( &p_sys->batch, i_packet_size, i_packet_header_size ) )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     vlc_dictionary_init( &p_sys->attachments, 0 );
 
     p_sys->patfix.i_first_dts = -1;
@@ -417,12 +424,14 @@ static int Open( vlc_object_t *p_this )
     patpid = GetPID(p_sys, 0);
     if ( !PIDSetup( p_demux, TYPE_PAT, patpid, NULL ) )
     {
+        ts_batch_Clean( &p_sys->batch );
         free( p_sys );
         return VLC_ENOMEM;
     }
     if( !ts_psi_PAT_Attach( patpid, p_demux ) )
     {
         PIDRelease( p_demux, patpid );
+        ts_batch_Clean( &p_sys->batch );
         free( p_sys );
         return VLC_EGENERIC;
     }
@@ -495,6 +504,10 @@ static int Open( vlc_object_t *p_this )
     }
     free( psz_string );
 
+    /* Read the packets in place from the stream blocks, e.g. file mappings,
+     * unless they are descrambled in place */
+    p_sys->batch.b_blocks = p_sys->csa == NULL && p_sys->stream->pf_block != NULL;
+
     p_sys->b_split_es = var_InheritBool( p_demux, "ts-split-es" );
 
     p_sys->b_canseek = false;
@@ -530,6 +543,17 @@ static int Open( vlc_object_t *p_this )
     vlc_stream_Control( p_sys->stream, STREAM_CAN_FASTSEEK,
                         &p_sys->b_canfastseek );
 
+    /* The ARIB descrambler is inserted once the PMT is parsed: packets read
+     * ahead of it could not be read again from a non seekable stream */
+    if( !p_sys->b_canseek &&
+        ( p_sys->standard == TS_STANDARD_AUTO || p_sys->standard == TS_STANDARD_ARIB ) &&
+        module_exists( "aribcam" ) )
+        p_sys->batch.b_readahead = false;
+
+    ARRAY_INIT( p_sys->seekindex.programs );
+    p_sys->seekindex.b_enabled = p_sys->b_canfastseek && !p_sys->b_access_control &&
+                                 !p_demux->b_preparsing;
+
     if( !p_sys->b_access_control && var_CreateGetBool( p_demux, "ts-pmtfix-waitdata" ) )
         p_sys->es_creation = DELAY_ES;
     else
@@ -590,6 +614,12 @@ static void Close( vlc_object_t *p_this )
     /* Clear up attachments */
     vlc_dictionary_clear( &p_sys->attachments, FreeDictAttachment, NULL );
 
+    ts_seek_index_t seekindex;
+    ARRAY_FOREACH( seekindex, p_sys->seekindex.programs )
+        seek_index_Delete( seekindex.p_index );
+    ARRAY_RESET( p_sys->seekindex.programs );
+
+    ts_batch_Clean( &p_sys->batch );
     free( p_sys );
 }
 
@@ -615,6 +645,22 @@ static int ChangeKeyCallback( vlc_object_t *p_this, char const *psz_cmd,
     return i_tmp;
 }
 
+static void TSPacketViewRelease( block_t *p_pkt )
+{
+    VLC_UNUSED(p_pkt); /* owned by the batch */
+}
+
+static const struct vlc_block_callbacks ts_packet_view_cbs =
+{
+    TSPacketViewRelease,
+};
+
+/* Stream position of the next packet to demux */
+uint64_t TSTell( demux_sys_t *p_sys )
+{
+    return vlc_stream_Tell( p_sys->stream ) - ts_batch_Pending( &p_sys->batch );
+}
+
 /*****************************************************************************
  * Demux:
  *****************************************************************************/
@@ -636,38 +682,45 @@ static int Demux( demux_t *p_demux )
     {
         bool         b_frame = false;
         int          i_header = 0;
+        block_t      pkt_view;
         block_t     *p_pkt;
-        if( !(p_pkt = ReadTSPacket( p_demux )) )
+        uint8_t     *p_data;
+        uint16_t     i_pid;
+        if( !(p_data = ts_batch_Read( &p_sys->batch, VLC_OBJECT(p_demux),
+                                      p_sys->stream, &i_pid )) )
         {
             return VLC_DEMUXER_EOF;
         }
 
+        /* Packets are processed in the batch, PES payloads being copied
+         * to their stream gather buffer */
+        p_pkt = block_Init( &pkt_view, &ts_packet_view_cbs, p_data,
+                            p_sys->i_packet_size - p_sys->i_packet_header_size );
+
         if( p_sys->b_start_record )
         {
-            /* Enable recording once synchronized */
+            /* Enable recording once synchronized, without losing the
+             * packets already read ahead if possible */
+            const size_t i_ahead = ts_batch_Pending( &p_sys->batch );
+            if( i_ahead > 0 && p_sys->b_canseek &&
+                vlc_stream_Seek( p_sys->stream, TSTell( p_sys ) ) == VLC_SUCCESS )
+                ts_batch_Flush( &p_sys->batch );
             vlc_stream_Control( p_sys->stream, STREAM_SET_RECORD_STATE, true,
                                 "ts" );
             p_sys->b_start_record = false;
         }
 
-        /* Early reject truncated packets from hw devices */
-        if( unlikely(p_pkt->i_buffer < TS_PACKET_SIZE_188) )
-        {
-            block_Release( p_pkt );
-            continue;
-        }
-
         /* Reject any fully uncorrected packet. Even PID can be incorrect */
         if( p_pkt->p_buffer[1]&0x80 )
         {
             msg_Dbg( p_demux, "transport_error_indicator set (pid=%d)",
-                     PIDGet( p_pkt ) );
+                     i_pid );
             block_Release( p_pkt );
             continue;
         }
 
         /* Parse the TS packet */
-        ts_pid_t *p_pid = GetPID( p_sys, PIDGet( p_pkt ) );
+        ts_pid_t *p_pid = GetPID( p_sys, i_pid );
         if( !SEEN(p_pid) )
         {
             if( p_pid->type == TYPE_FREE )
@@ -731,6 +784,7 @@ static int Demux( demux_t *p_demux )
 
             if( p_pid->u.p_stream->transport == TS_TRANSPORT_PES )
             {
+                /* PES packets are gathered until complete */
                 b_frame = GatherPESData( p_demux, p_pid, p_pkt, i_header );
             }
             else if( p_pid->u.p_stream->transport == TS_TRANSPORT_SECTIONS )
@@ -952,7 +1006,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = TSTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1145,9 +1199,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        ts_batch_Flush( &p_sys->batch );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        ts_batch_Flush( &p_sys->batch );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1888,9 +1944,8 @@ static inline void FlushESBuffer( ts_stream_t *p_pes )
     if( p_pes->gather.p_data )
     {
         p_pes->gather.i_gathered = p_pes->gather.i_data_size = 0;
-        block_ChainRelease( p_pes->gather.p_data );
+        block_Release( p_pes->gather.p_data );
         p_pes->gather.p_data = NULL;
-        p_pes->gather.pp_last = &p_pes->gather.p_data;
         p_pes->gather.i_saved = 0;
     }
     if( p_pes->p_proc )
@@ -1901,6 +1956,9 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    /* Packets read ahead are from before the seek */
+    ts_batch_Flush( &p_sys->batch );
+
     ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
     for( int i=0; i< p_pat->programs.i_size; i++ )
     {
@@ -1936,6 +1994,55 @@ static void ReadyQueuesPostSeek( demux_t *p_demux )
     }
 }
 
+/* Returns the seek index of the program, kept until the demuxer is closed,
+ * as PCRs of several selected programs may be interleaved */
+static seek_index_t * GetSeekIndex( demux_t *p_demux, const ts_pmt_t *p_pmt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->seekindex.b_enabled )
+        return NULL;
+
+    ts_seek_index_t seekindex;
+    ARRAY_FOREACH( seekindex, p_sys->seekindex.programs )
+    {
+        if( seekindex.i_program == p_pmt->i_number )
+            return seekindex.p_index;
+    }
+
+    /* Times are relative to the program first PCR */
+    char psz_format[9];
+    snprintf( psz_format, sizeof(psz_format), "ts%d", p_pmt->i_number );
+    seekindex.i_program = p_pmt->i_number;
+    seekindex.p_index = seek_index_New( VLC_OBJECT(p_demux),
+                                        p_demux->psz_filepath, psz_format );
+    if( !seekindex.p_index )
+    {
+        p_sys->seekindex.b_enabled = false;
+        return NULL;
+    }
+    ARRAY_APPEND( p_sys->seekindex.programs, seekindex );
+    return seekindex.p_index;
+}
+
+static void SeekIndexAddPCR( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_pcr )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_pmt->b_selected || p_pmt->pcr.i_first == -1 )
+        return;
+
+    seek_index_t *p_index = GetSeekIndex( p_demux, p_pmt );
+    if( p_index )
+    {
+        /* Relative to the first PCR, across the 33 bits wrap */
+        const stime_t i_time =
+            TimeStampWrapAround( p_pmt->pcr.i_first, i_pcr ) - p_pmt->pcr.i_first;
+        seek_index_Add( p_index, FROM_SCALE(i_time),
+                        TSTell( p_sys ) - p_sys->i_packet_size );
+    }
+}
+
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaledtime )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -1944,6 +2051,18 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
         return vlc_stream_Seek( p_sys->stream, 0 );
 
+    /* Use the PCR positions already seen, if close enough */
+    seek_index_t *p_index = GetSeekIndex( p_demux, p_pmt );
+    const stime_t i_indexed = TimeStampWrapAround( p_pmt->pcr.i_first, i_scaledtime )
+                            - p_pmt->pcr.i_first;
+    vlc_tick_t i_indextime;
+    uint64_t i_indexpos;
+    if( p_index &&
+        !seek_index_Lookup( p_index, FROM_SCALE(i_indexed),
+                            &i_indextime, &i_indexpos ) &&
+        vlc_stream_Seek( p_sys->stream, i_indexpos ) == VLC_SUCCESS )
+        return VLC_SUCCESS;
+
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
@@ -2251,14 +2370,14 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            TSTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = TSTell( p_sys );
             }
         }
     }
@@ -2266,24 +2385,14 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
 
 static int IsVideoEnd( ts_pid_t *p_pid )
 {
-    /* jump to near end of PES packet */
-    block_t *p = p_pid->u.p_stream->gather.p_data;
-    if( !p || !p->p_next )
-        return 0;
-    while( p->p_next->p_next )
-        p = p->p_next;
-    if( p->p_next->i_buffer > 4)
-        p = p->p_next;
-
-    /* extract last bytes */
-    uint8_t tail[ 188 ];
-    const int i_tail = block_ChainExtract( p, tail, sizeof( tail ) );
-    if( i_tail < 4 )
+    /* check for start code at end of PES packet */
+    const block_t *p = p_pid->u.p_stream->gather.p_data;
+    if( !p || p->i_buffer < 4 )
         return 0;
 
-    /* check for start code at end */
-    return ( tail[ i_tail - 4 ] == 0 && tail[ i_tail - 3 ] == 0 && tail[ i_tail - 2 ] == 1 &&
-             ( tail[ i_tail - 1 ] == 0xb7 ||  tail[ i_tail - 1 ] == 0x0a ) );
+    const uint8_t *tail = &p->p_buffer[p->i_buffer - 4];
+    return ( tail[0] == 0 && tail[1] == 0 && tail[2] == 1 &&
+             ( tail[3] == 0xb7 || tail[3] == 0x0a ) );
 }
 
 static void PCRCheckDTS( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr)
@@ -2379,6 +2488,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
             {
                 /* ? update PCR for the whole group program ? */
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                SeekIndexAddPCR( p_demux, p_pmt, i_pcr );
             }
         }
         else /* set PCR provided by current pid to program(s) referencing it */
@@ -2389,6 +2499,7 @@ static void PCRHandle( demux_t *p_demux, ts_pid_t *pid, stime_t i_pcr )
                 /* We've found a target group for update */
                 PCRCheckDTS( p_demux, p_pmt, i_pcr );
                 ProgramSetPCR( p_demux, p_pmt, i_program_pcr );
+                SeekIndexAddPCR( p_demux, p_pmt, i_pcr );
             }
         }
 
@@ -20,6 +20,9 @@
 #ifndef VLC_TS_H
 #define VLC_TS_H
 
+#include "ts_batch.h"
+#include "seekindex.h"
+
 #ifdef HAVE_ARIBB24
     typedef struct arib_instance_t arib_instance_t;
 #endif
@@ -51,6 +54,12 @@ typedef struct
     int i_service;
 } vdr_info_t;
 
+typedef struct
+{
+    uint16_t      i_program;
+    seek_index_t *p_index;
+} ts_seek_index_t;
+
 struct demux_sys_t
 {
     stream_t   *stream;
@@ -71,9 +80,19 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* TS packets read ahead from the stream */
+    ts_batch_t  batch;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
+    /* PCR positions of the selected programs, used for seeking */
+    struct
+    {
+        DECL_ARRAY(ts_seek_index_t) programs;
+        bool          b_enabled;
+    } seekindex;
+
     ts_standards_e standard;
 
     struct
@@ -148,6 +167,8 @@ void TsChangeStandard( demux_sys_t *, ts_standards_e );
 
 bool ProgramIsSelected( demux_sys_t *, uint16_t i_pgrm );
 
+uint64_t TSTell( demux_sys_t * );
+
 void UpdatePESFilters( demux_t *p_demux, bool b_all );
 
 int ProbeStart( demux_t *p_demux, int i_program );
@@ -0,0 +1,286 @@
+/*****************************************************************************
+ * ts_batch.c: Transport Stream batched packet reading
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_cpu.h>
+
+#include "ts_batch.h"
+
+#include <assert.h>
+
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+
+int ts_batch_Init( ts_batch_t *p_batch, unsigned i_packet_size,
+                   unsigned i_header_size )
+{
+    assert( i_header_size + 4 <= i_packet_size );
+
+    p_batch->p_buffer = malloc( TS_BATCH_PACKETS * i_packet_size );
+    if( !p_batch->p_buffer )
+        return VLC_ENOMEM;
+    p_batch->p_block = NULL;
+    p_batch->b_blocks = false;
+    p_batch->b_readahead = true;
+    p_batch->i_packet_size = i_packet_size;
+    p_batch->i_header_size = i_header_size;
+    ts_batch_Flush( p_batch );
+    return VLC_SUCCESS;
+}
+
+void ts_batch_Clean( ts_batch_t *p_batch )
+{
+    if( p_batch->p_block )
+        block_Release( p_batch->p_block );
+    free( p_batch->p_buffer );
+}
+
+void ts_batch_Flush( ts_batch_t *p_batch )
+{
+    /* The block is released by the next read, since the last packet
+     * may have been read in place from it */
+    p_batch->i_block_left = 0;
+    p_batch->p_data = p_batch->p_buffer;
+    p_batch->i_buffer = 0;
+    p_batch->i_offset = 0;
+    p_batch->i_checked = 0;
+    p_batch->i_next = 0;
+}
+
+static inline uint16_t HeaderPID( const uint8_t *p )
+{
+    return ((p[1] & 0x1f) << 8) | p[2];
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+__attribute__ ((__target__ ("avx2")))
+static unsigned ScanAVX2( const uint8_t *p_buf, size_t i_stride,
+                          unsigned i_count, uint16_t *pi_pid )
+{
+    const __m256i offsets = _mm256_mullo_epi32( _mm256_set1_epi32( i_stride ),
+                                    _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ) );
+    const __m256i sync_mask = _mm256_set1_epi32( 0xff );
+    const __m256i sync = _mm256_set1_epi32( 0x47 );
+    const __m256i pid_hi_mask = _mm256_set1_epi32( 0x1f00 );
+    unsigned i = 0;
+
+    for( ; i + 8 <= i_count; i += 8 )
+    {
+        /* First 4 bytes of 8 packets, the sync byte in the low byte */
+        const __m256i hdr = _mm256_i32gather_epi32( (const int *)(p_buf + i * i_stride),
+                                                    offsets, 1 );
+        const __m256i ok = _mm256_cmpeq_epi32( _mm256_and_si256( hdr, sync_mask ), sync );
+        const unsigned i_ok = _mm256_movemask_ps( _mm256_castsi256_ps( ok ) );
+
+        const __m256i pid = _mm256_or_si256(
+                                _mm256_and_si256( hdr, pid_hi_mask ),
+                                _mm256_and_si256( _mm256_srli_epi32( hdr, 16 ), sync_mask ) );
+        const __m256i pid16 = _mm256_permute4x64_epi64( _mm256_packus_epi32( pid, pid ), 0x08 );
+        _mm_storeu_si128( (__m128i *)&pi_pid[i], _mm256_castsi256_si128( pid16 ) );
+
+        if( i_ok != 0xff )
+            return i + ctz( ~i_ok );
+    }
+
+    for( ; i < i_count; i++ )
+    {
+        const uint8_t *p = p_buf + i * i_stride;
+        if( p[0] != 0x47 )
+            break;
+        pi_pid[i] = HeaderPID( p );
+    }
+    return i;
+}
+#endif
+
+unsigned ts_batch_Scan( const uint8_t *p_buf, size_t i_stride,
+                        unsigned i_count, uint16_t *pi_pid )
+{
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+        return ScanAVX2( p_buf, i_stride, i_count, pi_pid );
+#endif
+
+    unsigned i = 0;
+    for( ; i < i_count; i++ )
+    {
+        const uint8_t *p = p_buf + i * i_stride;
+        if( p[0] != 0x47 )
+            break;
+        pi_pid[i] = HeaderPID( p );
+    }
+    return i;
+}
+
+/* Bytes in the read window after the next packet */
+static inline size_t WindowPending( const ts_batch_t *p_batch )
+{
+    return p_batch->i_buffer - p_batch->i_offset;
+}
+
+/* Reads from the stream until at least i_min bytes are pending.
+ * Partial reads return as soon as data is available, so that live streams
+ * are not delayed until a whole batch is received. */
+static int Fill( ts_batch_t *p_batch, stream_t *s, size_t i_min )
+{
+    const size_t i_size = p_batch->b_readahead
+                        ? TS_BATCH_PACKETS * p_batch->i_packet_size : i_min;
+    size_t i_pending = WindowPending( p_batch );
+
+    assert( i_min <= TS_BATCH_PACKETS * p_batch->i_packet_size );
+    memmove( p_batch->p_buffer, &p_batch->p_data[p_batch->i_offset], i_pending );
+    p_batch->p_data = p_batch->p_buffer;
+    p_batch->i_buffer = i_pending;
+    p_batch->i_offset = 0;
+
+    while( p_batch->i_buffer < i_min )
+    {
+        ssize_t i_read = vlc_stream_ReadPartial( s, &p_batch->p_buffer[p_batch->i_buffer],
+                                                 i_size - p_batch->i_buffer );
+        if( i_read <= 0 )
+            return VLC_EGENERIC;
+        p_batch->i_buffer += i_read;
+    }
+    return VLC_SUCCESS;
+}
+
+/* Reads from the current block, or the next ones, until at least i_min bytes
+ * are pending. The bytes are read in place if they are in a single block,
+ * otherwise they are gathered in the batch buffer. */
+static int FillBlocks( ts_batch_t *p_batch, stream_t *s, size_t i_min )
+{
+    size_t i_pending = WindowPending( p_batch );
+
+    assert( i_min <= TS_BATCH_PACKETS * p_batch->i_packet_size );
+    memmove( p_batch->p_buffer, &p_batch->p_data[p_batch->i_offset], i_pending );
+    p_batch->p_data = p_batch->p_buffer;
+    p_batch->i_buffer = i_pending;
+    p_batch->i_offset = 0;
+
+    while( p_batch->i_buffer < i_min )
+    {
+        block_t *p_block = p_batch->p_block;
+
+        if( p_batch->i_block_left == 0 )
+        {
+            if( p_block )
+                block_Release( p_block );
+            p_batch->p_block = p_block = vlc_stream_ReadBlock( s );
+            if( p_block == NULL )
+            {
+                if( vlc_stream_Eof( s ) )
+                    return VLC_EGENERIC;
+                continue; /* no data yet, retry as vlc_stream_Read() does */
+            }
+            p_batch->i_block_left = p_block->i_buffer;
+        }
+
+        uint8_t *p_left = &p_block->p_buffer[p_block->i_buffer - p_batch->i_block_left];
+        if( p_batch->i_buffer == 0 && p_batch->i_block_left >= i_min )
+        {
+            /* Nothing to gather: read in place */
+            p_batch->p_data = p_left;
+            p_batch->i_buffer = p_batch->i_block_left;
+            p_batch->i_block_left = 0;
+            break;
+        }
+
+        size_t i_copy = __MIN( i_min - p_batch->i_buffer, p_batch->i_block_left );
+        memcpy( &p_batch->p_buffer[p_batch->i_buffer], p_left, i_copy );
+        p_batch->i_buffer += i_copy;
+        p_batch->i_block_left -= i_copy;
+    }
+    return VLC_SUCCESS;
+}
+
+uint8_t * ts_batch_Read( ts_batch_t *p_batch, vlc_object_t *p_obj, stream_t *s,
+                         uint16_t *pi_pid )
+{
+    const size_t i_size = p_batch->i_packet_size;
+    const size_t i_header = p_batch->i_header_size;
+    bool b_synced = true;
+    /* First offset to test when resynchronizing: the packet at the current
+     * offset is known to be lost, unless it was left untested by the last
+     * round, for lack of the next packet to check */
+    size_t i_first = 1;
+
+    while( p_batch->i_next == p_batch->i_checked )
+    {
+        const size_t i_pending = WindowPending( p_batch );
+
+        /* Resynchronizing needs two packets to check consecutive sync bytes */
+        const size_t i_min = b_synced ? i_size : 2 * i_size;
+        if( i_pending < i_min )
+        {
+            if( (p_batch->b_blocks && p_batch->b_readahead ? FillBlocks : Fill)( p_batch, s, i_min ) )
+            {
+                int64_t i_stream_size = stream_Size( s );
+                uint64_t i_pos = vlc_stream_Tell( s );
+                if( i_stream_size >= 0 && (uint64_t)i_stream_size == i_pos )
+                    msg_Dbg( p_obj, "EOF at %"PRIu64, i_pos );
+                else
+                    msg_Dbg( p_obj, "Can't read TS packet at %"PRIu64, i_pos );
+                return NULL;
+            }
+            continue;
+        }
+
+        const uint8_t *p = &p_batch->p_data[p_batch->i_offset + i_header];
+        if( b_synced )
+        {
+            /* Check sync bytes and extract PIDs of the packets read */
+            p_batch->i_checked = ts_batch_Scan( p, i_size,
+                                                __MIN( i_pending / i_size, TS_BATCH_PACKETS ),
+                                                p_batch->pi_pid );
+            p_batch->i_next = 0;
+            if( p_batch->i_checked == 0 )
+            {
+                msg_Warn( p_obj, "lost synchro" );
+                b_synced = false;
+            }
+            continue;
+        }
+
+        size_t i_skip = i_first;
+        while( i_skip + i_header + i_size < i_pending )
+        {
+            if( p[i_skip] == 0x47 && p[i_skip + i_size] == 0x47 )
+            {
+                b_synced = true;
+                break;
+            }
+            i_skip++;
+        }
+        i_first = 0;
+        if( i_skip > 0 )
+            msg_Dbg( p_obj, "skipping %zu bytes of garbage", i_skip );
+        p_batch->i_offset += i_skip;
+    }
+
+    uint8_t *p_pkt = &p_batch->p_data[p_batch->i_offset + i_header];
+    *pi_pid = p_batch->pi_pid[p_batch->i_next++];
+    p_batch->i_offset += i_size;
+    return p_pkt;
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * ts_batch.h: Transport Stream batched packet reading
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_BATCH_H
+#define VLC_TS_BATCH_H
+
+/* Packets read from the stream at once */
+#define TS_BATCH_PACKETS 128
+
+/**
+ * Reads TS packets from the stream by chunks, instead of one block per
+ * packet, and checks their sync bytes and extracts their PIDs by groups.
+ *
+ * Packets are returned in place, and remain valid until the next read.
+ * If b_blocks is set, they are read in place from the blocks of the stream,
+ * and only the packets split across two blocks are copied. The packets must
+ * then not be modified, since the blocks may be read-only file mappings.
+ * If b_readahead is unset, no more than the packet returned is read, so that
+ * the stream can be replaced between two packets, e.g. by a stream filter.
+ */
+typedef struct
+{
+    uint8_t *p_buffer;          /* TS_BATCH_PACKETS packets */
+    uint8_t *p_data;            /* read window: p_buffer, or block data */
+    size_t   i_buffer;          /* bytes in the read window */
+    size_t   i_offset;          /* offset of the next packet */
+    block_t *p_block;           /* stream block being read (or NULL) */
+    size_t   i_block_left;      /* bytes of p_block after the read window */
+    bool     b_blocks;          /* read the stream blocks in place */
+    bool     b_readahead;       /* read up to TS_BATCH_PACKETS at once */
+    unsigned i_packet_size;     /* 188, 192 or 204 */
+    unsigned i_header_size;     /* bytes before the sync byte */
+
+    /* PIDs of the packets from i_offset onward with a checked sync byte */
+    uint16_t pi_pid[TS_BATCH_PACKETS];
+    unsigned i_checked;
+    unsigned i_next;
+} ts_batch_t;
+
+int ts_batch_Init( ts_batch_t *, unsigned i_packet_size, unsigned i_header_size );
+void ts_batch_Clean( ts_batch_t * );
+
+/**
+ * Drops the packets read ahead, e.g. after a seek.
+ * The last packet read remains valid until the next read.
+ */
+void ts_batch_Flush( ts_batch_t * );
+
+/**
+ * Returns the number of bytes read ahead from the stream.
+ */
+static inline size_t ts_batch_Pending( const ts_batch_t *p_batch )
+{
+    return p_batch->i_buffer - p_batch->i_offset + p_batch->i_block_left;
+}
+
+/**
+ * Reads the next packet, resynchronizing on the sync byte if needed.
+ *
+ * \param pi_pid [OUT] PID of the packet
+ * \return the packet, from its sync byte on, with i_packet_size minus
+ * i_header_size valid bytes, or NULL at the end of the stream
+ */
+uint8_t * ts_batch_Read( ts_batch_t *, vlc_object_t *, stream_t *,
+                         uint16_t *pi_pid );
+
+/**
+ * Extracts the PIDs of consecutive packets.
+ *
+ * \param p_buf sync byte of the first packet
+ * \param i_stride packet size
+ * \param i_count number of packets
+ * \param pi_pid [OUT] PIDs
+ * \return the number of leading packets with a valid sync byte
+ */
+unsigned ts_batch_Scan( const uint8_t *p_buf, size_t i_stride,
+                        unsigned i_count, uint16_t *pi_pid );
+
+#endif
@@ -96,6 +96,45 @@ static uint8_t *FindNextPESHeader( uint8_t *p_buf, size_t i_buffer )
     return NULL;
 }
 
+/* Copies a packet payload to the PES buffer. The buffer is allocated once
+ * from the PES size, or from the previous PES size when it is unbounded,
+ * and only grown when that guess was too small. */
+static void ts_pes_Append( ts_stream_t *p_pes, block_t *p_pkt )
+{
+    block_t *p_data = p_pes->gather.p_data;
+    const size_t i_gathered = p_pes->gather.i_gathered;
+    const size_t i_size = i_gathered + p_pkt->i_buffer;
+
+    if( p_data == NULL )
+    {
+        size_t i_alloc = p_pes->gather.i_data_size ? p_pes->gather.i_data_size
+                                                   : p_pes->gather.i_last_size;
+        p_data = block_Alloc( __MAX( i_alloc, i_size ) );
+        if( p_data != NULL )
+            p_data->i_flags = p_pkt->i_flags;
+    }
+    else if( (size_t)(p_data->p_start + p_data->i_size - p_data->p_buffer) < i_size )
+    {
+        p_data = block_Realloc( p_data, 0, __MAX( i_size, 2 * i_gathered ) );
+    }
+
+    if( unlikely(p_data == NULL) )
+    {
+        /* drop that PES, the next packets are not starting a new one */
+        p_pes->gather.i_data_size = 0;
+        p_pes->gather.i_gathered = 0;
+        p_pes->gather.p_data = NULL;
+        block_Release( p_pkt );
+        return;
+    }
+
+    memcpy( &p_data->p_buffer[i_gathered], p_pkt->p_buffer, p_pkt->i_buffer );
+    p_data->i_buffer = i_size;
+    p_pes->gather.p_data = p_data;
+    p_pes->gather.i_gathered = i_size;
+    block_Release( p_pkt );
+}
+
 static bool ts_pes_Push( ts_pes_parse_callback *cb,
                   ts_stream_t *p_pes, block_t *p_pkt, bool b_unit_start )
 {
@@ -103,13 +142,13 @@ static bool ts_pes_Push( ts_pes_parse_callback *cb,
 
     if ( b_unit_start && p_pes->gather.p_data )
     {
-        block_t *p_datachain = p_pes->gather.p_data;
+        block_t *p_data = p_pes->gather.p_data;
         /* Flush the pes from pid */
         p_pes->gather.p_data = NULL;
         p_pes->gather.i_data_size = 0;
+        p_pes->gather.i_last_size = p_pes->gather.i_gathered;
         p_pes->gather.i_gathered = 0;
-        p_pes->gather.pp_last = &p_pes->gather.p_data;
-        cb->pf_parse( cb->p_obj, cb->priv, p_datachain );
+        cb->pf_parse( cb->p_obj, cb->priv, p_data );
         b_ret = true;
     }
 
@@ -129,8 +168,7 @@ static bool ts_pes_Push( ts_pes_parse_callback *cb,
         return b_ret;
     }
 
-    block_ChainLastAppend( &p_pes->gather.pp_last, p_pkt );
-    p_pes->gather.i_gathered += p_pkt->i_buffer;
+    ts_pes_Append( p_pes, p_pkt );
 
     if( p_pes->gather.i_data_size > 0 &&
         p_pes->gather.i_gathered >= p_pes->gather.i_data_size )
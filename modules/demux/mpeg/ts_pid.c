@@ -42,8 +42,8 @@ void ts_pid_list_Init( ts_pid_list_t *p_list )
     p_list->pp_all = NULL;
     p_list->i_all = 0;
     p_list->i_all_alloc = 0;
-    p_list->i_last_pid = 0;
-    p_list->p_last = NULL;
+    for( int i = 0; i < PID_PAGES; i++ )
+        p_list->pp_pages[i] = NULL;
 }
 
 void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
@@ -60,6 +60,8 @@ void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
         free( pid );
     }
     free( p_list->pp_all );
+    for( int i = 0; i < PID_PAGES; i++ )
+        free( p_list->pp_pages[i] );
 }
 
 struct searchkey
@@ -78,25 +80,21 @@ static int ts_bsearch_searchkey_Compare( const void *key, const void *other )
     return ( p_key->i_pid >= p_pid->i_pid ) ? p_key->i_pid - p_pid->i_pid : -1;
 }
 
-ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
+static ts_pid_t * ts_pid_New( ts_pid_list_t *p_list, uint16_t i_pid )
 {
-    switch( i_pid )
+    size_t i_index = 0;
+
+    ts_pid_t ***pp_page = &p_list->pp_pages[i_pid / PID_PAGE_SIZE];
+    if( *pp_page == NULL )
     {
-        case 0:
-            return &p_list->pat;
-        case 0x1FFB:
-            return &p_list->base_si;
-        case 0x1FFF:
-            return &p_list->dummy;
-        default:
-            if( p_list->i_last_pid == i_pid )
-                return p_list->p_last;
-        break;
+        *pp_page = calloc( PID_PAGE_SIZE, sizeof(ts_pid_t *) );
+        if( !*pp_page )
+        {
+            abort();
+            //return NULL;
+        }
     }
 
-    size_t i_index = 0;
-    ts_pid_t *p_pid = NULL;
-
     if( p_list->pp_all )
     {
         struct searchkey pidkey;
@@ -105,59 +103,75 @@ ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
 
         ts_pid_t **pp_pidk = bsearch( &pidkey, p_list->pp_all, p_list->i_all,
                                       sizeof(ts_pid_t *), ts_bsearch_searchkey_Compare );
-        if ( pp_pidk )
-            p_pid = *pp_pidk;
-        else
-            i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
+        assert( pp_pidk == NULL );
+        VLC_UNUSED(pp_pidk);
+        i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
     }
 
-    if( p_pid == NULL )
+    if( p_list->i_all >= p_list->i_all_alloc )
     {
-        if( p_list->i_all >= p_list->i_all_alloc )
-        {
-            ts_pid_t **p_realloc = realloc( p_list->pp_all,
-                                            (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
-            if( !p_realloc )
-            {
-                abort();
-                //return NULL;
-            }
-            p_list->pp_all = p_realloc;
-            p_list->i_all_alloc += PID_ALLOC_CHUNK;
-        }
-
-        p_pid = calloc( 1, sizeof(*p_pid) );
-        if( !p_pid )
+        ts_pid_t **p_realloc = realloc( p_list->pp_all,
+                                        (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
+        if( !p_realloc )
         {
             abort();
             //return NULL;
         }
+        p_list->pp_all = p_realloc;
+        p_list->i_all_alloc += PID_ALLOC_CHUNK;
+    }
 
-        p_pid->i_cc  = 0xff;
-        p_pid->i_pid = i_pid;
-
-        /* Do insertion based on last bsearch mid point */
-        if( p_list->i_all )
-        {
-            if( p_list->pp_all[i_index]->i_pid < i_pid )
-                i_index++;
+    ts_pid_t *p_pid = calloc( 1, sizeof(*p_pid) );
+    if( !p_pid )
+    {
+        abort();
+        //return NULL;
+    }
 
-            memmove( &p_list->pp_all[i_index + 1],
-                    &p_list->pp_all[i_index],
-                    (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
-        }
+    p_pid->i_cc  = 0xff;
+    p_pid->i_pid = i_pid;
 
-        p_list->pp_all[i_index] = p_pid;
-        p_list->i_all++;
+    /* Do insertion based on last bsearch mid point */
+    if( p_list->i_all )
+    {
+        if( p_list->pp_all[i_index]->i_pid < i_pid )
+            i_index++;
 
+        memmove( &p_list->pp_all[i_index + 1],
+                &p_list->pp_all[i_index],
+                (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
     }
 
-    p_list->p_last = p_pid;
-    p_list->i_last_pid = i_pid;
+    p_list->pp_all[i_index] = p_pid;
+    p_list->i_all++;
+
+    (*pp_page)[i_pid % PID_PAGE_SIZE] = p_pid;
 
     return p_pid;
 }
 
+ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
+{
+    switch( i_pid )
+    {
+        case 0:
+            return &p_list->pat;
+        case 0x1FFB:
+            return &p_list->base_si;
+        case 0x1FFF:
+            return &p_list->dummy;
+        default:
+            assert( i_pid < 0x1FFF );
+        break;
+    }
+
+    ts_pid_t **pp_page = p_list->pp_pages[i_pid / PID_PAGE_SIZE];
+    if( likely(pp_page) && likely(pp_page[i_pid % PID_PAGE_SIZE]) )
+        return pp_page[i_pid % PID_PAGE_SIZE];
+
+    return ts_pid_New( p_list, i_pid );
+}
+
 ts_pid_t * ts_pid_Next( ts_pid_list_t *p_list, ts_pid_next_context_t *p_ctx )
 {
     if( likely(p_list->i_all && p_ctx) )
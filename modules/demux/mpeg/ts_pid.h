@@ -24,6 +24,10 @@
 #define MIN_ES_PID 4    /* Should be 32.. broken muxers */
 #define MAX_ES_PID 8190
 
+/* Direct lookup table, by pages of consecutive pids allocated on use */
+#define PID_PAGE_SIZE 256
+#define PID_PAGES (8192 / PID_PAGE_SIZE)
+
 #include "ts_streams.h"
 
 typedef struct demux_sys_t demux_sys_t;
@@ -89,14 +93,12 @@ struct ts_pid_list_t
     ts_pid_t   pat;
     ts_pid_t   dummy;
     ts_pid_t   base_si;
-    /* all non commons ones, dynamically allocated */
+    /* all non commons ones, dynamically allocated, sorted by pid */
     ts_pid_t **pp_all;
     int        i_all;
     int        i_all_alloc;
-    /* last recently used */
-    uint16_t   i_last_pid;
-    ts_pid_t  *p_last;
-
+    /* same ones, indexed by pid */
+    ts_pid_t **pp_pages[PID_PAGES];
 };
 
 /* opacified pid list */
@@ -2069,8 +2069,19 @@ static void PMTCallBack( void *data, dvbpsi_pmt_t *p_dvbpsipmt )
                 en50221_capmt_Delete( p_en );
                 if ( p_sys->standard == TS_STANDARD_ARIB && !p_sys->arib.b25stream )
                 {
+                    /* Packets read ahead must go through the descrambler */
+                    const size_t i_ahead = ts_batch_Pending( &p_sys->batch );
+                    bool b_back = i_ahead == 0;
+                    if( !b_back && p_sys->b_canseek )
+                        b_back = vlc_stream_Seek( p_demux->s, TSTell( p_sys ) ) == VLC_SUCCESS;
+                    if( !b_back )
+                        msg_Warn( p_demux, "%zu bytes read ahead will not be descrambled",
+                                  i_ahead );
+
                     p_sys->arib.b25stream = vlc_stream_FilterNew( p_demux->s, "aribcam" );
                     p_sys->stream = ( p_sys->arib.b25stream ) ? p_sys->arib.b25stream : p_demux->s;
+                    if( b_back )
+                        ts_batch_Flush( &p_sys->batch );
                 }
             }
         }
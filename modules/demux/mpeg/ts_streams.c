@@ -284,8 +284,8 @@ ts_stream_t *ts_stream_New( demux_t *p_demux, ts_pmt_t *p_program )
     pes->transport = TS_TRANSPORT_PES;
     pes->gather.i_data_size = 0;
     pes->gather.i_gathered = 0;
+    pes->gather.i_last_size = 0;
     pes->gather.p_data = NULL;
-    pes->gather.pp_last = &pes->gather.p_data;
     pes->gather.i_saved = 0;
     pes->b_broken_PUSI_conformance = false;
     pes->b_always_receive = false;
@@ -303,7 +303,7 @@ void ts_stream_Del( demux_t *p_demux, ts_stream_t *pes )
     ts_pes_ChainDelete_es( p_demux, pes->p_es );
 
     if( pes->gather.p_data )
-        block_ChainRelease( pes->gather.p_data );
+        block_Release( pes->gather.p_data );
 
     if( pes->p_sections_proc )
         ts_sections_processor_ChainDelete( pes->p_sections_proc );
@@ -122,8 +122,8 @@ struct ts_stream_t
     {
         size_t      i_data_size;
         size_t      i_gathered;
-        block_t     *p_data;
-        block_t     **pp_last;
+        size_t      i_last_size; /* previous PES size, for unbounded ones */
+        block_t     *p_data; /* single buffer the payloads are copied to */
         uint8_t     saved[5];
         size_t      i_saved;
     } gather;
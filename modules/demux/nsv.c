@@ -49,6 +49,7 @@ static void Close  ( vlc_object_t * );
 vlc_module_begin ()
     set_description( N_("NullSoft demuxer" ) )
     set_capability( "demux", 10 )
+    set_probe_magic( 0, "NSV" )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_callbacks( Open, Close )
@@ -50,6 +50,7 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("Nuv demuxer") )
     set_capability( "demux", 145 )
+    set_probe_magic( 6, "Video" )
     set_callbacks( Open, Close )
     add_shortcut( "nuv" )
 vlc_module_end ()
@@ -62,6 +62,8 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 50 )
+    set_probe_magic( 0, "OggS" )
+    set_probe_mime_types( "application/ogg,video/ogg,audio/ogg" )
     set_callbacks( Open, Close )
     add_shortcut( "ogg" )
 vlc_module_end ()
@@ -54,6 +54,7 @@ vlc_module_begin ()
     set_category (CAT_INPUT)
     set_subcategory (SUBCAT_INPUT_DEMUX)
     set_capability ("demux", 100)
+    set_probe_magic (1, "SID")
     set_callbacks (Open, Close)
 vlc_module_end ()
 
@@ -43,6 +43,7 @@ vlc_module_begin()
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_DEMUX)
     set_capability("demux", 1)
+    set_probe_magic(3, "STL")
     set_callbacks(Open, Close)
     add_shortcut("stl", "subtitle")
 vlc_module_end()
@@ -721,5 +721,6 @@ vlc_module_begin ()
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_capability( "demux", 142 )
+    set_probe_magic( 8, "WAVE" )
     set_callbacks( Open, Close )
 vlc_module_end ()
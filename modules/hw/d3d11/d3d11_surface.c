@@ -54,6 +54,7 @@
 typedef struct
 {
     copy_cache_t     cache;
+    copy_engine_t    *engine;
     union {
         ID3D11Texture2D  *staging;
         ID3D11Resource   *staging_resource;
@@ -301,7 +302,8 @@ static void D3D11_YUY2(filter_t *p_filter, picture_t *src, picture_t *dst)
                                  + pitch[1] * desc.Height / 2,
         };
 
-        Copy420_P_to_P(dst, plane, pitch,
+        CopyEngineCopy(sys->engine, Copy420_P_to_P, dst, plane, pitch,
+                       ARRAY_SIZE(plane),
                        src->format.i_visible_height + src->format.i_y_offset,
                        &sys->cache);
     } else if (desc.Format == DXGI_FORMAT_NV12 ||
@@ -315,13 +317,15 @@ static void D3D11_YUY2(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.RowPitch,
         };
         if (desc.Format == DXGI_FORMAT_NV12)
-            Copy420_SP_to_P(dst, plane, pitch,
-                            __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
-                            &sys->cache);
+            CopyEngineCopy(sys->engine, Copy420_SP_to_P, dst, plane, pitch,
+                           ARRAY_SIZE(plane),
+                           __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
+                           &sys->cache);
         else
-            Copy420_16_SP_to_P(dst, plane, pitch,
-                               __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
-                               6, &sys->cache);
+            CopyEngineCopy16(sys->engine, Copy420_16_SP_to_P, dst, plane, pitch,
+                             ARRAY_SIZE(plane),
+                             __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
+                             6, &sys->cache);
         picture_SwapUV(dst);
     } else {
         msg_Err(p_filter, "Unsupported D3D11VA conversion from 0x%08X to YV12", desc.Format);
@@ -405,9 +409,10 @@ static void D3D11_NV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.RowPitch,
             lock.RowPitch,
         };
-        Copy420_SP_to_SP(dst, plane, pitch,
-                         __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
-                         &sys->cache);
+        CopyEngineCopy(sys->engine, Copy420_SP_to_SP, dst, plane, pitch,
+                       ARRAY_SIZE(plane),
+                       __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
+                       &sys->cache);
     } else {
         msg_Err(p_filter, "Unsupported D3D11VA conversion from 0x%08X to NV12", desc.Format);
     }
@@ -723,6 +728,9 @@ int D3D11OpenConverter( vlc_object_t *obj )
 
     if (CopyInitCache(&p_sys->cache, p_filter->fmt_in.video.i_width * pixel_bytes))
         return VLC_ENOMEM;
+    /* Reading the staging texture is slow: spread the copy over several
+     * threads, or copy in the calling thread on error. */
+    p_sys->engine = CopyEngineNew(0, p_filter->fmt_in.video.i_width * pixel_bytes);
 
     vlc_mutex_init(&p_sys->staging_lock);
     p_filter->p_sys = p_sys;
@@ -832,6 +840,8 @@ void D3D11CloseConverter( vlc_object_t *obj )
         ID3D11Texture2D_Release(p_sys->procOutTexture);
     D3D11_ReleaseProcessor( &p_sys->d3d_proc );
 #endif
+    if (p_sys->engine)
+        CopyEngineDelete(p_sys->engine);
     CopyCleanCache(&p_sys->cache);
     if (p_sys->staging)
         ID3D11Texture2D_Release(p_sys->staging);
@@ -45,6 +45,7 @@ typedef struct
 {
     /* GPU to CPU */
     copy_cache_t      cache;
+    copy_engine_t     *engine;
 
     /* CPU to GPU */
     filter_t          *filter;
@@ -68,7 +69,7 @@ static bool GetLock(filter_t *p_filter, IDirect3DSurface9 *d3d,
 
 static void DXA9_YV12(filter_t *p_filter, picture_t *src, picture_t *dst)
 {
-    copy_cache_t *p_copy_cache = (copy_cache_t*) p_filter->p_sys;
+    filter_sys_t *p_filter_sys = p_filter->p_sys;
     picture_sys_d3d9_t *p_sys = ActiveD3D9PictureSys(src);
 
     D3DSURFACE_DESC desc;
@@ -103,7 +104,9 @@ static void DXA9_YV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             plane[1] = plane[2];
             plane[2] = V;
         }
-        Copy420_P_to_P(dst, plane, pitch, src->format.i_height, p_copy_cache);
+        CopyEngineCopy(p_filter_sys->engine, Copy420_P_to_P, dst, plane, pitch,
+                       ARRAY_SIZE(plane), src->format.i_height,
+                       &p_filter_sys->cache);
 
         if (dst->format.i_chroma == VLC_CODEC_I420)
             picture_SwapUV( dst );
@@ -118,13 +121,15 @@ static void DXA9_YV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.Pitch,
         };
         if (desc.Format == MAKEFOURCC('N','V','1','2'))
-            Copy420_SP_to_P(dst, plane, pitch,
-                            __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
-                            p_copy_cache);
+            CopyEngineCopy(p_filter_sys->engine, Copy420_SP_to_P, dst, plane, pitch,
+                           ARRAY_SIZE(plane),
+                           __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
+                           &p_filter_sys->cache);
         else
-            Copy420_16_SP_to_P(dst, plane, pitch,
-                              __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
-                              6, p_copy_cache);
+            CopyEngineCopy16(p_filter_sys->engine, Copy420_16_SP_to_P, dst, plane, pitch,
+                             ARRAY_SIZE(plane),
+                             __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
+                             6, &p_filter_sys->cache);
 
         if (dst->format.i_chroma != VLC_CODEC_I420 && dst->format.i_chroma != VLC_CODEC_I420_10L)
             picture_SwapUV(dst);
@@ -138,7 +143,7 @@ static void DXA9_YV12(filter_t *p_filter, picture_t *src, picture_t *dst)
 
 static void DXA9_NV12(filter_t *p_filter, picture_t *src, picture_t *dst)
 {
-    copy_cache_t *p_copy_cache = (copy_cache_t*) p_filter->p_sys;
+    filter_sys_t *p_filter_sys = p_filter->p_sys;
     picture_sys_d3d9_t *p_sys = ActiveD3D9PictureSys(src);
 
     D3DSURFACE_DESC desc;
@@ -156,9 +161,10 @@ static void DXA9_NV12(filter_t *p_filter, picture_t *src, picture_t *dst)
             lock.Pitch,
             lock.Pitch,
         };
-        Copy420_SP_to_SP(dst, plane, pitch,
-                         __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
-                         p_copy_cache);
+        CopyEngineCopy(p_filter_sys->engine, Copy420_SP_to_SP, dst, plane, pitch,
+                       ARRAY_SIZE(plane),
+                       __MIN(desc.Height, src->format.i_y_offset + src->format.i_visible_height),
+                       &p_filter_sys->cache);
     } else {
         msg_Err(p_filter, "Unsupported DXA9 conversion from 0x%08X to NV12", desc.Format);
     }
@@ -428,6 +434,9 @@ int D3D9OpenConverter( vlc_object_t *obj )
         free(p_sys);
         return VLC_ENOMEM;
     }
+    /* Reading from the locked surface is slow: spread the copy over several
+     * threads, or copy in the calling thread on error. */
+    p_sys->engine = CopyEngineNew(0, p_filter->fmt_in.video.i_width * pixel_bytes);
 
     p_filter->p_sys = p_sys;
     return VLC_SUCCESS;
@@ -523,6 +532,8 @@ void D3D9CloseConverter( vlc_object_t *obj )
 {
     filter_t *p_filter = (filter_t *)obj;
     filter_sys_t *p_sys = p_filter->p_sys;
+    if (p_sys->engine)
+        CopyEngineDelete( p_sys->engine );
     CopyCleanCache( &p_sys->cache );
     free( p_sys );
     p_filter->p_sys = NULL;
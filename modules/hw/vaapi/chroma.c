@@ -43,6 +43,7 @@ typedef struct
     picture_pool_t *    dest_pics;
     VASurfaceID *       va_surface_ids;
     copy_cache_t        cache;
+    copy_engine_t *     engine; /* multi-threaded download, or NULL */
 
     bool                derive_failed;
     bool                image_fallback_failed;
@@ -85,31 +86,32 @@ static int CreateFallbackImage(filter_t *filter, picture_t *src_pic,
 
 static inline void
 FillPictureFromVAImage(picture_t *dest,
-                       VAImage *src_img, uint8_t *src_buf, copy_cache_t *cache)
+                       VAImage *src_img, uint8_t *src_buf,
+                       copy_engine_t *engine, copy_cache_t *cache)
 {
     const uint8_t * src_planes[2] = { src_buf + src_img->offsets[0],
                                       src_buf + src_img->offsets[1] };
     const size_t    src_pitches[2] = { src_img->pitches[0],
                                        src_img->pitches[1] };
+    copy_conv_cb conv = NULL;
+    copy_conv16_cb conv16 = NULL;
 
     switch (src_img->format.fourcc)
     {
     case VA_FOURCC_NV12:
     {
         assert(dest->format.i_chroma == VLC_CODEC_I420);
-        Copy420_SP_to_P(dest, src_planes, src_pitches, src_img->height, cache);
+        conv = Copy420_SP_to_P;
         break;
     }
     case VA_FOURCC_P010:
         switch (dest->format.i_chroma)
         {
             case VLC_CODEC_P010:
-                Copy420_SP_to_SP(dest, src_planes, src_pitches, src_img->height,
-                                 cache);
+                conv = Copy420_SP_to_SP;
                 break;
             case VLC_CODEC_I420_10L:
-                Copy420_16_SP_to_P(dest, src_planes, src_pitches,
-                                   src_img->height, 6, cache);
+                conv16 = Copy420_16_SP_to_P;
                 break;
             default:
                 vlc_assert_unreachable();
@@ -119,6 +121,13 @@ FillPictureFromVAImage(picture_t *dest,
         vlc_assert_unreachable();
         break;
     }
+
+    if (conv16 != NULL)
+        CopyEngineCopy16(engine, conv16, dest, src_planes, src_pitches,
+                         ARRAY_SIZE(src_planes), src_img->height, 6, cache);
+    else
+        CopyEngineCopy(engine, conv, dest, src_planes, src_pitches,
+                       ARRAY_SIZE(src_planes), src_img->height, cache);
 }
 
 static picture_t *
@@ -169,7 +178,8 @@ DownloadSurface(filter_t *filter, picture_t *src_pic)
     if (vlc_vaapi_MapBuffer(VLC_OBJECT(filter), va_dpy, src_img.buf, &src_buf))
         goto error;
 
-    FillPictureFromVAImage(dest, &src_img, src_buf, &filter_sys->cache);
+    FillPictureFromVAImage(dest, &src_img, src_buf, filter_sys->engine,
+                           &filter_sys->cache);
 
     vlc_vaapi_UnmapBuffer(VLC_OBJECT(filter), va_dpy, src_img.buf);
     vlc_vaapi_DestroyImage(VLC_OBJECT(filter), va_dpy, src_img.image_id);
@@ -379,6 +389,10 @@ vlc_vaapi_OpenChroma(vlc_object_t *obj)
          * this point (in case of cpu rendering) */
         filter_sys->dpy = NULL;
         filter_sys->dest_pics = NULL;
+        /* Reading from uncached (USWC) memory is slow: spread the download
+         * over several threads, or copy in the calling thread on error. */
+        filter_sys->engine = CopyEngineNew(0, filter->fmt_in.video.i_width
+                                              * pixel_bytes);
     }
 
     if (CopyInitCache(&filter_sys->cache, filter->fmt_in.video.i_width
@@ -390,6 +404,8 @@ vlc_vaapi_OpenChroma(vlc_object_t *obj)
             vlc_video_context_Release(filter->vctx_out);
             filter->vctx_out = NULL;
         }
+        else if (filter_sys->engine != NULL)
+            CopyEngineDelete(filter_sys->engine);
         free(filter_sys);
         return VLC_EGENERIC;
     }
@@ -412,6 +428,8 @@ vlc_vaapi_CloseChroma(vlc_object_t *obj)
 
     if (filter_sys->dest_pics)
         picture_pool_Release(filter_sys->dest_pics);
+    if (filter_sys->engine)
+        CopyEngineDelete(filter_sys->engine);
     CopyCleanCache(&filter_sys->cache);
     if (filter->vctx_out)
         vlc_video_context_Release(filter->vctx_out);
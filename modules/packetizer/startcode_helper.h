@@ -25,6 +25,12 @@
 #if !defined(CAN_COMPILE_SSE2) && defined(HAVE_SSE2_INTRINSICS)
    #include <emmintrin.h>
 #endif
+#if defined(HAVE_AVX2_INTRINSICS) || defined(HAVE_AVX512_INTRINSICS)
+   #include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+   #include <arm_neon.h>
+#endif
 
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
  * by using a 4 times faster trick than single byte lookup. */
@@ -57,9 +63,6 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             return p;
     }
 
-    if( p == end )
-        return NULL;
-
     alignedend = end - ((intptr_t) end & 15);
     if( alignedend > p )
     {
@@ -140,16 +143,113 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+/* The wide kernels below test all start positions of a vector at once: a
+ * start code begins at p[i] if p[i+1] == 0, p[i] == 0 and p[i+2] == 1.
+ * The zero byte at offset 1 is checked first as it is the rarest match.
+ * Unaligned loads are used, and the tail is left to the scalar code. */
+
+#if defined(HAVE_AVX2_INTRINSICS)
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    const __m256i zeros = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8( 1 );
+
+    for( ; end - p >= 32 + 2; p += 32 )
+    {
+        __m256i v1 = _mm256_loadu_si256( (const __m256i *)(p + 1) );
+        uint32_t match = _mm256_movemask_epi8( _mm256_cmpeq_epi8( v1, zeros ) );
+        if( match == 0 )
+            continue;
+
+        __m256i v0 = _mm256_loadu_si256( (const __m256i *)p );
+        __m256i v2 = _mm256_loadu_si256( (const __m256i *)(p + 2) );
+        match &= _mm256_movemask_epi8( _mm256_cmpeq_epi8( v0, zeros ) );
+        match &= _mm256_movemask_epi8( _mm256_cmpeq_epi8( v2, ones ) );
+        if( match )
+            return p + ctz( match );
+    }
+
+    return startcode_FindAnnexB_Bits( p, end );
+}
+#endif
+
+#if defined(HAVE_AVX512_INTRINSICS) && defined(__x86_64__)
+__attribute__ ((__target__ ("avx512f,avx512bw")))
+static inline const uint8_t * startcode_FindAnnexB_AVX512( const uint8_t *p, const uint8_t *end )
+{
+    const __m512i zeros = _mm512_setzero_si512();
+    const __m512i ones = _mm512_set1_epi8( 1 );
+
+    for( ; end - p >= 64 + 2; p += 64 )
+    {
+        __mmask64 match = _mm512_cmpeq_epi8_mask( _mm512_loadu_si512( p + 1 ),
+                                                  zeros );
+        if( match == 0 )
+            continue;
+
+        match = _mm512_mask_cmpeq_epi8_mask( match, _mm512_loadu_si512( p ),
+                                             zeros );
+        match = _mm512_mask_cmpeq_epi8_mask( match, _mm512_loadu_si512( p + 2 ),
+                                             ones );
+        if( match )
+            return p + ctz( (uint64_t) match );
+    }
+
+    return startcode_FindAnnexB_Bits( p, end );
+}
+#endif
+
+#if defined(__ARM_NEON)
+/* Packs a byte mask into 4 bits per byte, as NEON has no movemask */
+static inline uint64_t startcode_NEON_Mask( uint8x16_t mask )
+{
+    uint8x8_t nibbles = vshrn_n_u16( vreinterpretq_u16_u8( mask ), 4 );
+    return vget_lane_u64( vreinterpret_u64_u8( nibbles ), 0 );
+}
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    const uint8x16_t zeros = vdupq_n_u8( 0 );
+    const uint8x16_t ones = vdupq_n_u8( 1 );
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        uint8x16_t m = vceqq_u8( vld1q_u8( p + 1 ), zeros );
+        if( startcode_NEON_Mask( m ) == 0 )
+            continue;
+
+        m = vandq_u8( m, vceqq_u8( vld1q_u8( p ), zeros ) );
+        m = vandq_u8( m, vceqq_u8( vld1q_u8( p + 2 ), ones ) );
+
+        uint64_t match = startcode_NEON_Mask( m );
+        if( match )
+            return p + ctz( match ) / 4;
+    }
+
+    return startcode_FindAnnexB_Bits( p, end );
+}
+#endif
+
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#if defined(HAVE_AVX512_INTRINSICS) && defined(__x86_64__)
+    if (vlc_CPU_AVX512())
+        return startcode_FindAnnexB_AVX512(p, end);
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#endif
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
-}
-#else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
 #endif
+#if defined(__ARM_NEON)
+    if (vlc_CPU_ARM_NEON())
+        return startcode_FindAnnexB_NEON(p, end);
+#endif
+    return startcode_FindAnnexB_Bits(p, end);
+}
 
 #endif
@@ -67,6 +67,7 @@
 typedef struct
 {
     block_bytestream_t cache; /* bytestream chain for storing cache */
+    uint64_t offset; /* stream offset of the cache read position */
 
     struct
     {
@@ -174,6 +175,7 @@ static void AStreamControlReset(stream_t *s)
     stream_sys_t *sys = s->p_sys;
 
     block_BytestreamEmpty( &sys->cache );
+    sys->offset = vlc_stream_Tell(s->s);
 
     /* Do the prebuffering */
     AStreamPrebufferBlock(s);
@@ -183,14 +185,20 @@ static int AStreamSeekBlock(stream_t *s, uint64_t i_pos)
 {
     stream_sys_t *sys = s->p_sys;
 
-    if( block_SkipBytes( &sys->cache, i_pos) == VLC_SUCCESS )
+    /* Seek forward within the cache if possible */
+    if( i_pos >= sys->offset
+     && block_SkipBytes( &sys->cache, i_pos - sys->offset ) == VLC_SUCCESS )
+    {
+        sys->offset = i_pos;
         return VLC_SUCCESS;
+    }
 
     /* Not enought bytes, empty and seek */
     /* Do the access seek */
     if (vlc_stream_Seek(s->s, i_pos)) return VLC_EGENERIC;
 
     block_BytestreamEmpty( &sys->cache );
+    sys->offset = i_pos;
 
     /* Refill a block */
     if (AStreamRefillBlock(s))
@@ -222,6 +230,7 @@ static ssize_t AStreamReadBlock(stream_t *s, void *buf, size_t len)
     /* Copy data */
     if( block_GetBytes( &sys->cache, buf, i_copy ) )
         return -1;
+    sys->offset += i_copy;
 
 
     /* If we ended up on refill, try to read refilled cache */
@@ -231,6 +240,39 @@ static ssize_t AStreamReadBlock(stream_t *s, void *buf, size_t len)
     return i_copy;
 }
 
+/* Hands the cached data over block by block, without copying it */
+static block_t *AStreamBlock(stream_t *s, bool *restrict eof)
+{
+    stream_sys_t *sys = s->p_sys;
+
+    if (block_BytestreamRemaining(&sys->cache) == 0
+     && AStreamRefillBlock(s) != VLC_SUCCESS)
+    {
+        *eof = vlc_stream_Eof(s->s);
+        return NULL;
+    }
+
+    /* Detach the block at the read position from the cache */
+    block_BytestreamFlush(&sys->cache);
+
+    block_t *block = sys->cache.p_chain;
+    if (block == NULL)
+        return NULL;
+
+    sys->cache.p_chain = sys->cache.p_block = block->p_next;
+    if (sys->cache.p_chain == NULL)
+        sys->cache.pp_last = &sys->cache.p_chain;
+    sys->cache.i_total -= block->i_buffer;
+    block->p_next = NULL;
+
+    block->p_buffer += sys->cache.i_block_offset;
+    block->i_buffer -= sys->cache.i_block_offset;
+    sys->cache.i_block_offset = 0;
+
+    sys->offset += block->i_buffer;
+    return block;
+}
+
 /****************************************************************************
  * AStreamControl:
  ****************************************************************************/
@@ -289,6 +331,7 @@ static int Open(vlc_object_t *obj)
 
     /* Init all fields of sys->block */
     block_BytestreamInit( &sys->cache );
+    sys->offset = vlc_stream_Tell(s->s);
 
     s->p_sys = sys;
     /* Do the prebuffering */
@@ -302,6 +345,7 @@ static int Open(vlc_object_t *obj)
     }
 
     s->pf_read = AStreamReadBlock;
+    s->pf_block = AStreamBlock;
     s->pf_seek = AStreamSeekBlock;
     s->pf_control = AStreamControl;
     return VLC_SUCCESS;
@@ -69,6 +69,7 @@
 #include "platform_fonts.h"
 #include "freetype.h"
 #include "text_layout.h"
+#include "glyph_cache.h"
 
 /*****************************************************************************
  * Module descriptor
@@ -76,6 +77,9 @@
 static int  Create ( vlc_object_t * );
 static void Destroy( vlc_object_t * );
 
+/* Memory budget of the glyph cache */
+#define GLYPH_CACHE_MAX_SIZE (8 << 20)
+
 #define FONT_TEXT N_("Font")
 #define MONOSPACE_FONT_TEXT N_("Monospace Font")
 
@@ -1433,6 +1437,10 @@ static int Create( vlc_object_t *p_this )
     vlc_dictionary_init( &p_sys->family_map, 50 );
     vlc_dictionary_init( &p_sys->fallback_map, 20 );
 
+    p_sys->p_cache = GlyphCacheNew( GLYPH_CACHE_MAX_SIZE );
+    if( unlikely( !p_sys->p_cache ) )
+        goto error;
+
     p_sys->i_scale = 100;
 
     /* default style to apply to uncomplete segmeents styles */
@@ -1557,6 +1565,10 @@ static void Destroy( vlc_object_t *p_this )
     text_style_Delete( p_sys->p_default_style );
     text_style_Delete( p_sys->p_forced_style );
 
+    /* Cached glyphs, before the faces they belong to */
+    if( p_sys->p_cache )
+        GlyphCacheDelete( VLC_OBJECT(p_filter), p_sys->p_cache );
+
     /* Fonts dicts */
     vlc_dictionary_clear( &p_sys->fallback_map, FreeFamilies, p_filter );
     vlc_dictionary_clear( &p_sys->face_map, FreeFace, p_filter );
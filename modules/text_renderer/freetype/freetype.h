@@ -72,6 +72,7 @@ typedef uint32_t uni_char_t;
  * It describes the freetype specific properties of an output thread.
  *****************************************************************************/
 typedef struct vlc_family_t vlc_family_t;
+typedef struct glyph_cache_t glyph_cache_t;
 typedef struct
 {
     FT_Library     p_library;       /* handle to library     */
@@ -110,6 +111,9 @@ typedef struct
     /** Font face cache */
     vlc_dictionary_t  face_map;
 
+    /** Glyph and shaped run cache, referencing faces of \ref face_map */
+    glyph_cache_t    *p_cache;
+
     int               i_fallback_counter;
 
     /* Current scaling of the text, default is 100 (%) */
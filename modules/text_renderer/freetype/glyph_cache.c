@@ -0,0 +1,433 @@
+/*****************************************************************************
+ * glyph_cache.c : Glyph and shaped run cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/** \ingroup freetype
+ * @{
+ * \file
+ * Glyph and shaped run cache
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+
+#include "glyph_cache.h"
+
+#define GLYPH_CACHE_BUCKETS 1024
+
+enum glyph_cache_type
+{
+    GLYPH_CACHE_OUTLINES,
+    GLYPH_CACHE_BITMAP,
+    GLYPH_CACHE_RUN,
+    GLYPH_CACHE_TYPES
+};
+
+static const char *const ppsz_type_names[GLYPH_CACHE_TYPES] =
+{
+    "outline", "bitmap", "shaped run",
+};
+
+typedef struct glyph_cache_entry_t glyph_cache_entry_t;
+
+struct glyph_cache_entry_t
+{
+    struct vlc_list      node;      /**< LRU list, most recent first */
+    glyph_cache_entry_t *p_next;    /**< next entry in the hash bucket */
+    uint32_t             i_hash;
+    enum glyph_cache_type i_type;
+    size_t               i_size;    /**< accounted memory */
+
+    union
+    {
+        struct
+        {
+            FT_Glyph  p_glyph;
+            FT_Glyph  p_outline;
+            FT_Vector advance;
+        } outlines;
+        FT_Glyph p_bitmap;
+        struct
+        {
+            void   *p_data;
+            size_t  i_data;
+        } run;
+    } u;
+
+    size_t               i_key;
+    unsigned char        key[];
+};
+
+struct glyph_cache_t
+{
+    glyph_cache_entry_t *pp_buckets[GLYPH_CACHE_BUCKETS];
+    struct vlc_list      lru;
+    size_t               i_size;
+    size_t               i_max_size;
+
+    struct
+    {
+        unsigned i_hits;
+        unsigned i_misses;
+    } stats[GLYPH_CACHE_TYPES];
+};
+
+/** Key of a rendered glyph, without padding either */
+typedef struct
+{
+    glyph_cache_key_t glyph;
+    uint16_t          i_x;          /**< subpixel pen position (26.6) */
+    uint16_t          i_y;
+    uint32_t          b_outline;
+} bitmap_key_t;
+
+static_assert( sizeof( bitmap_key_t ) == sizeof( glyph_cache_key_t )
+               + 2 * sizeof( uint16_t ) + sizeof( uint32_t ),
+               "Padding in glyph cache keys" );
+
+static uint32_t Hash( enum glyph_cache_type i_type,
+                      const void *p_key, size_t i_key )
+{
+    /* FNV-1a */
+    const unsigned char *p = p_key;
+    uint32_t i_hash = 2166136261u ^ i_type;
+
+    for( size_t i = 0; i < i_key; i++ )
+    {
+        i_hash ^= p[i];
+        i_hash *= 16777619u;
+    }
+    return i_hash;
+}
+
+static size_t GlyphSize( FT_Glyph p_glyph )
+{
+    if( !p_glyph )
+        return 0;
+
+    if( p_glyph->format == FT_GLYPH_FORMAT_BITMAP )
+    {
+        const FT_Bitmap *p_bitmap = &((FT_BitmapGlyph)p_glyph)->bitmap;
+        return sizeof( FT_BitmapGlyphRec )
+             + (size_t)abs( p_bitmap->pitch ) * p_bitmap->rows;
+    }
+    if( p_glyph->format == FT_GLYPH_FORMAT_OUTLINE )
+    {
+        const FT_Outline *p_outline = &((FT_OutlineGlyph)p_glyph)->outline;
+        return sizeof( FT_OutlineGlyphRec )
+             + (size_t)p_outline->n_points * ( sizeof( FT_Vector ) + 1 )
+             + (size_t)p_outline->n_contours * sizeof( short );
+    }
+    return sizeof( FT_GlyphRec );
+}
+
+static void EntryDelete( glyph_cache_entry_t *p_entry )
+{
+    switch( p_entry->i_type )
+    {
+        case GLYPH_CACHE_OUTLINES:
+            FT_Done_Glyph( p_entry->u.outlines.p_glyph );
+            if( p_entry->u.outlines.p_outline )
+                FT_Done_Glyph( p_entry->u.outlines.p_outline );
+            break;
+        case GLYPH_CACHE_BITMAP:
+            FT_Done_Glyph( p_entry->u.p_bitmap );
+            break;
+        case GLYPH_CACHE_RUN:
+            free( p_entry->u.run.p_data );
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+    free( p_entry );
+}
+
+static void EntryRemove( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    glyph_cache_entry_t **pp =
+        &p_cache->pp_buckets[p_entry->i_hash % GLYPH_CACHE_BUCKETS];
+
+    while( *pp != p_entry )
+        pp = &(*pp)->p_next;
+    *pp = p_entry->p_next;
+
+    vlc_list_remove( &p_entry->node );
+    p_cache->i_size -= p_entry->i_size;
+    EntryDelete( p_entry );
+}
+
+static glyph_cache_entry_t *Lookup( glyph_cache_t *p_cache,
+                                    enum glyph_cache_type i_type,
+                                    const void *p_key, size_t i_key )
+{
+    const uint32_t i_hash = Hash( i_type, p_key, i_key );
+
+    for( glyph_cache_entry_t *p_entry =
+            p_cache->pp_buckets[i_hash % GLYPH_CACHE_BUCKETS];
+         p_entry != NULL; p_entry = p_entry->p_next )
+    {
+        if( p_entry->i_hash == i_hash && p_entry->i_type == i_type
+         && p_entry->i_key == i_key && !memcmp( p_entry->key, p_key, i_key ) )
+        {
+            /* Move to the front of the LRU list */
+            vlc_list_remove( &p_entry->node );
+            vlc_list_prepend( &p_entry->node, &p_cache->lru );
+            p_cache->stats[i_type].i_hits++;
+            return p_entry;
+        }
+    }
+    p_cache->stats[i_type].i_misses++;
+    return NULL;
+}
+
+static glyph_cache_entry_t *EntryNew( enum glyph_cache_type i_type,
+                                      const void *p_key, size_t i_key )
+{
+    glyph_cache_entry_t *p_entry = malloc( sizeof( *p_entry ) + i_key );
+    if( unlikely( !p_entry ) )
+        return NULL;
+
+    p_entry->i_hash = Hash( i_type, p_key, i_key );
+    p_entry->i_type = i_type;
+    p_entry->i_key = i_key;
+    memcpy( p_entry->key, p_key, i_key );
+    return p_entry;
+}
+
+/**
+ * Inserts a new entry, evicting the least recently used entries as needed.
+ */
+static void Insert( glyph_cache_t *p_cache, glyph_cache_entry_t *p_entry )
+{
+    p_entry->i_size += sizeof( *p_entry ) + p_entry->i_key;
+    if( p_entry->i_size > p_cache->i_max_size / 4 )
+    {
+        /* Do not let a single huge glyph flush the whole cache */
+        EntryDelete( p_entry );
+        return;
+    }
+
+    while( p_cache->i_size + p_entry->i_size > p_cache->i_max_size )
+    {
+        glyph_cache_entry_t *p_last =
+            vlc_list_last_entry_or_null( &p_cache->lru, glyph_cache_entry_t,
+                                         node );
+        assert( p_last != NULL );
+        EntryRemove( p_cache, p_last );
+    }
+
+    glyph_cache_entry_t **pp_bucket =
+        &p_cache->pp_buckets[p_entry->i_hash % GLYPH_CACHE_BUCKETS];
+    p_entry->p_next = *pp_bucket;
+    *pp_bucket = p_entry;
+    vlc_list_prepend( &p_entry->node, &p_cache->lru );
+    p_cache->i_size += p_entry->i_size;
+}
+
+glyph_cache_t *GlyphCacheNew( size_t i_max_size )
+{
+    glyph_cache_t *p_cache = calloc( 1, sizeof( *p_cache ) );
+    if( unlikely( !p_cache ) )
+        return NULL;
+
+    vlc_list_init( &p_cache->lru );
+    p_cache->i_max_size = i_max_size;
+    return p_cache;
+}
+
+void GlyphCacheFlush( glyph_cache_t *p_cache )
+{
+    glyph_cache_entry_t *p_entry;
+
+    vlc_list_foreach( p_entry, &p_cache->lru, node )
+        EntryDelete( p_entry );
+
+    vlc_list_init( &p_cache->lru );
+    memset( p_cache->pp_buckets, 0, sizeof( p_cache->pp_buckets ) );
+    p_cache->i_size = 0;
+}
+
+void GlyphCacheDelete( vlc_object_t *p_obj, glyph_cache_t *p_cache )
+{
+    for( int i = 0; i < GLYPH_CACHE_TYPES; i++ )
+        if( p_cache->stats[i].i_hits || p_cache->stats[i].i_misses )
+            msg_Dbg( p_obj, "%s cache: %u hits, %u misses",
+                     ppsz_type_names[i], p_cache->stats[i].i_hits,
+                     p_cache->stats[i].i_misses );
+
+    GlyphCacheFlush( p_cache );
+    free( p_cache );
+}
+
+int GlyphCacheGetOutlines( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                           FT_Glyph *pp_glyph, FT_Glyph *pp_outline,
+                           FT_Vector *p_advance )
+{
+    glyph_cache_entry_t *p_entry =
+        Lookup( p_cache, GLYPH_CACHE_OUTLINES, p_key, sizeof( *p_key ) );
+    if( !p_entry )
+        return VLC_EGENERIC;
+
+    if( FT_Glyph_Copy( p_entry->u.outlines.p_glyph, pp_glyph ) )
+        return VLC_EGENERIC;
+
+    *pp_outline = NULL;
+    if( p_entry->u.outlines.p_outline
+     && FT_Glyph_Copy( p_entry->u.outlines.p_outline, pp_outline ) )
+    {
+        FT_Done_Glyph( *pp_glyph );
+        return VLC_EGENERIC;
+    }
+
+    *p_advance = p_entry->u.outlines.advance;
+    return VLC_SUCCESS;
+}
+
+void GlyphCachePutOutlines( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                            FT_Glyph p_glyph, FT_Glyph p_outline,
+                            const FT_Vector *p_advance )
+{
+    glyph_cache_entry_t *p_entry =
+        EntryNew( GLYPH_CACHE_OUTLINES, p_key, sizeof( *p_key ) );
+    if( !p_entry )
+        return;
+
+    p_entry->u.outlines.p_outline = NULL;
+    if( FT_Glyph_Copy( p_glyph, &p_entry->u.outlines.p_glyph ) )
+    {
+        free( p_entry );
+        return;
+    }
+    if( p_outline
+     && FT_Glyph_Copy( p_outline, &p_entry->u.outlines.p_outline ) )
+    {
+        FT_Done_Glyph( p_entry->u.outlines.p_glyph );
+        free( p_entry );
+        return;
+    }
+    p_entry->u.outlines.advance = *p_advance;
+    p_entry->i_size = GlyphSize( p_glyph ) + GlyphSize( p_outline );
+    Insert( p_cache, p_entry );
+}
+
+/*
+ * Rendering a glyph at a whole pixel offset only moves the bitmap, so bitmaps
+ * are cached for the subpixel part of the pen position, and moved to its
+ * whole pixel part.
+ */
+static void BitmapKey( bitmap_key_t *p_bkey, const glyph_cache_key_t *p_key,
+                       bool b_outline, const FT_Vector *p_origin )
+{
+    memcpy( &p_bkey->glyph, p_key, sizeof( *p_key ) );
+    p_bkey->i_x = p_origin->x & 63;
+    p_bkey->i_y = p_origin->y & 63;
+    p_bkey->b_outline = b_outline;
+}
+
+FT_Glyph GlyphCacheGetBitmap( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                              bool b_outline, const FT_Vector *p_origin )
+{
+    bitmap_key_t key;
+    BitmapKey( &key, p_key, b_outline, p_origin );
+
+    glyph_cache_entry_t *p_entry =
+        Lookup( p_cache, GLYPH_CACHE_BITMAP, &key, sizeof( key ) );
+    FT_Glyph p_glyph;
+
+    if( !p_entry || FT_Glyph_Copy( p_entry->u.p_bitmap, &p_glyph ) )
+        return NULL;
+
+    FT_BitmapGlyph p_bitmap = (FT_BitmapGlyph)p_glyph;
+    p_bitmap->left += ( p_origin->x - key.i_x ) / 64;
+    p_bitmap->top  += ( p_origin->y - key.i_y ) / 64;
+    return p_glyph;
+}
+
+void GlyphCachePutBitmap( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                          bool b_outline, const FT_Vector *p_origin,
+                          FT_Glyph p_bitmap )
+{
+    assert( p_bitmap->format == FT_GLYPH_FORMAT_BITMAP );
+
+    bitmap_key_t key;
+    BitmapKey( &key, p_key, b_outline, p_origin );
+
+    glyph_cache_entry_t *p_entry =
+        EntryNew( GLYPH_CACHE_BITMAP, &key, sizeof( key ) );
+    if( !p_entry )
+        return;
+
+    if( FT_Glyph_Copy( p_bitmap, &p_entry->u.p_bitmap ) )
+    {
+        free( p_entry );
+        return;
+    }
+
+    FT_BitmapGlyph p_copy = (FT_BitmapGlyph)p_entry->u.p_bitmap;
+    p_copy->left -= ( p_origin->x - key.i_x ) / 64;
+    p_copy->top  -= ( p_origin->y - key.i_y ) / 64;
+    p_entry->i_size = GlyphSize( p_bitmap );
+    Insert( p_cache, p_entry );
+}
+
+int GlyphCacheGetRun( glyph_cache_t *p_cache, const void *p_key, size_t i_key,
+                      void **pp_data, size_t *pi_data )
+{
+    glyph_cache_entry_t *p_entry =
+        Lookup( p_cache, GLYPH_CACHE_RUN, p_key, i_key );
+    if( !p_entry )
+        return VLC_EGENERIC;
+
+    void *p_data = malloc( p_entry->u.run.i_data );
+    if( unlikely( !p_data ) )
+        return VLC_ENOMEM;
+
+    memcpy( p_data, p_entry->u.run.p_data, p_entry->u.run.i_data );
+    *pp_data = p_data;
+    *pi_data = p_entry->u.run.i_data;
+    return VLC_SUCCESS;
+}
+
+void GlyphCachePutRun( glyph_cache_t *p_cache, const void *p_key, size_t i_key,
+                       void *p_data, size_t i_data )
+{
+    glyph_cache_entry_t *p_entry = EntryNew( GLYPH_CACHE_RUN, p_key, i_key );
+    if( !p_entry )
+    {
+        free( p_data );
+        return;
+    }
+
+    p_entry->u.run.p_data = p_data;
+    p_entry->u.run.i_data = i_data;
+    p_entry->i_size = i_data;
+    Insert( p_cache, p_entry );
+}
+
+/** @} */
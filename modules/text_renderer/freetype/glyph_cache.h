@@ -0,0 +1,138 @@
+/*****************************************************************************
+ * glyph_cache.h : Glyph and shaped run cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+/** \ingroup freetype
+ * @{
+ * \file
+ * Glyph and shaped run cache
+ *
+ * Subtitles and overlays render the same text over and over again. This
+ * caches, in least recently used order and within a memory budget:
+ *  - the glyph outlines, as loaded, emboldened, slanted and stroked,
+ *  - the glyph bitmaps, for each subpixel position of the pen,
+ *  - the output of the shaper for each run of text, keyed by the face (and
+ *    thus the font and style), the script, the direction and the text.
+ *
+ * Font faces are cached per file, index and size by the font manager, and
+ * live as long as the filter, so a face pointer identifies a font size too.
+ */
+
+#include <assert.h>
+
+#include "freetype.h"
+
+/**
+ * Glyph outline key
+ *
+ * Keys are hashed and compared bytewise, so they have no padding.
+ */
+typedef struct
+{
+    FT_Face     p_face;     /**< font face (and size) */
+    FT_Fixed    i_radius;   /**< outline stroker radius, 0 if not outlined */
+    uint32_t    i_index;    /**< glyph index in the face */
+    uint32_t    i_flags;    /**< synthetic styles (STYLE_BOLD, STYLE_ITALIC) */
+} glyph_cache_key_t;
+
+static_assert( sizeof( glyph_cache_key_t ) == sizeof( FT_Face )
+               + sizeof( FT_Fixed ) + 2 * sizeof( uint32_t ),
+               "Padding in glyph cache keys" );
+
+/**
+ * Creates a glyph cache.
+ *
+ * \param i_max_size memory budget in bytes
+ */
+glyph_cache_t *GlyphCacheNew( size_t i_max_size );
+
+/**
+ * Destroys a glyph cache, and prints its statistics.
+ */
+void GlyphCacheDelete( vlc_object_t *p_obj, glyph_cache_t *p_cache );
+
+/**
+ * Drops all cached glyphs and runs.
+ *
+ * This must be called before destroying font faces.
+ */
+void GlyphCacheFlush( glyph_cache_t *p_cache );
+
+/**
+ * Looks up the outlines of a glyph.
+ *
+ * \param pp_glyph [OUT] copy of the glyph outline
+ * \param pp_outline [OUT] copy of the stroked outline, or NULL
+ * \param p_advance [OUT] glyph advance (26.6)
+ * \return VLC_SUCCESS on cache hit
+ */
+int GlyphCacheGetOutlines( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                           FT_Glyph *pp_glyph, FT_Glyph *pp_outline,
+                           FT_Vector *p_advance );
+
+/**
+ * Stores copies of the outlines of a glyph.
+ */
+void GlyphCachePutOutlines( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                            FT_Glyph p_glyph, FT_Glyph p_outline,
+                            const FT_Vector *p_advance );
+
+/**
+ * Looks up a rendered glyph.
+ *
+ * \param b_outline whether to look up the stroked outline or the glyph
+ * \param p_origin pen position (26.6) the glyph is rendered at
+ * \return a bitmap glyph, to be released with FT_Done_Glyph(), or NULL
+ */
+FT_Glyph GlyphCacheGetBitmap( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                              bool b_outline, const FT_Vector *p_origin );
+
+/**
+ * Stores a copy of a rendered glyph.
+ */
+void GlyphCachePutBitmap( glyph_cache_t *p_cache, const glyph_cache_key_t *p_key,
+                          bool b_outline, const FT_Vector *p_origin,
+                          FT_Glyph p_bitmap );
+
+/**
+ * Looks up a shaped run.
+ *
+ * The key and the data are opaque to the cache, and compared bytewise.
+ *
+ * \param pp_data [OUT] heap-allocated copy of the shaper output
+ * \param pi_data [OUT] size of the shaper output in bytes
+ * \return VLC_SUCCESS on cache hit
+ */
+int GlyphCacheGetRun( glyph_cache_t *p_cache, const void *p_key, size_t i_key,
+                      void **pp_data, size_t *pi_data );
+
+/**
+ * Stores a shaped run.
+ *
+ * \param p_data heap-allocated shaper output, owned by the cache afterwards
+ */
+void GlyphCachePutRun( glyph_cache_t *p_cache, const void *p_key, size_t i_key,
+                       void *p_data, size_t i_data );
+
+/** @} */
+
+#endif
@@ -64,6 +64,7 @@
 #include "freetype.h"
 #include "text_layout.h"
 #include "platform_fonts.h"
+#include "glyph_cache.h"
 
 #include <stdlib.h>
 
@@ -112,6 +113,7 @@ typedef struct run_desc_t
     hb_glyph_info_t            *p_glyph_infos;
     hb_glyph_position_t        *p_glyph_positions;
     unsigned int                i_glyph_count;
+    void                       *p_cached_glyphs; /* shaper output from the cache */
 #endif
 
 } run_desc_t;
@@ -131,6 +133,7 @@ typedef struct glyph_bitmaps_t
     int      i_y_offset;
     int      i_x_advance;
     int      i_y_advance;
+    glyph_cache_key_t cache_key; /* NULL face if not cacheable */
 } glyph_bitmaps_t;
 
 typedef struct paragraph_t
@@ -717,6 +720,108 @@ static int ItemizeParagraph( filter_t *p_filter, paragraph_t *p_paragraph )
 }
 
 #ifdef HAVE_HARFBUZZ
+/**
+ * Shaped run cache key, followed by the code points of the run
+ */
+typedef struct
+{
+    FT_Face         p_face;         /**< font face, size and style */
+    uint32_t        i_script;       /**< hb_script_t */
+    uint32_t        i_direction;    /**< hb_direction_t */
+} run_cache_key_t;
+
+static_assert( sizeof( run_cache_key_t ) == sizeof( FT_Face )
+               + 2 * sizeof( uint32_t ), "Padding in shaped run cache keys" );
+
+/**
+ * Shapes a run, or fetches its shaped glyphs from the cache.
+ */
+static int ShapeRunHarfBuzz( filter_t *p_filter, paragraph_t *p_paragraph,
+                             run_desc_t *p_run )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const size_t i_length = p_run->i_end_offset - p_run->i_start_offset;
+    const size_t i_key = sizeof( run_cache_key_t )
+                       + i_length * sizeof( *p_paragraph->p_code_points );
+    const size_t i_glyph_size = sizeof( hb_glyph_info_t )
+                              + sizeof( hb_glyph_position_t );
+
+    run_cache_key_t *p_key = malloc( i_key );
+    if( p_key )
+    {
+        p_key->p_face = p_run->p_face;
+        p_key->i_script = p_run->script;
+        p_key->i_direction = p_run->direction;
+        memcpy( p_key + 1, p_paragraph->p_code_points + p_run->i_start_offset,
+                i_length * sizeof( *p_paragraph->p_code_points ) );
+
+        void *p_data;
+        size_t i_data;
+        if( GlyphCacheGetRun( p_sys->p_cache, p_key, i_key,
+                              &p_data, &i_data ) == VLC_SUCCESS )
+        {
+            free( p_key );
+            p_run->p_cached_glyphs = p_data;
+            p_run->i_glyph_count = i_data / i_glyph_size;
+            p_run->p_glyph_infos = p_data;
+            p_run->p_glyph_positions = (hb_glyph_position_t *)
+                ( p_run->p_glyph_infos + p_run->i_glyph_count );
+            return VLC_SUCCESS;
+        }
+    }
+
+    p_run->p_hb_font = hb_ft_font_create( p_run->p_face, 0 );
+    if( !p_run->p_hb_font )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+        free( p_key );
+        return VLC_EGENERIC;
+    }
+
+    p_run->p_buffer = hb_buffer_create();
+    if( !p_run->p_buffer )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
+        free( p_key );
+        return VLC_EGENERIC;
+    }
+
+    hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
+    hb_buffer_set_script( p_run->p_buffer, p_run->script );
+#ifdef __OS2__
+    hb_buffer_add_utf16( p_run->p_buffer,
+                         p_paragraph->p_code_points + p_run->i_start_offset,
+                         i_length, 0, i_length );
+#else
+    hb_buffer_add_utf32( p_run->p_buffer,
+                         p_paragraph->p_code_points + p_run->i_start_offset,
+                         i_length, 0, i_length );
+#endif
+    hb_shape( p_run->p_hb_font, p_run->p_buffer, 0, 0 );
+    p_run->p_glyph_infos =
+        hb_buffer_get_glyph_infos( p_run->p_buffer, &p_run->i_glyph_count );
+    p_run->p_glyph_positions =
+        hb_buffer_get_glyph_positions( p_run->p_buffer, &p_run->i_glyph_count );
+
+    if( p_key && p_run->i_glyph_count > 0 )
+    {
+        const size_t i_infos = p_run->i_glyph_count * sizeof( hb_glyph_info_t );
+        const size_t i_data = p_run->i_glyph_count * i_glyph_size;
+        uint8_t *p_data = malloc( i_data );
+        if( p_data )
+        {
+            memcpy( p_data, p_run->p_glyph_infos, i_infos );
+            memcpy( p_data + i_infos, p_run->p_glyph_positions,
+                    i_data - i_infos );
+            GlyphCachePutRun( p_sys->p_cache, p_key, i_key, p_data, i_data );
+        }
+    }
+    free( p_key );
+    return VLC_SUCCESS;
+}
+
 /**
  * Shape an itemized paragraph using HarfBuzz.
  * This is where the glyphs of complex scripts get their positions
@@ -770,40 +875,8 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
         else
             p_face = p_run->p_face;
 
-        p_run->p_hb_font = hb_ft_font_create( p_face, 0 );
-        if( !p_run->p_hb_font )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
-            goto error;
-        }
-
-        p_run->p_buffer = hb_buffer_create();
-        if( !p_run->p_buffer )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
+        if( ShapeRunHarfBuzz( p_filter, p_paragraph, p_run ) )
             goto error;
-        }
-
-        hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
-        hb_buffer_set_script( p_run->p_buffer, p_run->script );
-#ifdef __OS2__
-        hb_buffer_add_utf16( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-#else
-        hb_buffer_add_utf32( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-#endif
-        hb_shape( p_run->p_hb_font, p_run->p_buffer, 0, 0 );
-        p_run->p_glyph_infos =
-            hb_buffer_get_glyph_infos( p_run->p_buffer, &p_run->i_glyph_count );
-        p_run->p_glyph_positions =
-            hb_buffer_get_glyph_positions( p_run->p_buffer, &p_run->i_glyph_count );
 
         if( p_run->i_glyph_count <= 0 )
         {
@@ -885,6 +958,7 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
     {
         hb_font_destroy( p_paragraph->p_runs[ i ].p_hb_font );
         hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        free( p_paragraph->p_runs[ i ].p_cached_glyphs );
     }
     FreeParagraph( *p_old_paragraph );
     *p_old_paragraph = p_new_paragraph;
@@ -898,6 +972,7 @@ error:
             hb_font_destroy( p_paragraph->p_runs[ i ].p_hb_font );
         if( p_paragraph->p_runs[ i ].p_buffer )
             hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        free( p_paragraph->p_runs[ i ].p_cached_glyphs );
     }
 
     if( p_new_paragraph )
@@ -1039,12 +1114,13 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         else
             p_face = p_run->p_face;
 
+        int i_radius = 0;
         if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
         {
             double f_outline_thickness =
                 var_InheritInteger( p_filter, "freetype-outline-thickness" ) / 100.0;
             f_outline_thickness = VLC_CLIP( f_outline_thickness, 0.0, 0.5 );
-            int i_radius = ( i_live_size << 6 ) * f_outline_thickness;
+            i_radius = ( i_live_size << 6 ) * f_outline_thickness;
             FT_Stroker_Set( p_sys->p_stroker,
                             i_radius,
                             FT_STROKER_LINECAP_ROUND,
@@ -1069,6 +1145,7 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
         p_bitmaps->p_shadow = 0; \
         p_bitmaps->i_x_advance = 0; \
         p_bitmaps->i_y_advance = 0; \
+        p_bitmaps->cache_key.p_face = NULL; \
         continue; \
     }
 
@@ -1101,39 +1178,59 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
                     SKIP_GLYPH( p_bitmaps )
             }
 
-            if( FT_Load_Glyph( p_face, i_glyph_index,
-                               FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
-             && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
-                SKIP_GLYPH( p_bitmaps )
-
+            glyph_cache_key_t *p_key = &p_bitmaps->cache_key;
+            memset( p_key, 0, sizeof( *p_key ) );
+            p_key->p_face = p_face;
+            p_key->i_index = i_glyph_index;
             if( ( p_style->i_style_flags & STYLE_BOLD )
                   && !( p_face->style_flags & FT_STYLE_FLAG_BOLD ) )
-                FT_GlyphSlot_Embolden( p_face->glyph );
+                p_key->i_flags |= STYLE_BOLD;
             if( ( p_style->i_style_flags & STYLE_ITALIC )
                   && !( p_face->style_flags & FT_STYLE_FLAG_ITALIC ) )
-                FT_GlyphSlot_Oblique( p_face->glyph );
+                p_key->i_flags |= STYLE_ITALIC;
+            p_key->i_radius = i_radius;
 
-            if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
-                SKIP_GLYPH( p_bitmaps )
+            FT_Vector advance;
+            if( GlyphCacheGetOutlines( p_sys->p_cache, p_key, &p_bitmaps->p_glyph,
+                                       &p_bitmaps->p_outline, &advance ) )
+            {
+                if( FT_Load_Glyph( p_face, i_glyph_index,
+                                   FT_LOAD_NO_BITMAP | FT_LOAD_DEFAULT )
+                 && FT_Load_Glyph( p_face, i_glyph_index, FT_LOAD_DEFAULT ) )
+                    SKIP_GLYPH( p_bitmaps )
 
-#undef SKIP_GLYPH
+                if( p_key->i_flags & STYLE_BOLD )
+                    FT_GlyphSlot_Embolden( p_face->glyph );
+                if( p_key->i_flags & STYLE_ITALIC )
+                    FT_GlyphSlot_Oblique( p_face->glyph );
 
-            if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
-            {
-                p_bitmaps->p_outline = p_bitmaps->p_glyph;
-                if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
-                                           p_sys->p_stroker, 0, 0 ) )
-                    p_bitmaps->p_outline = 0;
+                if( FT_Get_Glyph( p_face->glyph, &p_bitmaps->p_glyph ) )
+                    SKIP_GLYPH( p_bitmaps )
+
+                p_bitmaps->p_outline = 0;
+                if( p_sys->p_stroker && (p_style->i_style_flags & STYLE_OUTLINE) )
+                {
+                    p_bitmaps->p_outline = p_bitmaps->p_glyph;
+                    if( FT_Glyph_StrokeBorder( &p_bitmaps->p_outline,
+                                               p_sys->p_stroker, 0, 0 ) )
+                        p_bitmaps->p_outline = 0;
+                }
+
+                advance = p_face->glyph->advance;
+                GlyphCachePutOutlines( p_sys->p_cache, p_key, p_bitmaps->p_glyph,
+                                       p_bitmaps->p_outline, &advance );
             }
 
+#undef SKIP_GLYPH
+
             if( p_style->i_shadow_alpha != STYLE_ALPHA_TRANSPARENT )
                 p_bitmaps->p_shadow = p_bitmaps->p_outline ?
                                       p_bitmaps->p_outline : p_bitmaps->p_glyph;
 
             if( b_overwrite_advance )
             {
-                p_bitmaps->i_x_advance = p_face->glyph->advance.x;
-                p_bitmaps->i_y_advance = p_face->glyph->advance.y;
+                p_bitmaps->i_x_advance = advance.x;
+                p_bitmaps->i_y_advance = advance.y;
             }
 
             unsigned i_x_advance = FT_FLOOR( abs( p_bitmaps->i_x_advance ) );
@@ -1144,6 +1241,39 @@ static int LoadGlyphs( filter_t *p_filter, paragraph_t *p_paragraph,
     return VLC_SUCCESS;
 }
 
+/**
+ * Renders a glyph like FT_Glyph_To_Bitmap(), through the glyph cache.
+ */
+static FT_Error RenderGlyph( filter_t *p_filter, const glyph_bitmaps_t *p_bitmaps,
+                             FT_Glyph *pp_glyph, bool b_outline,
+                             FT_Vector *p_origin, FT_Bool destroy )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const glyph_cache_key_t *p_key = &p_bitmaps->cache_key;
+
+    /* Only outlines depend on the pen position */
+    if( !p_key->p_face || (*pp_glyph)->format != FT_GLYPH_FORMAT_OUTLINE )
+        return FT_Glyph_To_Bitmap( pp_glyph, FT_RENDER_MODE_NORMAL,
+                                   p_origin, destroy );
+
+    FT_Glyph p_bitmap = GlyphCacheGetBitmap( p_sys->p_cache, p_key,
+                                             b_outline, p_origin );
+    if( p_bitmap )
+    {
+        if( destroy )
+            FT_Done_Glyph( *pp_glyph );
+        *pp_glyph = p_bitmap;
+        return 0;
+    }
+
+    FT_Error err = FT_Glyph_To_Bitmap( pp_glyph, FT_RENDER_MODE_NORMAL,
+                                       p_origin, destroy );
+    if( !err )
+        GlyphCachePutBitmap( p_sys->p_cache, p_key, b_outline, p_origin,
+                             *pp_glyph );
+    return err;
+}
+
 static int LayoutLine( filter_t *p_filter,
                        paragraph_t *p_paragraph,
                        int i_first_char, int i_last_char,
@@ -1240,8 +1370,9 @@ static int LayoutLine( filter_t *p_filter,
 
         if( p_bitmaps->p_shadow )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_shadow, FT_RENDER_MODE_NORMAL,
-                                    &pen_shadow, 0 ) )
+            if( RenderGlyph( p_filter, p_bitmaps, &p_bitmaps->p_shadow,
+                             p_bitmaps->p_shadow == p_bitmaps->p_outline,
+                             &pen_shadow, 0 ) )
                 p_bitmaps->p_shadow = 0;
             else
                 FT_Glyph_Get_CBox( p_bitmaps->p_shadow, ft_glyph_bbox_pixels,
@@ -1249,8 +1380,8 @@ static int LayoutLine( filter_t *p_filter,
         }
         if( p_bitmaps->p_glyph )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_glyph, FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 1 ) )
+            if( RenderGlyph( p_filter, p_bitmaps, &p_bitmaps->p_glyph, false,
+                             &pen_new, 1 ) )
             {
                 FT_Done_Glyph( p_bitmaps->p_glyph );
                 if( p_bitmaps->p_outline )
@@ -1265,8 +1396,8 @@ static int LayoutLine( filter_t *p_filter,
         }
         if( p_bitmaps->p_outline )
         {
-            if( FT_Glyph_To_Bitmap( &p_bitmaps->p_outline, FT_RENDER_MODE_NORMAL,
-                                    &pen_new, 1 ) )
+            if( RenderGlyph( p_filter, p_bitmaps, &p_bitmaps->p_outline, true,
+                             &pen_new, 1 ) )
             {
                 FT_Done_Glyph( p_bitmaps->p_outline );
                 p_bitmaps->p_outline = 0;
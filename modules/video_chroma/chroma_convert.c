@@ -0,0 +1,1109 @@
+/*****************************************************************************
+ * chroma_convert.c: table-driven YUV and YUV to RGB conversions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Rather than one function per pair of formats, each line is unpacked from the
+ * source format to 16-bit Y, U and V lines, the chroma lines are resampled to
+ * the destination subsampling, then they are packed to the destination format.
+ * Line buffers stay in the L1 cache, so the extra passes are cheap compared to
+ * the picture memory accesses. Formats are described by a table, and only the
+ * unpacking and packing kernels depend on the memory layout.
+ *
+ * Chroma is resampled with the nearest sample, as the other VLC converters.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+#include <vlc_slices.h>
+
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+#ifdef HAVE_AVX2_INTRINSICS
+static int  OpenAVX2( vlc_object_t * );
+#endif
+
+/* The C version ranks below the SIMD converters of other modules, the AVX2
+ * version above them. */
+vlc_module_begin ()
+    set_description( N_("Table-driven YUV and RGB conversions") )
+    set_capability( "video converter", 90 )
+    set_callbacks( Open, Close )
+#ifdef HAVE_AVX2_INTRINSICS
+    add_submodule ()
+    set_description( N_("AVX2 table-driven YUV and RGB conversions") )
+    set_capability( "video converter", 140 )
+    set_callbacks( OpenAVX2, Close )
+#endif
+vlc_module_end ()
+
+/*****************************************************************************
+ * Formats
+ *****************************************************************************/
+enum conv_layout
+{
+    CONV_GREY, /* Y plane only */
+    CONV_PLANAR, /* Y, U and V planes */
+    CONV_SEMIPLANAR, /* Y plane and interleaved U/V plane */
+    CONV_PACKED, /* interleaved 4:2:2 Y/U/Y/V */
+    CONV_RGB, /* 8-bit RGB with 4 bytes per pixel (output only) */
+};
+
+struct conv_format
+{
+    vlc_fourcc_t fourcc;
+    uint8_t layout;
+    uint8_t size; /* bytes per sample */
+    uint8_t shift; /* left shift from a stored sample to 16 bits */
+    uint8_t hsub; /* log2 of the horizontal chroma subsampling */
+    uint8_t vsub; /* log2 of the vertical chroma subsampling */
+    bool swap; /* V before U */
+    bool luma_odd; /* packed luma on odd bytes (UYVY and VYUY) */
+    bool full_range; /* full range by definition (JPEG) */
+};
+
+#define GREY(fcc, size, shift) \
+    { VLC_CODEC_##fcc, CONV_GREY, size, shift, 0, 0, false, false, false }
+#define PLANAR(fcc, size, shift, h, v, swap, full) \
+    { VLC_CODEC_##fcc, CONV_PLANAR, size, shift, h, v, swap, false, full }
+#define SEMIPLANAR(fcc, size, shift, h, v, swap) \
+    { VLC_CODEC_##fcc, CONV_SEMIPLANAR, size, shift, h, v, swap, false, false }
+#define PACKED(fcc, swap, odd) \
+    { VLC_CODEC_##fcc, CONV_PACKED, 1, 8, 1, 0, swap, odd, false }
+#define RGB(fcc) \
+    { VLC_CODEC_##fcc, CONV_RGB, 4, 0, 0, 0, false, false, true }
+
+static const struct conv_format formats[] = {
+    GREY(GREY, 1, 8),
+    GREY(GREY_10L, 2, 6),
+    GREY(GREY_12L, 2, 4),
+    GREY(GREY_16L, 2, 0),
+
+    PLANAR(I420, 1, 8, 1, 1, false, false),
+    PLANAR(YV12, 1, 8, 1, 1, true, false),
+    PLANAR(J420, 1, 8, 1, 1, false, true),
+    PLANAR(I422, 1, 8, 1, 0, false, false),
+    PLANAR(J422, 1, 8, 1, 0, false, true),
+    PLANAR(I440, 1, 8, 0, 1, false, false),
+    PLANAR(J440, 1, 8, 0, 1, false, true),
+    PLANAR(I444, 1, 8, 0, 0, false, false),
+    PLANAR(J444, 1, 8, 0, 0, false, true),
+    PLANAR(I420_9L, 2, 7, 1, 1, false, false),
+    PLANAR(I420_10L, 2, 6, 1, 1, false, false),
+    PLANAR(I420_12L, 2, 4, 1, 1, false, false),
+    PLANAR(I420_16L, 2, 0, 1, 1, false, false),
+    PLANAR(I422_9L, 2, 7, 1, 0, false, false),
+    PLANAR(I422_10L, 2, 6, 1, 0, false, false),
+    PLANAR(I422_12L, 2, 4, 1, 0, false, false),
+    PLANAR(I422_16L, 2, 0, 1, 0, false, false),
+    PLANAR(I444_9L, 2, 7, 0, 0, false, false),
+    PLANAR(I444_10L, 2, 6, 0, 0, false, false),
+    PLANAR(I444_12L, 2, 4, 0, 0, false, false),
+    PLANAR(I444_16L, 2, 0, 0, 0, false, false),
+
+    SEMIPLANAR(NV12, 1, 8, 1, 1, false),
+    SEMIPLANAR(NV21, 1, 8, 1, 1, true),
+    SEMIPLANAR(NV16, 1, 8, 1, 0, false),
+    SEMIPLANAR(NV61, 1, 8, 1, 0, true),
+    SEMIPLANAR(P010, 2, 0, 1, 1, false),
+    SEMIPLANAR(P016, 2, 0, 1, 1, false),
+
+    PACKED(YUYV, false, false),
+    PACKED(YVYU, true, false),
+    PACKED(UYVY, false, true),
+    PACKED(VYUY, true, true),
+
+    RGB(RGB32),
+    RGB(RGBA),
+    RGB(BGRA),
+    RGB(ARGB),
+};
+
+static const struct conv_format *FindFormat(vlc_fourcc_t fourcc)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(formats); i++)
+        if (formats[i].fourcc == fourcc)
+            return &formats[i];
+    return NULL;
+}
+
+/* Number of significant bits of a format */
+static unsigned FormatBits(const struct conv_format *fmt)
+{
+    /* P010 stores the 10 significant bits in the most significant bits. */
+    if (fmt->fourcc == VLC_CODEC_P010)
+        return 10;
+    return 16 - fmt->shift;
+}
+
+static bool IsFullRange(const struct conv_format *fmt,
+                        const video_format_t *vf)
+{
+    return fmt->full_range || vf->color_range == COLOR_RANGE_FULL;
+}
+
+/*****************************************************************************
+ * YUV to RGB matrix
+ *****************************************************************************/
+/* YUV samples are reduced to 14 bits, so that products with Q12 coefficients
+ * and their sums fit in 32 bits, and the AVX2 kernel can use 16-bit lanes. */
+#define RGB_COEF_BITS 12
+#define RGB_SHIFT (RGB_COEF_BITS + 14 - 8)
+#define RGB_ROUND (1 << (RGB_SHIFT - 1))
+#define RGB_CHROMA_ZERO (1 << 13)
+
+struct conv_matrix
+{
+    int16_t cy, crv, cgu, cgv, cbu; /* Q12 coefficients */
+    int16_t y_offset; /* black level on 14 bits */
+    uint8_t r, g, b, a; /* byte offsets in a pixel */
+};
+
+static void SetupMatrix(struct conv_matrix *m, video_color_space_t space,
+                        bool full_range)
+{
+    double kr, kb;
+
+    switch (space)
+    {
+        case COLOR_SPACE_BT709:
+            kr = 0.2126, kb = 0.0722;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627, kb = 0.0593;
+            break;
+        default:
+            kr = 0.299, kb = 0.114;
+            break;
+    }
+
+    const double kg = 1. - kr - kb;
+    const double ys = full_range ? 1. : 255. / 219.;
+    const double cs = full_range ? 1. : 255. / 224.;
+    const double one = 1 << RGB_COEF_BITS;
+
+    m->cy = lround(ys * one);
+    m->crv = lround(2. * (1. - kr) * cs * one);
+    m->cbu = lround(2. * (1. - kb) * cs * one);
+    m->cgu = lround(-2. * (1. - kb) * kb / kg * cs * one);
+    m->cgv = lround(-2. * (1. - kr) * kr / kg * cs * one);
+    m->y_offset = full_range ? 0 : 16 << 6;
+}
+
+/* Computes the byte offset of a component from an RGB32 mask. */
+static int MaskOffset(uint32_t mask)
+{
+    if (mask == 0 || (ctz(mask) % 8) != 0 || (mask >> ctz(mask)) != 0xff)
+        return -1;
+#ifdef WORDS_BIGENDIAN
+    return 3 - ctz(mask) / 8;
+#else
+    return ctz(mask) / 8;
+#endif
+}
+
+static int SetupRGB(struct conv_matrix *m, const video_format_t *fmt)
+{
+    switch (fmt->i_chroma)
+    {
+        case VLC_CODEC_RGBA:
+            m->r = 0, m->g = 1, m->b = 2, m->a = 3;
+            return 0;
+        case VLC_CODEC_BGRA:
+            m->b = 0, m->g = 1, m->r = 2, m->a = 3;
+            return 0;
+        case VLC_CODEC_ARGB:
+            m->a = 0, m->r = 1, m->g = 2, m->b = 3;
+            return 0;
+    }
+
+    assert(fmt->i_chroma == VLC_CODEC_RGB32);
+
+    video_format_t vfmt = *fmt;
+    video_format_FixRgb(&vfmt);
+
+    int r = MaskOffset(vfmt.i_rmask);
+    int g = MaskOffset(vfmt.i_gmask);
+    int b = MaskOffset(vfmt.i_bmask);
+
+    if (r < 0 || g < 0 || b < 0 || r == g || g == b || r == b)
+        return -1;
+    m->r = r, m->g = g, m->b = b;
+    m->a = 6 - r - g - b;
+    return 0;
+}
+
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+typedef void (*plane_unpack_cb)(uint16_t *, const uint8_t *, unsigned,
+                                unsigned);
+typedef void (*plane_pack_cb)(uint8_t *, const uint16_t *, unsigned,
+                              unsigned, unsigned);
+typedef void (*uv_unpack_cb)(uint16_t *, uint16_t *, const uint8_t *,
+                             unsigned, unsigned);
+typedef void (*uv_pack_cb)(uint8_t *, const uint16_t *, const uint16_t *,
+                           unsigned, unsigned, unsigned);
+typedef void (*packed_unpack_cb)(uint16_t *, uint16_t *, uint16_t *,
+                                 const uint8_t *, unsigned, bool);
+typedef void (*packed_pack_cb)(uint8_t *, const uint16_t *, const uint16_t *,
+                               const uint16_t *, unsigned, bool);
+typedef void (*rgb_pack_cb)(uint8_t *, const uint16_t *, const uint16_t *,
+                            const uint16_t *, unsigned,
+                            const struct conv_matrix *);
+
+static void PlaneUnpack8(uint16_t *dst, const uint8_t *src, unsigned n,
+                         unsigned shift)
+{
+    assert(shift == 8);
+    for (unsigned x = 0; x < n; x++)
+        dst[x] = src[x] << 8;
+}
+
+static void PlaneUnpack16(uint16_t *dst, const uint8_t *src, unsigned n,
+                          unsigned shift)
+{
+    const uint16_t *s = (const uint16_t *)src;
+
+    for (unsigned x = 0; x < n; x++)
+        dst[x] = s[x] << shift;
+}
+
+static void PlanePack8(uint8_t *dst, const uint16_t *src, unsigned n,
+                       unsigned rshift, unsigned lshift)
+{
+    assert(rshift == 8 && lshift == 0);
+    for (unsigned x = 0; x < n; x++)
+        dst[x] = src[x] >> 8;
+}
+
+static void PlanePack16(uint8_t *dst, const uint16_t *src, unsigned n,
+                        unsigned rshift, unsigned lshift)
+{
+    uint16_t *d = (uint16_t *)dst;
+
+    for (unsigned x = 0; x < n; x++)
+        d[x] = (src[x] >> rshift) << lshift;
+}
+
+static void UVUnpack8(uint16_t *u, uint16_t *v, const uint8_t *src,
+                      unsigned n, unsigned shift)
+{
+    assert(shift == 8);
+    for (unsigned x = 0; x < n; x++)
+    {
+        u[x] = src[2 * x] << 8;
+        v[x] = src[2 * x + 1] << 8;
+    }
+}
+
+static void UVUnpack16(uint16_t *u, uint16_t *v, const uint8_t *src,
+                       unsigned n, unsigned shift)
+{
+    const uint16_t *s = (const uint16_t *)src;
+
+    for (unsigned x = 0; x < n; x++)
+    {
+        u[x] = s[2 * x] << shift;
+        v[x] = s[2 * x + 1] << shift;
+    }
+}
+
+static void UVPack8(uint8_t *dst, const uint16_t *u, const uint16_t *v,
+                    unsigned n, unsigned rshift, unsigned lshift)
+{
+    assert(rshift == 8 && lshift == 0);
+    for (unsigned x = 0; x < n; x++)
+    {
+        dst[2 * x] = u[x] >> 8;
+        dst[2 * x + 1] = v[x] >> 8;
+    }
+}
+
+static void UVPack16(uint8_t *dst, const uint16_t *u, const uint16_t *v,
+                     unsigned n, unsigned rshift, unsigned lshift)
+{
+    uint16_t *d = (uint16_t *)dst;
+
+    for (unsigned x = 0; x < n; x++)
+    {
+        d[2 * x] = (u[x] >> rshift) << lshift;
+        d[2 * x + 1] = (v[x] >> rshift) << lshift;
+    }
+}
+
+static void PackedUnpack(uint16_t *py, uint16_t *pu, uint16_t *pv,
+                         const uint8_t *src, unsigned n, bool luma_odd)
+{
+    const unsigned yo = luma_odd;
+    const unsigned co = !yo;
+
+    for (unsigned x = 0; x < n / 2; x++, src += 4)
+    {
+        py[2 * x] = src[yo] << 8;
+        py[2 * x + 1] = src[yo + 2] << 8;
+        pu[x] = src[co] << 8;
+        pv[x] = src[co + 2] << 8;
+    }
+}
+
+static void PackedPack(uint8_t *dst, const uint16_t *py, const uint16_t *pu,
+                       const uint16_t *pv, unsigned n, bool luma_odd)
+{
+    const unsigned yo = luma_odd;
+    const unsigned co = !yo;
+
+    for (unsigned x = 0; x < n / 2; x++, dst += 4)
+    {
+        dst[yo] = py[2 * x] >> 8;
+        dst[yo + 2] = py[2 * x + 1] >> 8;
+        dst[co] = pu[x] >> 8;
+        dst[co + 2] = pv[x] >> 8;
+    }
+}
+
+static void RGBPack(uint8_t *dst, const uint16_t *py, const uint16_t *pu,
+                    const uint16_t *pv, unsigned n,
+                    const struct conv_matrix *m)
+{
+    for (unsigned x = 0; x < n; x++)
+    {
+        int y = (py[x] >> 2) - m->y_offset;
+        int u = (pu[x] >> 2) - RGB_CHROMA_ZERO;
+        int v = (pv[x] >> 2) - RGB_CHROMA_ZERO;
+        int r = (m->cy * y + m->crv * v + RGB_ROUND) >> RGB_SHIFT;
+        int g = (m->cy * y + m->cgu * u + m->cgv * v + RGB_ROUND) >> RGB_SHIFT;
+        int b = (m->cy * y + m->cbu * u + RGB_ROUND) >> RGB_SHIFT;
+
+        dst[m->r] = clip_uint8_vlc(r);
+        dst[m->g] = clip_uint8_vlc(g);
+        dst[m->b] = clip_uint8_vlc(b);
+        dst[m->a] = 0xff;
+        dst += 4;
+    }
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+/* The AVX2 kernels process full vectors, and leave the remaining samples to
+ * the C kernels. Both must give exactly the same results. */
+__attribute__ ((__target__ ("avx2")))
+static void PlaneUnpack8AVX2(uint16_t *dst, const uint8_t *src, unsigned n,
+                             unsigned shift)
+{
+    unsigned x = 0;
+
+    for (; x + 32 <= n; x += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + x));
+        __m256i lo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(a));
+        __m256i hi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(a, 1));
+
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm256_slli_epi16(lo, 8));
+        _mm256_storeu_si256((__m256i *)(dst + x + 16),
+                            _mm256_slli_epi16(hi, 8));
+    }
+    PlaneUnpack8(dst + x, src + x, n - x, shift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void PlaneUnpack16AVX2(uint16_t *dst, const uint8_t *src, unsigned n,
+                              unsigned shift)
+{
+    const uint16_t *s = (const uint16_t *)src;
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    unsigned x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + x));
+
+        _mm256_storeu_si256((__m256i *)(dst + x), _mm256_sll_epi16(a, count));
+    }
+    PlaneUnpack16(dst + x, (const uint8_t *)(s + x), n - x, shift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void PlanePack8AVX2(uint8_t *dst, const uint16_t *src, unsigned n,
+                           unsigned rshift, unsigned lshift)
+{
+    unsigned x = 0;
+
+    for (; x + 32 <= n; x += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + x + 16));
+        __m256i c = _mm256_packus_epi16(_mm256_srli_epi16(a, 8),
+                                        _mm256_srli_epi16(b, 8));
+
+        _mm256_storeu_si256((__m256i *)(dst + x),
+                            _mm256_permute4x64_epi64(c, 0xD8));
+    }
+    PlanePack8(dst + x, src + x, n - x, rshift, lshift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void PlanePack16AVX2(uint8_t *dst, const uint16_t *src, unsigned n,
+                            unsigned rshift, unsigned lshift)
+{
+    uint16_t *d = (uint16_t *)dst;
+    const __m128i rcount = _mm_cvtsi32_si128(rshift);
+    const __m128i lcount = _mm_cvtsi32_si128(lshift);
+    unsigned x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + x));
+
+        a = _mm256_sll_epi16(_mm256_srl_epi16(a, rcount), lcount);
+        _mm256_storeu_si256((__m256i *)(d + x), a);
+    }
+    PlanePack16((uint8_t *)(d + x), src + x, n - x, rshift, lshift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void UVUnpack8AVX2(uint16_t *u, uint16_t *v, const uint8_t *src,
+                          unsigned n, unsigned shift)
+{
+    const __m256i vmask = _mm256_set1_epi16(0xff00);
+    unsigned x = 0;
+
+    /* Each 16-bit lane holds one U/V pair: U in the low byte. */
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + 2 * x));
+
+        _mm256_storeu_si256((__m256i *)(u + x), _mm256_slli_epi16(a, 8));
+        _mm256_storeu_si256((__m256i *)(v + x), _mm256_and_si256(a, vmask));
+    }
+    UVUnpack8(u + x, v + x, src + 2 * x, n - x, shift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void UVUnpack16AVX2(uint16_t *u, uint16_t *v, const uint8_t *src,
+                           unsigned n, unsigned shift)
+{
+    const uint16_t *s = (const uint16_t *)src;
+    const __m256i umask = _mm256_set1_epi32(0xffff);
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    unsigned x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + 2 * x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + 2 * x + 16));
+        __m256i cu = _mm256_packus_epi32(_mm256_and_si256(a, umask),
+                                         _mm256_and_si256(b, umask));
+        __m256i cv = _mm256_packus_epi32(_mm256_srli_epi32(a, 16),
+                                         _mm256_srli_epi32(b, 16));
+
+        cu = _mm256_permute4x64_epi64(cu, 0xD8);
+        cv = _mm256_permute4x64_epi64(cv, 0xD8);
+        _mm256_storeu_si256((__m256i *)(u + x), _mm256_sll_epi16(cu, count));
+        _mm256_storeu_si256((__m256i *)(v + x), _mm256_sll_epi16(cv, count));
+    }
+    UVUnpack16(u + x, v + x, (const uint8_t *)(s + 2 * x), n - x, shift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void UVPack8AVX2(uint8_t *dst, const uint16_t *u, const uint16_t *v,
+                        unsigned n, unsigned rshift, unsigned lshift)
+{
+    const __m256i vmask = _mm256_set1_epi16(0xff00);
+    unsigned x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(u + x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(v + x));
+        __m256i c = _mm256_or_si256(_mm256_srli_epi16(a, 8),
+                                    _mm256_and_si256(b, vmask));
+
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x), c);
+    }
+    UVPack8(dst + 2 * x, u + x, v + x, n - x, rshift, lshift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void UVPack16AVX2(uint8_t *dst, const uint16_t *u, const uint16_t *v,
+                         unsigned n, unsigned rshift, unsigned lshift)
+{
+    uint16_t *d = (uint16_t *)dst;
+    const __m128i rcount = _mm_cvtsi32_si128(rshift);
+    const __m128i lcount = _mm_cvtsi32_si128(lshift);
+    unsigned x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(u + x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(v + x));
+
+        a = _mm256_sll_epi16(_mm256_srl_epi16(a, rcount), lcount);
+        b = _mm256_sll_epi16(_mm256_srl_epi16(b, rcount), lcount);
+
+        __m256i lo = _mm256_unpacklo_epi16(a, b);
+        __m256i hi = _mm256_unpackhi_epi16(a, b);
+
+        _mm256_storeu_si256((__m256i *)(d + 2 * x),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(d + 2 * x + 16),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    UVPack16((uint8_t *)(d + 2 * x), u + x, v + x, n - x, rshift, lshift);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void PackedUnpackAVX2(uint16_t *py, uint16_t *pu, uint16_t *pv,
+                             const uint8_t *src, unsigned n, bool luma_odd)
+{
+    const __m256i hmask = _mm256_set1_epi16(0xff00);
+    const __m256i umask = _mm256_set1_epi32(0xffff);
+    unsigned x = 0;
+
+    /* Each 16-bit lane holds one luma and one chroma sample. Chroma samples
+     * alternate between U and V, i.e. each 32-bit lane holds a U/V pair. */
+    for (; x + 32 <= n; x += 32)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(src + 2 * x));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + 2 * x + 32));
+        __m256i ya, yb, ca, cb;
+
+        if (luma_odd)
+        {
+            ya = _mm256_and_si256(a, hmask);
+            yb = _mm256_and_si256(b, hmask);
+            ca = _mm256_slli_epi16(a, 8);
+            cb = _mm256_slli_epi16(b, 8);
+        }
+        else
+        {
+            ya = _mm256_slli_epi16(a, 8);
+            yb = _mm256_slli_epi16(b, 8);
+            ca = _mm256_and_si256(a, hmask);
+            cb = _mm256_and_si256(b, hmask);
+        }
+
+        __m256i u = _mm256_packus_epi32(_mm256_and_si256(ca, umask),
+                                        _mm256_and_si256(cb, umask));
+        __m256i v = _mm256_packus_epi32(_mm256_srli_epi32(ca, 16),
+                                        _mm256_srli_epi32(cb, 16));
+
+        _mm256_storeu_si256((__m256i *)(py + x), ya);
+        _mm256_storeu_si256((__m256i *)(py + x + 16), yb);
+        _mm256_storeu_si256((__m256i *)(pu + x / 2),
+                            _mm256_permute4x64_epi64(u, 0xD8));
+        _mm256_storeu_si256((__m256i *)(pv + x / 2),
+                            _mm256_permute4x64_epi64(v, 0xD8));
+    }
+    PackedUnpack(py + x, pu + x / 2, pv + x / 2, src + 2 * x, n - x,
+                 luma_odd);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void PackedPackAVX2(uint8_t *dst, const uint16_t *py,
+                           const uint16_t *pu, const uint16_t *pv,
+                           unsigned n, bool luma_odd)
+{
+    const __m256i hmask = _mm256_set1_epi16(0xff00);
+    unsigned x = 0;
+
+    for (; x + 32 <= n; x += 32)
+    {
+        __m256i y0 = _mm256_loadu_si256((const __m256i *)(py + x));
+        __m256i y1 = _mm256_loadu_si256((const __m256i *)(py + x + 16));
+        __m256i u = _mm256_loadu_si256((const __m256i *)(pu + x / 2));
+        __m256i v = _mm256_loadu_si256((const __m256i *)(pv + x / 2));
+        __m256i y = _mm256_packus_epi16(_mm256_srli_epi16(y0, 8),
+                                        _mm256_srli_epi16(y1, 8));
+        __m256i c = _mm256_or_si256(_mm256_srli_epi16(u, 8),
+                                    _mm256_and_si256(v, hmask));
+        __m256i lo, hi;
+
+        y = _mm256_permute4x64_epi64(y, 0xD8);
+        if (luma_odd)
+        {
+            lo = _mm256_unpacklo_epi8(c, y);
+            hi = _mm256_unpackhi_epi8(c, y);
+        }
+        else
+        {
+            lo = _mm256_unpacklo_epi8(y, c);
+            hi = _mm256_unpackhi_epi8(y, c);
+        }
+
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x),
+                            _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst + 2 * x + 32),
+                            _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    PackedPack(dst + 2 * x, py + x, pu + x / 2, pv + x / 2, n - x, luma_odd);
+}
+
+/* Scales a 16-bit lane component to a byte in a 32-bit lane pixel. */
+#define RGB_PLACE(c, half, count) \
+    _mm256_sll_epi32(_mm256_cvtepu16_epi32(half(c)), count)
+#define RGB_LO(c) _mm256_castsi256_si128(c)
+#define RGB_HI(c) _mm256_extracti128_si256(c, 1)
+
+__attribute__ ((__target__ ("avx2")))
+static void RGBPackAVX2(uint8_t *dst, const uint16_t *py, const uint16_t *pu,
+                        const uint16_t *pv, unsigned n,
+                        const struct conv_matrix *m)
+{
+    const __m256i y_offset = _mm256_set1_epi16(m->y_offset);
+    const __m256i zero_c = _mm256_set1_epi16(RGB_CHROMA_ZERO);
+    const __m256i cy_crv = _mm256_set1_epi32((uint16_t)m->cy
+                                             | ((uint32_t)m->crv << 16));
+    const __m256i cy_cbu = _mm256_set1_epi32((uint16_t)m->cy
+                                             | ((uint32_t)m->cbu << 16));
+    const __m256i cy_cgu = _mm256_set1_epi32((uint16_t)m->cy
+                                             | ((uint32_t)m->cgu << 16));
+    const __m256i cgv = _mm256_set1_epi32((uint16_t)m->cgv);
+    const __m256i round = _mm256_set1_epi32(RGB_ROUND);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi16(255);
+    const __m256i alpha = _mm256_set1_epi32(0xffu << (8 * m->a));
+    const __m128i rcount = _mm_cvtsi32_si128(8 * m->r);
+    const __m128i gcount = _mm_cvtsi32_si128(8 * m->g);
+    const __m128i bcount = _mm_cvtsi32_si128(8 * m->b);
+    unsigned x = 0;
+
+    for (; x + 16 <= n; x += 16)
+    {
+        __m256i y = _mm256_loadu_si256((const __m256i *)(py + x));
+        __m256i u = _mm256_loadu_si256((const __m256i *)(pu + x));
+        __m256i v = _mm256_loadu_si256((const __m256i *)(pv + x));
+
+        y = _mm256_sub_epi16(_mm256_srli_epi16(y, 2), y_offset);
+        u = _mm256_sub_epi16(_mm256_srli_epi16(u, 2), zero_c);
+        v = _mm256_sub_epi16(_mm256_srli_epi16(v, 2), zero_c);
+
+        /* Pairs of (Y, V) and (Y, U) multiplied by pairs of coefficients.
+         * The low and high unpacks are packed back in the same order. */
+        __m256i yv_lo = _mm256_unpacklo_epi16(y, v);
+        __m256i yv_hi = _mm256_unpackhi_epi16(y, v);
+        __m256i yu_lo = _mm256_unpacklo_epi16(y, u);
+        __m256i yu_hi = _mm256_unpackhi_epi16(y, u);
+        __m256i v_lo = _mm256_unpacklo_epi16(v, zero);
+        __m256i v_hi = _mm256_unpackhi_epi16(v, zero);
+
+        __m256i r_lo = _mm256_add_epi32(_mm256_madd_epi16(yv_lo, cy_crv), round);
+        __m256i r_hi = _mm256_add_epi32(_mm256_madd_epi16(yv_hi, cy_crv), round);
+        __m256i b_lo = _mm256_add_epi32(_mm256_madd_epi16(yu_lo, cy_cbu), round);
+        __m256i b_hi = _mm256_add_epi32(_mm256_madd_epi16(yu_hi, cy_cbu), round);
+        __m256i g_lo = _mm256_add_epi32(_mm256_madd_epi16(yu_lo, cy_cgu),
+                                        _mm256_madd_epi16(v_lo, cgv));
+        __m256i g_hi = _mm256_add_epi32(_mm256_madd_epi16(yu_hi, cy_cgu),
+                                        _mm256_madd_epi16(v_hi, cgv));
+        g_lo = _mm256_add_epi32(g_lo, round);
+        g_hi = _mm256_add_epi32(g_hi, round);
+
+        __m256i r = _mm256_packs_epi32(_mm256_srai_epi32(r_lo, RGB_SHIFT),
+                                       _mm256_srai_epi32(r_hi, RGB_SHIFT));
+        __m256i g = _mm256_packs_epi32(_mm256_srai_epi32(g_lo, RGB_SHIFT),
+                                       _mm256_srai_epi32(g_hi, RGB_SHIFT));
+        __m256i b = _mm256_packs_epi32(_mm256_srai_epi32(b_lo, RGB_SHIFT),
+                                       _mm256_srai_epi32(b_hi, RGB_SHIFT));
+
+        r = _mm256_min_epi16(_mm256_max_epi16(r, zero), max);
+        g = _mm256_min_epi16(_mm256_max_epi16(g, zero), max);
+        b = _mm256_min_epi16(_mm256_max_epi16(b, zero), max);
+
+        __m256i p0 = _mm256_or_si256(
+            _mm256_or_si256(RGB_PLACE(r, RGB_LO, rcount),
+                            RGB_PLACE(g, RGB_LO, gcount)),
+            _mm256_or_si256(RGB_PLACE(b, RGB_LO, bcount), alpha));
+        __m256i p1 = _mm256_or_si256(
+            _mm256_or_si256(RGB_PLACE(r, RGB_HI, rcount),
+                            RGB_PLACE(g, RGB_HI, gcount)),
+            _mm256_or_si256(RGB_PLACE(b, RGB_HI, bcount), alpha));
+
+        _mm256_storeu_si256((__m256i *)(dst + 4 * x), p0);
+        _mm256_storeu_si256((__m256i *)(dst + 4 * x + 32), p1);
+    }
+    RGBPack(dst + 4 * x, py + x, pu + x, pv + x, n - x, m);
+}
+#endif
+
+/*****************************************************************************
+ * Engine
+ *****************************************************************************/
+struct conv_lines
+{
+    uint16_t *y;
+    uint16_t *u, *v; /* chroma at the source subsampling */
+    uint16_t *cu, *cv; /* chroma at the destination subsampling */
+};
+
+typedef struct
+{
+    const struct conv_format *src;
+    const struct conv_format *dst;
+    unsigned width;
+    unsigned height;
+    unsigned src_cwidth; /* source chroma line width */
+    unsigned dst_cwidth; /* destination chroma line width */
+    unsigned dst_rshift, dst_lshift; /* 16 bits to destination sample */
+    unsigned align; /* slice alignment in lines */
+
+    plane_unpack_cb plane_unpack;
+    uv_unpack_cb uv_unpack;
+    plane_pack_cb plane_pack;
+    uv_pack_cb uv_pack;
+    packed_unpack_cb packed_unpack;
+    packed_pack_cb packed_pack;
+    rgb_pack_cb rgb_pack;
+    struct conv_matrix matrix;
+
+    unsigned slices;
+    uint16_t *buffer;
+    struct conv_lines lines[];
+} filter_sys_t;
+
+struct conv_job
+{
+    const filter_sys_t *sys;
+    const picture_t *src;
+    picture_t *dst;
+};
+
+static const uint8_t *SrcLine(const picture_t *pic, int plane, unsigned y)
+{
+    return pic->p[plane].p_pixels + y * pic->p[plane].i_pitch;
+}
+
+static uint8_t *DstLine(picture_t *pic, int plane, unsigned y)
+{
+    return pic->p[plane].p_pixels + y * pic->p[plane].i_pitch;
+}
+
+static void UnpackLuma(const filter_sys_t *sys, const picture_t *pic,
+                       unsigned y, const struct conv_lines *l)
+{
+    sys->plane_unpack(l->y, SrcLine(pic, 0, y), sys->width, sys->src->shift);
+}
+
+static void UnpackChroma(const filter_sys_t *sys, const picture_t *pic,
+                         unsigned cy, const struct conv_lines *l)
+{
+    const struct conv_format *fmt = sys->src;
+    uint16_t *u = fmt->swap ? l->v : l->u;
+    uint16_t *v = fmt->swap ? l->u : l->v;
+
+    switch (fmt->layout)
+    {
+        case CONV_PLANAR:
+            sys->plane_unpack(u, SrcLine(pic, 1, cy), sys->src_cwidth,
+                              fmt->shift);
+            sys->plane_unpack(v, SrcLine(pic, 2, cy), sys->src_cwidth,
+                              fmt->shift);
+            break;
+        case CONV_SEMIPLANAR:
+            sys->uv_unpack(u, v, SrcLine(pic, 1, cy), sys->src_cwidth,
+                           fmt->shift);
+            break;
+        default:
+            vlc_assert_unreachable();
+    }
+}
+
+/* Resamples the chroma line to the destination horizontal subsampling. */
+static void ResampleChroma(const filter_sys_t *sys, const struct conv_lines *l)
+{
+    const unsigned n = sys->dst_cwidth;
+
+    if (sys->src->hsub > sys->dst->hsub)
+    {
+        const unsigned s = sys->src->hsub - sys->dst->hsub;
+
+        for (unsigned x = 0; x < n; x++)
+        {
+            l->cu[x] = l->u[x >> s];
+            l->cv[x] = l->v[x >> s];
+        }
+    }
+    else if (sys->src->hsub < sys->dst->hsub)
+    {
+        const unsigned s = sys->dst->hsub - sys->src->hsub;
+
+        for (unsigned x = 0; x < n; x++)
+        {
+            l->cu[x] = l->u[x << s];
+            l->cv[x] = l->v[x << s];
+        }
+    }
+}
+
+static void ConvertSlice(void *opaque, unsigned slice, unsigned count)
+{
+    const struct conv_job *job = opaque;
+    const filter_sys_t *sys = job->sys;
+    const struct conv_format *src = sys->src;
+    const struct conv_format *dst = sys->dst;
+    const struct conv_lines *l = &sys->lines[slice];
+    const bool resample = src->hsub != dst->hsub && src->layout != CONV_GREY;
+    const uint16_t *cu = resample ? l->cu : l->u;
+    const uint16_t *cv = resample ? l->cv : l->v;
+    unsigned first, end;
+    unsigned last = UINT_MAX; /* last unpacked source chroma line */
+
+    vlc_slice_Lines(slice, count, sys->height, sys->align, &first, &end);
+
+    for (unsigned y = first; y < end; y++)
+    {
+        /* Whether this line carries a destination chroma line */
+        const bool chroma = dst->layout != CONV_GREY
+                         && (y & ((1u << dst->vsub) - 1)) == 0;
+
+        if (src->layout == CONV_PACKED)
+            sys->packed_unpack(l->y, src->swap ? l->v : l->u,
+                               src->swap ? l->u : l->v,
+                               SrcLine(job->src, 0, y), sys->width,
+                               src->luma_odd);
+        else
+        {
+            UnpackLuma(sys, job->src, y, l);
+            if (chroma && src->layout != CONV_GREY
+             && (y >> src->vsub) != last)
+            {
+                last = y >> src->vsub;
+                UnpackChroma(sys, job->src, last, l);
+            }
+        }
+        if (chroma && resample)
+            ResampleChroma(sys, l);
+
+        switch (dst->layout)
+        {
+            case CONV_GREY:
+                sys->plane_pack(DstLine(job->dst, 0, y), l->y, sys->width,
+                                sys->dst_rshift, sys->dst_lshift);
+                break;
+            case CONV_PLANAR:
+                sys->plane_pack(DstLine(job->dst, 0, y), l->y, sys->width,
+                                sys->dst_rshift, sys->dst_lshift);
+                if (chroma)
+                {
+                    const unsigned cy = y >> dst->vsub;
+
+                    sys->plane_pack(DstLine(job->dst, dst->swap ? 2 : 1, cy),
+                                    cu, sys->dst_cwidth,
+                                    sys->dst_rshift, sys->dst_lshift);
+                    sys->plane_pack(DstLine(job->dst, dst->swap ? 1 : 2, cy),
+                                    cv, sys->dst_cwidth,
+                                    sys->dst_rshift, sys->dst_lshift);
+                }
+                break;
+            case CONV_SEMIPLANAR:
+                sys->plane_pack(DstLine(job->dst, 0, y), l->y, sys->width,
+                                sys->dst_rshift, sys->dst_lshift);
+                if (chroma)
+                    sys->uv_pack(DstLine(job->dst, 1, y >> dst->vsub),
+                                 dst->swap ? cv : cu, dst->swap ? cu : cv,
+                                 sys->dst_cwidth,
+                                 sys->dst_rshift, sys->dst_lshift);
+                break;
+            case CONV_PACKED:
+                sys->packed_pack(DstLine(job->dst, 0, y), l->y,
+                                 dst->swap ? cv : cu, dst->swap ? cu : cv,
+                                 sys->width, dst->luma_odd);
+                break;
+            case CONV_RGB:
+                sys->rgb_pack(DstLine(job->dst, 0, y), l->y, cu, cv,
+                              sys->width, &sys->matrix);
+                break;
+        }
+    }
+}
+
+static picture_t *Filter(filter_t *filter, picture_t *src)
+{
+    filter_sys_t *sys = filter->p_sys;
+    picture_t *dst = filter_NewPicture(filter);
+
+    if (dst != NULL)
+    {
+        struct conv_job job = { sys, src, dst };
+
+        vlc_slices_Run(filter, sys->slices, ConvertSlice, &job);
+        picture_CopyProperties(dst, src);
+    }
+    picture_Release(src);
+    return dst;
+}
+
+static void SetupKernels(filter_sys_t *sys, bool avx2)
+{
+    const bool wide_src = sys->src->size == 2;
+    const bool wide_dst = sys->dst->size == 2;
+
+    sys->plane_unpack = wide_src ? PlaneUnpack16 : PlaneUnpack8;
+    sys->uv_unpack = wide_src ? UVUnpack16 : UVUnpack8;
+    sys->plane_pack = wide_dst ? PlanePack16 : PlanePack8;
+    sys->uv_pack = wide_dst ? UVPack16 : UVPack8;
+    sys->packed_unpack = PackedUnpack;
+    sys->packed_pack = PackedPack;
+    sys->rgb_pack = RGBPack;
+
+#ifdef HAVE_AVX2_INTRINSICS
+    if (avx2)
+    {
+        sys->plane_unpack = wide_src ? PlaneUnpack16AVX2 : PlaneUnpack8AVX2;
+        sys->uv_unpack = wide_src ? UVUnpack16AVX2 : UVUnpack8AVX2;
+        sys->plane_pack = wide_dst ? PlanePack16AVX2 : PlanePack8AVX2;
+        sys->uv_pack = wide_dst ? UVPack16AVX2 : UVPack8AVX2;
+        sys->packed_unpack = PackedUnpackAVX2;
+        sys->packed_pack = PackedPackAVX2;
+        sys->rgb_pack = RGBPackAVX2;
+    }
+#else
+    VLC_UNUSED(avx2);
+#endif
+}
+
+static int OpenCommon(vlc_object_t *obj, bool avx2)
+{
+    filter_t *filter = (filter_t *)obj;
+    const video_format_t *in = &filter->fmt_in.video;
+    const video_format_t *out = &filter->fmt_out.video;
+    const struct conv_format *src = FindFormat(in->i_chroma);
+    const struct conv_format *dst = FindFormat(out->i_chroma);
+
+    if (src == NULL || dst == NULL || src == dst || src->layout == CONV_RGB)
+        return VLC_EGENERIC;
+
+    if (in->i_width != out->i_width || in->i_height != out->i_height
+     || in->orientation != out->orientation)
+        return VLC_EGENERIC;
+
+    /* Subsampled formats need an even number of luma samples. */
+    const unsigned hsub = __MAX(src->hsub, dst->hsub);
+    const unsigned vsub = __MAX(src->vsub, dst->vsub);
+
+    if ((in->i_width & ((1u << hsub) - 1))
+     || (in->i_height & ((1u << vsub) - 1)) || in->i_width == 0)
+        return VLC_EGENERIC;
+
+    struct conv_matrix matrix = { 0 };
+
+    if (dst->layout == CONV_RGB)
+    {
+        video_color_space_t space = in->space;
+
+        if (space == COLOR_SPACE_UNDEF)
+            space = (in->i_visible_height > 576) ? COLOR_SPACE_BT709
+                                                 : COLOR_SPACE_BT601;
+        SetupMatrix(&matrix, space, IsFullRange(src, in));
+        if (SetupRGB(&matrix, out))
+            return VLC_EGENERIC;
+    }
+    else if (IsFullRange(src, in) != IsFullRange(dst, out))
+        return VLC_EGENERIC; /* YUV samples are copied without scaling */
+
+    unsigned slices = vlc_slices_Count(filter, in->i_height >> vsub);
+    filter_sys_t *sys = malloc(sizeof (*sys) + slices * sizeof (sys->lines[0]));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->src = src;
+    sys->dst = dst;
+    sys->width = in->i_width;
+    sys->height = in->i_height;
+    sys->src_cwidth = in->i_width >> src->hsub;
+    sys->dst_cwidth = in->i_width >> dst->hsub;
+    sys->dst_rshift = 16 - FormatBits(dst);
+    sys->dst_lshift = 16 - FormatBits(dst) - dst->shift;
+    sys->align = 1u << vsub;
+    sys->matrix = matrix;
+    sys->slices = slices;
+    SetupKernels(sys, avx2);
+
+    /* One luma line and two pairs of chroma lines per slice */
+    const size_t stride = (in->i_width + 31) & ~31u;
+
+    sys->buffer = vlc_alloc(slices * 5, stride * sizeof (uint16_t));
+    if (unlikely(sys->buffer == NULL))
+    {
+        free(sys);
+        return VLC_ENOMEM;
+    }
+
+    for (unsigned i = 0; i < slices; i++)
+    {
+        struct conv_lines *l = &sys->lines[i];
+        uint16_t *buf = sys->buffer + 5 * i * stride;
+
+        l->y = buf;
+        l->u = buf + stride;
+        l->v = buf + 2 * stride;
+        l->cu = buf + 3 * stride;
+        l->cv = buf + 4 * stride;
+
+        if (src->layout == CONV_GREY)
+        {   /* Neutral chroma, set once and for all */
+            for (size_t x = 0; x < stride; x++)
+                l->u[x] = l->v[x] = 0x8000;
+        }
+    }
+
+    filter->p_sys = sys;
+    filter->pf_video_filter = Filter;
+    msg_Dbg(filter, "converting %4.4s to %4.4s with %u slice(s)%s",
+            (const char *)&in->i_chroma, (const char *)&out->i_chroma,
+            slices, avx2 ? " (AVX2)" : "");
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    return OpenCommon(obj, false);
+}
+
+#ifdef HAVE_AVX2_INTRINSICS
+static int OpenAVX2(vlc_object_t *obj)
+{
+    if (!vlc_CPU_AVX2())
+        return VLC_EGENERIC;
+    return OpenCommon(obj, true);
+}
+#endif
+
+static void Close(vlc_object_t *obj)
+{
+    filter_t *filter = (filter_t *)obj;
+    filter_sys_t *sys = filter->p_sys;
+
+    free(sys->buffer);
+    free(sys);
+}
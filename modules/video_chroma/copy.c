@@ -901,6 +901,268 @@ void Copy420_P_to_P(picture_t *dst, const uint8_t *src[static 3],
                src[2], src_pitch[2], (height+1) / 2, 0);
 }
 
+/* Smallest band height, in luma lines, worth handing over to a thread */
+#define COPY_BAND_MIN_LINES 32
+/* Copies are bound by the memory bandwidth: more threads do not help. */
+#define COPY_MAX_THREADS 4
+
+struct copy_worker
+{
+    copy_engine_t *engine;
+    vlc_thread_t thread;
+    copy_cache_t cache;
+};
+
+struct copy_engine
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* signaled when a copy is started or on exit */
+    vlc_cond_t done; /* signaled when the last band is copied */
+
+    /* Current copy */
+    copy_conv_cb conv;
+    copy_conv16_cb conv16;
+    picture_t *dst;
+    const uint8_t *src[3];
+    size_t src_pitch[3];
+    unsigned src_planes;
+    unsigned height;
+    int bitshift;
+
+    unsigned next; /* next band to copy */
+    unsigned count; /* number of bands */
+    unsigned pending; /* number of bands not copied yet */
+    bool closing;
+
+    copy_cache_t cache; /* bounce buffer of the waiting thread */
+    unsigned threadc;
+    struct copy_worker workers[];
+};
+
+/* Copies a band of luma lines (and the corresponding chroma lines). This
+ * relies on the conversion functions only using the plane pointers and
+ * pitches of the destination picture. */
+static void CopyEngineBand(const copy_engine_t *engine, unsigned band,
+                           const copy_cache_t *cache)
+{
+    const unsigned height = engine->height;
+    /* Even band boundaries, so that chroma lines are not split */
+    const unsigned y0 = (height * band / engine->count) & ~1u;
+    const unsigned y1 = (band + 1 == engine->count)
+                      ? height : (height * (band + 1) / engine->count) & ~1u;
+    const uint8_t *src[3] = { NULL, NULL, NULL };
+    picture_t dst;
+
+    if (y0 >= y1)
+        return;
+
+    dst.i_planes = engine->dst->i_planes;
+    for (int n = 0; n < engine->dst->i_planes; n++)
+    {
+        dst.p[n] = engine->dst->p[n];
+        dst.p[n].p_pixels += (n > 0 ? y0 / 2 : y0) * dst.p[n].i_pitch;
+    }
+    for (unsigned n = 0; n < engine->src_planes; n++)
+        src[n] = engine->src[n] + (n > 0 ? y0 / 2 : y0) * engine->src_pitch[n];
+
+    if (engine->conv16 != NULL)
+        engine->conv16(&dst, src, engine->src_pitch, y1 - y0,
+                       engine->bitshift, cache);
+    else
+        engine->conv(&dst, src, engine->src_pitch, y1 - y0, cache);
+}
+
+/* Copies the next band. The lock is released while copying. */
+static void CopyEngineProcess(copy_engine_t *engine, const copy_cache_t *cache)
+{
+    unsigned band = engine->next++;
+
+    vlc_mutex_unlock(&engine->lock);
+    CopyEngineBand(engine, band, cache);
+    vlc_mutex_lock(&engine->lock);
+
+    assert(engine->pending > 0);
+    if (--engine->pending == 0)
+        vlc_cond_signal(&engine->done);
+}
+
+static void *CopyEngineThread(void *data)
+{
+    struct copy_worker *worker = data;
+    copy_engine_t *engine = worker->engine;
+
+    vlc_mutex_lock(&engine->lock);
+    for (;;)
+    {
+        if (engine->next < engine->count)
+            CopyEngineProcess(engine, &worker->cache);
+        else if (!engine->closing)
+            vlc_cond_wait(&engine->wait, &engine->lock);
+        else
+            break;
+    }
+    vlc_mutex_unlock(&engine->lock);
+    return NULL;
+}
+
+copy_engine_t *CopyEngineNew(unsigned threads, unsigned width)
+{
+    /* The waiting thread copies bands too. */
+    if (threads == 0)
+        threads = __MIN(vlc_GetCPUCount(), COPY_MAX_THREADS) - 1;
+
+    copy_engine_t *engine = malloc(sizeof (*engine)
+                                   + threads * sizeof (engine->workers[0]));
+    if (unlikely(engine == NULL))
+        return NULL;
+
+    if (CopyInitCache(&engine->cache, width))
+    {
+        free(engine);
+        return NULL;
+    }
+
+    vlc_mutex_init(&engine->lock);
+    vlc_cond_init(&engine->wait);
+    vlc_cond_init(&engine->done);
+    engine->next = engine->count = engine->pending = 0;
+    engine->closing = false;
+    engine->threadc = 0;
+
+    while (engine->threadc < threads)
+    {
+        struct copy_worker *worker = &engine->workers[engine->threadc];
+
+        worker->engine = engine;
+        if (CopyInitCache(&worker->cache, width))
+            break;
+        if (vlc_clone(&worker->thread, CopyEngineThread, worker,
+                      VLC_THREAD_PRIORITY_VIDEO))
+        {
+            CopyCleanCache(&worker->cache);
+            break;
+        }
+        engine->threadc++;
+    }
+    return engine;
+}
+
+void CopyEngineDelete(copy_engine_t *engine)
+{
+    CopyEngineWait(engine);
+
+    vlc_mutex_lock(&engine->lock);
+    engine->closing = true;
+    vlc_cond_broadcast(&engine->wait);
+    vlc_mutex_unlock(&engine->lock);
+
+    for (unsigned i = 0; i < engine->threadc; i++)
+    {
+        vlc_join(engine->workers[i].thread, NULL);
+        CopyCleanCache(&engine->workers[i].cache);
+    }
+    CopyCleanCache(&engine->cache);
+    free(engine);
+}
+
+static void CopyEngineRun(copy_engine_t *engine, picture_t *dst,
+                          const uint8_t *src[], const size_t src_pitch[],
+                          unsigned height)
+{
+    unsigned count = __MIN(2 * (engine->threadc + 1),
+                           height / COPY_BAND_MIN_LINES);
+
+    if (count == 0)
+        count = 1;
+
+    engine->dst = dst;
+    for (unsigned n = 0; n < engine->src_planes; n++)
+    {
+        engine->src[n] = src[n];
+        engine->src_pitch[n] = src_pitch[n];
+    }
+    engine->height = height;
+    engine->next = 0;
+    engine->count = engine->pending = count;
+    vlc_cond_broadcast(&engine->wait);
+    vlc_mutex_unlock(&engine->lock);
+}
+
+void CopyEngineStart(copy_engine_t *engine, copy_conv_cb conv,
+                     picture_t *dst, const uint8_t *src[],
+                     const size_t src_pitch[], unsigned src_planes,
+                     unsigned height)
+{
+    assert(src_planes >= 1 && src_planes <= ARRAY_SIZE(engine->src));
+
+    CopyEngineWait(engine);
+
+    vlc_mutex_lock(&engine->lock);
+    engine->conv = conv;
+    engine->conv16 = NULL;
+    engine->bitshift = 0;
+    engine->src_planes = src_planes;
+    CopyEngineRun(engine, dst, src, src_pitch, height);
+}
+
+void CopyEngineStart16(copy_engine_t *engine, copy_conv16_cb conv,
+                       picture_t *dst, const uint8_t *src[],
+                       const size_t src_pitch[], unsigned src_planes,
+                       unsigned height, int bitshift)
+{
+    assert(src_planes >= 1 && src_planes <= ARRAY_SIZE(engine->src));
+
+    CopyEngineWait(engine);
+
+    vlc_mutex_lock(&engine->lock);
+    engine->conv = NULL;
+    engine->conv16 = conv;
+    engine->bitshift = bitshift;
+    engine->src_planes = src_planes;
+    CopyEngineRun(engine, dst, src, src_pitch, height);
+}
+
+void CopyEngineWait(copy_engine_t *engine)
+{
+    vlc_mutex_lock(&engine->lock);
+    while (engine->next < engine->count)
+        CopyEngineProcess(engine, &engine->cache);
+    while (engine->pending > 0)
+        vlc_cond_wait(&engine->done, &engine->lock);
+    engine->count = engine->next = 0;
+    vlc_mutex_unlock(&engine->lock);
+}
+
+void CopyEngineCopy(copy_engine_t *engine, copy_conv_cb conv,
+                    picture_t *dst, const uint8_t *src[],
+                    const size_t src_pitch[], unsigned src_planes,
+                    unsigned height, const copy_cache_t *cache)
+{
+    if (engine == NULL)
+    {
+        conv(dst, src, src_pitch, height, cache);
+        return;
+    }
+    CopyEngineStart(engine, conv, dst, src, src_pitch, src_planes, height);
+    CopyEngineWait(engine);
+}
+
+void CopyEngineCopy16(copy_engine_t *engine, copy_conv16_cb conv,
+                      picture_t *dst, const uint8_t *src[],
+                      const size_t src_pitch[], unsigned src_planes,
+                      unsigned height, int bitshift,
+                      const copy_cache_t *cache)
+{
+    if (engine == NULL)
+    {
+        conv(dst, src, src_pitch, height, bitshift, cache);
+        return;
+    }
+    CopyEngineStart16(engine, conv, dst, src, src_pitch, src_planes, height,
+                      bitshift);
+    CopyEngineWait(engine);
+}
+
 int picture_UpdatePlanes(picture_t *picture, uint8_t *data, unsigned pitch)
 {
     /* fill in buffer info in first plane */
@@ -1118,6 +1380,9 @@ int main(void)
     }
 #endif
 
+    copy_engine_t *engine = CopyEngineNew(3, 2 * sizes[NB_SIZES - 1].i_width);
+    assert(engine != NULL);
+
     for (size_t i = 0; i < NB_CONVS; ++i)
     {
         const struct test_conv *conv = &convs[i];
@@ -1177,11 +1442,28 @@ int main(void)
                                    &cache);
                 piccheck(dst, dst_dsc, false);
                 picture_Release(dst);
+
+                /* Same conversion with the multi-threaded engine */
+                dst = picture_NewFromFormat(&fmt);
+                assert(dst);
+                if (test_dst->bitshift == 0)
+                    CopyEngineStart(engine, test_dst->conv, dst, src_planes,
+                                    src_pitches, src->i_planes,
+                                    src->format.i_visible_height);
+                else
+                    CopyEngineStart16(engine, test_dst->conv16, dst,
+                                      src_planes, src_pitches, src->i_planes,
+                                      src->format.i_visible_height,
+                                      test_dst->bitshift);
+                CopyEngineWait(engine);
+                piccheck(dst, dst_dsc, false);
+                picture_Release(dst);
             }
             picture_Release(src);
             CopyCleanCache(&cache);
         }
     }
+    CopyEngineDelete(engine);
     return 0;
 }
 
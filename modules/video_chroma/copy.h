@@ -74,6 +74,59 @@ void Copy420_16_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
                         const size_t src_pitch[static 2], unsigned height,
                         int bitshift, const copy_cache_t *cache);
 
+/* Multi-threaded copies
+ *
+ * A copy engine splits each copy in horizontal bands, and copies them from a
+ * set of worker threads, each with its own bounce buffer. The workers start
+ * copying from CopyEngineStart(), and CopyEngineWait() copies the remaining
+ * bands from the calling thread, then waits for the workers. The copy does
+ * not outlive the call to CopyEngineWait(): it is parallel, not
+ * asynchronous.
+ *
+ * Only one copy can be in progress at a time per engine. */
+typedef struct copy_engine copy_engine_t;
+
+typedef void (*copy_conv_cb)(picture_t *, const uint8_t *[],
+                             const size_t [], unsigned,
+                             const copy_cache_t *);
+typedef void (*copy_conv16_cb)(picture_t *, const uint8_t *[],
+                               const size_t [], unsigned, int,
+                               const copy_cache_t *);
+
+/* Creates a copy engine with a number of worker threads. If threads is zero,
+ * one less than the number of CPUs is used.
+ * Returns NULL on error. */
+copy_engine_t *CopyEngineNew(unsigned threads, unsigned width);
+void CopyEngineDelete(copy_engine_t *engine);
+
+/* Starts a copy with one of the Copy420_* functions above, from src_planes
+ * source planes. The source planes and the destination picture must remain
+ * valid until CopyEngineWait(). */
+void CopyEngineStart(copy_engine_t *engine, copy_conv_cb conv,
+                     picture_t *dst, const uint8_t *src[],
+                     const size_t src_pitch[], unsigned src_planes,
+                     unsigned height);
+/* Starts a copy with one of the Copy420_16_* functions above. */
+void CopyEngineStart16(copy_engine_t *engine, copy_conv16_cb conv,
+                       picture_t *dst, const uint8_t *src[],
+                       const size_t src_pitch[], unsigned src_planes,
+                       unsigned height, int bitshift);
+/* Waits for the completion of the started copy, if any. */
+void CopyEngineWait(copy_engine_t *engine);
+
+/* Copies with one of the Copy420_* functions above, and waits for the copy.
+ * If engine is NULL, the calling thread copies alone, with the given cache. */
+void CopyEngineCopy(copy_engine_t *engine, copy_conv_cb conv,
+                    picture_t *dst, const uint8_t *src[],
+                    const size_t src_pitch[], unsigned src_planes,
+                    unsigned height, const copy_cache_t *cache);
+/* Copies with one of the Copy420_16_* functions above, and waits. */
+void CopyEngineCopy16(copy_engine_t *engine, copy_conv16_cb conv,
+                      picture_t *dst, const uint8_t *src[],
+                      const size_t src_pitch[], unsigned src_planes,
+                      unsigned height, int bitshift,
+                      const copy_cache_t *cache);
+
 /**
  * This functions sets the internal plane pointers/dimensions for the given
  * buffer.
@@ -37,6 +37,7 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slices.h>
 #include "filter_picture.h"
 
 #include "adjust_sat_hue.h"
@@ -240,6 +241,84 @@ static void Destroy( vlc_object_t *p_this )
                      &p_sys->b_brightness_threshold );
 }
 
+struct adjust_slice
+{
+    const picture_t *src;
+    picture_t *dst;
+    const int *lut;
+    bool b_16bit;
+};
+
+/*****************************************************************************
+ * Apply the luma lookup table to a horizontal band of a Planar YUV picture
+ *****************************************************************************/
+static void AdjustLumaSlice( void *opaque, unsigned slice, unsigned count )
+{
+    const struct adjust_slice *ctx = opaque;
+    const plane_t *p_in = &ctx->src->p[Y_PLANE];
+    plane_t *p_out = &ctx->dst->p[Y_PLANE];
+    const int *pi_luma = ctx->lut;
+    unsigned first, end;
+
+    vlc_slice_Lines( slice, count, p_in->i_visible_lines, 1, &first, &end );
+
+    for( unsigned y = first; y < end; y++ )
+    {
+        if( ctx->b_16bit )
+        {
+            const uint16_t *p_src, *p_line_end;
+            uint16_t *p_dst;
+            const int i_width = p_in->i_visible_pitch >> 1;
+
+            p_src = (const uint16_t *)&p_in->p_pixels[y * p_in->i_pitch];
+            p_dst = (uint16_t *)&p_out->p_pixels[y * p_out->i_pitch];
+            p_line_end = p_src + (i_width & ~7);
+
+            for( ; p_src < p_line_end ; )
+            {
+                /* Do 8 pixels at a time */
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+            }
+
+            p_line_end += i_width & 7;
+
+            for( ; p_src < p_line_end ; )
+            {
+                *p_dst++ = pi_luma[ *p_src++ ];
+            }
+        }
+        else
+        {
+            const uint8_t *p_src, *p_line_end;
+            uint8_t *p_dst;
+            const int i_width = p_in->i_visible_pitch;
+
+            p_src = &p_in->p_pixels[y * p_in->i_pitch];
+            p_dst = &p_out->p_pixels[y * p_out->i_pitch];
+            p_line_end = p_src + (i_width & ~7);
+
+            for( ; p_src < p_line_end ; )
+            {
+                /* Do 8 pixels at a time */
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+                *p_dst++ = pi_luma[ *p_src++ ]; *p_dst++ = pi_luma[ *p_src++ ];
+            }
+
+            p_line_end += i_width & 7;
+
+            for( ; p_src < p_line_end ; )
+            {
+                *p_dst++ = pi_luma[ *p_src++ ];
+            }
+        }
+    }
+}
+
 /*****************************************************************************
  * Run the filter on a Planar YUV picture
  *****************************************************************************/
@@ -335,78 +414,16 @@ static picture_t *FilterPlanar( filter_t *p_filter, picture_t *p_pic )
     /*
      * Do the Y plane
      */
-    if ( b_16bit )
-    {
-        uint16_t *p_in, *p_in_end, *p_line_end;
-        uint16_t *p_out;
-        p_in = (uint16_t *) p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-            * (p_pic->p[Y_PLANE].i_pitch >> 1) - 8;
-
-        p_out = (uint16_t *) p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + (p_pic->p[Y_PLANE].i_visible_pitch >> 1) - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += (p_pic->p[Y_PLANE].i_pitch >> 1)
-                - (p_pic->p[Y_PLANE].i_visible_pitch >> 1);
-            p_out += (p_outpic->p[Y_PLANE].i_pitch >> 1)
-                - (p_outpic->p[Y_PLANE].i_visible_pitch >> 1);
-        }
-    }
-    else
-    {
-        uint8_t *p_in, *p_in_end, *p_line_end;
-        uint8_t *p_out;
-        p_in = p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-                 * p_pic->p[Y_PLANE].i_pitch - 8;
-
-        p_out = p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += p_pic->p[Y_PLANE].i_pitch
-                  - p_pic->p[Y_PLANE].i_visible_pitch;
-            p_out += p_outpic->p[Y_PLANE].i_pitch
-                   - p_outpic->p[Y_PLANE].i_visible_pitch;
-        }
-    }
+    struct adjust_slice ctx = {
+        .src = p_pic,
+        .dst = p_outpic,
+        .lut = pi_luma,
+        .b_16bit = b_16bit,
+    };
+    vlc_slices_Run( p_filter,
+                    vlc_slices_Count( p_filter,
+                                      p_pic->p[Y_PLANE].i_visible_lines ),
+                    AdjustLumaSlice, &ctx );
 
     /*
      * Do the U and V planes
@@ -31,8 +31,13 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#ifdef HAVE_AVX2_INTRINSICS
+# include <immintrin.h>
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -637,11 +642,469 @@ static const struct {
 #undef YUV
 };
 
+} // namespace
+
+#ifdef HAVE_AVX2_INTRINSICS
+/*****************************************************************************
+ * AVX2 blending
+ *****************************************************************************
+ * Those use the same arithmetic as the generic code above, so the results
+ * are identical. Blocks of fully transparent source pixels are skipped.
+ *****************************************************************************/
+namespace {
+
+struct CBlendArea {
+    picture_t *dst;
+    unsigned dst_x, dst_y;
+    const picture_t *src;
+    const video_format_t *src_fmt;
+    unsigned src_x, src_y;
+    unsigned width, height;
+    unsigned alpha;
+};
+
+/* Source line, one array per component */
+struct CSourceLine {
+    const uint8_t *y, *u, *v, *a;
+};
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i div255x16(__m256i v)
+{
+    v = _mm256_add_epi16(_mm256_add_epi16(_mm256_srli_epi16(v, 8), v),
+                         _mm256_set1_epi16(1));
+    return _mm256_srli_epi16(v, 8);
+}
+
+/* Blends 16-bit lanes of 8-bit samples */
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i merge8x16(__m256i d, __m256i s, __m256i f)
+{
+    __m256i g = _mm256_sub_epi16(_mm256_set1_epi16(255), f);
+
+    return div255x16(_mm256_add_epi16(_mm256_mullo_epi16(d, g),
+                                      _mm256_mullo_epi16(s, f)));
+}
+
+/* Blends 16-bit lanes of samples of up to 10 bits, with 32-bit products */
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i merge10x16(__m256i d, __m256i s, __m256i f)
+{
+    const __m256i one = _mm256_set1_epi32(1);
+    __m256i g = _mm256_sub_epi16(_mm256_set1_epi16(255), f);
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(d, s),
+                                   _mm256_unpacklo_epi16(g, f));
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(d, s),
+                                   _mm256_unpackhi_epi16(g, f));
+
+    lo = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(
+                               _mm256_srli_epi32(lo, 8), lo), one), 8);
+    hi = _mm256_srli_epi32(_mm256_add_epi32(_mm256_add_epi32(
+                               _mm256_srli_epi32(hi, 8), hi), one), 8);
+
+    /* div255() is not exact above 8 bits: leave transparent pixels alone */
+    __m256i r = _mm256_packus_epi32(lo, hi);
+    return _mm256_blendv_epi8(r, d, _mm256_cmpeq_epi16(f, _mm256_setzero_si256()));
+}
+
+/* Scales 8-bit samples to 10 bits as convert8To10Bits does:
+ * x * 1023 / 255 = 4 * x + x / 85 */
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i bits10x16(__m256i s)
+{
+    return _mm256_add_epi16(_mm256_slli_epi16(s, 2),
+                            _mm256_mulhi_epu16(s, _mm256_set1_epi16(772)));
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i alphax16(__m256i a, unsigned alpha)
+{
+    return div255x16(_mm256_mullo_epi16(a, _mm256_set1_epi16(alpha)));
+}
+
+template <typename pixel>
+static inline unsigned scaleSample(unsigned v)
+{
+    return sizeof (pixel) > 1 ? v * 1023 / 255 : v;
+}
+
+/* Blends full resolution samples */
+template <typename pixel>
+__attribute__ ((__target__ ("avx2")))
+static void BlendLineFull(pixel *dst, const uint8_t *src,
+                               const uint8_t *a, unsigned n, unsigned alpha)
+{
+    unsigned x = 0;
+
+    if (sizeof (pixel) == 1) {
+        uint8_t *dst8 = reinterpret_cast<uint8_t *>(dst);
+        const __m256i zero = _mm256_setzero_si256();
+
+        for (; x + 32 <= n; x += 32) {
+            __m256i sa = _mm256_loadu_si256((const __m256i *)&a[x]);
+            if (_mm256_testz_si256(sa, sa))
+                continue;
+
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst8[x]);
+            __m256i s = _mm256_loadu_si256((const __m256i *)&src[x]);
+            __m256i lo = merge8x16(_mm256_unpacklo_epi8(d, zero),
+                                   _mm256_unpacklo_epi8(s, zero),
+                                   alphax16(_mm256_unpacklo_epi8(sa, zero),
+                                            alpha));
+            __m256i hi = merge8x16(_mm256_unpackhi_epi8(d, zero),
+                                   _mm256_unpackhi_epi8(s, zero),
+                                   alphax16(_mm256_unpackhi_epi8(sa, zero),
+                                            alpha));
+            _mm256_storeu_si256((__m256i *)&dst8[x],
+                                _mm256_packus_epi16(lo, hi));
+        }
+    } else {
+        for (; x + 16 <= n; x += 16) {
+            __m128i sa = _mm_loadu_si128((const __m128i *)&a[x]);
+            if (_mm_testz_si128(sa, sa))
+                continue;
+
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst[x]);
+            __m256i s = _mm256_cvtepu8_epi16(
+                            _mm_loadu_si128((const __m128i *)&src[x]));
+            __m256i f = alphax16(_mm256_cvtepu8_epi16(sa), alpha);
+            _mm256_storeu_si256((__m256i *)&dst[x],
+                                merge10x16(d, bits10x16(s), f));
+        }
+    }
+
+    for (; x < n; x++) {
+        unsigned f = div255(alpha * a[x]);
+        if (f > 0)
+            merge(&dst[x], scaleSample<pixel>(src[x]), f);
+    }
+}
+
+/* Blends horizontally subsampled samples, from every other source pixel */
+template <typename pixel>
+__attribute__ ((__target__ ("avx2")))
+static void BlendLineHalf(pixel *dst, const uint8_t *src,
+                               const uint8_t *a, unsigned n, unsigned alpha)
+{
+    const __m256i even = _mm256_set1_epi16(0xff);
+    unsigned x = 0;
+
+    /* The source may end right after its last even sample (2 * n - 1
+     * bytes), so the 32 bytes loads must stop one sample early. */
+    for (; x + 16 < n; x += 16) {
+        __m256i sa = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&a[2 * x]), even);
+        if (_mm256_testz_si256(sa, sa))
+            continue;
+
+        __m256i s = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&src[2 * x]), even);
+        __m256i f = alphax16(sa, alpha);
+
+        if (sizeof (pixel) == 1) {
+            uint8_t *dst8 = reinterpret_cast<uint8_t *>(&dst[x]);
+            __m256i d = _mm256_cvtepu8_epi16(
+                            _mm_loadu_si128((const __m128i *)dst8));
+            __m256i r = merge8x16(d, s, f);
+
+            r = _mm256_permute4x64_epi64(_mm256_packus_epi16(r, r), 0x08);
+            _mm_storeu_si128((__m128i *)dst8, _mm256_castsi256_si128(r));
+        } else {
+            __m256i d = _mm256_loadu_si256((const __m256i *)&dst[x]);
+            _mm256_storeu_si256((__m256i *)&dst[x],
+                                merge10x16(d, bits10x16(s), f));
+        }
+    }
+
+    for (; x < n; x++) {
+        unsigned f = div255(alpha * a[2 * x]);
+        if (f > 0)
+            merge(&dst[x], scaleSample<pixel>(src[2 * x]), f);
+    }
+}
+
+/* Blends interleaved chroma samples, from every other source pixel */
+__attribute__ ((__target__ ("avx2")))
+static void BlendLineUV(uint8_t *dst, const uint8_t *u, const uint8_t *v,
+                             const uint8_t *a, unsigned n, unsigned alpha)
+{
+    const __m256i even = _mm256_set1_epi16(0xff);
+    unsigned x = 0;
+
+    /* Same source bounds as BlendLineHalf() */
+    for (; x + 16 < n; x += 16) {
+        __m256i sa = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&a[2 * x]), even);
+        if (_mm256_testz_si256(sa, sa))
+            continue;
+
+        __m256i d = _mm256_loadu_si256((const __m256i *)&dst[2 * x]);
+        __m256i su = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&u[2 * x]), even);
+        __m256i sv = _mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)&v[2 * x]), even);
+        __m256i f = alphax16(sa, alpha);
+        __m256i ru = merge8x16(_mm256_and_si256(d, even), su, f);
+        __m256i rv = merge8x16(_mm256_srli_epi16(d, 8), sv, f);
+
+        _mm256_storeu_si256((__m256i *)&dst[2 * x],
+                            _mm256_or_si256(ru, _mm256_slli_epi16(rv, 8)));
+    }
+
+    for (; x < n; x++) {
+        unsigned f = div255(alpha * a[2 * x]);
+        if (f > 0) {
+            merge(&dst[2 * x], u[2 * x], f);
+            merge(&dst[2 * x + 1], v[2 * x], f);
+        }
+    }
+}
+
+/* Blends RGBA onto RGBA (or BGRA), as CPictureRGBX::merge() does */
+template <bool swap_rb>
+__attribute__ ((__target__ ("avx2")))
+static void BlendLineRGBA(uint8_t *dst, const uint8_t *src,
+                               unsigned n, unsigned alpha)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i opaque = _mm256_set1_epi32(0xff000000);
+    /* 16-bit lanes of the alpha channel */
+    const __m256i alane = _mm256_set1_epi64x(0xffff000000000000LL);
+    const __m256i swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7,
+                                          10, 9, 8, 11, 14, 13, 12, 15,
+                                          2, 1, 0, 3, 6, 5, 4, 7,
+                                          10, 9, 8, 11, 14, 13, 12, 15);
+    unsigned x = 0;
+
+    for (; x + 8 <= n; x += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)&src[4 * x]);
+        if (_mm256_testz_si256(s, opaque))
+            continue;
+        if (swap_rb)
+            s = _mm256_shuffle_epi8(s, swap);
+
+        __m256i d = _mm256_loadu_si256((const __m256i *)&dst[4 * x]);
+        __m256i r[2];
+
+        for (unsigned i = 0; i < 2; i++) {
+            __m256i d16 = i ? _mm256_unpackhi_epi8(d, zero)
+                            : _mm256_unpacklo_epi8(d, zero);
+            __m256i s16 = i ? _mm256_unpackhi_epi8(s, zero)
+                            : _mm256_unpacklo_epi8(s, zero);
+            __m256i sa = _mm256_shufflehi_epi16(
+                            _mm256_shufflelo_epi16(s16, 0xff), 0xff);
+            __m256i da = _mm256_shufflehi_epi16(
+                            _mm256_shufflelo_epi16(d16, 0xff), 0xff);
+            __m256i f = alphax16(sa, alpha);
+
+            /* The colour is first blended with the existing one according
+             * to the existing alpha, then with the new one. The alpha
+             * channel is only blended with full opacity. */
+            s16 = _mm256_blendv_epi8(s16, _mm256_set1_epi16(255), alane);
+            da = _mm256_andnot_si256(alane,
+                                     _mm256_sub_epi16(_mm256_set1_epi16(255),
+                                                      da));
+            __m256i c = merge8x16(merge8x16(d16, s16, da), s16, f);
+
+            r[i] = _mm256_blendv_epi8(c, d16, _mm256_cmpeq_epi16(f, zero));
+        }
+        _mm256_storeu_si256((__m256i *)&dst[4 * x],
+                            _mm256_packus_epi16(r[0], r[1]));
+    }
+
+    const unsigned offset_r = swap_rb ? 2 : 0;
+    const unsigned offset_b = swap_rb ? 0 : 2;
+
+    for (; x < n; x++) {
+        const uint8_t *sp = &src[4 * x];
+        uint8_t *dp = &dst[4 * x];
+        unsigned f = div255(alpha * sp[3]);
+
+        if (f == 0)
+            continue;
+        ::merge(&dp[offset_r], sp[0], 255 - dp[3]);
+        ::merge(&dp[1], sp[1], 255 - dp[3]);
+        ::merge(&dp[offset_b], sp[2], 255 - dp[3]);
+        ::merge(&dp[offset_r], sp[0], f);
+        ::merge(&dp[1], sp[1], f);
+        ::merge(&dp[offset_b], sp[2], f);
+        ::merge(&dp[3], 255, f);
+    }
+}
+
+/* Gets a line of YUVA or YUVP source, or false if it is fully transparent.
+ * YUVP lines are expanded with the palette as packed YUVA entries. */
+__attribute__ ((__target__ ("avx2")))
+static bool GetSourceLine(const CBlendArea &area, const uint32_t *palette,
+                          unsigned y, CSourceLine *line, uint8_t *buf)
+{
+    const picture_t *src = area.src;
+    const unsigned sy = area.src_y + y;
+
+    if (palette == NULL) {
+        line->y = &src->p[Y_PLANE].p_pixels[sy * src->p[Y_PLANE].i_pitch + area.src_x];
+        line->u = &src->p[U_PLANE].p_pixels[sy * src->p[U_PLANE].i_pitch + area.src_x];
+        line->v = &src->p[V_PLANE].p_pixels[sy * src->p[V_PLANE].i_pitch + area.src_x];
+        line->a = &src->p[A_PLANE].p_pixels[sy * src->p[A_PLANE].i_pitch + area.src_x];
+        return true;
+    }
+
+    const uint8_t *index = &src->p[0].p_pixels[sy * src->p[0].i_pitch + area.src_x];
+    uint8_t *py = buf, *pu = py + area.width, *pv = pu + area.width;
+    uint8_t *pa = pv + area.width;
+    /* Groups the bytes of 4 entries by component */
+    const __m256i split = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13,
+                                           2, 6, 10, 14, 3, 7, 11, 15,
+                                           0, 4, 8, 12, 1, 5, 9, 13,
+                                           2, 6, 10, 14, 3, 7, 11, 15);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    __m256i any = _mm256_setzero_si256();
+    unsigned x = 0;
+
+    for (; x + 8 <= area.width; x += 8) {
+        __m256i i = _mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64((const __m128i *)&index[x]));
+        __m256i e = _mm256_i32gather_epi32((const int *)palette, i, 4);
+
+        any = _mm256_or_si256(any, e);
+        e = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(e, split), order);
+        _mm_storel_epi64((__m128i *)&py[x], _mm256_castsi256_si128(e));
+        _mm_storeh_pd((double *)&pu[x],
+                      _mm_castsi128_pd(_mm256_castsi256_si128(e)));
+        e = _mm256_permute4x64_epi64(e, 0xEE);
+        _mm_storel_epi64((__m128i *)&pv[x], _mm256_castsi256_si128(e));
+        _mm_storeh_pd((double *)&pa[x],
+                      _mm_castsi128_pd(_mm256_castsi256_si128(e)));
+    }
+
+    uint32_t opaque = !_mm256_testz_si256(any,
+                                          _mm256_set1_epi32(0xff000000));
+
+    for (; x < area.width; x++) {
+        uint32_t entry = palette[index[x]];
+
+        py[x] = entry;
+        pu[x] = entry >> 8;
+        pv[x] = entry >> 16;
+        pa[x] = entry >> 24;
+        opaque |= entry >> 24;
+    }
+
+    line->y = py;
+    line->u = pu;
+    line->v = pv;
+    line->a = pa;
+    return opaque != 0;
+}
+
+template <typename pixel, bool semiplanar, bool swap_uv>
+__attribute__ ((__target__ ("avx2")))
+static void BlendYUV420(const CBlendArea &area, uint8_t *buf)
+{
+    picture_t *dst = area.dst;
+    const unsigned u_plane = swap_uv ? V_PLANE : U_PLANE;
+    const unsigned v_plane = swap_uv ? U_PLANE : V_PLANE;
+    /* First source pixel on an even destination column */
+    const unsigned x0 = area.dst_x & 1;
+    const unsigned cx = (area.dst_x + x0) / 2;
+    const unsigned cn = (area.width > x0) ? (area.width - x0 + 1) / 2 : 0;
+    uint32_t palette[256];
+
+    if (area.src_fmt->i_chroma == VLC_CODEC_YUVP) {
+        const video_palette_t *p = area.src_fmt->p_palette;
+
+        for (unsigned i = 0; i < 256; i++)
+            palette[i] = p->palette[i][0] | (p->palette[i][1] << 8)
+                       | (p->palette[i][2] << 16)
+                       | ((uint32_t)p->palette[i][3] << 24);
+    }
+
+    for (unsigned y = 0; y < area.height; y++) {
+        const unsigned dy = area.dst_y + y;
+        CSourceLine line;
+
+        if (!GetSourceLine(area, area.src_fmt->i_chroma == VLC_CODEC_YUVP
+                                 ? palette : NULL, y, &line, buf))
+            continue;
+
+        pixel *luma = reinterpret_cast<pixel *>(
+            &dst->p[Y_PLANE].p_pixels[dy * dst->p[Y_PLANE].i_pitch]);
+        BlendLineFull(&luma[area.dst_x], line.y, line.a, area.width,
+                      area.alpha);
+
+        if ((dy % 2) != 0 || cn == 0)
+            continue;
+
+        if (semiplanar) {
+            uint8_t *uv = &dst->p[1].p_pixels[dy / 2 * dst->p[1].i_pitch];
+            BlendLineUV(&uv[2 * cx], (swap_uv ? line.v : line.u) + x0,
+                        (swap_uv ? line.u : line.v) + x0, line.a + x0, cn,
+                        area.alpha);
+        } else {
+            pixel *u = reinterpret_cast<pixel *>(
+                &dst->p[u_plane].p_pixels[dy / 2 * dst->p[u_plane].i_pitch]);
+            pixel *v = reinterpret_cast<pixel *>(
+                &dst->p[v_plane].p_pixels[dy / 2 * dst->p[v_plane].i_pitch]);
+            BlendLineHalf(&u[cx], line.u + x0, line.a + x0, cn, area.alpha);
+            BlendLineHalf(&v[cx], line.v + x0, line.a + x0, cn, area.alpha);
+        }
+    }
+}
+
+template <bool swap_rb>
+__attribute__ ((__target__ ("avx2")))
+static void BlendRGBA(const CBlendArea &area, uint8_t *)
+{
+    const plane_t *d = &area.dst->p[0];
+    const plane_t *s = &area.src->p[0];
+
+    for (unsigned y = 0; y < area.height; y++)
+        BlendLineRGBA<swap_rb>(
+            &d->p_pixels[(area.dst_y + y) * d->i_pitch + 4 * area.dst_x],
+            &s->p_pixels[(area.src_y + y) * s->i_pitch + 4 * area.src_x],
+            area.width, area.alpha);
+}
+
+typedef void (*blend_fast_function_t)(const CBlendArea &, uint8_t *);
+
+static const struct {
+    vlc_fourcc_t          dst;
+    vlc_fourcc_t          src;
+    blend_fast_function_t blend;
+} blends_avx2[] = {
+#define YUV(csp, pixel, semiplanar, swap_uv) \
+    { csp, VLC_CODEC_YUVA, BlendYUV420<pixel, semiplanar, swap_uv> }, \
+    { csp, VLC_CODEC_YUVP, BlendYUV420<pixel, semiplanar, swap_uv> }
+
+    YUV(VLC_CODEC_I420,     uint8_t,  false, false),
+    YUV(VLC_CODEC_J420,     uint8_t,  false, false),
+    YUV(VLC_CODEC_YV12,     uint8_t,  false, true),
+    YUV(VLC_CODEC_NV12,     uint8_t,  true,  false),
+    YUV(VLC_CODEC_NV21,     uint8_t,  true,  true),
+#ifndef WORDS_BIGENDIAN
+    YUV(VLC_CODEC_I420_10L, uint16_t, false, false),
+#endif
+    { VLC_CODEC_RGBA, VLC_CODEC_RGBA, BlendRGBA<false> },
+    { VLC_CODEC_BGRA, VLC_CODEC_RGBA, BlendRGBA<true> },
+#undef YUV
+};
+
+} // namespace
+#endif
+
+namespace {
+
 struct filter_sys_t {
     filter_sys_t() : blend(NULL)
+#ifdef HAVE_AVX2_INTRINSICS
+                   , blend_avx2(NULL)
+#endif
     {
     }
     blend_function_t blend;
+#ifdef HAVE_AVX2_INTRINSICS
+    blend_fast_function_t blend_avx2;
+#endif
 };
 
 } // namespace
@@ -671,6 +1134,29 @@ static void Blend(filter_t *filter,
     video_format_FixRgb(&filter->fmt_out.video);
     video_format_FixRgb(&filter->fmt_in.video);
 
+#ifdef HAVE_AVX2_INTRINSICS
+    if (sys->blend_avx2 != NULL) {
+        const CBlendArea area = {
+            dst,
+            filter->fmt_out.video.i_x_offset + x_offset,
+            filter->fmt_out.video.i_y_offset + y_offset,
+            src, &filter->fmt_in.video,
+            filter->fmt_in.video.i_x_offset,
+            filter->fmt_in.video.i_y_offset,
+            (unsigned)width, (unsigned)height, (unsigned)alpha,
+        };
+        /* Room to expand a line of palettized source, with padding for
+         * the vector loads */
+        uint8_t *buf = (uint8_t *)malloc(4 * width + 32);
+
+        if (likely(buf != NULL)) {
+            sys->blend_avx2(area, buf);
+            free(buf);
+            return;
+        }
+    }
+#endif
+
     sys->blend(CPicture(dst, &filter->fmt_out.video,
                         filter->fmt_out.video.i_x_offset + x_offset,
                         filter->fmt_out.video.i_y_offset + y_offset),
@@ -692,6 +1178,15 @@ static int Open(vlc_object_t *object)
             sys->blend = blends[i].blend;
     }
 
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2()) {
+        for (size_t i = 0; i < ARRAY_SIZE(blends_avx2); i++) {
+            if (blends_avx2[i].src == src && blends_avx2[i].dst == dst)
+                sys->blend_avx2 = blends_avx2[i].blend;
+        }
+    }
+#endif
+
     if (!sys->blend) {
        msg_Err(filter, "no matching alpha blending routine (chroma: %4.4s -> %4.4s)",
                (char *)&src, (char *)&dst);
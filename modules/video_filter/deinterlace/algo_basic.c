@@ -32,6 +32,7 @@
 #include <vlc_common.h>
 #include <vlc_picture.h>
 #include <vlc_filter.h>
+#include <vlc_slices.h>
 
 #include "merge.h"
 #include "deinterlace.h" /* definition of p_sys, needed for Merge() */
@@ -129,58 +130,62 @@ int RenderBob( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic,
  * RenderLinear: BOB with linear interpolation
  *****************************************************************************/
 
-int RenderLinear( filter_t *p_filter,
-                  picture_t *p_outpic, picture_t *p_pic, int order, int i_field )
+struct basic_slice
 {
-    VLC_UNUSED(order);
-    int i_plane;
+    filter_t *p_filter;
+    picture_t *p_outpic;
+    const picture_t *p_pic;
+    int i_field;
+};
 
-    filter_sys_t *p_sys = p_filter->p_sys;
+static void LinearSlice( void *opaque, unsigned slice, unsigned count )
+{
+    const struct basic_slice *ctx = opaque;
+    filter_sys_t *p_sys = ctx->p_filter->p_sys;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    for( int i_plane = 0 ; i_plane < ctx->p_pic->i_planes ; i_plane++ )
     {
-        uint8_t *p_in, *p_out_end, *p_out;
-
-        p_in = p_pic->p[i_plane].p_pixels;
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
-
-        /* For BOTTOM field we need to add the first line */
-        if( i_field == 1 )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-            p_in += p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-        }
-
-        p_out_end -= 2 * p_outpic->p[i_plane].i_pitch;
-
-        for( ; p_out < p_out_end ; )
-        {
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-
-            p_out += p_outpic->p[i_plane].i_pitch;
-
-            Merge( p_out, p_in, p_in + 2 * p_pic->p[i_plane].i_pitch,
-                   p_pic->p[i_plane].i_pitch );
-
-            p_in += 2 * p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-        }
+        const plane_t *p_in = &ctx->p_pic->p[i_plane];
+        plane_t *p_out = &ctx->p_outpic->p[i_plane];
+        const unsigned i_lines = p_out->i_visible_lines;
+        const size_t i_bytes = p_out->i_visible_pitch;
+        unsigned first, end;
 
-        memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
+        vlc_slice_Lines( slice, count, i_lines, 1, &first, &end );
 
-        /* For TOP field we need to add the last line */
-        if( i_field == 0 )
+        for( unsigned y = first; y < end; y++ )
         {
-            p_in += p_pic->p[i_plane].i_pitch;
-            p_out += p_outpic->p[i_plane].i_pitch;
-            memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
+            uint8_t *p_dst = &p_out->p_pixels[y * p_out->i_pitch];
+            const uint8_t *p_src = &p_in->p_pixels[y * p_in->i_pitch];
+
+            /* Lines of the rendered field, and the outer lines, are copied.
+             * The other lines are interpolated from their neighbours. */
+            if( (int)(y % 2) == ctx->i_field || y == 0 || y + 1 >= i_lines )
+                memcpy( p_dst, p_src, i_bytes );
+            else
+                Merge( p_dst, p_src - p_in->i_pitch, p_src + p_in->i_pitch,
+                       i_bytes );
         }
     }
     EndMerge();
+}
+
+int RenderLinear( filter_t *p_filter,
+                  picture_t *p_outpic, picture_t *p_pic, int order, int i_field )
+{
+    VLC_UNUSED(order);
+
+    struct basic_slice ctx = {
+        .p_filter = p_filter,
+        .p_outpic = p_outpic,
+        .p_pic = p_pic,
+        .i_field = i_field,
+    };
+
+    vlc_slices_Run( p_filter,
+                    vlc_slices_Count( p_filter,
+                                      p_outpic->p[0].i_visible_lines ),
+                    LinearSlice, &ctx );
     return VLC_SUCCESS;
 }
 
@@ -223,37 +228,47 @@ int RenderMean( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
  * RenderBlend: Full-resolution blender
  *****************************************************************************/
 
-int RenderBlend( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+static void BlendSlice( void *opaque, unsigned slice, unsigned count )
 {
-    int i_plane;
-
-    filter_sys_t *p_sys = p_filter->p_sys;
+    const struct basic_slice *ctx = opaque;
+    filter_sys_t *p_sys = ctx->p_filter->p_sys;
 
-    /* Copy image and skip lines */
-    for( i_plane = 0 ; i_plane < p_pic->i_planes ; i_plane++ )
+    for( int i_plane = 0 ; i_plane < ctx->p_pic->i_planes ; i_plane++ )
     {
-        uint8_t *p_in, *p_out_end, *p_out;
+        const plane_t *p_in = &ctx->p_pic->p[i_plane];
+        plane_t *p_out = &ctx->p_outpic->p[i_plane];
+        const size_t i_bytes = p_out->i_visible_pitch;
+        unsigned first, end;
 
-        p_in = p_pic->p[i_plane].p_pixels;
-
-        p_out = p_outpic->p[i_plane].p_pixels;
-        p_out_end = p_out + p_outpic->p[i_plane].i_pitch
-                             * p_outpic->p[i_plane].i_visible_lines;
-
-        /* First line: simple copy */
-        memcpy( p_out, p_in, p_pic->p[i_plane].i_pitch );
-        p_out += p_outpic->p[i_plane].i_pitch;
+        vlc_slice_Lines( slice, count, p_out->i_visible_lines, 1,
+                         &first, &end );
 
-        /* Remaining lines: mean value */
-        for( ; p_out < p_out_end ; )
+        for( unsigned y = first; y < end; y++ )
         {
-            Merge( p_out, p_in, p_in + p_pic->p[i_plane].i_pitch,
-                   p_pic->p[i_plane].i_pitch );
-
-            p_out += p_outpic->p[i_plane].i_pitch;
-            p_in  += p_pic->p[i_plane].i_pitch;
+            uint8_t *p_dst = &p_out->p_pixels[y * p_out->i_pitch];
+            const uint8_t *p_src = &p_in->p_pixels[y * p_in->i_pitch];
+
+            /* First line: simple copy; remaining lines: mean value */
+            if( y == 0 )
+                memcpy( p_dst, p_src, i_bytes );
+            else
+                Merge( p_dst, p_src - p_in->i_pitch, p_src, i_bytes );
         }
     }
     EndMerge();
+}
+
+int RenderBlend( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    struct basic_slice ctx = {
+        .p_filter = p_filter,
+        .p_outpic = p_outpic,
+        .p_pic = p_pic,
+    };
+
+    vlc_slices_Run( p_filter,
+                    vlc_slices_Count( p_filter,
+                                      p_outpic->p[0].i_visible_lines ),
+                    BlendSlice, &ctx );
     return VLC_SUCCESS;
 }
@@ -32,6 +32,7 @@
 #include <vlc_cpu.h>
 #include <vlc_picture.h>
 #include <vlc_filter.h>
+#include <vlc_slices.h>
 
 #include "deinterlace.h" /* filter_sys_t  */
 #include "common.h"      /* FFMIN3 et al. */
@@ -46,6 +47,78 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+struct yadif_slice
+{
+    picture_t *p_dst;
+    const picture_t *p_prev;
+    const picture_t *p_cur;
+    const picture_t *p_next;
+    int i_field;
+    int parity;
+    unsigned pixel_size;
+    void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
+                   int w, int prefs, int mrefs, int parity, int mode);
+};
+
+/* Filters a horizontal band of each plane. Each output line only depends on
+ * the input pictures, so bands are independent. */
+static void YadifSlice( void *opaque, unsigned slice, unsigned count )
+{
+    const struct yadif_slice *ctx = opaque;
+
+    for( int n = 0; n < ctx->p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &ctx->p_prev->p[n];
+        const plane_t *curp  = &ctx->p_cur->p[n];
+        const plane_t *nextp = &ctx->p_next->p[n];
+        plane_t *dstp        = &ctx->p_dst->p[n];
+        unsigned first, end;
+
+        vlc_slice_Lines( slice, count, dstp->i_visible_lines, 1,
+                         &first, &end );
+        if( first < 1 )
+            first = 1;
+        if( end > (unsigned)dstp->i_visible_lines - 1 )
+            end = dstp->i_visible_lines - 1;
+
+        for( int y = first; y < (int)end; y++ )
+        {
+            if( (y % 2) == ctx->i_field  ||  ctx->parity == 2 )
+            {
+                memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                            &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            }
+            else
+            {
+                int mode;
+                /* Spatial checks only when enough data */
+                mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+                assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+                ctx->filter( &dstp->p_pixels[y * dstp->i_pitch],
+                             &prevp->p_pixels[y * prevp->i_pitch],
+                             &curp->p_pixels[y * curp->i_pitch],
+                             &nextp->p_pixels[y * nextp->i_pitch],
+                             dstp->i_visible_pitch / ctx->pixel_size,
+                             y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                             y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                             ctx->parity,
+                             mode );
+            }
+
+            /* We duplicate the first and last lines */
+            if( y == 1 )
+                memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+            else if( y == dstp->i_visible_lines - 2 )
+                memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+        }
+    }
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -108,72 +181,51 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     /* Filter if we have all the pictures we need */
     if( p_prev && p_cur && p_next )
     {
-        /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
-
+        struct yadif_slice ctx = {
+            .p_dst = p_dst,
+            .p_prev = p_prev,
+            .p_cur = p_cur,
+            .p_next = p_next,
+            .i_field = i_field,
+            .parity = yadif_parity,
+            .pixel_size = p_sys->chroma->pixel_size,
+        };
+
+#if defined(HAVE_AVX2_INTRINSICS)
+        if( vlc_CPU_AVX2() )
+            ctx.filter = yadif_filter_line_avx2;
+        else
+#endif
 #if defined(HAVE_X86ASM)
         if( vlc_CPU_SSSE3() )
-            filter = vlcpriv_yadif_filter_line_ssse3;
+            ctx.filter = vlcpriv_yadif_filter_line_ssse3;
         else
         if( vlc_CPU_SSE2() )
-            filter = vlcpriv_yadif_filter_line_sse2;
+            ctx.filter = vlcpriv_yadif_filter_line_sse2;
         else
 #if defined(__i386__)
         if( vlc_CPU_MMXEXT() )
-            filter = vlcpriv_yadif_filter_line_mmxext;
+            ctx.filter = vlcpriv_yadif_filter_line_mmxext;
         else
 #endif
 #endif
-            filter = yadif_filter_line_c;
-
-        if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
+            ctx.filter = yadif_filter_line_c;
 
-        for( int n = 0; n < p_dst->i_planes; n++ )
+        if( ctx.pixel_size == 2 )
         {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
+#if defined(HAVE_AVX2_INTRINSICS)
+            if( vlc_CPU_AVX2() )
+                ctx.filter = yadif_filter_line_avx2_16bit;
+            else
+#endif
+                ctx.filter = yadif_filter_line_c_16bit;
         }
 
+        vlc_slices_Run( p_filter,
+                        vlc_slices_Count( p_filter,
+                                          p_dst->p[0].i_visible_lines ),
+                        YadifSlice, &ctx );
+
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
         return VLC_SUCCESS;
@@ -184,7 +236,10 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
                  as set by Open() or SetFilterMethod(). It is always 0. */
 
         /* FIXME not good as it does not use i_order/i_field */
-        RenderX( p_filter, p_dst, p_next );
+        if( p_sys->chroma->pixel_size == 1 )
+            RenderX( p_filter, p_dst, p_next );
+        else /* RenderX() only handles 8-bit pixels */
+            RenderLinear( p_filter, p_dst, p_next, 0, 0 );
         return VLC_SUCCESS;
     }
     else
@@ -93,6 +93,139 @@ static void yadif_filter_line_c_16bit(uint8_t *dst8, uint8_t *prev8, uint8_t *cu
     FILTER
 }
 
+#if defined(HAVE_AVX2_INTRINSICS)
+#include <immintrin.h>
+
+/* AVX2 versions of FILTER: 16 8-bit pixels are processed at a time as 16-bit
+ * lanes, or 8 16-bit pixels as 32-bit lanes, so that no intermediate value
+ * can overflow. The remaining pixels are left to the C code. */
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i yadif_load_avx2(const uint8_t *p)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)p));
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline void yadif_store_avx2(uint8_t *p, __m256i v)
+{
+    _mm_storeu_si128((__m128i *)p,
+                     _mm_packus_epi16(_mm256_castsi256_si128(v),
+                                      _mm256_extracti128_si256(v, 1)));
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i yadif_load_avx2_16bit(const uint16_t *p)
+{
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)p));
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline void yadif_store_avx2_16bit(uint16_t *p, __m256i v)
+{
+    _mm_storeu_si128((__m128i *)p,
+                     _mm_packus_epi32(_mm256_castsi256_si128(v),
+                                      _mm256_extracti128_si256(v, 1)));
+}
+
+#define ABSDIFF_AVX2(S, a, b) _mm256_abs_##S(_mm256_sub_##S(a, b))
+#define AVG_AVX2(S, a, b) _mm256_srai_##S(_mm256_add_##S(a, b), 1)
+
+#define SCORE_AVX2(S, L, j) \
+    _mm256_add_##S(_mm256_add_##S( \
+        ABSDIFF_AVX2(S, L(&cur[x+mrefs-1+(j)]), L(&cur[x+prefs-1-(j)])), \
+        ABSDIFF_AVX2(S, L(&cur[x+mrefs  +(j)]), L(&cur[x+prefs  -(j)]))), \
+        ABSDIFF_AVX2(S, L(&cur[x+mrefs+1+(j)]), L(&cur[x+prefs+1-(j)])))
+
+/* Same as CHECK(j), where the mask stands for the nested conditions. */
+#define CHECK_AVX2(S, L, j, mask) \
+    do { \
+        __m256i s = SCORE_AVX2(S, L, j); \
+        mask = _mm256_and_si256(mask, _mm256_cmpgt_##S(spatial_score, s)); \
+        spatial_score = _mm256_blendv_epi8(spatial_score, s, mask); \
+        spatial_pred = _mm256_blendv_epi8(spatial_pred, \
+            AVG_AVX2(S, L(&cur[x+mrefs+(j)]), L(&cur[x+prefs-(j)])), mask); \
+    } while (0)
+
+#define FILTER_AVX2(S, L, ST, N) \
+    for (; x + (N) <= w; x += (N)) { \
+        __m256i c = L(&cur[x+mrefs]); \
+        __m256i e = L(&cur[x+prefs]); \
+        __m256i p2 = L(&prev2[x]); \
+        __m256i n2 = L(&next2[x]); \
+        __m256i d = AVG_AVX2(S, p2, n2); \
+        __m256i temporal_diff0 = ABSDIFF_AVX2(S, p2, n2); \
+        __m256i temporal_diff1 = _mm256_srai_##S(_mm256_add_##S( \
+            ABSDIFF_AVX2(S, L(&prev[x+mrefs]), c), \
+            ABSDIFF_AVX2(S, L(&prev[x+prefs]), e)), 1); \
+        __m256i temporal_diff2 = _mm256_srai_##S(_mm256_add_##S( \
+            ABSDIFF_AVX2(S, L(&next[x+mrefs]), c), \
+            ABSDIFF_AVX2(S, L(&next[x+prefs]), e)), 1); \
+        __m256i diff = _mm256_max_##S(_mm256_max_##S( \
+            _mm256_srai_##S(temporal_diff0, 1), temporal_diff1), \
+            temporal_diff2); \
+        __m256i spatial_pred = AVG_AVX2(S, c, e); \
+        __m256i spatial_score = _mm256_sub_##S(_mm256_add_##S( \
+            _mm256_add_##S( \
+                ABSDIFF_AVX2(S, L(&cur[x+mrefs-1]), L(&cur[x+prefs-1])), \
+                ABSDIFF_AVX2(S, c, e)), \
+            ABSDIFF_AVX2(S, L(&cur[x+mrefs+1]), L(&cur[x+prefs+1]))), \
+            _mm256_set1_##S(1)); \
+        __m256i mask = _mm256_set1_##S(-1); \
+ \
+        CHECK_AVX2(S, L, -1, mask); CHECK_AVX2(S, L, -2, mask); \
+        mask = _mm256_set1_##S(-1); \
+        CHECK_AVX2(S, L,  1, mask); CHECK_AVX2(S, L,  2, mask); \
+ \
+        if (mode < 2) { \
+            __m256i b = AVG_AVX2(S, L(&prev2[x+2*mrefs]), L(&next2[x+2*mrefs])); \
+            __m256i f = AVG_AVX2(S, L(&prev2[x+2*prefs]), L(&next2[x+2*prefs])); \
+            __m256i de = _mm256_sub_##S(d, e); \
+            __m256i dc = _mm256_sub_##S(d, c); \
+            __m256i bc = _mm256_sub_##S(b, c); \
+            __m256i fe = _mm256_sub_##S(f, e); \
+            __m256i max = _mm256_max_##S(_mm256_max_##S(de, dc), \
+                                         _mm256_min_##S(bc, fe)); \
+            __m256i min = _mm256_min_##S(_mm256_min_##S(de, dc), \
+                                         _mm256_max_##S(bc, fe)); \
+ \
+            diff = _mm256_max_##S(_mm256_max_##S(diff, min), \
+                                  _mm256_sub_##S(_mm256_setzero_si256(), max)); \
+        } \
+ \
+        spatial_pred = _mm256_min_##S(spatial_pred, _mm256_add_##S(d, diff)); \
+        spatial_pred = _mm256_max_##S(spatial_pred, _mm256_sub_##S(d, diff)); \
+ \
+        ST(&dst[x], spatial_pred); \
+    }
+
+__attribute__ ((__target__ ("avx2")))
+static void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    int x = 0;
+    uint8_t *prev2= parity ? prev : cur ;
+    uint8_t *next2= parity ? cur  : next;
+    FILTER_AVX2(epi16, yadif_load_avx2, yadif_store_avx2, 16)
+    yadif_filter_line_c(dst + x, prev + x, cur + x, next + x, w - x, prefs, mrefs, parity, mode);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void yadif_filter_line_avx2_16bit(uint8_t *dst8, uint8_t *prev8, uint8_t *cur8, uint8_t *next8, int w, int prefs, int mrefs, int parity, int mode) {
+    uint16_t *dst = (uint16_t *)dst8;
+    uint16_t *prev = (uint16_t *)prev8;
+    uint16_t *cur = (uint16_t *)cur8;
+    uint16_t *next = (uint16_t *)next8;
+    int x = 0;
+    uint16_t *prev2= parity ? prev : cur ;
+    uint16_t *next2= parity ? cur  : next;
+    mrefs /= 2;
+    prefs /= 2;
+    FILTER_AVX2(epi32, yadif_load_avx2_16bit, yadif_store_avx2_16bit, 8)
+    yadif_filter_line_c_16bit((uint8_t *)(dst + x), (uint8_t *)(prev + x),
+                              (uint8_t *)(cur + x), (uint8_t *)(next + x),
+                              w - x, prefs * 2, mrefs * 2, parity, mode);
+}
+#endif
+
 #if defined(__i386__) || defined(__x86_64__)
 void vlcpriv_yadif_filter_line_ssse3(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode);
 void vlcpriv_yadif_filter_line_sse2(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode);
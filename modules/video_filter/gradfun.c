@@ -35,6 +35,7 @@
 #include <vlc_cpu.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slices.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -108,6 +109,8 @@ typedef struct
     int              radius;
     const vlc_chroma_description_t *chroma;
     struct vf_priv_s cfg;
+    size_t           buf_size; /* per band, in elements of cfg.buf */
+    unsigned         buf_count;
 } filter_sys_t;
 
 static int Open(vlc_object_t *object)
@@ -132,6 +135,7 @@ static int Open(vlc_object_t *object)
     var_AddCallback(filter, CFG_PREFIX "strength", Callback, NULL);
     var_AddCallback(filter, CFG_PREFIX "radius",   Callback, NULL);
     sys->cfg.buf = NULL;
+    sys->buf_count = 0;
 
     struct vf_priv_s *cfg = &sys->cfg;
     cfg->thresh      = 0.0;
@@ -172,6 +176,34 @@ static void Close(vlc_object_t *object)
     free(sys);
 }
 
+struct gradfun_slice
+{
+    struct vf_priv_s *cfg;
+    size_t           buf_size;
+    uint8_t         *dst;
+    uint8_t         *src;
+    int              w, h, dst_pitch, src_pitch, r;
+};
+
+/* Filters a horizontal band of a plane. Each band has its own blur buffer,
+ * and sums the lines above it again, so the result does not depend on the
+ * number of bands. */
+static void FilterSlice(void *opaque, unsigned slice, unsigned count)
+{
+    const struct gradfun_slice *ctx = opaque;
+    unsigned first, end;
+
+    /* Split the lines that start a blur window, the first band also
+     * filters the r lines above them, and the last band the r lines below */
+    vlc_slice_Lines(slice, count, ctx->h - 2 * ctx->r, 2, &first, &end);
+    first = slice > 0 ? ctx->r + first : 0;
+    end   = slice + 1 < count ? ctx->r + end : (unsigned)ctx->h;
+
+    filter_plane(ctx->cfg, ctx->cfg->buf + slice * ctx->buf_size,
+                 ctx->dst, ctx->src, ctx->w, ctx->h,
+                 ctx->dst_pitch, ctx->src_pitch, ctx->r, first, end);
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -189,12 +221,17 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
 
     const video_format_t *fmt = &filter->fmt_in.video;
     struct vf_priv_s *cfg = &sys->cfg;
+    const unsigned count = vlc_slices_Count(filter, fmt->i_height);
 
     cfg->thresh = (1 << 15) / strength;
-    if (cfg->radius != radius) {
+    if (cfg->radius != radius || sys->buf_count != count) {
         cfg->radius = radius;
+        /* Keep bands 16-byte aligned */
+        sys->buf_size = ((((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) + 7) & ~7;
+        sys->buf_count = count;
+        aligned_free(cfg->buf);
         cfg->buf    = aligned_alloc(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
+                                   count * sys->buf_size * sizeof(*cfg->buf));
     }
 
     for (int i = 0; i < dst->i_planes; i++) {
@@ -208,8 +245,21 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
                  cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
         r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
         if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
+            struct gradfun_slice ctx = {
+                .cfg = cfg,
+                .buf_size = sys->buf_size,
+                .dst = dstp->p_pixels,
+                .src = srcp->p_pixels,
+                .w = w,
+                .h = h,
+                .dst_pitch = dstp->i_pitch,
+                .src_pitch = srcp->i_pitch,
+                .r = r,
+            };
+            /* Bands of at least 4 radii, as each one blurs r lines again */
+            unsigned bands = __MAX((h - 2 * r) / (4 * r), 1);
+
+            vlc_slices_Run(filter, __MIN(count, bands), FilterSlice, &ctx);
         } else {
             plane_CopyPixels(dstp, srcp);
         }
@@ -32,6 +32,7 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slices.h>
 #include "filter_picture.h"
 
 
@@ -90,6 +91,7 @@ typedef struct
 {
     const vlc_chroma_description_t *chroma;
     int w[3], h[3];
+    int wmax;
 
     struct vf_priv_s cfg;
     bool   b_recalc_coefs;
@@ -137,7 +139,9 @@ static int Open(vlc_object_t *this)
         if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
     }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
+    /* One line per plane, as planes are denoised in parallel */
+    sys->wmax = wmax;
+    cfg->Line = malloc(3*wmax*sizeof(unsigned int));
     if (!cfg->Line) {
         free(sys);
         return VLC_ENOMEM;
@@ -189,6 +193,32 @@ static void Close(vlc_object_t *this)
 /*****************************************************************************
  * Filter
  *****************************************************************************/
+struct hqdn3d_slice
+{
+    filter_sys_t *sys;
+    picture_t *src;
+    picture_t *dst;
+};
+
+/* Denoises a plane. Each line depends on the filtered line above it, so a
+ * plane cannot be split in bands without changing the result. */
+static void DenoisePlane(void *opaque, unsigned slice, unsigned count)
+{
+    const struct hqdn3d_slice *ctx = opaque;
+    filter_sys_t *sys = ctx->sys;
+    struct vf_priv_s *cfg = &sys->cfg;
+    const int i = slice;
+    const int spat = i ? 2 : 0, temp = i ? 3 : 1;
+    VLC_UNUSED(count);
+
+    deNoise(ctx->src->p[i].p_pixels, ctx->dst->p[i].p_pixels,
+            cfg->Line + i * sys->wmax, &cfg->Frame[i], sys->w[i], sys->h[i],
+            ctx->src->p[i].i_pitch, ctx->dst->p[i].i_pitch,
+            cfg->Coefs[spat],
+            cfg->Coefs[spat],
+            cfg->Coefs[temp]);
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     picture_t *dst;
@@ -218,24 +248,8 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
+    struct hqdn3d_slice ctx = { .sys = sys, .src = src, .dst = dst };
+    vlc_slices_Run(filter, 3, DenoisePlane, &ctx);
 
     if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
     {
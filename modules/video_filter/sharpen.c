@@ -42,6 +42,7 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_slices.h>
 #include "filter_picture.h"
 
 #define SIG_TEXT N_("Sharpen strength (0-2)")
@@ -159,24 +160,31 @@ static void Destroy( vlc_object_t *p_this )
 #define IS_YUV_420_10BITS(fmt) (fmt == VLC_CODEC_I420_10L ||    \
                                 fmt == VLC_CODEC_I420_10B)
 
-#define SHARPEN_FRAME(maxval, data_t)                                   \
+#define SHARPEN_LINES(maxval, data_t)                                   \
     do                                                                  \
     {                                                                   \
         assert((maxval) >= 0);                                          \
-        data_t *restrict p_src = (data_t *)p_pic->p[Y_PLANE].p_pixels;  \
-        data_t *restrict p_out = (data_t *)p_outpic->p[Y_PLANE].p_pixels; \
+        const data_t *restrict p_src =                                  \
+            (const data_t *)ctx->src->p[Y_PLANE].p_pixels;              \
+        data_t *restrict p_out = (data_t *)ctx->dst->p[Y_PLANE].p_pixels; \
         const unsigned data_sz = sizeof(data_t);                        \
-        const int i_src_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
-        const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_sys->sigma);         \
+        const int i_src_line_len = ctx->src->p[Y_PLANE].i_pitch / data_sz; \
+        const int i_out_line_len = ctx->dst->p[Y_PLANE].i_pitch / data_sz; \
+        const unsigned i_width = i_visible_pitch / data_sz;             \
+        const int sigma = ctx->sigma;                                   \
                                                                         \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
-                                                                        \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = first; i < end; i++ )                         \
         {                                                               \
+            if( i == 0 || i == i_visible_lines - 1 )                    \
+            {                                                           \
+                memcpy(&p_out[i * i_out_line_len],                      \
+                       &p_src[i * i_src_line_len], i_visible_pitch);    \
+                continue;                                               \
+            }                                                           \
+                                                                        \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
-            for( unsigned j = data_sz; j < i_visible_pitch - 1; j++ )   \
+            for( unsigned j = 1; j < i_width - 1; j++ )                 \
             {                                                           \
                 const int line_idx_1 = (i - 1) * i_src_line_len;        \
                 const int line_idx_2 = i * i_src_line_len;              \
@@ -196,21 +204,39 @@ static void Destroy( vlc_object_t *p_this )
                 p_out[i * i_out_line_len + j] =                         \
                     VLC_CLIP( p_src[line_idx_2 + j] + pix, 0, maxval);  \
             }                                                           \
-            p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
-                p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
+            p_out[i * i_out_line_len + i_width - 1] =                   \
+                p_src[i * i_src_line_len + i_width - 1];                \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
     } while (0)
 
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+struct sharpen_slice
 {
-    picture_t *p_outpic;
+    const picture_t *src;
+    picture_t *dst;
+    int sigma;
+};
+
+/* Sharpens a horizontal band of the luma plane */
+static void SharpenSlice( void *opaque, unsigned slice, unsigned count )
+{
+    const struct sharpen_slice *ctx = opaque;
     const int v1 = -1;
     const int v2 = 3; /* 2^3 = 8 */
-    const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
-    const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
+    const unsigned i_visible_lines = ctx->src->p[Y_PLANE].i_visible_lines;
+    const unsigned i_visible_pitch = ctx->src->p[Y_PLANE].i_visible_pitch;
+    unsigned first, end;
+
+    vlc_slice_Lines( slice, count, i_visible_lines, 1, &first, &end );
+
+    if (!IS_YUV_420_10BITS(ctx->src->format.i_chroma))
+        SHARPEN_LINES(255, uint8_t);
+    else
+        SHARPEN_LINES(1023, uint16_t);
+}
+
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    picture_t *p_outpic;
 
     p_outpic = filter_NewPicture( p_filter );
     if( !p_outpic )
@@ -220,11 +246,15 @@ static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
     }
 
     filter_sys_t *p_sys = p_filter->p_sys;
+    struct sharpen_slice ctx = {
+        .src = p_pic,
+        .dst = p_outpic,
+        .sigma = atomic_load(&p_sys->sigma),
+    };
+    const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
 
-    if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
-        SHARPEN_FRAME(255, uint8_t);
-    else
-        SHARPEN_FRAME(1023, uint16_t);
+    vlc_slices_Run( p_filter, vlc_slices_Count( p_filter, i_visible_lines ),
+                    SharpenSlice, &ctx );
 
     plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
     plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
@@ -66,6 +66,15 @@ int config_LoadCmdLine( vlc_object_t *p_this, int i_argc,
     const module_config_t *pp_shortopts[256];
     char *psz_shortopts;
 
+    /* Without any option, do not load every configuration item only to
+     * look for none. */
+    if( i_argc == 1 )
+    {
+        if( pindex != NULL )
+            *pindex = 1;
+        return 0;
+    }
+
     /*
      * Generate the longopts and shortopts structures used by getopt_long
      */
@@ -112,9 +121,13 @@ int config_LoadCmdLine( vlc_object_t *p_this, int i_argc,
 
     /* Fill the p_longopts and psz_shortopts structures */
     i_index = 0;
-    for (const vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
-        for (const module_config_t *p_item = p->conf.items,
+        const module_config_t *items = vlc_plugin_config(p);
+        if (items == NULL)
+            continue;
+
+        for (const module_config_t *p_item = items,
                                    *p_end = p_item + p->conf.size;
              p_item < p_end;
              p_item++)
@@ -55,6 +55,18 @@ extern bool config_dirty;
 
 bool config_IsSafe (const char *);
 
+/**
+ * Releases a string configuration value.
+ *
+ * String items share the storage of their default value until they are
+ * changed, so that loading the plugins cache does not copy every string.
+ */
+static inline void config_FreeString(const module_config_t *item, char *str)
+{
+    if (str != item->orig.psz)
+        free(str);
+}
+
 /**
  * Gets the arch-specific installation directory.
  *
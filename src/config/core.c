@@ -149,7 +149,7 @@ void config_PutPsz(const char *psz_name, const char *psz_value)
     config_dirty = true;
     vlc_rwlock_unlock (&config_lock);
 
-    free (oldstr);
+    config_FreeString(p_config, oldstr);
 }
 
 void config_PutInt(const char *psz_name, int64_t i_value )
@@ -382,28 +382,38 @@ error:
     return -1;
 }
 
+struct config_entry
+{
+    const char *name;
+    vlc_plugin_t *plugin;
+    size_t index; /**< Item index within the plugin */
+};
+
 static int confcmp (const void *a, const void *b)
 {
-    const module_config_t *const *ca = a, *const *cb = b;
+    const struct config_entry *ca = a, *cb = b;
 
-    return strcmp ((*ca)->psz_name, (*cb)->psz_name);
+    return strcmp (ca->name, cb->name);
 }
 
 static int confnamecmp (const void *key, const void *elem)
 {
-    const module_config_t *const *conf = elem;
+    const struct config_entry *conf = elem;
 
-    return strcmp (key, (*conf)->psz_name);
+    return strcmp (key, conf->name);
 }
 
 static struct
 {
-    module_config_t **list;
+    struct config_entry *list;
     size_t count;
 } config = { NULL, 0 };
 
 /**
  * Index the configuration items by name for faster lookups.
+ *
+ * Items of plugins from the plugins cache are indexed by their cached names,
+ * so that they are only loaded if they are looked up.
  */
 int config_SortConfig (void)
 {
@@ -411,24 +421,43 @@ int config_SortConfig (void)
     size_t nconf = 0;
 
     for (p = vlc_plugins; p != NULL; p = p->next)
-         nconf += p->conf.size;
+         nconf += p->conf.count;
 
-    module_config_t **clist = vlc_alloc (nconf, sizeof (*clist));
+    struct config_entry *clist = vlc_alloc (nconf, sizeof (*clist));
     if (unlikely(clist == NULL))
         return VLC_ENOMEM;
 
     nconf = 0;
     for (p = vlc_plugins; p != NULL; p = p->next)
     {
-        module_config_t *item, *end;
+        const module_config_t *items =
+            atomic_load_explicit(&p->conf.items, memory_order_acquire);
+
+#ifdef HAVE_DYNAMIC_PLUGINS
+        if (items == NULL && p->conf.names != NULL)
+        {
+            const char *name = p->conf.names;
+            size_t n = 0;
+
+            for (size_t i = 0; i < p->conf.size; i++)
+            {
+                if (name[0] != '\0' && n++ < p->conf.count)
+                    clist[nconf++] = (struct config_entry){ name, p, i };
+                name += strlen (name) + 1;
+            }
+            continue;
+        }
+#endif
+        if (items == NULL)
+            continue;
 
-        for (item = p->conf.items, end = item + p->conf.size;
-             item < end;
-             item++)
+        for (size_t i = 0; i < p->conf.size; i++)
         {
+            const module_config_t *item = items + i;
+
             if (!CONFIG_ITEM(item->i_type))
                 continue; /* ignore hints */
-            clist[nconf++] = item;
+            clist[nconf++] = (struct config_entry){ item->psz_name, p, i };
         }
     }
 
@@ -441,7 +470,7 @@ int config_SortConfig (void)
 
 void config_UnsortConfig (void)
 {
-    module_config_t **clist;
+    struct config_entry *clist;
 
     clist = config.list;
     config.list = NULL;
@@ -455,9 +484,13 @@ module_config_t *config_FindConfig(const char *name)
     if (unlikely(name == NULL))
         return NULL;
 
-    module_config_t *const *p;
+    const struct config_entry *p;
     p = bsearch (name, config.list, config.count, sizeof (*p), confnamecmp);
-    return p ? *p : NULL;
+    if (p == NULL)
+        return NULL;
+
+    module_config_t *items = vlc_plugin_config(p->plugin);
+    return (items != NULL) ? items + p->index : NULL;
 }
 
 /**
@@ -473,7 +506,7 @@ void config_Free (module_config_t *tab, size_t confsize)
 
         if (IsConfigStringType (p_item->i_type))
         {
-            free (p_item->value.psz);
+            config_FreeString(p_item, p_item->value.psz);
             if (p_item->list_count)
                 free (p_item->list.psz);
         }
@@ -489,9 +522,15 @@ void config_ResetAll(void)
     vlc_rwlock_wrlock (&config_lock);
     for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
+        /* Items not loaded yet still have their default values. */
+        module_config_t *items =
+            atomic_load_explicit(&p->conf.items, memory_order_acquire);
+        if (items == NULL)
+            continue;
+
         for (size_t i = 0; i < p->conf.size; i++ )
         {
-            module_config_t *p_config = p->conf.items + i;
+            module_config_t *p_config = items + i;
 
             if (IsConfigIntegerType (p_config->i_type))
                 p_config->value.i = p_config->orig.i;
@@ -501,9 +540,8 @@ void config_ResetAll(void)
             else
             if (IsConfigStringType (p_config->i_type))
             {
-                free ((char *)p_config->value.psz);
-                p_config->value.psz =
-                        strdupnull (p_config->orig.psz);
+                config_FreeString(p_config, p_config->value.psz);
+                p_config->value.psz = p_config->orig.psz;
             }
         }
     }
@@ -563,11 +563,15 @@ static bool module_match(const module_t *m, const char *pattern, bool strict)
     return false;
 }
 
-static bool plugin_show(const vlc_plugin_t *plugin)
+static bool plugin_show(vlc_plugin_t *plugin)
 {
+    const module_config_t *items = vlc_plugin_config(plugin);
+    if (items == NULL)
+        return false;
+
     for (size_t i = 0; i < plugin->conf.size; i++)
     {
-        const module_config_t *item = plugin->conf.items + i;
+        const module_config_t *item = items + i;
 
         if (!CONFIG_ITEM(item->i_type))
             continue;
@@ -597,7 +601,7 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
     const bool desc = var_InheritBool(p_this, "help-verbose");
 
     /* Enumerate the config for each module */
-    for (const vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
+    for (vlc_plugin_t *p = vlc_plugins; p != NULL; p = p->next)
     {
         const module_t *m = p->module;
         const module_config_t *section = NULL;
@@ -620,9 +624,10 @@ static void Usage (vlc_object_t *p_this, char const *psz_search)
                    module_gettext(m, m->psz_help));
 
         /* Print module options */
+        const module_config_t *items = vlc_plugin_config(p);
         for (size_t j = 0; j < p->conf.size; j++)
         {
-            const module_config_t *item = p->conf.items + j;
+            const module_config_t *item = items + j;
 
             if (item->b_removed)
                 continue; /* Skip removed options */
@@ -1868,6 +1868,9 @@ CreateDecoder( vlc_object_t *p_parent,
         vlc_object_delete(p_dec);
         return NULL;
     }
+    /* Blocks are queued from a single thread (see vlc_input_decoder_Decode),
+     * so they need not lock the decoder fifo. */
+    vlc_fifo_EnableLockless( p_owner->p_fifo );
 
     vlc_mutex_init( &p_owner->lock );
     vlc_mutex_init( &p_owner->mouse_lock );
@@ -1966,6 +1969,13 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
     decoder_Clean( p_dec );
     if ( p_owner->out_pool )
     {
+        struct picture_pool_stats stats;
+
+        picture_pool_GetStats( p_owner->out_pool, &stats );
+        msg_Dbg( p_dec, "picture pool: %u pictures, peak %u, %"PRIu64
+                 " requests, %"PRIu64" waits (%"PRId64" us)", stats.size,
+                 stats.peak, stats.gets, stats.waits,
+                 US_FROM_VLC_TICK(stats.wait_time) );
         picture_pool_Release( p_owner->out_pool );
         p_owner->out_pool = NULL;
     }
@@ -2214,6 +2224,16 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
 void vlc_input_decoder_Decode( vlc_input_decoder_t *p_owner, block_t *p_block,
                                bool b_do_pace )
 {
+    /* Fast path: queue without locking if no regulation is needed. The fifo
+     * counters can be read without locking in lock-less mode. */
+    if( b_do_pace ? ( p_owner->b_waiting
+                   || vlc_fifo_GetCount( p_owner->p_fifo ) < 10 )
+                  : vlc_fifo_GetBytes( p_owner->p_fifo ) <= 400*1024*1024 )
+    {
+        vlc_fifo_QueueLockless( p_owner->p_fifo, p_block );
+        return;
+    }
+
     vlc_fifo_Lock( p_owner->p_fifo );
     if( !b_do_pace )
     {
@@ -183,6 +183,9 @@ static int demux_Probe(void *func, bool forced, va_list ap)
     return ret;
 }
 
+/* Peeked size for demuxers magic numbers */
+#define DEMUX_HINT_PEEK 64
+
 demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
                             const char *psz_demux, const char *url,
                             stream_t *s, es_out_t *out, bool b_preparsing )
@@ -197,15 +200,13 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     assert(s != NULL);
     priv = vlc_stream_Private(p_demux);
 
-    if (!strcasecmp( psz_demux, "any" ) || !psz_demux[0])
-    {   /* Look up demux by mime-type for hard to detect formats */
-        char *type = stream_MimeType( s );
-        if( type != NULL )
-        {
-            psz_demux = demux_NameFromMimeType( type );
-            free( type );
-        }
-    }
+    struct vlc_module_hint hint = { NULL, NULL, NULL, 0 };
+    char *type = stream_MimeType( s );
+
+    if( type != NULL && (!strcasecmp( psz_demux, "any" ) || !psz_demux[0]) )
+        /* Look up demux by mime-type for hard to detect formats */
+        psz_demux = demux_NameFromMimeType( type );
+    hint.mime = type;
 
     p_demux->p_input_item = p_input ? input_GetItem(p_input) : NULL;
     p_demux->psz_name = strdup( psz_demux );
@@ -245,8 +246,23 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     if( psz_module == NULL )
         psz_module = p_demux->psz_name;
 
-    priv->module = vlc_module_load(p_demux, "demux", psz_module,
-        !strcmp(psz_module, p_demux->psz_name), demux_Probe, p_demux);
+    /* Skip the demuxers whose probing hints do not match. The extension is
+     * taken from the same string as demux_IsPathExtension(). */
+    const char *psz_name = (p_demux->psz_filepath != NULL)
+                           ? p_demux->psz_filepath : p_demux->psz_location;
+    const char *psz_ext = strrchr( psz_name, '.' );
+    if( psz_ext != NULL && strchr( psz_ext, '/' ) == NULL )
+        hint.extension = psz_ext + 1;
+
+    if( vlc_stream_Tell( s ) == 0 )
+    {
+        ssize_t i_peek = vlc_stream_Peek( s, &hint.peek, DEMUX_HINT_PEEK );
+        hint.peek_size = (i_peek > 0) ? i_peek : 0;
+    }
+
+    priv->module = vlc_module_load_hinted(p_demux, "demux", psz_module,
+        !strcmp(psz_module, p_demux->psz_name), &hint, demux_Probe, p_demux);
+    free( type );
 
     if (priv->module == NULL)
     {
@@ -256,6 +272,7 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
 
     return p_demux;
 error:
+    free( type );
     free( p_demux->psz_name );
     stream_CommonDelete( p_demux );
     return NULL;
@@ -401,6 +401,11 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define FILTER_THREADS_TEXT N_("Video filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads that slice-threaded video filters may use to " \
+    "process a picture (0 = number of CPU cores).")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -686,6 +691,16 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_FAST_SEEK_LONGTEXT N_( \
     "Favor speed over precision while seeking" )
 
+#define SEEK_INDEX_TEXT N_("Seek index cache")
+#define SEEK_INDEX_LONGTEXT N_( \
+    "Remember the time positions found while playing large local files, " \
+    "for fast and exact seeking in MPEG streams the next time they are " \
+    "played, and the fragments index of fragmented MP4 files. " \
+    "The indexes are kept in the user cache directory, in files named " \
+    "after a hash of the path of the played files, so they reveal which " \
+    "local files were played. The least recently written ones are " \
+    "removed beyond 256 files or 32 MiB." )
+
 #define INPUT_RATE_TEXT N_("Playback speed")
 #define INPUT_RATE_LONGTEXT N_( \
     "This defines the playback speed (nominal speed is 1.0)." )
@@ -1742,6 +1757,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer( "filter-threads", 0, FILTER_THREADS_TEXT,
+                 FILTER_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 64 )
 
 #if 0
     add_string( "pixel-ratio", "1", PIXEL_RATIO_TEXT, PIXEL_RATIO_TEXT )
@@ -1863,6 +1881,8 @@ vlc_module_begin ()
     add_bool( "input-fast-seek", false,
               INPUT_FAST_SEEK_TEXT, INPUT_FAST_SEEK_LONGTEXT, false )
         change_safe ()
+    add_bool( "demux-seek-index", true,
+              SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT, true )
     add_float( "rate", 1.,
                INPUT_RATE_TEXT, INPUT_RATE_LONGTEXT, false )
 
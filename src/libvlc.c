@@ -65,6 +65,7 @@
 #include <vlc_thumbnailer.h>
 
 #include "libvlc.h"
+#include "misc/picture.h"
 
 #include <vlc_vlm.h>
 
@@ -95,6 +96,7 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->slices = vlc_slices_New();
 
     vlc_ExitInit( &priv->exit );
 
@@ -152,6 +154,9 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         return VLC_EGENERIC;
     }
 
+    /* The recycled picture buffers are shared by all instances */
+    picture_CacheHold ();
+
     vlc_threads_setup (p_libvlc);
 
     /* Load the builtins and plugins into the module_bank.
@@ -387,6 +392,12 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    struct picture_cache_stats stats;
+    if( picture_CacheRelease( &stats ) )
+        msg_Dbg( p_libvlc, "picture buffers: %"PRIu64" reused, %"PRIu64
+                 " allocated, %"PRIu64" evicted", stats.hits, stats.misses,
+                 stats.evictions );
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
@@ -408,6 +419,10 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
  */
 void libvlc_InternalDestroy( libvlc_int_t *p_libvlc )
 {
+    libvlc_priv_t *priv = libvlc_priv (p_libvlc);
+
+    if (priv->slices != NULL)
+        vlc_slices_Delete(priv->slices);
     vlc_object_delete(p_libvlc);
 }
 
@@ -194,6 +194,7 @@ typedef struct libvlc_priv_t
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_thumbnailer_t *p_thumbnailer; ///< Lazily instantiated media thumbnailer
+    struct vlc_slices *slices; ///< Slice worker threads (or NULL)
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -204,6 +205,12 @@ static inline libvlc_priv_t *libvlc_priv (libvlc_int_t *libvlc)
     return container_of(libvlc, libvlc_priv_t, public_data);
 }
 
+/*
+ * Slice-parallel processing
+ */
+struct vlc_slices *vlc_slices_New(void);
+void vlc_slices_Delete(struct vlc_slices *);
+
 int intf_InsertItem(libvlc_int_t *, const char *mrl, unsigned optc,
                     const char * const *optv, unsigned flags);
 void intf_DestroyAll( libvlc_int_t * );
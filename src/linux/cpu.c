@@ -96,6 +96,8 @@ unsigned vlc_CPU_raw(void)
                 core_caps |= VLC_CPU_AVX;
             if (!strcmp (cap, "avx2"))
                 core_caps |= VLC_CPU_AVX2;
+            if (!strcmp (cap, "avx512bw")) /* implies avx512f */
+                core_caps |= VLC_CPU_AVX512;
             if (!strcmp (cap, "3dnow"))
                 core_caps |= VLC_CPU_3dNOW;
             if (!strcmp (cap, "xop"))
@@ -30,6 +30,9 @@
 #include <errno.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdlib.h>
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -105,6 +108,350 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+/*
+ * Block cache
+ *
+ * Blocks with a total allocation size up to BLOCK_CACHE_MAX_SHIFT bits are
+ * rounded up to the next quarter of a power of two (e.g. 80 kiB for a 65507
+ * bytes datagram) and recycled instead of returned to the heap.
+ * Each thread keeps a few free blocks per size class. The thread caches spill
+ * into, and refill from, a shared depot in batches, so that blocks allocated
+ * by one thread and released by another are still recycled.
+ *
+ * The cache can be disabled (e.g. to debug memory errors) by setting the
+ * VLC_BLOCK_CACHE environment variable to 0.
+ */
+#define BLOCK_CACHE_MIN_SHIFT 9  /* 512 bytes */
+#define BLOCK_CACHE_MAX_SHIFT 18 /* 256 kiB */
+/** Size classes per power of two (log2) */
+#define BLOCK_CACHE_STEP_SHIFT 2
+#define BLOCK_CACHE_CLASSES \
+    (((BLOCK_CACHE_MAX_SHIFT - BLOCK_CACHE_MIN_SHIFT) << BLOCK_CACHE_STEP_SHIFT) + 1)
+/** Upper bound for the bytes cached by each thread in a size class */
+#define BLOCK_CACHE_THREAD_BYTES (1 << 18)
+/** Upper bound for the number of blocks cached by a thread in a class */
+#define BLOCK_CACHE_THREAD_DEPTH 32
+/** Upper bound for the bytes cached in the shared depot */
+#define BLOCK_CACHE_DEPOT_BYTES (16 << 20)
+/** Number of thread-local allocation hits accounted at once */
+#define BLOCK_CACHE_HITS_BATCH 64
+
+struct block_cache
+{
+    block_t *head[BLOCK_CACHE_CLASSES];
+    unsigned count[BLOCK_CACHE_CLASSES];
+    unsigned hits;
+    bool registered;
+    bool dead;
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    block_t *head[BLOCK_CACHE_CLASSES];
+    unsigned count[BLOCK_CACHE_CLASSES];
+    size_t bytes;
+} block_depot = { .lock = VLC_STATIC_MUTEX };
+
+static struct
+{
+    atomic_uint_fast64_t hits;
+    atomic_uint_fast64_t misses;
+    atomic_uint_fast64_t oversized;
+} block_stats;
+
+static thread_local struct block_cache block_tcache;
+static vlc_threadvar_t block_cache_key;
+static vlc_once_t block_cache_once = VLC_STATIC_ONCE;
+static bool block_cache_enabled;
+
+/** Total allocation size of a size class */
+static size_t block_cache_Size(unsigned cls)
+{
+    const unsigned steps = 1u << BLOCK_CACHE_STEP_SHIFT;
+    const unsigned shift = (cls >> BLOCK_CACHE_STEP_SHIFT)
+                         + BLOCK_CACHE_MIN_SHIFT - BLOCK_CACHE_STEP_SHIFT;
+
+    return (size_t)(steps + (cls & (steps - 1))) << shift;
+}
+
+static unsigned block_cache_depth(unsigned cls)
+{
+    unsigned depth = BLOCK_CACHE_THREAD_BYTES / block_cache_Size(cls);
+
+    if (depth > BLOCK_CACHE_THREAD_DEPTH)
+        depth = BLOCK_CACHE_THREAD_DEPTH;
+    if (depth < 2)
+        depth = 2;
+    return depth;
+}
+
+static void block_cache_Free(block_t *list)
+{
+    while (list != NULL)
+    {
+        block_t *next = list->p_next;
+
+        free(list);
+        list = next;
+    }
+}
+
+/**
+ * Moves the last count blocks of a thread cache class to the shared depot,
+ * or to the heap if the depot is full.
+ */
+static void block_cache_Spill(struct block_cache *tc, unsigned cls,
+                              unsigned count)
+{
+    block_t *first = tc->head[cls], *last = first;
+    const size_t size = block_cache_Size(cls);
+
+    assert(count > 0 && count <= tc->count[cls]);
+
+    for (unsigned i = 1; i < tc->count[cls] - count; i++)
+        last = last->p_next;
+
+    if (count < tc->count[cls])
+    {
+        first = last->p_next;
+        last->p_next = NULL;
+    }
+    else
+        tc->head[cls] = NULL;
+    tc->count[cls] -= count;
+
+    last = first;
+    while (last->p_next != NULL)
+        last = last->p_next;
+
+    vlc_mutex_lock(&block_depot.lock);
+    if (block_depot.bytes + count * size <= BLOCK_CACHE_DEPOT_BYTES)
+    {
+        last->p_next = block_depot.head[cls];
+        block_depot.head[cls] = first;
+        block_depot.count[cls] += count;
+        block_depot.bytes += count * size;
+        first = NULL;
+    }
+    vlc_mutex_unlock(&block_depot.lock);
+
+    block_cache_Free(first);
+}
+
+/**
+ * Moves up to count blocks from the shared depot to a thread cache class.
+ */
+static void block_cache_Refill(struct block_cache *tc, unsigned cls,
+                               unsigned count)
+{
+    const size_t size = block_cache_Size(cls);
+
+    assert(tc->head[cls] == NULL);
+
+    vlc_mutex_lock(&block_depot.lock);
+    if (block_depot.count[cls] > 0)
+    {
+        block_t *first = block_depot.head[cls], *last = first;
+        unsigned n = 1;
+
+        while (n < count && last->p_next != NULL)
+        {
+            last = last->p_next;
+            n++;
+        }
+        block_depot.head[cls] = last->p_next;
+        block_depot.count[cls] -= n;
+        block_depot.bytes -= n * size;
+        last->p_next = NULL;
+        tc->head[cls] = first;
+        tc->count[cls] = n;
+    }
+    vlc_mutex_unlock(&block_depot.lock);
+}
+
+static void block_cache_FlushHits(struct block_cache *tc)
+{
+    atomic_fetch_add_explicit(&block_stats.hits, tc->hits,
+                              memory_order_relaxed);
+    tc->hits = 0;
+}
+
+/** Returns the cache of a thread when it exits. */
+static void block_cache_Destroy(void *data)
+{
+    struct block_cache *tc = data;
+
+    for (unsigned cls = 0; cls < BLOCK_CACHE_CLASSES; cls++)
+        if (tc->count[cls] > 0)
+            block_cache_Spill(tc, cls, tc->count[cls]);
+    block_cache_FlushHits(tc);
+    /* Blocks released later on (by other destructors) go to the heap. */
+    tc->dead = true;
+}
+
+/**
+ * Frees the cached blocks when the process exits or libvlccore is unloaded.
+ *
+ * Thread-specific destructors are not run for the main thread, so its cache
+ * is returned here too.
+ */
+__attribute__((destructor))
+static void block_cache_Exit(void)
+{
+    struct block_cache *tc = &block_tcache;
+
+    if (tc->registered && !tc->dead)
+        block_cache_Destroy(tc);
+
+    vlc_mutex_lock(&block_depot.lock);
+    for (unsigned cls = 0; cls < BLOCK_CACHE_CLASSES; cls++)
+    {
+        block_cache_Free(block_depot.head[cls]);
+        block_depot.head[cls] = NULL;
+        block_depot.count[cls] = 0;
+    }
+    block_depot.bytes = 0;
+    vlc_mutex_unlock(&block_depot.lock);
+}
+
+static void block_cache_Init(void)
+{
+    const char *env = getenv("VLC_BLOCK_CACHE");
+
+    if (env != NULL && atoi(env) == 0)
+        return;
+    if (vlc_threadvar_create(&block_cache_key, block_cache_Destroy))
+        return;
+    block_cache_enabled = true;
+}
+
+static struct block_cache *block_cache_Get(void)
+{
+    vlc_once(&block_cache_once, block_cache_Init);
+    if (!block_cache_enabled)
+        return NULL;
+
+    struct block_cache *tc = &block_tcache;
+
+    if (unlikely(tc->dead))
+        return NULL;
+    if (unlikely(!tc->registered))
+    {   /* Register the destructor for this thread */
+        if (vlc_threadvar_set(block_cache_key, tc))
+            return NULL;
+        tc->registered = true;
+    }
+    return tc;
+}
+
+/** Size class of a total allocation size, or -1 if not cacheable. */
+static int block_cache_Class(size_t alloc)
+{
+    if (alloc > ((size_t)1 << BLOCK_CACHE_MAX_SHIFT))
+        return -1;
+    if (alloc <= ((size_t)1 << BLOCK_CACHE_MIN_SHIFT))
+        return 0;
+
+    /* Power of two below, and step above it */
+    const unsigned shift = (sizeof (alloc) * CHAR_BIT) - 1 - clz(alloc - 1);
+    const unsigned step = (alloc - 1 - ((size_t)1 << shift))
+                          >> (shift - BLOCK_CACHE_STEP_SHIFT);
+
+    return ((shift - BLOCK_CACHE_MIN_SHIFT) << BLOCK_CACHE_STEP_SHIFT)
+           + step + 1;
+}
+
+static void block_cached_Release(block_t *block)
+{
+    assert(block->p_start == (unsigned char *)(block + 1));
+
+    const size_t alloc = sizeof (*block) + block->i_size;
+    const unsigned cls = block_cache_Class(alloc);
+    struct block_cache *tc = &block_tcache;
+
+    assert(alloc == block_cache_Size(cls));
+
+    if (unlikely(!tc->registered) || tc->dead)
+    {   /* First block operation in this thread */
+        tc = block_cache_Get();
+        if (tc == NULL)
+        {
+            free(block);
+            return;
+        }
+    }
+
+    const unsigned depth = block_cache_depth(cls);
+
+    if (tc->count[cls] >= depth)
+        block_cache_Spill(tc, cls, depth / 2);
+
+    block->p_next = tc->head[cls];
+    tc->head[cls] = block;
+    tc->count[cls]++;
+}
+
+static const struct vlc_block_callbacks block_cached_cbs =
+{
+    block_cached_Release,
+};
+
+static block_t *block_cache_Alloc(size_t alloc)
+{
+    int cls = block_cache_Class(alloc);
+    struct block_cache *tc;
+
+    if (cls < 0 || (tc = block_cache_Get()) == NULL)
+    {
+        if (cls < 0)
+            atomic_fetch_add_explicit(&block_stats.oversized, 1,
+                                      memory_order_relaxed);
+        return NULL;
+    }
+
+    if (tc->head[cls] == NULL)
+        block_cache_Refill(tc, cls, block_cache_depth(cls) / 2);
+
+    block_t *b = tc->head[cls];
+    const size_t size = block_cache_Size(cls);
+
+    if (b != NULL)
+    {
+        tc->head[cls] = b->p_next;
+        tc->count[cls]--;
+        if (++tc->hits >= BLOCK_CACHE_HITS_BATCH)
+            block_cache_FlushHits(tc);
+    }
+    else
+    {
+        b = malloc(size);
+        if (unlikely(b == NULL))
+            return NULL;
+        atomic_fetch_add_explicit(&block_stats.misses, 1,
+                                  memory_order_relaxed);
+    }
+
+    return block_Init(b, &block_cached_cbs, b + 1, size - sizeof (*b));
+}
+
+void block_GetStats(struct vlc_block_stats *restrict st)
+{
+    struct block_cache *tc = &block_tcache;
+
+    if (tc->registered && !tc->dead)
+        block_cache_FlushHits(tc);
+
+    st->hits = atomic_load_explicit(&block_stats.hits, memory_order_relaxed);
+    st->misses = atomic_load_explicit(&block_stats.misses,
+                                      memory_order_relaxed);
+    st->oversized = atomic_load_explicit(&block_stats.oversized,
+                                         memory_order_relaxed);
+    vlc_mutex_lock(&block_depot.lock);
+    st->cached = block_depot.bytes;
+    vlc_mutex_unlock(&block_depot.lock);
+}
+
 block_t *block_Alloc (size_t size)
 {
     if (unlikely(size >> 27))
@@ -119,11 +466,15 @@ block_t *block_Alloc (size_t size)
     if (unlikely(alloc <= size))
         return NULL;
 
-    block_t *b = malloc (alloc);
-    if (unlikely(b == NULL))
-        return NULL;
+    block_t *b = block_cache_Alloc(alloc);
+    if (b == NULL)
+    {
+        b = malloc (alloc);
+        if (unlikely(b == NULL))
+            return NULL;
 
-    block_Init(b, &block_generic_cbs, b + 1, alloc - sizeof (*b));
+        block_Init(b, &block_generic_cbs, b + 1, alloc - sizeof (*b));
+    }
     static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
                    "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
     b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
@@ -120,25 +120,26 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
     uint32_t i_capabilities = 0;
 
 #if defined( __i386__ ) || defined( __x86_64__ )
-    unsigned int i_eax, i_ebx, i_ecx, i_edx;
+    unsigned int i_eax, i_ebx, i_ecx, i_edx, i_max;
     bool b_amd;
 
     /* Needed for x86 CPU capabilities detection */
 # if defined (__i386__) && defined (__PIC__)
-#  define cpuid(reg) \
+#  define cpuid_count(reg, sub) \
     asm volatile ("xchgl %%ebx,%1\n\t" \
                   "cpuid\n\t" \
                   "xchgl %%ebx,%1\n\t" \
                   : "=a" (i_eax), "=r" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                  : "a" (reg) \
+                  : "a" (reg), "c" (sub) \
                   : "cc");
 # else
-#  define cpuid(reg) \
+#  define cpuid_count(reg, sub) \
     asm volatile ("cpuid\n\t" \
                   : "=a" (i_eax), "=b" (i_ebx), "=c" (i_ecx), "=d" (i_edx) \
-                  : "a" (reg) \
+                  : "a" (reg), "c" (sub) \
                   : "cc");
 # endif
+# define cpuid(reg) cpuid_count(reg, 0)
      /* Check if the OS really supports the requested instructions */
 # if defined (__i386__) && !defined (__i486__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -165,6 +166,7 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
 
     /* the CPU supports the CPUID instruction - get its level */
     cpuid( 0x00000000 );
+    i_max = i_eax;
 
 # if defined (__i386__) && !defined (__i586__) \
   && !defined (__i686__) && !defined (__pentium4__) \
@@ -205,6 +207,33 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
             i_capabilities |= VLC_CPU_SSE4_2;
     }
 
+    /* AVX needs the OS to save the YMM registers (XCR0 bits 1-2), and
+     * AVX-512 the opmask and ZMM registers as well (XCR0 bits 5-7) */
+    if( ( i_ecx & 0x18000000 ) == 0x18000000 ) /* OSXSAVE and AVX */
+    {
+        unsigned int i_xcr0;
+
+        asm volatile ("xgetbv\n\t"
+                      : "=a" (i_xcr0), "=d" (i_edx)
+                      : "c" (0));
+
+        if( ( i_xcr0 & 0x06 ) == 0x06 )
+        {
+            i_capabilities |= VLC_CPU_AVX;
+
+            if( i_max >= 7 )
+            {
+                cpuid_count( 0x00000007, 0 );
+                if( i_ebx & 0x00000020 )
+                    i_capabilities |= VLC_CPU_AVX2;
+                /* AVX-512 Foundation and Byte/Word */
+                if( ( i_ebx & 0x40010000 ) == 0x40010000
+                 && ( i_xcr0 & 0xe6 ) == 0xe6 )
+                    i_capabilities |= VLC_CPU_AVX512;
+            }
+        }
+    }
+
     /* test for additional capabilities */
     cpuid( 0x80000000 );
 
@@ -291,6 +320,8 @@ void vlc_CPU_dump (vlc_object_t *obj)
         vlc_memstream_puts(&stream, "AVX ");
     if (vlc_CPU_AVX2())
         vlc_memstream_puts(&stream, "AVX2 ");
+    if (vlc_CPU_AVX512())
+        vlc_memstream_puts(&stream, "AVX512 ");
     if (vlc_CPU_3dNOW())
         vlc_memstream_puts(&stream, "3DNow! ");
     if (vlc_CPU_XOP())
@@ -26,12 +26,17 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
 #include <vlc_block.h>
 #include "libvlc.h"
 
+/* Number of blocks that can be queued without locking before the consumer
+ * collects them */
+#define FIFO_RING_SIZE 64
+
 /**
  * Internal state for block queues
  */
@@ -40,53 +45,220 @@ struct block_fifo_t
     vlc_queue_t         q;
     size_t              i_depth;
     size_t              i_size;
+
+    /* Lock-less mode (see vlc_fifo_EnableLockless()): the producer fills the
+     * ring, and whoever holds the lock empties it into the queue. */
+    bool                lockless;
+    atomic_bool         waiting; /**< Whether the consumer may be waiting */
+    atomic_size_t       head; /**< Next ring slot to collect */
+    atomic_size_t       tail; /**< Next ring slot to fill */
+    atomic_size_t       depth; /**< Lock-less mode block count */
+    atomic_size_t       size; /**< Lock-less mode byte count */
+    block_t            *ring[FIFO_RING_SIZE];
 };
 
 static_assert (offsetof (block_fifo_t, q) == 0, "Problems in <vlc_block.h>");
 
+/**
+ * Moves the blocks queued without locking to the locked queue.
+ */
+static void vlc_fifo_Collect(block_fifo_t *fifo)
+{
+    vlc_mutex_assert(&fifo->q.lock);
+
+    if (!fifo->lockless)
+        return;
+
+    size_t head = atomic_load_explicit(&fifo->head, memory_order_relaxed);
+    size_t tail = atomic_load(&fifo->tail);
+
+    if (head == tail)
+        return;
+
+    block_t *list, **pp = &list;
+
+    do {
+        block_t *block = fifo->ring[head++ % FIFO_RING_SIZE];
+
+        *pp = block;
+        pp = &block->p_next;
+    } while (head != tail);
+    *pp = NULL;
+
+    atomic_store_explicit(&fifo->head, head, memory_order_release);
+    vlc_queue_EnqueueUnlocked(&fifo->q, list);
+}
+
+/**
+ * Collects the blocks queued without locking, for a consumer that will wait
+ * if there are none.
+ */
+static void vlc_fifo_Poll(block_fifo_t *fifo)
+{
+    vlc_fifo_Collect(fifo);
+
+    if (!fifo->lockless || !vlc_queue_IsEmpty(&fifo->q))
+        return;
+
+    /* Advertise the wait, then check the ring again. Either this thread sees
+     * the new blocks, or the producer sees the flag and signals (the producer
+     * needs the lock to do so, which is held until waiting). */
+    atomic_store(&fifo->waiting, true);
+    vlc_fifo_Collect(fifo);
+}
+
+/**
+ * Updates the block and byte counts.
+ *
+ * @return the block count before the update
+ */
+static size_t vlc_fifo_Account(block_fifo_t *fifo, const block_t *block,
+                               bool add)
+{
+    size_t depth = 0, size = 0, old_depth;
+
+    for (const block_t *b = block; b != NULL; b = b->p_next) {
+        depth++;
+        size += b->i_buffer;
+    }
+
+    if (fifo->lockless) {
+        if (add) {
+            old_depth = atomic_fetch_add_explicit(&fifo->depth, depth,
+                                                  memory_order_relaxed);
+            atomic_fetch_add_explicit(&fifo->size, size,
+                                      memory_order_relaxed);
+        } else {
+            old_depth = atomic_fetch_sub_explicit(&fifo->depth, depth,
+                                                  memory_order_relaxed);
+            assert(old_depth >= depth);
+            atomic_fetch_sub_explicit(&fifo->size, size,
+                                      memory_order_relaxed);
+        }
+    } else {
+        old_depth = fifo->i_depth;
+        if (add) {
+            fifo->i_depth += depth;
+            fifo->i_size += size;
+        } else {
+            assert(fifo->i_depth >= depth);
+            assert(fifo->i_size >= size);
+            fifo->i_depth -= depth;
+            fifo->i_size -= size;
+        }
+    }
+    return old_depth;
+}
+
 size_t vlc_fifo_GetCount(const vlc_fifo_t *fifo)
 {
+    if (fifo->lockless)
+        return atomic_load_explicit(&fifo->depth, memory_order_relaxed);
+
     vlc_mutex_assert(&fifo->q.lock);
     return fifo->i_depth;
 }
 
 size_t vlc_fifo_GetBytes(const vlc_fifo_t *fifo)
 {
+    if (fifo->lockless)
+        return atomic_load_explicit(&fifo->size, memory_order_relaxed);
+
     vlc_mutex_assert(&fifo->q.lock);
     return fifo->i_size;
 }
 
 void vlc_fifo_QueueUnlocked(block_fifo_t *fifo, block_t *block)
 {
-    for (block_t *b = block; b != NULL; b = b->p_next) {
-        fifo->i_depth++;
-        fifo->i_size += block->i_buffer;
-    }
-
+    /* Keep the order with respect to lock-less queued blocks. */
+    vlc_fifo_Collect(fifo);
+    vlc_fifo_Account(fifo, block, true);
     vlc_queue_EnqueueUnlocked(&fifo->q, block);
 }
 
 block_t *vlc_fifo_DequeueUnlocked(block_fifo_t *fifo)
 {
+    vlc_fifo_Poll(fifo);
+
+    /* Lock-less producers account for blocks before putting them in the
+     * ring, so the count is only an upper bound. */
     block_t *block = vlc_queue_DequeueUnlocked(&fifo->q);
 
-    if (block != NULL) {
-        assert(fifo->i_depth > 0);
-        assert(fifo->i_size >= block->i_buffer);
-        fifo->i_depth--;
-        fifo->i_size -= block->i_buffer;
-    }
+    if (block != NULL)
+        vlc_fifo_Account(fifo, block, false);
 
     return block;
 }
 
 block_t *vlc_fifo_DequeueAllUnlocked(block_fifo_t *fifo)
 {
+    vlc_fifo_Collect(fifo);
+
+    if (fifo->lockless) {
+        block_t *list = vlc_queue_DequeueAllUnlocked(&fifo->q);
+
+        vlc_fifo_Account(fifo, list, false);
+        return list;
+    }
+
     fifo->i_depth = 0;
     fifo->i_size = 0;
     return vlc_queue_DequeueAllUnlocked(&fifo->q);
 }
 
+void vlc_fifo_EnableLockless(vlc_fifo_t *fifo)
+{
+    assert(vlc_queue_IsEmpty(&fifo->q));
+    assert(fifo->i_depth == 0);
+    fifo->lockless = true;
+}
+
+void vlc_fifo_QueueLockless(vlc_fifo_t *fifo, block_t *block)
+{
+    assert(fifo->lockless);
+
+    if (block == NULL)
+        return;
+
+    /* Only this thread writes the tail. */
+    size_t tail = atomic_load_explicit(&fifo->tail, memory_order_relaxed);
+    bool was_empty = false;
+
+    while (block != NULL) {
+        size_t head = atomic_load_explicit(&fifo->head, memory_order_acquire);
+
+        if (tail - head >= FIFO_RING_SIZE) {
+            /* The ring is full: queue the rest after it, with the lock. */
+            vlc_fifo_Lock(fifo);
+            vlc_fifo_QueueUnlocked(fifo, block);
+            vlc_fifo_Signal(fifo);
+            vlc_fifo_Unlock(fifo);
+            return;
+        }
+
+        block_t *next = block->p_next;
+
+        block->p_next = NULL;
+        if (vlc_fifo_Account(fifo, block, true) == 0)
+            was_empty = true;
+        fifo->ring[tail++ % FIFO_RING_SIZE] = block;
+        atomic_store(&fifo->tail, tail);
+        block = next;
+    }
+
+    /* Signal if the FIFO was empty, since the consumer may wait until
+     * vlc_fifo_IsEmpty() is false, or if vlc_fifo_DequeueUnlocked() found no
+     * block while one was being queued. The consumer checks either with the
+     * lock held until it waits, so the signal cannot be missed. */
+    bool waiting = atomic_exchange(&fifo->waiting, false);
+
+    if (waiting || was_empty) {
+        vlc_fifo_Lock(fifo);
+        vlc_fifo_Signal(fifo);
+        vlc_fifo_Unlock(fifo);
+    }
+}
+
 block_fifo_t *block_FifoNew( void )
 {
     block_fifo_t *p_fifo = malloc( sizeof( block_fifo_t ) );
@@ -95,6 +267,12 @@ block_fifo_t *block_FifoNew( void )
         vlc_queue_Init(&p_fifo->q, offsetof (block_t, p_next));
         p_fifo->i_depth = 0;
         p_fifo->i_size = 0;
+        p_fifo->lockless = false;
+        atomic_init(&p_fifo->waiting, false);
+        atomic_init(&p_fifo->head, 0);
+        atomic_init(&p_fifo->tail, 0);
+        atomic_init(&p_fifo->depth, 0);
+        atomic_init(&p_fifo->size, 0);
     }
 
     return p_fifo;
@@ -113,13 +291,12 @@ block_t *block_FifoGet(block_fifo_t *fifo)
     vlc_testcancel();
 
     vlc_fifo_Lock(fifo);
-    while (vlc_fifo_IsEmpty(fifo))
+    while ((block = vlc_fifo_DequeueUnlocked(fifo)) == NULL)
     {
         vlc_fifo_CleanupPush(fifo);
         vlc_fifo_Wait(fifo);
         vlc_cleanup_pop();
     }
-    block = vlc_fifo_DequeueUnlocked(fifo);
     vlc_fifo_Unlock(fifo);
 
     return block;
@@ -130,7 +307,16 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
     block_t *b;
 
     vlc_fifo_Lock(p_fifo);
-    assert(p_fifo->q.first != NULL);
+    vlc_fifo_Poll(p_fifo);
+    /* A lock-less queued block may be counted but not in the ring yet. */
+    while (vlc_queue_IsEmpty(&p_fifo->q))
+    {
+        assert(!vlc_fifo_IsEmpty(p_fifo));
+        vlc_fifo_CleanupPush(p_fifo);
+        vlc_fifo_Wait(p_fifo);
+        vlc_cleanup_pop();
+        vlc_fifo_Poll(p_fifo);
+    }
     b = (block_t *)p_fifo->q.first;
     vlc_fifo_Unlock(p_fifo);
 
@@ -60,6 +60,137 @@ static void picture_DestroyDummy( picture_t *p_picture )
     (void) p_picture;
 }
 
+/*****************************************************************************
+ * Picture buffer recycling
+ *****************************************************************************/
+
+/** Maximum number of recycled picture buffers */
+#define PICTURE_CACHE_MAX 32
+/** Maximum total size of recycled picture buffers */
+#define PICTURE_CACHE_SIZE_MAX (UINT32_C(1) << 27) /* 128MB */
+
+/**
+ * Buffers of released pictures, kept for pictures of the same size.
+ *
+ * The buffer size depends only on the chroma and the aligned dimensions,
+ * so filters and converters that output the same format over and over get
+ * the same buffers back, without allocation nor page faults.
+ */
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned usage; /**< LibVLC instances holding the cache */
+    unsigned count;
+    size_t size; /**< Total size of the cached buffers */
+    struct picture_cache_stats stats;
+    picture_buffer_t buffers[PICTURE_CACHE_MAX]; /**< Least recent first */
+} picture_cache = { .lock = VLC_STATIC_MUTEX };
+
+static void *picture_CacheGet(int *restrict fdp, size_t size)
+{
+    void *base = NULL;
+
+    vlc_mutex_lock(&picture_cache.lock);
+    for (unsigned i = picture_cache.count; i-- > 0;)
+    {
+        picture_buffer_t *buf = &picture_cache.buffers[i];
+
+        if (buf->size != size)
+            continue;
+
+        *fdp = buf->fd;
+        base = buf->base;
+        picture_cache.size -= size;
+        picture_cache.count--;
+        memmove(buf, buf + 1, (picture_cache.count - i) * sizeof (*buf));
+        break;
+    }
+
+    if (base != NULL)
+        picture_cache.stats.hits++;
+    else
+        picture_cache.stats.misses++;
+    vlc_mutex_unlock(&picture_cache.lock);
+    return base;
+}
+
+static void picture_CachePut(const picture_buffer_t *restrict res)
+{
+    picture_buffer_t evicted[PICTURE_CACHE_MAX];
+    unsigned n = 0;
+
+    if (res->size > PICTURE_CACHE_SIZE_MAX)
+    {
+        picture_Deallocate(res->fd, res->base, res->size);
+        return;
+    }
+
+    vlc_mutex_lock(&picture_cache.lock);
+    if (picture_cache.usage == 0)
+    {   /* No instance would ever flush the buffer */
+        vlc_mutex_unlock(&picture_cache.lock);
+        picture_Deallocate(res->fd, res->base, res->size);
+        return;
+    }
+
+    /* Evict the least recently released buffers to make room */
+    while (picture_cache.count >= PICTURE_CACHE_MAX
+        || picture_cache.size + res->size > PICTURE_CACHE_SIZE_MAX)
+    {
+        assert(picture_cache.count > 0);
+        evicted[n] = picture_cache.buffers[0];
+        picture_cache.size -= evicted[n].size;
+        picture_cache.count--;
+        memmove(picture_cache.buffers, picture_cache.buffers + 1,
+                picture_cache.count * sizeof (picture_cache.buffers[0]));
+        n++;
+    }
+    picture_cache.buffers[picture_cache.count++] = *res;
+    picture_cache.size += res->size;
+    picture_cache.stats.evictions += n;
+    vlc_mutex_unlock(&picture_cache.lock);
+
+    while (n > 0)
+    {
+        n--;
+        picture_Deallocate(evicted[n].fd, evicted[n].base, evicted[n].size);
+    }
+}
+
+void picture_CacheHold(void)
+{
+    vlc_mutex_lock(&picture_cache.lock);
+    picture_cache.usage++;
+    vlc_mutex_unlock(&picture_cache.lock);
+}
+
+bool picture_CacheRelease(struct picture_cache_stats *restrict stats)
+{
+    picture_buffer_t evicted[PICTURE_CACHE_MAX];
+    unsigned n;
+
+    vlc_mutex_lock(&picture_cache.lock);
+    assert(picture_cache.usage > 0);
+    if (--picture_cache.usage > 0)
+    {   /* Other instances may still reuse the buffers */
+        vlc_mutex_unlock(&picture_cache.lock);
+        return false;
+    }
+
+    n = picture_cache.count;
+    memcpy(evicted, picture_cache.buffers, n * sizeof (evicted[0]));
+    picture_cache.count = 0;
+    picture_cache.size = 0;
+    if (stats != NULL)
+        *stats = picture_cache.stats;
+    memset(&picture_cache.stats, 0, sizeof (picture_cache.stats));
+    vlc_mutex_unlock(&picture_cache.lock);
+
+    for (unsigned i = 0; i < n; i++)
+        picture_Deallocate(evicted[i].fd, evicted[i].base, evicted[i].size);
+    return true;
+}
+
 /**
  * Destroys a picture allocated with picture_NewFromFormat().
  */
@@ -68,7 +199,7 @@ static void picture_DestroyFromFormat(picture_t *pic)
     picture_buffer_t *res = pic->p_sys;
 
     if (res != NULL)
-        picture_Deallocate(res->fd, res->base, res->size);
+        picture_CachePut(res);
 }
 
 VLC_WEAK void *picture_Allocate(int *restrict fdp, size_t size)
@@ -299,7 +430,13 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
     if (unlikely(pic_size >= PICTURE_SW_SIZE_MAX))
         goto error;
 
-    unsigned char *buf = picture_Allocate(&res->fd, pic_size);
+    unsigned char *buf = picture_CacheGet(&res->fd, pic_size);
+    if (buf != NULL)
+        /* New pages are zeroed, and some users, such as subpicture regions
+         * that are only partially drawn, rely on that. */
+        memset(buf, 0, pic_size);
+    else
+        buf = picture_Allocate(&res->fd, pic_size);
     if (unlikely(buf == NULL))
         goto error;
 
@@ -36,4 +36,25 @@ typedef struct
 void *picture_Allocate(int *, size_t);
 void picture_Deallocate(int, void *, size_t);
 
+struct picture_cache_stats
+{
+    uint64_t hits; /**< Buffers reused from the cache */
+    uint64_t misses; /**< Buffers allocated */
+    uint64_t evictions; /**< Buffers dropped from the cache */
+};
+
+/**
+ * Holds the recycled picture buffers for a LibVLC instance.
+ */
+void picture_CacheHold(void);
+
+/**
+ * Releases the recycled picture buffers held by a LibVLC instance, and frees
+ * them if no other instance holds them.
+ *
+ * @param stats storage for the cache statistics [OUT], or NULL
+ * @return whether the buffers were freed and the statistics stored
+ */
+bool picture_CacheRelease(struct picture_cache_stats *stats);
+
 picture_t * picture_InternalClone(picture_t *, void (*pf_destroy)(picture_t *), void *);
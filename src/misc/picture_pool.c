@@ -26,211 +26,326 @@
 # include "config.h"
 #endif
 #include <assert.h>
-#include <limits.h>
 #include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include <vlc_common.h>
+#include <vlc_tick.h>
 #include <vlc_picture_pool.h>
 #include "picture.h"
 
-#define POOL_MAX (CHAR_BIT * sizeof (unsigned long long))
-
-static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
+struct picture_pool_entry {
+    picture_t *picture;
+    picture_pool_t *pool; /**< Owner pool, for the release callback */
+    atomic_uint next; /**< Next free entry index plus one, or 0 */
+    unsigned master; /**< Entry index in the master pool (if reserved) */
+};
 
 struct picture_pool_t {
+    /** Free list: ABA tag in the upper 32 bits, head index plus one (or 0
+     * if empty) in the lower 32 bits */
+    atomic_uint_least64_t head;
+    atomic_bool canceled;
+    atomic_uint refs;
+
+    /* Slow path, only used to sleep until a picture is freed */
     vlc_mutex_t lock;
     vlc_cond_t  wait;
-
-    bool               canceled;
-    unsigned long long available;
-    atomic_ushort      refs;
-    unsigned short     picture_count;
-    picture_t  *picture[];
+    atomic_uint waiters;
+
+    /* Statistics */
+    atomic_uint in_use;
+    atomic_uint peak;
+    atomic_uint_least64_t gets;
+    atomic_uint_least64_t misses;
+    atomic_uint_least64_t waits;
+    atomic_uint_least64_t wait_time;
+
+    picture_pool_t *master; /**< Pool the pictures are reserved from */
+    unsigned picture_count;
+    struct picture_pool_entry entries[];
 };
 
+static void picture_pool_Push(picture_pool_t *pool, unsigned index)
+{
+    struct picture_pool_entry *entry = &pool->entries[index];
+    uint_least64_t head = atomic_load(&pool->head);
+    uint_least64_t val;
+
+    assert(index < pool->picture_count);
+    do
+    {
+        atomic_store_explicit(&entry->next, (uint32_t)head,
+                              memory_order_relaxed);
+        val = (((head >> 32) + 1) << 32) | (index + 1);
+    }
+    while (!atomic_compare_exchange_weak(&pool->head, &head, val));
+}
+
+static int picture_pool_Pop(picture_pool_t *pool)
+{
+    uint_least64_t head = atomic_load(&pool->head);
+
+    for (;;)
+    {
+        unsigned index = (uint32_t)head;
+
+        if (index == 0)
+            return -1;
+
+        /* The entry may be popped and pushed again concurrently, in which
+         * case the tag has changed and the exchange fails. */
+        unsigned next = atomic_load_explicit(&pool->entries[index - 1].next,
+                                             memory_order_relaxed);
+        uint_least64_t val = (((head >> 32) + 1) << 32) | next;
+
+        if (atomic_compare_exchange_weak(&pool->head, &head, val))
+            return index - 1;
+    }
+}
+
+/** Returns an entry to the free list, and wakes up a waiting thread if any */
+static void picture_pool_Put(picture_pool_t *pool, unsigned index)
+{
+    picture_pool_Push(pool, index);
+
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
+}
+
+static void picture_pool_Use(picture_pool_t *pool, unsigned count)
+{
+    unsigned in_use = atomic_fetch_add_explicit(&pool->in_use, count,
+                                                memory_order_relaxed) + count;
+    unsigned peak = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+
+    while (in_use > peak
+        && !atomic_compare_exchange_weak_explicit(&pool->peak, &peak, in_use,
+                                                  memory_order_relaxed,
+                                                  memory_order_relaxed));
+}
+
 static void picture_pool_Destroy(picture_pool_t *pool)
 {
     if (atomic_fetch_sub_explicit(&pool->refs, 1, memory_order_release) != 1)
         return;
 
     atomic_thread_fence(memory_order_acquire);
-    aligned_free(pool);
+
+    picture_pool_t *master = pool->master;
+
+    if (master != NULL)
+    {   /* Give the reserved entries back to the master pool */
+        for (unsigned i = 0; i < pool->picture_count; i++)
+            picture_pool_Put(master, pool->entries[i].master);
+        atomic_fetch_sub_explicit(&master->in_use, pool->picture_count,
+                                  memory_order_relaxed);
+        picture_pool_Destroy(master);
+    }
+
+    free(pool);
 }
 
 void picture_pool_Release(picture_pool_t *pool)
 {
     for (unsigned i = 0; i < pool->picture_count; i++)
-        picture_Release(pool->picture[i]);
+        picture_Release(pool->entries[i].picture);
     picture_pool_Destroy(pool);
 }
 
 static void picture_pool_ReleasePicture(picture_t *clone)
 {
     picture_priv_t *priv = (picture_priv_t *)clone;
-    uintptr_t sys = (uintptr_t)priv->gc.opaque;
-    picture_pool_t *pool = (void *)(sys & ~(POOL_MAX - 1));
-    unsigned offset = sys & (POOL_MAX - 1);
-    picture_t *picture = pool->picture[offset];
-
-    picture_Release(picture);
+    struct picture_pool_entry *entry = priv->gc.opaque;
+    picture_pool_t *pool = entry->pool;
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
+    picture_Release(entry->picture);
 
+    atomic_fetch_sub_explicit(&pool->in_use, 1, memory_order_relaxed);
+    picture_pool_Put(pool, entry - pool->entries);
     picture_pool_Destroy(pool);
 }
 
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
-                                            unsigned offset)
+                                            unsigned index)
 {
-    picture_t *picture = pool->picture[offset];
-    uintptr_t sys = ((uintptr_t)pool) + offset;
+    struct picture_pool_entry *entry = &pool->entries[index];
+    picture_t *clone = picture_InternalClone(entry->picture,
+                                             picture_pool_ReleasePicture,
+                                             entry);
+    if (unlikely(clone == NULL))
+    {
+        picture_pool_Put(pool, index);
+        return NULL;
+    }
 
-    return picture_InternalClone(picture, picture_pool_ReleasePicture,
-                                 (void*)sys);
+    assert(clone->p_next == NULL);
+    atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+    picture_pool_Use(pool, 1);
+    return clone;
 }
 
-picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
+static picture_pool_t *picture_pool_Alloc(unsigned count)
 {
-    if (unlikely(count > POOL_MAX))
-        return NULL;
-
     picture_pool_t *pool;
-    size_t size = sizeof (*pool) + count * sizeof (picture_t *);
+    size_t size;
+
+    if (unlikely(mul_overflow(count, sizeof (pool->entries[0]), &size)
+              || add_overflow(size, sizeof (*pool), &size)))
+        return NULL;
 
-    size += (-size) & (POOL_MAX - 1);
-    pool = aligned_alloc(POOL_MAX, size);
+    pool = malloc(size);
     if (unlikely(pool == NULL))
         return NULL;
 
+    atomic_init(&pool->head, 0);
+    atomic_init(&pool->canceled, false);
+    atomic_init(&pool->refs, 1);
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
-    if (count == POOL_MAX)
-        pool->available = ~0ULL;
-    else
-        pool->available = (1ULL << count) - 1;
-    atomic_init(&pool->refs,  1);
+    atomic_init(&pool->waiters, 0);
+    atomic_init(&pool->in_use, 0);
+    atomic_init(&pool->peak, 0);
+    atomic_init(&pool->gets, 0);
+    atomic_init(&pool->misses, 0);
+    atomic_init(&pool->waits, 0);
+    atomic_init(&pool->wait_time, 0);
+    pool->master = NULL;
     pool->picture_count = count;
-    memcpy(pool->picture, tab, count * sizeof (picture_t *));
-    pool->canceled = false;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        pool->entries[i].pool = pool;
+        pool->entries[i].master = i;
+        /* Initially, entries are free in index order. */
+        atomic_init(&pool->entries[i].next, (i + 1 < count) ? i + 2 : 0);
+    }
+    if (count > 0)
+        atomic_init(&pool->head, 1);
+    return pool;
+}
+
+picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
+{
+    picture_pool_t *pool = picture_pool_Alloc(count);
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    for (unsigned i = 0; i < count; i++)
+        pool->entries[i].picture = tab[i];
     return pool;
 }
 
 picture_pool_t *picture_pool_NewFromFormat(const video_format_t *fmt,
                                            unsigned count)
 {
-    picture_t *picture[count ? count : 1];
-    unsigned i;
+    picture_pool_t *pool = picture_pool_Alloc(count);
+    if (unlikely(pool == NULL))
+        return NULL;
 
-    for (i = 0; i < count; i++) {
-        picture[i] = picture_NewFromFormat(fmt);
-        if (picture[i] == NULL)
-            goto error;
+    for (unsigned i = 0; i < count; i++) {
+        pool->entries[i].picture = picture_NewFromFormat(fmt);
+        if (pool->entries[i].picture == NULL) {
+            while (i > 0)
+                picture_Release(pool->entries[--i].picture);
+            free(pool);
+            return NULL;
+        }
     }
-
-    picture_pool_t *pool = picture_pool_New(count, picture);
-    if (!pool)
-        goto error;
-
     return pool;
-
-error:
-    while (i > 0)
-        picture_Release(picture[--i]);
-    return NULL;
 }
 
 picture_pool_t *picture_pool_Reserve(picture_pool_t *master, unsigned count)
 {
-    picture_t *picture[count ? count : 1];
-    unsigned i;
+    assert(atomic_load(&master->refs) > 0);
 
-    for (i = 0; i < count; i++) {
-        picture[i] = picture_pool_Get(master);
-        if (picture[i] == NULL)
-            goto error;
-    }
+    picture_pool_t *pool = picture_pool_Alloc(count);
+    if (unlikely(pool == NULL))
+        return NULL;
 
-    picture_pool_t *pool = picture_pool_New(count, picture);
-    if (!pool)
-        goto error;
+    /* Take the entries off the master free list. The reserved pictures are
+     * handed out directly from the new pool, without an intermediate
+     * clone. */
+    for (unsigned i = 0; i < count; i++)
+    {
+        int index = picture_pool_Pop(master);
 
-    return pool;
+        if (index < 0)
+        {
+            while (i > 0)
+                picture_pool_Put(master, pool->entries[--i].master);
+            free(pool);
+            return NULL;
+        }
+
+        pool->entries[i].master = index;
+        pool->entries[i].picture = picture_Hold(master->entries[index].picture);
+    }
 
-error:
-    while (i > 0)
-        picture_Release(picture[--i]);
-    return NULL;
+    picture_pool_Use(master, count);
+    atomic_fetch_add_explicit(&master->refs, 1, memory_order_relaxed);
+    pool->master = master;
+    return pool;
 }
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    unsigned long long available;
+    assert(atomic_load(&pool->refs) > 0);
+    atomic_fetch_add_explicit(&pool->gets, 1, memory_order_relaxed);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
-    available = pool->available;
+    if (unlikely(atomic_load(&pool->canceled)))
+        return NULL;
 
-    while (available != 0)
+    int index = picture_pool_Pop(pool);
+    if (index < 0)
     {
-        int i = ctz(available);
-
-        if (unlikely(pool->canceled))
-            break;
-
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
-
-        picture_t *clone = picture_pool_ClonePicture(pool, i);
-        if (clone != NULL) {
-            assert(clone->p_next == NULL);
-            atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
-        }
-        return clone;
+        atomic_fetch_add_explicit(&pool->misses, 1, memory_order_relaxed);
+        return NULL;
     }
-
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    return picture_pool_ClonePicture(pool, index);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load(&pool->refs) > 0);
+    atomic_fetch_add_explicit(&pool->gets, 1, memory_order_relaxed);
 
-    while (pool->available == 0)
+    int index = picture_pool_Pop(pool);
+    if (index < 0)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
-        }
-        vlc_cond_wait(&pool->wait, &pool->lock);
-    }
-
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
-    vlc_mutex_unlock(&pool->lock);
+        vlc_tick_t start = vlc_tick_now();
+
+        /* Register as a waiter before checking the free list again, so that
+         * a concurrent release either is seen here or signals the
+         * condition. */
+        vlc_mutex_lock(&pool->lock);
+        atomic_fetch_add(&pool->waiters, 1);
+        while ((index = picture_pool_Pop(pool)) < 0
+            && !atomic_load(&pool->canceled))
+            vlc_cond_wait(&pool->wait, &pool->lock);
+        atomic_fetch_sub(&pool->waiters, 1);
+        vlc_mutex_unlock(&pool->lock);
 
-    picture_t *clone = picture_pool_ClonePicture(pool, i);
-    if (clone != NULL) {
-        assert(clone->p_next == NULL);
-        atomic_fetch_add_explicit(&pool->refs, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool->waits, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool->wait_time, vlc_tick_now() - start,
+                                  memory_order_relaxed);
+        if (index < 0)
+            return NULL;
     }
-    return clone;
+    return picture_pool_ClonePicture(pool, index);
 }
 
 void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
 {
-    vlc_mutex_lock(&pool->lock);
-    assert(pool->refs > 0);
+    assert(atomic_load(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    vlc_mutex_lock(&pool->lock);
+    atomic_store(&pool->canceled, canceled);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
@@ -240,3 +355,16 @@ unsigned picture_pool_GetSize(const picture_pool_t *pool)
 {
     return pool->picture_count;
 }
+
+void picture_pool_GetStats(const picture_pool_t *pool,
+                           struct picture_pool_stats *restrict stats)
+{
+    stats->size = pool->picture_count;
+    stats->in_use = atomic_load_explicit(&pool->in_use, memory_order_relaxed);
+    stats->peak = atomic_load_explicit(&pool->peak, memory_order_relaxed);
+    stats->gets = atomic_load_explicit(&pool->gets, memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&pool->misses, memory_order_relaxed);
+    stats->waits = atomic_load_explicit(&pool->waits, memory_order_relaxed);
+    stats->wait_time = atomic_load_explicit(&pool->wait_time,
+                                            memory_order_relaxed);
+}
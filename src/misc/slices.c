@@ -0,0 +1,254 @@
+/*****************************************************************************
+ * slices.c: slice-parallel processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_list.h>
+#include <vlc_slices.h>
+#include "libvlc.h"
+
+/** Smallest band height worth a thread hand-over */
+#define SLICE_MIN_LINES 16
+/** Upper bound on the number of worker threads */
+#define SLICE_MAX_THREADS 64
+
+struct vlc_slices_job
+{
+    vlc_slice_cb cb;
+    void *opaque;
+    unsigned count; /**< Number of slices */
+    unsigned next; /**< Next slice to process */
+    unsigned pending; /**< Number of slices not processed yet */
+    struct vlc_list node;
+};
+
+struct vlc_slices
+{
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /**< Signaled when a job is queued or on exit */
+    vlc_cond_t done; /**< Signaled when a job completes */
+    struct vlc_list jobs; /**< Jobs with slices not started yet */
+    bool started;
+    bool closing;
+    unsigned threadc;
+    vlc_thread_t *threadv;
+};
+
+/**
+ * Processes the next slice of a job.
+ * The pool lock must be held, and is released while processing the slice.
+ */
+static void vlc_slices_Process(struct vlc_slices *pool,
+                               struct vlc_slices_job *job)
+{
+    vlc_mutex_assert(&pool->lock);
+    assert(job->next < job->count);
+
+    unsigned slice = job->next++;
+
+    if (job->next == job->count)
+        vlc_list_remove(&job->node);
+
+    vlc_mutex_unlock(&pool->lock);
+    job->cb(job->opaque, slice, job->count);
+    vlc_mutex_lock(&pool->lock);
+
+    assert(job->pending > 0);
+    if (--job->pending == 0)
+        vlc_cond_broadcast(&pool->done);
+}
+
+static void *vlc_slices_Thread(void *data)
+{
+    struct vlc_slices *pool = data;
+
+    vlc_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        struct vlc_slices_job *job =
+            vlc_list_first_entry_or_null(&pool->jobs, struct vlc_slices_job,
+                                         node);
+        if (job != NULL)
+            vlc_slices_Process(pool, job);
+        else if (!pool->closing)
+            vlc_cond_wait(&pool->wait, &pool->lock);
+        else
+            break;
+    }
+    vlc_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/**
+ * Starts the worker threads on first use.
+ *
+ * The number of threads is only known once the configuration is loaded, and
+ * most instances never use any slice-threaded filter anyway.
+ */
+static void vlc_slices_Start(struct vlc_slices *pool, vlc_object_t *obj)
+{
+    vlc_mutex_assert(&pool->lock);
+
+    if (pool->started)
+        return;
+    pool->started = true;
+
+    int64_t val = var_InheritInteger(obj, "filter-threads");
+    unsigned count = (val > 0) ? (unsigned)val : vlc_GetCPUCount();
+
+    /* The calling thread processes slices too. */
+    if (count > SLICE_MAX_THREADS)
+        count = SLICE_MAX_THREADS;
+    if (count <= 1)
+        return;
+
+    pool->threadv = vlc_alloc(count - 1, sizeof (*pool->threadv));
+    if (unlikely(pool->threadv == NULL))
+        return;
+
+    while (pool->threadc < count - 1)
+    {
+        if (vlc_clone(&pool->threadv[pool->threadc], vlc_slices_Thread, pool,
+                      VLC_THREAD_PRIORITY_VIDEO))
+            break;
+        pool->threadc++;
+    }
+    msg_Dbg(obj, "using %u slice worker threads", pool->threadc);
+}
+
+static struct vlc_slices *vlc_slices_Get(vlc_object_t *obj)
+{
+    struct vlc_slices *pool = libvlc_priv(vlc_object_instance(obj))->slices;
+
+    if (pool != NULL)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_slices_Start(pool, obj);
+        vlc_mutex_unlock(&pool->lock);
+    }
+    return pool;
+}
+
+#undef vlc_slices_Count
+unsigned vlc_slices_Count(vlc_object_t *obj, unsigned lines)
+{
+    struct vlc_slices *pool = vlc_slices_Get(obj);
+
+    if (pool == NULL || pool->threadc == 0)
+        return 1;
+
+    /* Twice as many slices as threads, so that the work still balances if a
+     * thread is slow to wake up or busy with another job. */
+    unsigned count = 2 * (pool->threadc + 1);
+    unsigned max = lines / SLICE_MIN_LINES;
+
+    if (count > max)
+        count = max;
+    return count ? count : 1;
+}
+
+#undef vlc_slices_Run
+void vlc_slices_Run(vlc_object_t *obj, unsigned count,
+                    vlc_slice_cb cb, void *opaque)
+{
+    struct vlc_slices *pool = NULL;
+
+    if (count > 1)
+        pool = libvlc_priv(vlc_object_instance(obj))->slices;
+
+    if (pool != NULL)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_slices_Start(pool, obj);
+        if (pool->threadc == 0)
+        {
+            vlc_mutex_unlock(&pool->lock);
+            pool = NULL;
+        }
+    }
+
+    if (pool == NULL)
+    {
+        for (unsigned i = 0; i < count; i++)
+            cb(opaque, i, count);
+        return;
+    }
+
+    struct vlc_slices_job job = {
+        .cb = cb,
+        .opaque = opaque,
+        .count = count,
+        .next = 0,
+        .pending = count,
+    };
+    /* Workers refer to the job on the stack until it completes. */
+    int canc = vlc_savecancel();
+
+    vlc_list_append(&job.node, &pool->jobs);
+    if (count - 1 >= pool->threadc)
+        vlc_cond_broadcast(&pool->wait);
+    else
+        for (unsigned i = 1; i < count; i++)
+            vlc_cond_signal(&pool->wait);
+
+    while (job.next < job.count)
+        vlc_slices_Process(pool, &job);
+    while (job.pending > 0)
+        vlc_cond_wait(&pool->done, &pool->lock);
+    vlc_mutex_unlock(&pool->lock);
+    vlc_restorecancel(canc);
+}
+
+struct vlc_slices *vlc_slices_New(void)
+{
+    struct vlc_slices *pool = malloc(sizeof (*pool));
+    if (unlikely(pool == NULL))
+        return NULL;
+
+    vlc_mutex_init(&pool->lock);
+    vlc_cond_init(&pool->wait);
+    vlc_cond_init(&pool->done);
+    vlc_list_init(&pool->jobs);
+    pool->started = false;
+    pool->closing = false;
+    pool->threadc = 0;
+    pool->threadv = NULL;
+    return pool;
+}
+
+void vlc_slices_Delete(struct vlc_slices *pool)
+{
+    vlc_mutex_lock(&pool->lock);
+    assert(vlc_list_is_empty(&pool->jobs));
+    pool->closing = true;
+    vlc_cond_broadcast(&pool->wait);
+    vlc_mutex_unlock(&pool->lock);
+
+    for (unsigned i = 0; i < pool->threadc; i++)
+        vlc_join(pool->threadv[i], NULL);
+    free(pool->threadv);
+    free(pool);
+}
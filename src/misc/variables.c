@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,9 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    variable_t  *next; /**< Next variable in the same hash bucket */
+    uint32_t     hash; /**< Hash of the name */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -136,23 +135,75 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+/* Variables are looked up by name on every access, so each object keeps them
+ * in a hash table. The name hash is stored so that chains are walked without
+ * string comparisons in the common case. */
+
+static uint32_t VarHash( const char *psz_name )
+{
+    uint32_t hash = 2166136261u; /* FNV-1a */
+
+    for( const unsigned char *p = (const unsigned char *)psz_name; *p; p++ )
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
+}
+
+/**
+ * Finds the link to a variable in the hash table of an object.
+ * @return the link to the variable, or to the end of its hash bucket
+ */
+static variable_t **VarSlot( vlc_object_internals_t *priv,
+                             const char *psz_name, uint32_t hash )
 {
-    const variable_t *va = a, *vb = b;
+    variable_t **pp = &priv->var_table[hash & (priv->var_buckets - 1)];
+
+    vlc_mutex_assert( &priv->var_lock );
+
+    for( variable_t *var = *pp; var != NULL; var = *pp )
+    {
+        if( var->hash == hash && strcmp( var->psz_name, psz_name ) == 0 )
+            break;
+        pp = &var->next;
+    }
+    return pp;
+}
+
+static int VarGrow( vlc_object_internals_t *priv )
+{
+    size_t count = priv->var_buckets ? (priv->var_buckets * 2) : 8;
+    variable_t **table = calloc( count, sizeof (*table) );
+    if( unlikely(table == NULL) )
+        return VLC_ENOMEM;
+
+    for( size_t i = 0; i < priv->var_buckets; i++ )
+    {
+        variable_t *var = priv->var_table[i];
+
+        while( var != NULL )
+        {
+            variable_t *next = var->next;
+            variable_t **pp = &table[var->hash & (count - 1)];
+
+            var->next = *pp;
+            *pp = var;
+            var = next;
+        }
+    }
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    free( priv->var_table );
+    priv->var_table = table;
+    priv->var_buckets = count;
+    return VLC_SUCCESS;
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    void **pp_var;
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    if( priv->var_count == 0 )
+        return NULL;
+    return *VarSlot( priv, psz_name, VarHash( psz_name ) );
 }
 
 static void Destroy( variable_t *p_var )
@@ -295,6 +346,7 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = VarHash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -352,17 +404,23 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    void **pp_var;
-    variable_t *p_oldvar;
+    variable_t **pp_var, *p_oldvar;
     int ret = VLC_SUCCESS;
 
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
+    if( p_priv->var_count >= p_priv->var_buckets
+     && unlikely(VarGrow( p_priv ) != VLC_SUCCESS) )
         ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
+    else if( unlikely(p_var->psz_name == NULL) )
+        ret = VLC_ENOMEM;
+    else if( (p_oldvar = *(pp_var = VarSlot( p_priv, p_var->psz_name,
+                                             p_var->hash ))) == NULL )
+    {   /* Variable create */
+        *pp_var = p_var;
+        p_priv->var_count++;
         p_var = NULL; /* Variable created */
+    }
     else /* Variable already exists */
     {
         assert (((i_type ^ p_oldvar->i_type) & VLC_VAR_CLASS) == 0);
@@ -392,7 +450,8 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     else if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        *VarSlot( p_priv, p_var->psz_name, p_var->hash ) = p_var->next;
+        p_priv->var_count--;
     }
     else
     {
@@ -405,17 +464,27 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
-{
-    Destroy( var );
-}
-
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    for( size_t i = 0; i < priv->var_buckets; i++ )
+    {
+        variable_t *var = priv->var_table[i];
+
+        while( var != NULL )
+        {
+            variable_t *next = var->next;
+
+            Destroy( var );
+            var = next;
+        }
+    }
+
+    free( priv->var_table );
+    priv->var_table = NULL;
+    priv->var_buckets = 0;
+    priv->var_count = 0;
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -1135,21 +1204,6 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
-{
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
-}
-
 char **var_GetAllNames(vlc_object_t *obj)
 {
     vlc_object_internals_t *priv = vlc_internals(obj);
@@ -1157,9 +1211,15 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    for (size_t i = 0; i < priv->var_buckets; i++)
+        for (const variable_t *var = priv->var_table[i]; var != NULL;
+             var = var->next)
+        {
+            char *dup = strdup(var->psz_name);
+            if (dup != NULL)
+                ARRAY_APPEND(names, dup);
+        }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
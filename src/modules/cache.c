@@ -56,7 +56,7 @@
 #ifdef HAVE_DYNAMIC_PLUGINS
 /* Sub-version number
  * (only used to avoid breakage in dev version when cache structure changes) */
-#define CACHE_SUBVERSION_NUM 36
+#define CACHE_SUBVERSION_NUM 38
 
 /* Cache filename */
 #define CACHE_NAME "plugins.dat"
@@ -196,17 +196,17 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
     {
         const char *psz;
         LOAD_STRING(psz);
+        /* The value shares the mapped default until it is changed. */
         cfg->orig.psz = (char *)psz;
-        cfg->value.psz = (psz != NULL) ? strdup (cfg->orig.psz) : NULL;
+        cfg->value.psz = cfg->orig.psz;
 
         if (cfg->list_count)
             cfg->list.psz = xmalloc (cfg->list_count * sizeof (char *));
         for (unsigned i = 0; i < cfg->list_count; i++)
         {
             LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
-                goto error;
+            if (cfg->list.psz[i] == NULL) /* NULL -> empty string */
+                cfg->list.psz[i] = "";
         }
     }
     else
@@ -224,62 +224,103 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
         LOAD_ARRAY(cfg->list.i, cfg->list_count);
     }
 
-    cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
+    if (cfg->list_count)
+        cfg->list_text = xmalloc (cfg->list_count * sizeof (char *));
     for (unsigned i = 0; i < cfg->list_count; i++)
     {
         LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
-            goto error;
+        if (cfg->list_text[i] == NULL) /* NULL -> empty string */
+            cfg->list_text[i] = "";
     }
 
     return 0;
 error:
-    return -1; /* FIXME: leaks */
+    return -1; /* the caller frees the item */
 }
 
 static int vlc_cache_load_plugin_config(vlc_plugin_t *plugin, block_t *file)
 {
-    uint16_t lines;
+    uint16_t lines, count, booleans;
+    uint32_t size;
+    const char *names;
+    const unsigned char *items;
 
-    /* Calculate the structure length */
     LOAD_IMMEDIATE (lines);
+    LOAD_IMMEDIATE (count);
+    LOAD_IMMEDIATE (booleans);
+    if (count > lines || booleans > count)
+        goto error;
+
+    /* Item names, so that they can be indexed without loading the items */
+    LOAD_IMMEDIATE (size);
+    LOAD_ARRAY (names, size);
 
-    /* Allocate memory */
-    if (lines)
+    for (size_t i = 0, offset = 0; i < lines; i++)
     {
-        plugin->conf.items = calloc(sizeof (module_config_t), lines);
-        if (unlikely(plugin->conf.items == NULL))
-        {
-            plugin->conf.size = 0;
-            return -1;
-        }
+        if (offset >= size)
+            goto error;
+
+        const char *end = memchr(names + offset, '\0', size - offset);
+        if (end == NULL)
+            goto error;
+        offset = end + 1 - names;
     }
-    else
-        plugin->conf.items = NULL;
+
+    /* The items themselves are only loaded when first used */
+    LOAD_IMMEDIATE (size);
+    LOAD_ARRAY (items, size);
 
     plugin->conf.size = lines;
+    plugin->conf.count = count;
+    plugin->conf.booleans = booleans;
+    if (lines > 0)
+    {
+        plugin->conf.names = names;
+        plugin->conf.cache = items;
+        plugin->conf.cache_size = size;
+    }
+    return 0;
+error:
+    return -1;
+}
+
+/**
+ * Loads the configuration items of a plugin from the plugins cache.
+ *
+ * The items are deserialized in place from the memory-mapped cache, on first
+ * use rather than when the cache is loaded. See vlc_plugin_config().
+ */
+module_config_t *vlc_cache_load_config_items(vlc_plugin_t *plugin)
+{
+    size_t lines = plugin->conf.size;
+    block_t block, *file = &block;
+
+    assert(lines > 0 && plugin->conf.cache != NULL);
+    block_Init(file, NULL, (void *)plugin->conf.cache,
+               plugin->conf.cache_size);
+
+    module_config_t *items = calloc(lines, sizeof (*items));
+    if (unlikely(items == NULL))
+        return NULL;
 
-    /* Do the duplication job */
     for (size_t i = 0; i < lines; i++)
     {
-        module_config_t *item = plugin->conf.items + i;
+        module_config_t *item = items + i;
 
         if (vlc_cache_load_config(item, file))
-            return -1;
-
-        if (CONFIG_ITEM(item->i_type))
         {
-            plugin->conf.count++;
-            if (item->i_type == CONFIG_ITEM_BOOL)
-                plugin->conf.booleans++;
+            config_Free(items, i + 1);
+            return NULL;
         }
         item->owner = plugin;
     }
 
-    return 0;
-error:
-    return -1; /* FIXME: leaks */
+    if (file->i_buffer != 0)
+    {
+        config_Free(items, lines);
+        return NULL;
+    }
+    return items;
 }
 
 static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
@@ -307,6 +348,12 @@ static int vlc_cache_load_module(vlc_plugin_t *plugin, block_t *file)
     LOAD_STRING(module->deactivate_name);
     LOAD_STRING(module->psz_capability);
     LOAD_IMMEDIATE(module->i_score);
+
+    LOAD_STRING(module->probe_exts);
+    LOAD_STRING(module->probe_mimes);
+    LOAD_IMMEDIATE(module->probe_magic_offset);
+    LOAD_IMMEDIATE(module->probe_magic_size);
+    LOAD_ARRAY(module->probe_magic, module->probe_magic_size);
     return 0;
 error:
     return -1;
@@ -432,7 +479,10 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    /* Keep the plugins in file order: the cache generator and the plugins
+     * scan walk the directory in the same order, so that lookups normally
+     * match the first entry of the list. */
+    vlc_plugin_t *cache = NULL, **tailp = &cache;
 
     while (file->i_buffer > 0)
     {
@@ -448,8 +498,9 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        plugin->next = NULL;
+        *tailp = plugin;
+        tailp = &plugin->next;
     }
 
     file->p_next = *backingp;
@@ -459,7 +510,13 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
 error:
     msg_Warn( p_this, "plugins cache not loaded (corrupted)" );
 
-    /* TODO: cleanup */
+    while (cache != NULL)
+    {
+        vlc_plugin_t *next = cache->next;
+
+        vlc_plugin_destroy(cache);
+        cache = next;
+    }
     block_Release(file);
     return NULL;
 }
@@ -549,16 +606,60 @@ error:
     return -1;
 }
 
-static int CacheSaveModuleConfig(FILE *file, const vlc_plugin_t *plugin)
+static int CacheSaveModuleConfig(FILE *file, vlc_plugin_t *plugin)
 {
     uint16_t lines = plugin->conf.size;
+    uint16_t count = plugin->conf.count;
+    uint16_t booleans = plugin->conf.booleans;
+    const module_config_t *items = vlc_plugin_config(plugin);
+
+    if (lines > 0 && items == NULL)
+        goto error;
 
     SAVE_IMMEDIATE (lines);
+    SAVE_IMMEDIATE (count);
+    SAVE_IMMEDIATE (booleans);
+
+    /* Item names, nul-terminated and empty for hints */
+    uint32_t size = 0;
+
+    for (size_t i = 0; i < lines; i++)
+        if (CONFIG_ITEM(items[i].i_type))
+            size += strlen(items[i].psz_name);
+    size += lines;
+    SAVE_IMMEDIATE (size);
 
     for (size_t i = 0; i < lines; i++)
-        if (CacheSaveConfig(file, plugin->conf.items + i))
+    {
+        const char *name = CONFIG_ITEM(items[i].i_type) ? items[i].psz_name
+                                                        : "";
+        if (fwrite(name, 1, strlen(name) + 1, file) != strlen(name) + 1)
+            goto error;
+    }
+
+    /* Items, after their byte length */
+    long offset = ftell(file);
+    if (offset < 0)
+        goto error;
+
+    size = 0;
+    SAVE_IMMEDIATE (size);
+
+    for (size_t i = 0; i < lines; i++)
+        if (CacheSaveConfig(file, items + i))
            goto error;
 
+    long end = ftell(file);
+    if (end < 0)
+        goto error;
+
+    size = end - offset - sizeof (size);
+    if (fseek(file, offset, SEEK_SET))
+        goto error;
+    SAVE_IMMEDIATE (size);
+    if (fseek(file, end, SEEK_SET))
+        goto error;
+
     return 0;
 error:
     return -1;
@@ -578,6 +679,15 @@ static int CacheSaveModule(FILE *file, const module_t *module)
     SAVE_STRING(module->deactivate_name);
     SAVE_STRING(module->psz_capability);
     SAVE_IMMEDIATE(module->i_score);
+
+    SAVE_STRING(module->probe_exts);
+    SAVE_STRING(module->probe_mimes);
+    SAVE_IMMEDIATE(module->probe_magic_offset);
+    SAVE_IMMEDIATE(module->probe_magic_size);
+    if (module->probe_magic_size > 0
+     && fwrite(module->probe_magic, 1, module->probe_magic_size, file)
+         != module->probe_magic_size)
+        goto error;
     return 0;
 error:
     return -1;
@@ -608,7 +718,7 @@ static int CacheSaveBank(FILE *file, vlc_plugin_t *const *cache, size_t n)
 
     for (size_t i = 0; i < n; i++)
     {
-        const vlc_plugin_t *plugin = cache[i];
+        vlc_plugin_t *plugin = cache[i];
         uint32_t count = plugin->modules_count;
 
         SAVE_IMMEDIATE(count);
@@ -69,6 +69,11 @@ module_t *vlc_module_create(vlc_plugin_t *plugin)
     module->i_shortcuts = 0;
     module->psz_capability = NULL;
     module->i_score = (parent != NULL) ? parent->i_score : 1;
+    module->probe_exts = NULL;
+    module->probe_mimes = NULL;
+    module->probe_magic = NULL;
+    module->probe_magic_offset = 0;
+    module->probe_magic_size = 0;
     module->activate_name = NULL;
     module->deactivate_name = NULL;
     module->pf_activate = NULL;
@@ -99,11 +104,14 @@ vlc_plugin_t *vlc_plugin_create(void)
 
     plugin->modules_count = 0;
     plugin->textdomain = NULL;
-    plugin->conf.items = NULL;
+    atomic_init(&plugin->conf.items, NULL);
     plugin->conf.size = 0;
     plugin->conf.count = 0;
     plugin->conf.booleans = 0;
 #ifdef HAVE_DYNAMIC_PLUGINS
+    plugin->conf.names = NULL;
+    plugin->conf.cache = NULL;
+    plugin->conf.cache_size = 0;
     plugin->abspath = NULL;
     plugin->unloadable = true;
     atomic_init(&plugin->handle, 0);
@@ -130,7 +138,10 @@ void vlc_plugin_destroy(vlc_plugin_t *plugin)
     if (plugin->module != NULL)
         vlc_module_destroy(plugin->module);
 
-    config_Free(plugin->conf.items, plugin->conf.size);
+    module_config_t *items = atomic_load_explicit(&plugin->conf.items,
+                                                  memory_order_relaxed);
+    if (items != NULL)
+        config_Free(items, plugin->conf.size);
 #ifdef HAVE_DYNAMIC_PLUGINS
     free(plugin->abspath);
     free(plugin->path);
@@ -138,10 +149,38 @@ void vlc_plugin_destroy(vlc_plugin_t *plugin)
     free(plugin);
 }
 
+module_config_t *vlc_plugin_config(vlc_plugin_t *plugin)
+{
+    module_config_t *items = atomic_load_explicit(&plugin->conf.items,
+                                                  memory_order_acquire);
+#ifdef HAVE_DYNAMIC_PLUGINS
+    if (items == NULL && plugin->conf.size > 0)
+    {
+        static vlc_mutex_t lock = VLC_STATIC_MUTEX;
+
+        vlc_mutex_lock(&lock);
+        items = atomic_load_explicit(&plugin->conf.items,
+                                     memory_order_relaxed);
+        if (items == NULL && plugin->conf.cache != NULL)
+        {
+            items = vlc_cache_load_config_items(plugin);
+            if (items != NULL)
+                atomic_store_explicit(&plugin->conf.items, items,
+                                      memory_order_release);
+            else /* corrupted cache: do not try again */
+                plugin->conf.cache = NULL;
+        }
+        vlc_mutex_unlock(&lock);
+    }
+#endif
+    return items;
+}
+
 static module_config_t *vlc_config_create(vlc_plugin_t *plugin, int type)
 {
     unsigned confsize = plugin->conf.size;
-    module_config_t *tab = plugin->conf.items;
+    module_config_t *tab = atomic_load_explicit(&plugin->conf.items,
+                                                memory_order_relaxed);
 
     if ((confsize & 0xf) == 0)
     {
@@ -149,7 +188,7 @@ static module_config_t *vlc_config_create(vlc_plugin_t *plugin, int type)
         if (tab == NULL)
             return NULL;
 
-        plugin->conf.items = tab;
+        atomic_store_explicit(&plugin->conf.items, tab, memory_order_relaxed);
     }
 
     memset (tab + confsize, 0, sizeof (tab[confsize]));
@@ -277,6 +316,31 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             module->deactivate = va_arg(ap, void (*)(vlc_object_t *));
             break;
 
+        case VLC_MODULE_PROBE_EXTENSIONS:
+            module->probe_exts = va_arg (ap, const char *);
+            break;
+
+        case VLC_MODULE_PROBE_MIME_TYPES:
+            module->probe_mimes = va_arg (ap, const char *);
+            break;
+
+        case VLC_MODULE_PROBE_MAGIC:
+        {
+            unsigned offset = va_arg (ap, unsigned);
+            unsigned size = va_arg (ap, unsigned);
+            const char *magic = va_arg (ap, const char *);
+
+            if (offset > UINT16_MAX || size == 0 || size > UINT16_MAX)
+            {
+                ret = -1;
+                break;
+            }
+            module->probe_magic = magic;
+            module->probe_magic_offset = offset;
+            module->probe_magic_size = size;
+            break;
+        }
+
         case VLC_MODULE_NO_UNLOAD:
 #ifdef HAVE_DYNAMIC_PLUGINS
             plugin->unloadable = false;
@@ -341,8 +405,8 @@ static int vlc_plugin_desc_cb(void *ctx, void *tgt, int propid, ...)
             if (IsConfigStringType (item->i_type))
             {
                 const char *value = va_arg (ap, const char *);
-                item->value.psz = value ? strdup (value) : NULL;
                 item->orig.psz = (char *)value;
+                item->value.psz = item->orig.psz;
             }
             break;
         }
@@ -126,29 +126,91 @@ static int module_load(vlc_logger_t *log, module_t *m,
     return ret;
 }
 
+static bool module_match_list(const char *list, const char *value)
+{
+    size_t len = strlen(value);
+
+    while (*list)
+    {
+        size_t n = strcspn(list, ",");
+
+        if (n == len && strncasecmp(list, value, len) == 0)
+            return true;
+        list += n;
+        list += strspn(list, ",");
+    }
+    return false;
+}
+
 /**
- * Finds and instantiates the best module of a certain type.
- * All candidates modules having the specified capability and name will be
- * sorted in decreasing order of priority. Then the probe callback will be
- * invoked for each module, until it succeeds (returns 0), or all candidate
- * module failed to initialize.
- *
- * The probe callback first parameter is the address of the module entry point.
- * Further parameters are passed as an argument list; it corresponds to the
- * variable arguments passed to this function. This scheme is meant to
- * support arbitrary prototypes for the module entry point.
- *
- * \param log logger (or NULL to ignore)
- * \param capability capability, i.e. class of module
- * \param name name of the module asked, if any
- * \param strict if true, do not fallback to plugin with a different name
- *                 but the same capability
- * \param probe module probe callback
- * \return the module or NULL in case of a failure
+ * Checks whether the probing hints of a module match.
  */
-module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
-                            const char *name, bool strict,
-                            vlc_activate_t probe, ...)
+static bool module_match_hint(const module_t *m,
+                              const struct vlc_module_hint *hint)
+{
+    if (hint == NULL || (m->probe_exts == NULL && m->probe_mimes == NULL
+                      && m->probe_magic == NULL))
+        return true;
+
+    if (m->probe_exts != NULL)
+    {
+        /* No extension to tell: let the module decide. */
+        if (hint->extension == NULL)
+            return true;
+        if (module_match_list(m->probe_exts, hint->extension))
+            return true;
+    }
+
+    if (m->probe_mimes != NULL && hint->mime != NULL
+     && module_match_list(m->probe_mimes, hint->mime))
+        return true;
+
+    if (m->probe_magic != NULL)
+    {
+        size_t end = m->probe_magic_offset + m->probe_magic_size;
+
+        /* Not enough data to tell: let the module decide. */
+        if (hint->peek == NULL || hint->peek_size < end)
+            return true;
+        return memcmp(hint->peek + m->probe_magic_offset, m->probe_magic,
+                      m->probe_magic_size) == 0;
+    }
+    return false;
+}
+
+/* Probes taking longer than this are reported */
+#define MODULE_SLOW_PROBE VLC_TICK_FROM_MS(50)
+
+struct module_probe_stats
+{
+    unsigned probed; /**< Number of probed modules */
+    unsigned skipped; /**< Number of modules skipped by hints */
+    vlc_tick_t slowest; /**< Duration of the slowest probe */
+    const module_t *slowest_module; /**< Slowest probed module */
+};
+
+static int module_probe(vlc_logger_t *log, module_t *m, vlc_activate_t init,
+                        bool forced, va_list args,
+                        struct module_probe_stats *stats)
+{
+    vlc_tick_t start = vlc_tick_now();
+    int ret = module_load(log, m, init, forced, args);
+    vlc_tick_t duration = vlc_tick_now() - start;
+
+    stats->probed++;
+    if (stats->slowest_module == NULL || duration > stats->slowest)
+    {
+        stats->slowest = duration;
+        stats->slowest_module = m;
+    }
+    return ret;
+}
+
+static module_t *vlc_module_load_va(struct vlc_logger *log,
+                                    const char *capability, const char *name,
+                                    bool strict,
+                                    const struct vlc_module_hint *hint,
+                                    vlc_activate_t probe, va_list args)
 {
     if (name == NULL || name[0] == '\0')
         name = "any";
@@ -167,9 +229,9 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
     }
 
     module_t *module = NULL;
-    va_list args;
+    struct module_probe_stats stats = { 0, 0, 0, NULL };
+    vlc_tick_t start = vlc_tick_now();
 
-    va_start(args, probe);
     while (*name)
     {
         const char *shortcut = name;
@@ -191,7 +253,13 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
                 continue;
             mods[i] = NULL; // only try each module once at most...
 
-            int ret = module_load(log, cand, probe, force, args);
+            if (!force && !module_match_hint(cand, hint))
+            {
+                stats.skipped++;
+                continue;
+            }
+
+            int ret = module_probe(log, cand, probe, force, args, &stats);
             switch (ret)
             {
                 case VLC_SUCCESS:
@@ -212,7 +280,13 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
             if (cand == NULL || module_get_score (cand) <= 0)
                 continue;
 
-            int ret = module_load(log, cand, probe, false, args);
+            if (!module_match_hint(cand, hint))
+            {
+                stats.skipped++;
+                continue;
+            }
+
+            int ret = module_probe(log, cand, probe, false, args, &stats);
             switch (ret)
             {
                 case VLC_SUCCESS:
@@ -224,9 +298,17 @@ module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
         }
     }
 done:
-    va_end (args);
     module_list_free (mods);
 
+    /* Only report the probes that hints pruned or that took long */
+    if (stats.probed > 0
+     && (stats.skipped > 0 || stats.slowest >= MODULE_SLOW_PROBE))
+        vlc_debug(log, "%s probing took %"PRId64" us: %u probed, "
+                  "%u skipped, slowest \"%s\" (%"PRId64" us)", capability,
+                  US_FROM_VLC_TICK(vlc_tick_now() - start), stats.probed,
+                  stats.skipped, module_get_object(stats.slowest_module),
+                  US_FROM_VLC_TICK(stats.slowest));
+
     if (module != NULL)
         vlc_debug(log, "using %s module \"%s\"", capability,
                   module_get_object (module));
@@ -235,6 +317,54 @@ done:
     return module;
 }
 
+/**
+ * Finds and instantiates the best module of a certain type.
+ * All candidates modules having the specified capability and name will be
+ * sorted in decreasing order of priority. Then the probe callback will be
+ * invoked for each module, until it succeeds (returns 0), or all candidate
+ * module failed to initialize.
+ *
+ * The probe callback first parameter is the address of the module entry point.
+ * Further parameters are passed as an argument list; it corresponds to the
+ * variable arguments passed to this function. This scheme is meant to
+ * support arbitrary prototypes for the module entry point.
+ *
+ * \param log logger (or NULL to ignore)
+ * \param capability capability, i.e. class of module
+ * \param name name of the module asked, if any
+ * \param strict if true, do not fallback to plugin with a different name
+ *                 but the same capability
+ * \param probe module probe callback
+ * \return the module or NULL in case of a failure
+ */
+module_t *(vlc_module_load)(struct vlc_logger *log, const char *capability,
+                            const char *name, bool strict,
+                            vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_load_va(log, capability, name, strict, NULL,
+                                          probe, args);
+    va_end(args);
+    return module;
+}
+
+module_t *(vlc_module_load_hinted)(struct vlc_logger *log,
+                                   const char *capability, const char *name,
+                                   bool strict,
+                                   const struct vlc_module_hint *hint,
+                                   vlc_activate_t probe, ...)
+{
+    va_list args;
+
+    va_start(args, probe);
+    module_t *module = vlc_module_load_va(log, capability, name, strict, hint,
+                                          probe, args);
+    va_end(args);
+    return module;
+}
+
 static int generic_start(void *func, bool forced, va_list ap)
 {
     vlc_object_t *obj = va_arg(ap, vlc_object_t *);
@@ -306,7 +436,7 @@ bool module_exists (const char * psz_name)
 
 module_config_t *module_config_get( const module_t *module, unsigned *restrict psize )
 {
-    const vlc_plugin_t *plugin = module->plugin;
+    vlc_plugin_t *plugin = module->plugin;
 
     if (plugin->module != module)
     {   /* For backward compatibility, pretend non-first modules have no
@@ -325,9 +455,13 @@ module_config_t *module_config_get( const module_t *module, unsigned *restrict p
     if( !config )
         return NULL;
 
+    const module_config_t *items = vlc_plugin_config(plugin);
+    if (items == NULL)
+        size = 0;
+
     for( i = 0, j = 0; i < size; i++ )
     {
-        const module_config_t *item = plugin->conf.items + i;
+        const module_config_t *item = items + i;
         if( item->b_internal /* internal option */
          || item->b_removed /* removed option */ )
             continue;
@@ -39,10 +39,18 @@ typedef struct vlc_plugin_t
      */
     struct
     {
-        module_config_t *items; /**< Table of configuration parameters */
+        /** Table of configuration parameters (use vlc_plugin_config()) */
+        _Atomic(module_config_t *) items;
         size_t size; /**< Size of items table */
         size_t count; /**< Number of configuration items */
         size_t booleans; /**< Number of booleal config items */
+#ifdef HAVE_DYNAMIC_PLUGINS
+        /** Names of the items from the plugins cache, each nul-terminated
+         * and empty for hints, before the items are loaded (or NULL) */
+        const char *names;
+        const void *cache; /**< Serialized items not loaded yet (or NULL) */
+        size_t cache_size; /**< Byte length of the serialized items */
+#endif
     } conf;
 
 #ifdef HAVE_DYNAMIC_PLUGINS
@@ -91,6 +99,13 @@ struct module_t
     const char *psz_capability;                              /**< Capability */
     int      i_score;                          /**< Score for the capability */
 
+    /* Probing hints */
+    const char *probe_exts; /**< Comma-separated file extensions (or NULL) */
+    const char *probe_mimes; /**< Comma-separated MIME types (or NULL) */
+    const char *probe_magic; /**< Magic number (or NULL) */
+    uint16_t probe_magic_offset; /**< Byte offset of the magic number */
+    uint16_t probe_magic_size; /**< Byte length of the magic number */
+
     /* Callbacks */
     const char *activate_name;
     const char *deactivate_name;
@@ -100,6 +115,17 @@ struct module_t
 
 vlc_plugin_t *vlc_plugin_create(void);
 void vlc_plugin_destroy(vlc_plugin_t *);
+
+/**
+ * Gets the configuration items of a plug-in.
+ *
+ * The items of a plug-in from the plugins cache are only deserialized when
+ * first needed, e.g. when one of its options is looked up.
+ *
+ * eturn the table of plugin->conf.size items,
+ *         or NULL if there are none or they could not be loaded
+ */
+module_config_t *vlc_plugin_config(vlc_plugin_t *);
 module_t *vlc_module_create(vlc_plugin_t *);
 void vlc_module_destroy (module_t *);
 
@@ -164,6 +190,7 @@ char *vlc_dlerror(void) VLC_USED;
 /* Plugins cache */
 vlc_plugin_t *vlc_cache_load(vlc_object_t *, const char *, block_t **);
 vlc_plugin_t *vlc_cache_lookup(vlc_plugin_t **, const char *relpath);
+module_config_t *vlc_cache_load_config_items(vlc_plugin_t *);
 
 void CacheSave(vlc_object_t *, const char *, vlc_plugin_t *const *, size_t);
 
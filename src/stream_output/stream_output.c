@@ -490,6 +490,12 @@ sout_input_t *sout_MuxAddStream( sout_mux_t *p_mux, const es_format_t *p_fmt )
     p_input->p_fmt = &p_input->fmt;
 
     p_input->p_fifo = block_FifoNew();
+    if( unlikely(p_input->p_fifo == NULL) )
+    {
+        es_format_Clean( &p_input->fmt );
+        free( p_input );
+        return NULL;
+    }
     p_input->p_sys  = NULL;
 
     TAB_APPEND( p_mux->i_nb_inputs, p_mux->pp_inputs, p_input );
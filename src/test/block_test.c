@@ -23,6 +23,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #undef NDEBUG
 #include <assert.h>
@@ -86,11 +87,107 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void *test_block_cache_release (void *data)
+{
+    block_ChainRelease (data);
+    return NULL;
+}
+
+static void test_block_cache (void)
+{
+    static const size_t sizes[] = { 0, 188, 1316, 4000, 65507, 200000, 1 << 20 };
+    const char *env = getenv ("VLC_BLOCK_CACHE");
+    const bool enabled = env == NULL || atoi (env) != 0;
+    struct vlc_block_stats before, after;
+    block_t *chain = NULL;
+
+    /* Size classes waste at most a quarter of the allocation */
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        block_t *block = block_Alloc (sizes[i]);
+        assert (block != NULL);
+        assert (block->i_size <= sizes[i] + sizes[i] / 4 + 1024);
+        block_Release (block);
+    }
+
+    block_GetStats (&before);
+
+    /* Recycle blocks of various sizes within the same thread */
+    for (int round = 0; round < 100; round++)
+        for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+        {
+            block_t *block = block_Alloc (sizes[i]);
+            assert (block != NULL);
+            assert (block->i_buffer == sizes[i]);
+            assert (((uintptr_t)block->p_buffer % 32) == 0);
+            memset (block->p_buffer, round, block->i_buffer);
+            block_Release (block);
+        }
+
+    block_GetStats (&after);
+    assert (after.oversized == before.oversized + 100);
+    if (enabled)
+    {   /* The blocks freed above are reused. */
+        assert (after.hits == before.hits + 100 * (ARRAY_SIZE(sizes) - 1));
+        assert (after.misses == before.misses);
+
+        block_t *block = block_Alloc (4000);
+        assert (block != NULL);
+        void *buf = block->p_buffer;
+        block_Release (block);
+        block = block_Alloc (4000);
+        assert (block != NULL);
+        assert (block->p_buffer == buf);
+        block_Release (block);
+    }
+
+    /* Release blocks from another thread */
+    for (int i = 0; i < 1000; i++)
+    {
+        block_t *block = block_Alloc (188);
+        assert (block != NULL);
+        memset (block->p_buffer, 0x47, 188);
+        block->p_next = chain;
+        chain = block;
+    }
+
+    vlc_thread_t th;
+    int ret = vlc_clone (&th, test_block_cache_release, chain,
+                         VLC_THREAD_PRIORITY_LOW);
+    assert (ret == 0);
+    vlc_join (th, NULL);
+
+    /* The exited thread returned the blocks to the depot... */
+    block_GetStats (&before);
+    if (enabled)
+        assert (before.cached >= 1000 * 188);
+
+    /* ...where this thread gets them back. */
+    chain = NULL;
+    for (int i = 0; i < 1000; i++)
+    {
+        block_t *block = block_Alloc (188);
+        assert (block != NULL);
+        block->p_next = chain;
+        chain = block;
+    }
+
+    block_GetStats (&after);
+    if (enabled)
+    {
+        assert (after.hits == before.hits + 1000);
+        assert (after.misses == before.misses);
+        assert (after.cached < before.cached);
+    }
+    block_ChainRelease (chain);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_cache ();
     return 0;
 }
 
@@ -0,0 +1,222 @@
+/*****************************************************************************
+ * fifo.c: Test for block FIFO
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+
+#define BLOCKS 100000
+
+static block_t *test_block_New(unsigned seq)
+{
+    block_t *block = block_Alloc(1 + (seq % 7));
+
+    assert(block != NULL);
+    block->i_dts = seq;
+    return block;
+}
+
+static void test_fifo_Basic(bool lockless)
+{
+    block_fifo_t *fifo = block_FifoNew();
+
+    assert(fifo != NULL);
+    if (lockless)
+        vlc_fifo_EnableLockless(fifo);
+
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_IsEmpty(fifo));
+    vlc_fifo_Unlock(fifo);
+
+    /* Mix locked and lock-less queuing, including chains */
+    block_FifoPut(fifo, test_block_New(0));
+    if (lockless)
+    {
+        block_t *chain = test_block_New(1);
+
+        chain->p_next = test_block_New(2);
+        vlc_fifo_QueueLockless(fifo, chain);
+        assert(vlc_fifo_GetCount(fifo) == 3);
+        assert(vlc_fifo_GetBytes(fifo) == 1 + 2 + 3);
+    }
+    else
+    {
+        block_FifoPut(fifo, test_block_New(1));
+        block_FifoPut(fifo, test_block_New(2));
+    }
+    block_FifoPut(fifo, test_block_New(3));
+
+    assert(block_FifoShow(fifo)->i_dts == 0);
+
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_GetCount(fifo) == 4);
+    assert(vlc_fifo_GetBytes(fifo) == 1 + 2 + 3 + 4);
+    for (unsigned i = 0; i < 2; i++)
+    {
+        block_t *block = vlc_fifo_DequeueUnlocked(fifo);
+
+        assert(block->i_dts == i);
+        block_Release(block);
+    }
+    assert(vlc_fifo_GetCount(fifo) == 2);
+    assert(vlc_fifo_GetBytes(fifo) == 3 + 4);
+    vlc_fifo_Unlock(fifo);
+
+    block_FifoEmpty(fifo);
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_IsEmpty(fifo));
+    assert(vlc_fifo_GetBytes(fifo) == 0);
+    vlc_fifo_Unlock(fifo);
+
+    if (lockless)
+    {   /* More blocks than the ring holds, without consumer */
+        for (unsigned i = 0; i < 1000; i++)
+            vlc_fifo_QueueLockless(fifo, test_block_New(i));
+        assert(vlc_fifo_GetCount(fifo) == 1000);
+
+        vlc_fifo_Lock(fifo);
+        for (unsigned i = 0; i < 1000; i++)
+        {
+            block_t *block = vlc_fifo_DequeueUnlocked(fifo);
+
+            assert(block != NULL && block->i_dts == i);
+            block_Release(block);
+        }
+        assert(vlc_fifo_DequeueUnlocked(fifo) == NULL);
+        assert(vlc_fifo_IsEmpty(fifo));
+        vlc_fifo_Unlock(fifo);
+    }
+
+    if (lockless)   /* Blocks left in the FIFO are released */
+        vlc_fifo_QueueLockless(fifo, test_block_New(4));
+    block_FifoRelease(fifo);
+}
+
+static void *test_fifo_Producer(void *data)
+{
+    block_fifo_t *fifo = data;
+
+    for (unsigned i = 0; i < BLOCKS; i++)
+    {
+        block_t *block = test_block_New(i);
+
+        if (i % 100 == 0)
+            block_FifoPut(fifo, block);
+        else
+            vlc_fifo_QueueLockless(fifo, block);
+    }
+    return NULL;
+}
+
+static void test_fifo_Threads(void)
+{
+    block_fifo_t *fifo = block_FifoNew();
+    vlc_thread_t th;
+
+    assert(fifo != NULL);
+    vlc_fifo_EnableLockless(fifo);
+
+    int ret = vlc_clone(&th, test_fifo_Producer, fifo,
+                        VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+
+    for (unsigned i = 0; i < BLOCKS; i++)
+    {
+        block_t *block;
+
+        if (i % 3 == 0)
+        {   /* Blocks still being queued must be waited for. */
+            block = block_FifoGet(fifo);
+            assert(block != NULL);
+        }
+        else if (i % 3 == 1)
+        {   /* Waiting for the FIFO not to be empty must be woken up too. */
+            vlc_fifo_Lock(fifo);
+            while (vlc_fifo_IsEmpty(fifo))
+                vlc_fifo_Wait(fifo);
+            while ((block = vlc_fifo_DequeueUnlocked(fifo)) == NULL)
+                vlc_fifo_Wait(fifo);
+            vlc_fifo_Unlock(fifo);
+        }
+        else
+        {
+            vlc_fifo_Lock(fifo);
+            while ((block = vlc_fifo_DequeueUnlocked(fifo)) == NULL)
+                vlc_fifo_Wait(fifo);
+            vlc_fifo_Unlock(fifo);
+        }
+
+        assert(block->i_dts == i);
+        block_Release(block);
+    }
+
+    vlc_fifo_Lock(fifo);
+    assert(vlc_fifo_IsEmpty(fifo));
+    vlc_fifo_Unlock(fifo);
+
+    vlc_join(th, NULL);
+    block_FifoRelease(fifo);
+}
+
+static void *test_fifo_Waiter(void *data)
+{
+    block_fifo_t *fifo = data;
+
+    vlc_fifo_Lock(fifo);
+    while (vlc_fifo_IsEmpty(fifo))
+        vlc_fifo_Wait(fifo);
+    vlc_fifo_Unlock(fifo);
+    return NULL;
+}
+
+static void test_fifo_Wakeup(void)
+{
+    block_fifo_t *fifo = block_FifoNew();
+    vlc_thread_t th;
+
+    assert(fifo != NULL);
+    vlc_fifo_EnableLockless(fifo);
+
+    int ret = vlc_clone(&th, test_fifo_Waiter, fifo,
+                        VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+
+    /* Most likely queued while the consumer waits, without having dequeued */
+    vlc_tick_sleep(VLC_TICK_FROM_MS(10));
+    vlc_fifo_QueueLockless(fifo, test_block_New(0));
+
+    vlc_join(th, NULL);
+    block_FifoRelease(fifo);
+}
+
+int main(void)
+{
+    test_fifo_Basic(false);
+    test_fifo_Basic(true);
+    test_fifo_Threads();
+    test_fifo_Wakeup();
+    return 0;
+}
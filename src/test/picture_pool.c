@@ -52,8 +52,7 @@ static void test(bool zombie)
     for (unsigned i = 0; i < PICTURES; i++)
         assert(picture_pool_Get(pool) == NULL);
 
-    // Reserve currently assumes that all pictures are free (or reserved).
-    //assert(picture_pool_Reserve(pool, 1) == NULL);
+    assert(picture_pool_Reserve(pool, 1) == NULL);
 
     for (unsigned i = 0; i < PICTURES / 2; i++)
         picture_Hold(pics[i]);
@@ -108,6 +107,97 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static void test_large(void)
+{
+    const unsigned count = 200;
+    picture_t *pics[200];
+    struct picture_pool_stats stats;
+
+    pool = picture_pool_NewFromFormat(&fmt, count);
+    assert(pool != NULL);
+    assert(picture_pool_GetSize(pool) == count);
+
+    for (unsigned i = 0; i < count; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+        for (unsigned j = 0; j < i; j++)
+            assert(pics[i]->p[0].p_pixels != pics[j]->p[0].p_pixels);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.size == count);
+    assert(stats.in_use == count);
+    assert(stats.peak == count);
+    assert(stats.gets == count + 1);
+    assert(stats.misses == 1);
+    assert(stats.waits == 0);
+
+    for (unsigned i = 0; i < count; i++)
+        picture_Release(pics[i]);
+
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.in_use == 0);
+    assert(stats.peak == count);
+
+    /* Reserved pictures count as used in the master pool. */
+    reserve = picture_pool_Reserve(pool, count - 1);
+    assert(reserve != NULL);
+    assert(picture_pool_Reserve(pool, 2) == NULL);
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.in_use == count - 1);
+
+    pics[0] = picture_pool_Get(reserve);
+    assert(pics[0] != NULL);
+    picture_pool_Release(reserve);
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.in_use == count - 1);
+    picture_Release(pics[0]);
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.in_use == 0);
+
+    picture_pool_Release(pool);
+}
+
+#define THREADS 4
+#define ITERATIONS 10000
+
+static void *test_thread(void *data)
+{
+    picture_pool_t *p = data;
+
+    for (unsigned i = 0; i < ITERATIONS; i++) {
+        picture_t *pic = (i & 1) ? picture_pool_Wait(p) : picture_pool_Get(p);
+
+        if (pic != NULL)
+            picture_Release(pic);
+    }
+    return NULL;
+}
+
+static void test_threads(void)
+{
+    vlc_thread_t threads[THREADS];
+    struct picture_pool_stats stats;
+
+    /* Fewer pictures than threads, so that threads have to wait. */
+    pool = picture_pool_NewFromFormat(&fmt, THREADS / 2);
+    assert(pool != NULL);
+
+    for (unsigned i = 0; i < THREADS; i++)
+        assert(vlc_clone(&threads[i], test_thread, pool,
+                         VLC_THREAD_PRIORITY_LOW) == 0);
+    for (unsigned i = 0; i < THREADS; i++)
+        vlc_join(threads[i], NULL);
+
+    picture_pool_GetStats(pool, &stats);
+    assert(stats.in_use == 0);
+    assert(stats.peak <= THREADS / 2);
+    assert(stats.gets == THREADS * ITERATIONS);
+
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -124,6 +214,8 @@ int main(void)
 
     test(false);
     test(true);
+    test_large();
+    test_threads();
 
     return 0;
 }
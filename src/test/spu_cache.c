@@ -0,0 +1,261 @@
+/*****************************************************************************
+ * spu_cache.c: Test for the rendered text regions cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_subpicture.h>
+#include <vlc_text_style.h>
+
+#include "../video_output/spu_cache.h"
+#include "../misc/subpicture.h"
+
+const char vlc_module_name[] = "test_spu_cache";
+
+static const vlc_fourcc_t chroma_list[] = {
+    VLC_CODEC_YUVA, VLC_CODEC_RGBA, 0,
+};
+
+/* Default freetype settings */
+static spu_cache_settings_t settings = {
+    .text_scale = 100,
+    .color = 0xffffff,
+    .background_opacity = 0,
+    .background_color = 0,
+};
+
+static subpicture_region_t *NewTextRegion(const char *str, int font_size)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_TEXT);
+    subpicture_region_t *region = subpicture_region_New(&fmt);
+    assert(region != NULL);
+
+    region->p_text = text_segment_New(str);
+    assert(region->p_text != NULL);
+    region->p_text->style = text_style_Create(STYLE_NO_DEFAULTS);
+    assert(region->p_text->style != NULL);
+    region->p_text->style->i_font_size = font_size;
+    region->i_align = SUBPICTURE_ALIGN_BOTTOM;
+    return region;
+}
+
+/**
+ * Gets a text region through the cache, as the SPU renderer does.
+ *
+ * \return the rendered picture, and whether it came from the cache
+ */
+static picture_t *Render(spu_cache_t *cache, const char *str, int font_size,
+                         unsigned width, bool *hit)
+{
+    subpicture_region_t *region = NewTextRegion(str, font_size);
+    spu_cache_key_t key;
+
+    assert(spu_cache_Key(&key, width, width * 9 / 16, &settings, region,
+                         chroma_list) == VLC_SUCCESS);
+
+    *hit = spu_cache_Load(cache, &key, region) == VLC_SUCCESS;
+    if (*hit)
+    {
+        free(key.data);
+        assert(region->fmt.i_chroma == VLC_CODEC_RGBA);
+    }
+    else
+    {
+        /* Fake text renderer */
+        assert(region->p_picture == NULL);
+        region->fmt.i_chroma = VLC_CODEC_RGBA;
+        region->fmt.i_width = region->fmt.i_visible_width = 64;
+        region->fmt.i_height = region->fmt.i_visible_height = 16;
+        region->p_picture = picture_NewFromFormat(&region->fmt);
+        assert(region->p_picture != NULL);
+        region->i_x = 7;
+        spu_cache_Store(cache, &key, region);
+    }
+    assert(region->i_x == 7);
+    assert(region->i_align == SUBPICTURE_ALIGN_BOTTOM);
+
+    picture_t *pic = picture_Hold(region->p_picture);
+    subpicture_region_Delete(region);
+    return pic;
+}
+
+/* Checks that a region is, or is not, cached, and returns its picture */
+static picture_t *Check(spu_cache_t *cache, const char *str, int font_size,
+                        unsigned width, bool cached)
+{
+    const unsigned hits = cache->hits, misses = cache->misses;
+    bool hit;
+    picture_t *pic = Render(cache, str, font_size, width, &hit);
+
+    assert(hit == cached);
+    assert(cache->hits == hits + cached);
+    assert(cache->misses == misses + !cached);
+    return pic;
+}
+
+static void test_lookup(void)
+{
+    spu_cache_t cache;
+    spu_cache_Init(&cache);
+
+    picture_t *a = Check(&cache, "Hello", 32, 1280, false);
+
+    /* Identical region */
+    picture_t *b = Check(&cache, "Hello", 32, 1280, true);
+    assert(a == b);
+    picture_Release(b);
+
+    /* Text, style and rendering size changes */
+    picture_Release(Check(&cache, "Hello!", 32, 1280, false));
+    picture_Release(Check(&cache, "Hello", 48, 1280, false));
+    picture_Release(Check(&cache, "Hello", 32, 1920, false));
+    assert(cache.count == 4);
+
+    /* Text renderer settings changed at run time */
+    settings.color = 0xffff00;
+    picture_Release(Check(&cache, "Hello", 32, 1280, false));
+    settings.color = 0xffffff;
+    settings.background_opacity = 128;
+    picture_Release(Check(&cache, "Hello", 32, 1280, false));
+    settings.background_color = 0x0000ff;
+    picture_Release(Check(&cache, "Hello", 32, 1280, false));
+    settings.background_opacity = 0;
+    settings.background_color = 0;
+    assert(cache.count == 7);
+
+    b = Check(&cache, "Hello", 32, 1280, true);
+    assert(a == b);
+    picture_Release(b);
+    picture_Release(a);
+
+    spu_cache_Flush(&cache);
+}
+
+static void test_scaled(void)
+{
+    spu_cache_t cache;
+    spu_cache_Init(&cache);
+
+    picture_t *pic = Check(&cache, "Hello", 32, 1280, false);
+
+    /* Scaled by the SPU renderer after rendering */
+    subpicture_region_t *region = NewTextRegion("Hello", 32);
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_YUVA);
+    fmt.i_width = fmt.i_visible_width = 96;
+    fmt.i_height = fmt.i_visible_height = 24;
+    region->p_picture = picture_Hold(pic);
+    region->p_private = subpicture_region_private_New(&fmt);
+    assert(region->p_private != NULL);
+    region->p_private->p_picture = picture_NewFromFormat(&fmt);
+    assert(region->p_private->p_picture != NULL);
+    spu_cache_StoreScaled(&cache, region);
+
+    /* The scaled picture comes with the cached region. */
+    subpicture_region_t *copy = NewTextRegion("Hello", 32);
+    spu_cache_key_t key;
+
+    assert(spu_cache_Key(&key, 1280, 720, &settings, copy,
+                         chroma_list) == VLC_SUCCESS);
+    assert(spu_cache_Load(&cache, &key, copy) == VLC_SUCCESS);
+    free(key.data);
+    assert(copy->p_picture == pic);
+    assert(copy->p_private != NULL);
+    assert(copy->p_private->p_picture == region->p_private->p_picture);
+    assert(copy->p_private->fmt.i_width == 96);
+
+    subpicture_region_Delete(copy);
+    subpicture_region_Delete(region);
+    picture_Release(pic);
+    spu_cache_Flush(&cache);
+}
+
+static void test_eviction(void)
+{
+    spu_cache_t cache;
+    char str[16];
+
+    spu_cache_Init(&cache);
+    for (unsigned i = 0; i < SPU_CACHE_SIZE; i++)
+    {
+        sprintf(str, "line %u", i);
+        picture_Release(Check(&cache, str, 32, 1280, false));
+    }
+    assert(cache.count == SPU_CACHE_SIZE);
+    for (unsigned i = 0; i < SPU_CACHE_SIZE; i++)
+    {
+        sprintf(str, "line %u", i);
+        picture_Release(Check(&cache, str, 32, 1280, true));
+    }
+
+    /* Use the first entry again: the second one is now the least recently
+     * used, and is evicted by the next one. */
+    picture_Release(Check(&cache, "line 0", 32, 1280, true));
+    sprintf(str, "line %u", SPU_CACHE_SIZE);
+    picture_Release(Check(&cache, str, 32, 1280, false));
+    assert(cache.count == SPU_CACHE_SIZE);
+
+    for (unsigned i = 0; i <= SPU_CACHE_SIZE; i++)
+    {
+        sprintf(str, "line %u", i);
+        if (i != 1)
+            picture_Release(Check(&cache, str, 32, 1280, true));
+    }
+    picture_Release(Check(&cache, "line 1", 32, 1280, false));
+
+    spu_cache_Flush(&cache);
+}
+
+static void test_flush(void)
+{
+    spu_cache_t cache;
+    spu_cache_Init(&cache);
+
+    picture_Release(Check(&cache, "Hello", 32, 1280, false));
+    picture_Release(Check(&cache, "World", 32, 1280, false));
+    picture_Release(Check(&cache, "Hello", 32, 1280, true));
+
+    /* As when the SPU is attached to another input, whose attachments may
+     * provide other fonts */
+    spu_cache_Flush(&cache);
+    assert(cache.count == 0);
+    picture_Release(Check(&cache, "Hello", 32, 1280, false));
+    picture_Release(Check(&cache, "World", 32, 1280, false));
+
+    spu_cache_Flush(&cache);
+}
+
+int main(void)
+{
+    test_lookup();
+    test_scaled();
+    test_eviction();
+    test_flush();
+    return 0;
+}
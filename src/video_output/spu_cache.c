@@ -0,0 +1,283 @@
+/*****************************************************************************
+ * spu_cache.c : cache of rendered text regions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_memstream.h>
+#include <vlc_subpicture.h>
+
+#include "spu_cache.h"
+#include "../misc/subpicture.h"
+
+void spu_cache_Init(spu_cache_t *cache)
+{
+    cache->count = 0;
+    cache->clock = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+static void EntryClean(spu_cache_entry_t *entry)
+{
+    free(entry->key);
+    video_format_Clean(&entry->fmt);
+    picture_Release(entry->picture);
+    if (entry->scaled)
+        subpicture_region_private_Delete(entry->scaled);
+}
+
+void spu_cache_Flush(spu_cache_t *cache)
+{
+    for (size_t i = 0; i < cache->count; i++)
+        EntryClean(&cache->entries[i]);
+    cache->count = 0;
+}
+
+static void WriteString(struct vlc_memstream *ms, const char *str)
+{
+    /* Distinguish NULL from the empty string */
+    vlc_memstream_putc(ms, str != NULL);
+    if (str != NULL)
+        vlc_memstream_write(ms, str, strlen(str) + 1);
+}
+
+#define Write(ms, val) vlc_memstream_write(ms, &(val), sizeof (val))
+
+static void WriteStyle(struct vlc_memstream *ms, const text_style_t *style)
+{
+    vlc_memstream_putc(ms, style != NULL);
+    if (style == NULL)
+        return;
+
+    WriteString(ms, style->psz_fontname);
+    WriteString(ms, style->psz_monofontname);
+    Write(ms, style->i_features);
+    Write(ms, style->i_style_flags);
+    Write(ms, style->f_font_relsize);
+    Write(ms, style->i_font_size);
+    Write(ms, style->i_font_color);
+    Write(ms, style->i_font_alpha);
+    Write(ms, style->i_spacing);
+    Write(ms, style->i_outline_color);
+    Write(ms, style->i_outline_alpha);
+    Write(ms, style->i_outline_width);
+    Write(ms, style->i_shadow_color);
+    Write(ms, style->i_shadow_alpha);
+    Write(ms, style->i_shadow_width);
+    Write(ms, style->i_background_color);
+    Write(ms, style->i_background_alpha);
+    Write(ms, style->e_wrapinfo);
+}
+
+static uint64_t Hash(const char *data, size_t size)
+{
+    /* FNV-1a */
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+int spu_cache_Key(spu_cache_key_t *key, unsigned width, unsigned height,
+                  const spu_cache_settings_t *settings,
+                  const subpicture_region_t *region,
+                  const vlc_fourcc_t *chroma_list)
+{
+    const video_format_t *fmt = &region->fmt;
+    struct vlc_memstream ms;
+
+    if (vlc_memstream_open(&ms))
+        return VLC_ENOMEM;
+
+    Write(&ms, width);
+    Write(&ms, height);
+    Write(&ms, settings->text_scale);
+    Write(&ms, settings->color);
+    Write(&ms, settings->background_opacity);
+    Write(&ms, settings->background_color);
+    for (size_t i = 0; chroma_list[i]; i++)
+        Write(&ms, chroma_list[i]);
+    vlc_memstream_putc(&ms, 0);
+
+    Write(&ms, fmt->i_width);
+    Write(&ms, fmt->i_height);
+    Write(&ms, fmt->i_x_offset);
+    Write(&ms, fmt->i_y_offset);
+    Write(&ms, fmt->i_visible_width);
+    Write(&ms, fmt->i_visible_height);
+    Write(&ms, fmt->i_sar_num);
+    Write(&ms, fmt->i_sar_den);
+    Write(&ms, fmt->transfer);
+    Write(&ms, fmt->primaries);
+    Write(&ms, fmt->space);
+    Write(&ms, fmt->color_range);
+
+    Write(&ms, region->i_x);
+    Write(&ms, region->i_y);
+    Write(&ms, region->i_align);
+    Write(&ms, region->i_text_align);
+    Write(&ms, region->b_noregionbg);
+    Write(&ms, region->b_gridmode);
+    Write(&ms, region->b_balanced_text);
+    Write(&ms, region->i_max_width);
+    Write(&ms, region->i_max_height);
+
+    for (const text_segment_t *s = region->p_text; s != NULL; s = s->p_next)
+    {
+        vlc_memstream_putc(&ms, 1);
+        WriteString(&ms, s->psz_text);
+        WriteStyle(&ms, s->style);
+        for (const text_segment_ruby_t *r = s->p_ruby; r != NULL; r = r->p_next)
+        {
+            vlc_memstream_putc(&ms, 1);
+            WriteString(&ms, r->psz_base);
+            WriteString(&ms, r->psz_rt);
+        }
+        vlc_memstream_putc(&ms, 0);
+    }
+    vlc_memstream_putc(&ms, 0);
+
+    if (vlc_memstream_close(&ms))
+        return VLC_ENOMEM;
+
+    key->data = ms.ptr;
+    key->size = ms.length;
+    key->hash = Hash(ms.ptr, ms.length);
+    return VLC_SUCCESS;
+}
+
+#undef Write
+
+static spu_cache_entry_t *Find(spu_cache_t *cache, const spu_cache_key_t *key)
+{
+    for (size_t i = 0; i < cache->count; i++)
+    {
+        spu_cache_entry_t *entry = &cache->entries[i];
+
+        if (entry->hash == key->hash && entry->key_size == key->size
+         && memcmp(entry->key, key->data, key->size) == 0)
+            return entry;
+    }
+    return NULL;
+}
+
+int spu_cache_Load(spu_cache_t *cache, const spu_cache_key_t *key,
+                   subpicture_region_t *region)
+{
+    spu_cache_entry_t *entry = Find(cache, key);
+    video_format_t fmt;
+
+    assert(region->p_picture == NULL && region->p_private == NULL);
+    if (entry == NULL || video_format_Copy(&fmt, &entry->fmt))
+    {
+        cache->misses++;
+        return VLC_EGENERIC;
+    }
+
+    if (entry->scaled)
+    {
+        region->p_private = subpicture_region_private_New(&entry->scaled->fmt);
+        if (region->p_private)
+            region->p_private->p_picture = picture_Hold(entry->scaled->p_picture);
+    }
+
+    video_format_Clean(&region->fmt);
+    region->fmt       = fmt;
+    region->p_picture = picture_Hold(entry->picture);
+    region->i_x       = entry->x;
+    region->i_y       = entry->y;
+    region->i_align   = entry->align;
+
+    entry->last_use = ++cache->clock;
+    cache->hits++;
+    return VLC_SUCCESS;
+}
+
+void spu_cache_Store(spu_cache_t *cache, spu_cache_key_t *key,
+                     const subpicture_region_t *region)
+{
+    spu_cache_entry_t *entry;
+
+    if (cache->count < SPU_CACHE_SIZE)
+        entry = &cache->entries[cache->count];
+    else
+    {
+        entry = &cache->entries[0];
+        for (size_t i = 1; i < cache->count; i++)
+            if (cache->entries[i].last_use < entry->last_use)
+                entry = &cache->entries[i];
+        EntryClean(entry);
+        cache->count--;
+    }
+
+    if (video_format_Copy(&entry->fmt, &region->fmt))
+    {
+        /* Keep the entries packed */
+        if (entry != &cache->entries[cache->count])
+            *entry = cache->entries[cache->count];
+        free(key->data);
+        return;
+    }
+
+    entry->hash     = key->hash;
+    entry->key      = key->data;
+    entry->key_size = key->size;
+    entry->last_use = ++cache->clock;
+    entry->picture  = picture_Hold(region->p_picture);
+    entry->x        = region->i_x;
+    entry->y        = region->i_y;
+    entry->align    = region->i_align;
+    entry->scaled   = NULL;
+    cache->count++;
+}
+
+void spu_cache_StoreScaled(spu_cache_t *cache,
+                           const subpicture_region_t *region)
+{
+    subpicture_region_private_t *private = region->p_private;
+
+    for (size_t i = 0; i < cache->count; i++)
+    {
+        spu_cache_entry_t *entry = &cache->entries[i];
+
+        if (entry->picture != region->p_picture)
+            continue;
+
+        if (entry->scaled)
+        {
+            if (entry->scaled->p_picture == private->p_picture)
+                break;
+            subpicture_region_private_Delete(entry->scaled);
+        }
+        entry->scaled = subpicture_region_private_New(&private->fmt);
+        if (entry->scaled)
+            entry->scaled->p_picture = picture_Hold(private->p_picture);
+        break;
+    }
+}
@@ -0,0 +1,123 @@
+/*****************************************************************************
+ * spu_cache.h : cache of rendered text regions
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_VOUT_INTERNAL_SPU_CACHE_H
+#define LIBVLC_VOUT_INTERNAL_SPU_CACHE_H
+
+#include <vlc_subpicture.h>
+
+/* Number of rendered text regions kept across subpicture updates */
+#define SPU_CACHE_SIZE 16
+
+/* Rendered text region
+ *
+ * Subpicture updaters recreate their text regions whenever the video size
+ * changes or the text needs refreshing (blinking, scrolling, closed captions
+ * resent as new subpictures), usually with the same text. The entry keeps the
+ * output of the text renderer and the last scaled version of it, so that an
+ * identical region is neither rendered nor scaled again. */
+typedef struct {
+    uint64_t hash;
+    char *key;       /* text, styles and rendering parameters */
+    size_t key_size;
+    uint64_t last_use;
+
+    /* Region as rendered by the text renderer */
+    video_format_t fmt;
+    picture_t *picture;
+    int x;
+    int y;
+    int align;
+
+    subpicture_region_private_t *scaled; /* last scaled picture, or NULL */
+} spu_cache_entry_t;
+
+typedef struct {
+    spu_cache_entry_t entries[SPU_CACHE_SIZE];
+    size_t count;
+    uint64_t clock;
+    unsigned hits;
+    unsigned misses;
+} spu_cache_t;
+
+/* Text renderer settings read again at every rendering
+ *
+ * Changing them at run time changes the output of the text renderer for the
+ * same region. */
+typedef struct {
+    int64_t text_scale;          /* sub-text-scale */
+    int64_t color;               /* freetype-color */
+    int64_t background_opacity;  /* freetype-background-opacity */
+    int64_t background_color;    /* freetype-background-color */
+} spu_cache_settings_t;
+
+/* Serialized rendering parameters of a text region */
+typedef struct {
+    char *data;
+    size_t size;
+    uint64_t hash;
+} spu_cache_key_t;
+
+void spu_cache_Init(spu_cache_t *);
+
+/**
+ * Drops all the entries, e.g. when the text renderer changes.
+ */
+void spu_cache_Flush(spu_cache_t *);
+
+/**
+ * Serializes everything the text renderer output depends on.
+ *
+ * \param width rendering width
+ * \param height rendering height
+ * \param settings live text renderer settings
+ * \param chroma_list zero-terminated list of allowed chromas
+ */
+int spu_cache_Key(spu_cache_key_t *, unsigned width, unsigned height,
+                  const spu_cache_settings_t *settings,
+                  const subpicture_region_t *,
+                  const vlc_fourcc_t *chroma_list);
+
+/**
+ * Restores a rendered region from the cache.
+ *
+ * \return VLC_SUCCESS on a hit, with the region rendered (and possibly
+ * scaled), or an error on a miss, with the region unchanged
+ */
+int spu_cache_Load(spu_cache_t *, const spu_cache_key_t *,
+                   subpicture_region_t *);
+
+/**
+ * Stores a freshly rendered region into the cache.
+ *
+ * The cache takes ownership of the key data. The least recently used entry
+ * is evicted if the cache is full.
+ */
+void spu_cache_Store(spu_cache_t *, spu_cache_key_t *,
+                     const subpicture_region_t *);
+
+/**
+ * Remembers the scaled version of a cached rendered region.
+ *
+ * Only text regions can be cached: other regions are not looked up.
+ */
+void spu_cache_StoreScaled(spu_cache_t *, const subpicture_region_t *);
+
+#endif
@@ -42,6 +42,7 @@
 #include "../libvlc.h"
 #include "vout_internal.h"
 #include "../misc/subpicture.h"
+#include "spu_cache.h"
 
 /*****************************************************************************
  * Local prototypes
@@ -84,6 +85,7 @@ struct spu_private_t {
     int channel;             /**< number of subpicture channels registered */
     filter_t *text;                              /**< text renderer module */
     vlc_mutex_t textlock;
+    spu_cache_t cache;        /**< rendered text regions (under textlock) */
     filter_t *scale_yuvp;                     /**< scaling module for YUVP */
     filter_t *scale;                    /**< scaling module (all but YUVP) */
     bool force_crop;                     /**< force cropping of subpicture */
@@ -306,6 +308,14 @@ static filter_t *SpuRenderCreateAndLoadScale(vlc_object_t *object,
     return scale;
 }
 
+/* Text renderers without such a setting render the same either way. */
+static int64_t SpuTextSetting(filter_t *text, const char *name)
+{
+    if (config_FindConfig(name) == NULL)
+        return 0;
+    return var_InheritInteger(text, name);
+}
+
 static void SpuRenderText(spu_t *spu,
                           subpicture_region_t *region,
                           int i_original_width,
@@ -336,8 +346,37 @@ static void SpuRenderText(spu_t *spu,
         text->fmt_out.video.i_height         =
         text->fmt_out.video.i_visible_height = i_original_height;
 
+        const spu_cache_settings_t settings = {
+            .text_scale = var_InheritInteger(text, "sub-text-scale"),
+            .color = SpuTextSetting(text, "freetype-color"),
+            .background_opacity =
+                SpuTextSetting(text, "freetype-background-opacity"),
+            .background_color =
+                SpuTextSetting(text, "freetype-background-color"),
+        };
+        spu_cache_key_t key;
+        bool cacheable = spu_cache_Key(&key, i_original_width,
+                                       i_original_height, &settings,
+                                       region, chroma_list) == VLC_SUCCESS;
+
+        if (cacheable
+         && spu_cache_Load(&sys->cache, &key, region) == VLC_SUCCESS)
+        {
+            free(key.data);
+            vlc_mutex_unlock(&sys->textlock);
+            return;
+        }
+
         if ( region->p_text )
             text->pf_render(text, region, region, chroma_list);
+
+        /* Only keep actual renderings: text-to-speech renderers leave the
+         * region as text. */
+        if (cacheable && region->fmt.i_chroma != VLC_CODEC_TEXT
+         && region->p_picture != NULL)
+            spu_cache_Store(&sys->cache, &key, region);
+        else if (cacheable)
+            free(key.data);
     }
     vlc_mutex_unlock(&sys->textlock);
 }
@@ -800,7 +839,8 @@ static void SpuRenderRegion(spu_t *spu,
     *dst_ptr  = NULL;
 
     /* Render text region */
-    if (region->fmt.i_chroma == VLC_CODEC_TEXT)
+    const bool is_text = region->fmt.i_chroma == VLC_CODEC_TEXT;
+    if (is_text)
     {
         SpuRenderText(spu, region,
                       i_original_width, i_original_height,
@@ -1039,6 +1079,14 @@ static void SpuRenderRegion(spu_t *spu,
                     picture_Release(picture);
                 }
             }
+
+            /* Keep the scaled text for the next identical region */
+            if (is_text && region->p_private)
+            {
+                vlc_mutex_lock(&sys->textlock);
+                spu_cache_StoreScaled(&sys->cache, region);
+                vlc_mutex_unlock(&sys->textlock);
+            }
         }
 
         /* And use the scaled picture */
@@ -1566,6 +1614,11 @@ static void spu_Cleanup(spu_t *spu)
     if (sys->text)
         FilterRelease(sys->text);
 
+    if (sys->cache.hits || sys->cache.misses)
+        msg_Dbg(spu, "text cache: %u hits, %u misses",
+                sys->cache.hits, sys->cache.misses);
+    spu_cache_Flush(&sys->cache);
+
     if (sys->scale_yuvp)
         FilterRelease(sys->scale_yuvp);
 
@@ -1675,6 +1728,7 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     /* Load text and scale module */
     sys->text = SpuRenderCreateAndLoadText(spu);
     vlc_mutex_init(&sys->textlock);
+    spu_cache_Init(&sys->cache);
 
     /* XXX spu->p_scale is used for all conversion/scaling except yuvp to
      * yuva/rgba */
@@ -1721,6 +1775,8 @@ void spu_Attach(spu_t *spu, input_thread_t *input)
         spu->p->input = input;
 
         vlc_mutex_lock(&spu->p->textlock);
+        /* Fonts may come from the input attachments */
+        spu_cache_Flush(&spu->p->cache);
         if (spu->p->text)
             FilterRelease(spu->p->text);
         spu->p->text = SpuRenderCreateAndLoadText(spu);
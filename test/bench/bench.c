@@ -0,0 +1,211 @@
+/*****************************************************************************
+ * bench.c: LibVLC core micro-benchmarks runner
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: vlc-bench [-t min_time_ms] [-r runs] [filter...]
+ *
+ * Runs the benchmarks whose name contains any of the filters (or all of them)
+ * and prints the results as a JSON document on the standard output.
+ * Each benchmark is first calibrated so that a run lasts at least the minimum
+ * time, then run several times; the minimum, median and maximum times per
+ * operation are reported.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <vlc/vlc.h>
+#include <vlc_common.h>
+
+#include "../../lib/libvlc_internal.h"
+#include "bench.h"
+
+#define BENCH_RUNS_MAX 100
+
+void bench_StartTimer(struct vlc_bench *b)
+{
+    if (!b->timing)
+    {
+        b->start = vlc_tick_now();
+        b->timing = true;
+    }
+}
+
+void bench_StopTimer(struct vlc_bench *b)
+{
+    if (b->timing)
+    {
+        b->elapsed += vlc_tick_now() - b->start;
+        b->timing = false;
+    }
+}
+
+void bench_ResetTimer(struct vlc_bench *b)
+{
+    b->elapsed = 0;
+    if (b->timing)
+        b->start = vlc_tick_now();
+}
+
+static const struct vlc_bench_case *const bench_tables[] = {
+    bench_core_cases,
+    bench_stream_cases,
+    bench_packetizer_cases,
+    bench_chroma_cases,
+    bench_demux_cases,
+};
+
+/** Runs a benchmark once with a given iteration count. */
+static int bench_Run(const struct vlc_bench_case *c, struct vlc_bench *b,
+                     uint64_t n)
+{
+    b->n = n;
+    b->bytes = 0;
+    b->elapsed = 0;
+    b->timing = false;
+
+    bench_StartTimer(b);
+    int ret = c->run(b, c->arg);
+    bench_StopTimer(b);
+    return ret;
+}
+
+static int cmp_tick(const void *a, const void *b)
+{
+    vlc_tick_t x = *(const vlc_tick_t *)a, y = *(const vlc_tick_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static bool bench_Match(const char *name, char *const *filters, int count)
+{
+    if (count == 0)
+        return true;
+    for (int i = 0; i < count; i++)
+        if (strstr(name, filters[i]) != NULL)
+            return true;
+    return false;
+}
+
+static void bench_Case(const struct vlc_bench_case *c, vlc_object_t *obj,
+                       vlc_tick_t min_time, unsigned runs, bool first)
+{
+    struct vlc_bench b = { .obj = obj };
+    vlc_tick_t times[BENCH_RUNS_MAX];
+    uint64_t n = 1;
+
+    printf("%s    {\"name\": \"%s\"", first ? "" : ",\n", c->name);
+    fflush(stdout);
+
+    /* Calibrate the iteration count */
+    for (;;)
+    {
+        if (bench_Run(c, &b, n))
+        {
+            printf(", \"skipped\": true}");
+            return;
+        }
+        if (b.elapsed >= min_time || n >= (UINT64_C(1) << 40))
+            break;
+
+        uint64_t next = b.elapsed > 0
+                      ? n * (min_time * 6 / 5) / b.elapsed : n * 100;
+        n = __MIN(__MAX(next, n + 1), n * 100);
+    }
+
+    for (unsigned i = 0; i < runs; i++)
+    {
+        bench_Run(c, &b, n);
+        times[i] = b.elapsed;
+    }
+    qsort(times, runs, sizeof (times[0]), cmp_tick);
+
+    const double scale = 1000. / n; /* microseconds to ns per operation */
+
+    printf(", \"iterations\": %"PRIu64", \"runs\": %u, "
+           "\"ns_per_op\": {\"min\": %.3f, \"median\": %.3f, \"max\": %.3f}",
+           n, runs, times[0] * scale, times[runs / 2] * scale,
+           times[runs - 1] * scale);
+    if (b.bytes > 0)
+        printf(", \"bytes_per_op\": %zu, \"mb_per_s\": %.3f", b.bytes,
+               times[0] > 0 ? (double)b.bytes * n / times[0] : 0.);
+    printf("}");
+}
+
+int main(int argc, char *argv[])
+{
+    vlc_tick_t min_time = VLC_TICK_FROM_MS(200);
+    unsigned runs = 5;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:r:")) != -1)
+        switch (opt)
+        {
+            case 't':
+                min_time = VLC_TICK_FROM_MS(atoi(optarg));
+                break;
+            case 'r':
+                runs = atoi(optarg);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-t min_time_ms] [-r runs] "
+                        "[filter...]\n", argv[0]);
+                return 1;
+        }
+
+    if (min_time <= 0)
+        min_time = 1;
+    if (runs < 1 || runs > BENCH_RUNS_MAX)
+        runs = 5;
+
+    if (getenv("VLC_PLUGIN_PATH") == NULL)
+        setenv("VLC_PLUGIN_PATH", "../modules", 1);
+
+    static const char *const args[] = { "--quiet", "--ignore-config" };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return 1;
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    bool first = true;
+
+    printf("{\n  \"version\": 1,\n  \"libvlc\": \"%s\",\n"
+           "  \"min_time_ms\": %"PRId64",\n  \"benchmarks\": [\n",
+           libvlc_get_version(), MS_FROM_VLC_TICK(min_time));
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_tables); i++)
+        for (const struct vlc_bench_case *c = bench_tables[i];
+             c->name != NULL; c++)
+            if (bench_Match(c->name, argv + optind, argc - optind))
+            {
+                bench_Case(c, obj, min_time, runs, first);
+                first = false;
+            }
+
+    printf("\n  ]\n}\n");
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ * bench.h: LibVLC core micro-benchmarks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TEST_BENCH_H
+#define VLC_TEST_BENCH_H
+
+#include <stdint.h>
+
+/**
+ * Benchmark run state.
+ *
+ * A benchmark function runs its operation bench.n times. The timer is
+ * running when the function is called; setup and cleanup code can be
+ * excluded with bench_StopTimer() and bench_StartTimer().
+ */
+struct vlc_bench
+{
+    vlc_object_t *obj; /**< LibVLC object (for benchmarks needing one) */
+    uint64_t n; /**< Number of iterations to run */
+    size_t bytes; /**< Bytes processed per iteration (0 if not applicable) */
+
+    /* Private */
+    vlc_tick_t start;
+    vlc_tick_t elapsed;
+    bool timing;
+};
+
+struct vlc_bench_case
+{
+    const char *name;
+    /**
+     * Runs the benchmark.
+     * @return 0 on success, or -1 if the benchmark cannot run (skipped)
+     */
+    int (*run)(struct vlc_bench *, const void *arg);
+    const void *arg;
+};
+
+void bench_StartTimer(struct vlc_bench *);
+void bench_StopTimer(struct vlc_bench *);
+void bench_ResetTimer(struct vlc_bench *);
+
+/* Benchmark tables, each terminated by an entry with a NULL name */
+extern const struct vlc_bench_case bench_core_cases[];
+extern const struct vlc_bench_case bench_stream_cases[];
+extern const struct vlc_bench_case bench_packetizer_cases[];
+extern const struct vlc_bench_case bench_chroma_cases[];
+extern const struct vlc_bench_case bench_demux_cases[];
+
+#endif
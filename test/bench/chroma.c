@@ -0,0 +1,320 @@
+/*****************************************************************************
+ * chroma.c: video converters micro-benchmarks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_es.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+#include <vlc_picture_pool.h>
+
+#include "bench.h"
+
+#define BENCH_WIDTH 1920
+#define BENCH_HEIGHT 1080
+
+struct bench_conversion
+{
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    const char *module; /**< Module to use, or NULL for the best one */
+    unsigned width; /**< Output width, or 0 for the input width */
+    unsigned height; /**< Output height, or 0 for the input height */
+};
+
+/* Output pictures are recycled, so that allocation is not measured. */
+static picture_t *bench_chroma_NewPicture(filter_t *filter)
+{
+    return picture_pool_Wait(filter->owner.sys);
+}
+
+static const struct filter_video_callbacks bench_chroma_cbs = {
+    .buffer_new = bench_chroma_NewPicture,
+};
+
+static void bench_chroma_Delete(filter_t *filter)
+{
+    if (filter->p_module != NULL)
+        module_unneed(filter, filter->p_module);
+    if (filter->owner.sys != NULL)
+        picture_pool_Release(filter->owner.sys);
+    config_ChainDestroy(filter->p_cfg);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+}
+
+static filter_t *bench_chroma_New(vlc_object_t *obj,
+                                  const struct bench_conversion *conv,
+                                  const char *capability, const char *chain)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    if (filter == NULL)
+        return NULL;
+
+    char *name = NULL;
+
+    if (chain != NULL)
+        free(config_ChainCreate(&name, &filter->p_cfg, chain));
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, conv->src);
+    video_format_Setup(&filter->fmt_in.video, conv->src,
+                       BENCH_WIDTH, BENCH_HEIGHT, BENCH_WIDTH, BENCH_HEIGHT,
+                       1, 1);
+    const unsigned width = conv->width ? conv->width : BENCH_WIDTH;
+    const unsigned height = conv->height ? conv->height : BENCH_HEIGHT;
+
+    es_format_Init(&filter->fmt_out, VIDEO_ES, conv->dst);
+    video_format_Setup(&filter->fmt_out.video, conv->dst,
+                       width, height, width, height, 1, 1);
+    filter->owner.video = &bench_chroma_cbs;
+    filter->owner.sys = picture_pool_NewFromFormat(&filter->fmt_out.video, 4);
+
+    if (filter->owner.sys != NULL)
+        filter->p_module = module_need(filter, capability, name,
+                                       name != NULL);
+    free(name);
+    if (filter->p_module == NULL)
+    {
+        bench_chroma_Delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+static size_t bench_picture_Size(const picture_t *pic)
+{
+    size_t size = 0;
+
+    for (int i = 0; i < pic->i_planes; i++)
+        size += pic->p[i].i_visible_lines * pic->p[i].i_visible_pitch;
+    return size;
+}
+
+/** Filters the same picture repeatedly, then deletes the filter */
+static int bench_filter(struct vlc_bench *b, filter_t *filter)
+{
+    picture_t *src = picture_NewFromFormat(&filter->fmt_in.video);
+    if (src == NULL)
+        abort();
+    for (int i = 0; i < src->i_planes; i++)
+        memset(src->p[i].p_pixels, 0x80 + 16 * i,
+               src->p[i].i_lines * src->p[i].i_pitch);
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        picture_t *dst = filter->pf_video_filter(filter, picture_Hold(src));
+
+        /* Temporal filters may output no pictures or several ones. */
+        while (dst != NULL)
+        {
+            picture_t *next = dst->p_next;
+
+            dst->p_next = NULL;
+            picture_Release(dst);
+            dst = next;
+        }
+    }
+
+    bench_StopTimer(b);
+    b->bytes = bench_picture_Size(src);
+    picture_Release(src);
+    bench_chroma_Delete(filter);
+    return 0;
+}
+
+static int bench_chroma(struct vlc_bench *b, const void *arg)
+{
+    const struct bench_conversion *conv = arg;
+
+    bench_StopTimer(b);
+    filter_t *filter = bench_chroma_New(b->obj, conv, "video converter",
+                                        conv->module);
+    if (filter == NULL)
+        return -1;
+    return bench_filter(b, filter);
+}
+
+struct bench_vfilter
+{
+    const char *chain; /**< Filter name and options */
+    vlc_fourcc_t chroma;
+};
+
+static int bench_vfilter(struct vlc_bench *b, const void *arg)
+{
+    const struct bench_vfilter *vf = arg;
+    const struct bench_conversion conv = { .src = vf->chroma,
+                                           .dst = vf->chroma };
+
+    bench_StopTimer(b);
+    filter_t *filter = bench_chroma_New(b->obj, &conv, "video filter",
+                                        vf->chain);
+    if (filter == NULL)
+        return -1;
+    return bench_filter(b, filter);
+}
+
+struct bench_blend
+{
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+};
+
+#define BENCH_BLEND_WIDTH 1280
+#define BENCH_BLEND_HEIGHT 160
+
+/** Blends a subtitle-like region: text with transparent gaps around it */
+static int bench_blend(struct vlc_bench *b, const void *arg)
+{
+    const struct bench_blend *bl = arg;
+    video_format_t fmt;
+    video_palette_t palette = { .i_entries = 4 };
+
+    bench_StopTimer(b);
+    video_format_Setup(&fmt, bl->dst, BENCH_WIDTH, BENCH_HEIGHT,
+                       BENCH_WIDTH, BENCH_HEIGHT, 1, 1);
+    picture_t *dst = picture_NewFromFormat(&fmt);
+    video_format_Setup(&fmt, bl->src, BENCH_BLEND_WIDTH, BENCH_BLEND_HEIGHT,
+                       BENCH_BLEND_WIDTH, BENCH_BLEND_HEIGHT, 1, 1);
+    picture_t *src = picture_NewFromFormat(&fmt);
+    if (dst == NULL || src == NULL)
+        abort();
+
+    for (int i = 0; i < dst->i_planes; i++)
+        memset(dst->p[i].p_pixels, 0x40,
+               dst->p[i].i_lines * dst->p[i].i_pitch);
+    for (int i = 0; i < src->i_planes; i++)
+        for (int y = 0; y < src->p[i].i_lines; y++)
+        {
+            uint8_t *line = src->p[i].p_pixels + y * src->p[i].i_pitch;
+
+            for (int x = 0; x < src->p[i].i_pitch; x++)
+                /* Transparent in the top and bottom thirds */
+                line[x] = (y * 3 / src->p[i].i_lines == 1) ? x * 7 : 0;
+        }
+    for (unsigned i = 0; i < 4; i++)
+    {
+        palette.palette[i][0] = 0x10 + 0x40 * i;
+        palette.palette[i][1] = palette.palette[i][2] = 0x80;
+        palette.palette[i][3] = i ? 0xff : 0;
+    }
+    if (bl->src == VLC_CODEC_YUVP)
+    {
+        for (int y = 0; y < src->p[0].i_lines; y++)
+            for (int x = 0; x < src->p[0].i_pitch; x++)
+                src->p[0].p_pixels[y * src->p[0].i_pitch + x] &= 3;
+        src->format.p_palette = &palette;
+    }
+
+    vlc_blender_t *blend = filter_NewBlend(b->obj, &dst->format);
+    if (blend == NULL
+     || filter_ConfigureBlend(blend, BENCH_WIDTH, BENCH_HEIGHT,
+                              &src->format))
+        abort();
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+        filter_Blend(blend, dst, 320, 880, src, 255);
+
+    bench_StopTimer(b);
+    filter_DeleteBlend(blend);
+    src->format.p_palette = NULL;
+    picture_Release(src);
+    picture_Release(dst);
+    b->bytes = BENCH_BLEND_WIDTH * BENCH_BLEND_HEIGHT;
+    return 0;
+}
+
+#define CONV(a, b) \
+    { "chroma/" #a "/" #b, bench_chroma, \
+      &(const struct bench_conversion){ .src = VLC_CODEC_##a, \
+                                        .dst = VLC_CODEC_##b } }
+
+/* Same conversion with a given module, to compare implementations */
+#define CONV_WITH(a, b, m) \
+    { "chroma/" #a "/" #b "/" #m, bench_chroma, \
+      &(const struct bench_conversion){ .src = VLC_CODEC_##a, \
+                                        .dst = VLC_CODEC_##b, .module = #m } }
+
+/* Scaling to a given size, e.g. for mosaics and thumbnails */
+#define SCALE_WITH(a, w, h, m) \
+    { "scale/" #a "/" #w "x" #h "/" #m, bench_chroma, \
+      &(const struct bench_conversion){ .src = VLC_CODEC_##a, \
+                                        .dst = VLC_CODEC_##a, .module = #m, \
+                                        .width = w, .height = h } }
+
+#define BLEND(a, b) \
+    { "blend/" #a "/" #b, bench_blend, \
+      &(const struct bench_blend){ VLC_CODEC_##a, VLC_CODEC_##b } }
+
+#define VFILTER(n, chain, chroma) \
+    { "vfilter/" #n, bench_vfilter, \
+      &(const struct bench_vfilter){ chain, VLC_CODEC_##chroma } }
+
+const struct vlc_bench_case bench_chroma_cases[] = {
+    CONV(I420, YUYV),
+    CONV(I420, UYVY),
+    CONV(I420, NV12),
+    CONV(I420, RGB32),
+    CONV(NV12, I420),
+    CONV(YUYV, I420),
+    CONV(I422, YUYV),
+    CONV(I422, I420),
+    CONV(I420_10L, I420),
+    CONV(P010, I420_10L),
+    CONV(I420, RGBA),
+    CONV_WITH(I420, YUYV, chroma_convert),
+    CONV_WITH(I420, YUYV, swscale),
+    CONV_WITH(I420, RGB32, chroma_convert),
+    CONV_WITH(I420, RGB32, swscale),
+    CONV_WITH(I420_10L, RGBA, chroma_convert),
+    CONV_WITH(I420_10L, RGBA, swscale),
+    CONV_WITH(NV12, I420, chroma_convert),
+    CONV_WITH(NV12, I420, swscale),
+    SCALE_WITH(I420, 1280, 720, swscale),
+    SCALE_WITH(I420, 480, 272, swscale),
+    SCALE_WITH(RGB32, 480, 272, swscale),
+    BLEND(YUVA, I420),
+    BLEND(YUVP, I420),
+    BLEND(YUVA, NV12),
+    BLEND(YUVA, I420_10L),
+    BLEND(RGBA, RGBA),
+    BLEND(RGBA, I420),
+    VFILTER(adjust, "adjust", I420),
+    VFILTER(sharpen, "sharpen", I420),
+    VFILTER(gradfun, "gradfun", I420),
+    VFILTER(hqdn3d, "hqdn3d", I420),
+    VFILTER(deinterlace/blend, "deinterlace{mode=blend}", I420),
+    VFILTER(deinterlace/blend/10bit, "deinterlace{mode=blend}", I420_10L),
+    VFILTER(deinterlace/linear, "deinterlace{mode=linear}", I420),
+    VFILTER(deinterlace/linear/10bit, "deinterlace{mode=linear}", I420_10L),
+    VFILTER(deinterlace/yadif, "deinterlace{mode=yadif}", I420),
+    VFILTER(deinterlace/yadif/10bit, "deinterlace{mode=yadif}", I420_10L),
+    { NULL, NULL, NULL }
+};
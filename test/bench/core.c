@@ -0,0 +1,423 @@
+/*****************************************************************************
+ * core.c: LibVLC core primitives micro-benchmarks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_picture.h>
+#include <vlc_picture_pool.h>
+#include <vlc_variables.h>
+
+#include "bench.h"
+
+/*** Blocks ***/
+
+static int bench_block_alloc(struct vlc_bench *b, const void *arg)
+{
+    const size_t size = (uintptr_t)arg;
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        block_t *block = block_Alloc(size);
+        if (unlikely(block == NULL))
+            return -1;
+        block_Release(block);
+    }
+    return 0;
+}
+
+/** Allocates a burst of blocks, as a demultiplexer does, then frees them. */
+static int bench_block_burst(struct vlc_bench *b, const void *arg)
+{
+    const size_t size = (uintptr_t)arg;
+    block_t *blocks[64];
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        for (size_t j = 0; j < ARRAY_SIZE(blocks); j++)
+        {
+            blocks[j] = block_Alloc(size);
+            if (unlikely(blocks[j] == NULL))
+                abort();
+        }
+        for (size_t j = 0; j < ARRAY_SIZE(blocks); j++)
+            block_Release(blocks[j]);
+    }
+    return 0;
+}
+
+/*** FIFO ***/
+
+static block_fifo_t *bench_fifo_New(bool lockless)
+{
+    block_fifo_t *fifo = block_FifoNew();
+
+    if (fifo != NULL && lockless)
+        vlc_fifo_EnableLockless(fifo);
+    return fifo;
+}
+
+static void bench_fifo_Put(block_fifo_t *fifo, block_t *block, bool lockless)
+{
+    if (lockless)
+        vlc_fifo_QueueLockless(fifo, block);
+    else
+        block_FifoPut(fifo, block);
+}
+
+static int bench_fifo_put_get(struct vlc_bench *b, const void *arg)
+{
+    const bool lockless = arg != NULL;
+
+    bench_StopTimer(b);
+    block_fifo_t *fifo = bench_fifo_New(lockless);
+    block_t *block = block_Alloc(188);
+    if (fifo == NULL || block == NULL)
+        abort();
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        bench_fifo_Put(fifo, block, lockless);
+        block = block_FifoGet(fifo);
+    }
+
+    bench_StopTimer(b);
+    block_Release(block);
+    block_FifoRelease(fifo);
+    return 0;
+}
+
+struct bench_fifo_producer
+{
+    block_fifo_t *fifo;
+    block_t *block;
+    uint64_t count;
+    bool lockless;
+};
+
+static void *bench_fifo_Producer(void *data)
+{
+    struct bench_fifo_producer *p = data;
+
+    for (uint64_t i = 0; i < p->count; i++)
+        bench_fifo_Put(p->fifo, block_Duplicate(p->block), p->lockless);
+    return NULL;
+}
+
+/** One producer thread, one consumer thread. */
+static int bench_fifo_threaded(struct vlc_bench *b, const void *arg)
+{
+    struct bench_fifo_producer p = {
+        .count = b->n,
+        .lockless = arg != NULL,
+    };
+    vlc_thread_t th;
+
+    bench_StopTimer(b);
+    p.fifo = bench_fifo_New(p.lockless);
+    p.block = block_Alloc(1316);
+    if (p.fifo == NULL || p.block == NULL)
+        abort();
+    memset(p.block->p_buffer, 0, p.block->i_buffer);
+    bench_StartTimer(b);
+
+    if (vlc_clone(&th, bench_fifo_Producer, &p, VLC_THREAD_PRIORITY_LOW))
+        abort();
+
+    for (uint64_t i = 0; i < b->n; i++)
+        block_Release(block_FifoGet(p.fifo));
+
+    vlc_join(th, NULL);
+    bench_StopTimer(b);
+    block_Release(p.block);
+    block_FifoRelease(p.fifo);
+    b->bytes = 1316;
+    return 0;
+}
+
+/*** Pictures ***/
+
+static int bench_picture_new(struct vlc_bench *b, const void *arg)
+{
+    const unsigned height = (uintptr_t)arg;
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, height * 16 / 9, height,
+                       height * 16 / 9, height, 1, 1);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        picture_t *pic = picture_NewFromFormat(&fmt);
+        if (unlikely(pic == NULL))
+            abort();
+        picture_Release(pic);
+    }
+
+    b->bytes = fmt.i_width * fmt.i_height * 3 / 2;
+    return 0;
+}
+
+/*** Picture pool ***/
+
+static picture_pool_t *bench_pool_New(unsigned count)
+{
+    video_format_t fmt;
+
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, 320, 240, 320, 240, 1, 1);
+    return picture_pool_NewFromFormat(&fmt, count);
+}
+
+static int bench_pool_get(struct vlc_bench *b, const void *arg)
+{
+    picture_t *(*get)(picture_pool_t *) = arg != NULL ? picture_pool_Wait
+                                                      : picture_pool_Get;
+
+    bench_StopTimer(b);
+    picture_pool_t *pool = bench_pool_New(10);
+    if (pool == NULL)
+        abort();
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        picture_t *pic = get(pool);
+        if (unlikely(pic == NULL))
+            abort();
+        picture_Release(pic);
+    }
+
+    bench_StopTimer(b);
+    picture_pool_Release(pool);
+    return 0;
+}
+
+struct bench_pool_thread
+{
+    picture_pool_t *pool;
+    atomic_bool stop;
+};
+
+static void *bench_pool_Thread(void *data)
+{
+    struct bench_pool_thread *t = data;
+
+    while (!atomic_load_explicit(&t->stop, memory_order_relaxed))
+    {
+        picture_t *pic = picture_pool_Get(t->pool);
+        if (pic != NULL)
+            picture_Release(pic);
+    }
+    return NULL;
+}
+
+static int bench_pool_contended(struct vlc_bench *b, const void *arg)
+{
+    struct bench_pool_thread t;
+    vlc_thread_t th;
+
+    (void) arg;
+    bench_StopTimer(b);
+    /* More than 64 pictures, most of them in use */
+    t.pool = bench_pool_New(256);
+    if (t.pool == NULL)
+        abort();
+    atomic_init(&t.stop, false);
+
+    picture_t *held[250];
+    for (unsigned i = 0; i < ARRAY_SIZE(held); i++)
+        if ((held[i] = picture_pool_Get(t.pool)) == NULL)
+            abort();
+
+    if (vlc_clone(&th, bench_pool_Thread, &t, VLC_THREAD_PRIORITY_LOW))
+        abort();
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        picture_t *pic = picture_pool_Wait(t.pool);
+        if (unlikely(pic == NULL))
+            abort();
+        picture_Release(pic);
+    }
+
+    bench_StopTimer(b);
+    atomic_store(&t.stop, true);
+    vlc_join(th, NULL);
+    for (unsigned i = 0; i < ARRAY_SIZE(held); i++)
+        picture_Release(held[i]);
+    picture_pool_Release(t.pool);
+    return 0;
+}
+
+/*** Object variables ***/
+
+static void bench_var_Name(char *name, unsigned i)
+{
+    sprintf(name, "bench-var-%04u", i);
+}
+
+static void bench_vars_Create(vlc_object_t *obj, unsigned count)
+{
+    char name[32];
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        bench_var_Name(name, i);
+        var_Create(obj, name, VLC_VAR_INTEGER);
+    }
+}
+
+static void bench_vars_Destroy(vlc_object_t *obj, unsigned count)
+{
+    char name[32];
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        bench_var_Name(name, i);
+        var_Destroy(obj, name);
+    }
+}
+
+/** Reads a variable among a given number of variables of a fresh object. */
+static int bench_var_get(struct vlc_bench *b, const void *arg)
+{
+    const unsigned count = (uintptr_t)arg;
+    char name[32];
+    int64_t sum = 0;
+
+    bench_StopTimer(b);
+    vlc_object_t *obj = vlc_object_create(b->obj, sizeof (*obj));
+    if (obj == NULL)
+        abort();
+    bench_vars_Create(obj, count);
+    bench_var_Name(name, count / 2);
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+        sum += var_GetInteger(obj, name);
+
+    bench_StopTimer(b);
+    bench_vars_Destroy(obj, count);
+    vlc_object_delete(obj);
+    VLC_UNUSED(sum);
+    return 0;
+}
+
+static int bench_var_set(struct vlc_bench *b, const void *arg)
+{
+    const unsigned count = (uintptr_t)arg;
+    char name[32];
+
+    bench_StopTimer(b);
+    vlc_object_t *obj = vlc_object_create(b->obj, sizeof (*obj));
+    if (obj == NULL)
+        abort();
+    bench_vars_Create(obj, count);
+    bench_var_Name(name, count / 2);
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+        var_SetInteger(obj, name, i);
+
+    bench_StopTimer(b);
+    bench_vars_Destroy(obj, count);
+    vlc_object_delete(obj);
+    return 0;
+}
+
+/** Creates and destroys a variable. */
+static int bench_var_create(struct vlc_bench *b, const void *arg)
+{
+    const unsigned count = (uintptr_t)arg;
+
+    bench_StopTimer(b);
+    vlc_object_t *obj = vlc_object_create(b->obj, sizeof (*obj));
+    if (obj == NULL)
+        abort();
+    bench_vars_Create(obj, count);
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        var_Create(obj, "bench-var", VLC_VAR_INTEGER);
+        var_Destroy(obj, "bench-var");
+    }
+
+    bench_StopTimer(b);
+    bench_vars_Destroy(obj, count);
+    vlc_object_delete(obj);
+    return 0;
+}
+
+/** Inherits a configuration item through a child object. */
+static int bench_var_inherit(struct vlc_bench *b, const void *arg)
+{
+    int64_t sum = 0;
+
+    bench_StopTimer(b);
+    vlc_object_t *obj = vlc_object_create(b->obj, sizeof (*obj));
+    if (obj == NULL)
+        abort();
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+        sum += var_InheritInteger(obj, "verbose");
+
+    bench_StopTimer(b);
+    vlc_object_delete(obj);
+    VLC_UNUSED(arg); VLC_UNUSED(sum);
+    return 0;
+}
+
+#define SIZE(s) ((const void *)(uintptr_t)(s))
+#define ON ((const void *)"")
+
+const struct vlc_bench_case bench_core_cases[] = {
+    { "block/alloc/188", bench_block_alloc, SIZE(188) },
+    { "block/alloc/1316", bench_block_alloc, SIZE(1316) },
+    { "block/alloc/16384", bench_block_alloc, SIZE(16384) },
+    { "block/alloc/1048576", bench_block_alloc, SIZE(1048576) },
+    { "block/burst64/1316", bench_block_burst, SIZE(1316) },
+    { "fifo/put_get", bench_fifo_put_get, NULL },
+    { "fifo/put_get/lockless", bench_fifo_put_get, ON },
+    { "fifo/threaded", bench_fifo_threaded, NULL },
+    { "fifo/threaded/lockless", bench_fifo_threaded, ON },
+    { "picture/new/1080p", bench_picture_new, SIZE(1080) },
+    { "picture/new/2160p", bench_picture_new, SIZE(2160) },
+    { "picture_pool/get", bench_pool_get, NULL },
+    { "picture_pool/wait", bench_pool_get, ON },
+    { "picture_pool/contended", bench_pool_contended, NULL },
+    { "var/get_integer/16", bench_var_get, SIZE(16) },
+    { "var/get_integer/1024", bench_var_get, SIZE(1024) },
+    { "var/set_integer/16", bench_var_set, SIZE(16) },
+    { "var/set_integer/1024", bench_var_set, SIZE(1024) },
+    { "var/create_destroy/1024", bench_var_create, SIZE(1024) },
+    { "var/inherit_integer", bench_var_inherit, NULL },
+    { NULL, NULL, NULL }
+};
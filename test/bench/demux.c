@@ -0,0 +1,315 @@
+/*****************************************************************************
+ * demux.c: demultiplexers micro-benchmarks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+
+#include "bench.h"
+
+#define BENCH_TS_PACKETS 22310 /* about 4 MiB */
+#define BENCH_TS_PSI_INTERVAL 50
+#define BENCH_TS_PES_PACKETS 16 /* packets per PES */
+#define BENCH_TS_ES 4 /* elementary streams per program */
+
+struct bench_ts_mux
+{
+    unsigned programs;
+};
+
+static const struct
+{
+    uint8_t type;
+    uint8_t stream_id;
+} bench_ts_es[BENCH_TS_ES] = {
+    { 0x02, 0xE0 }, /* MPEG-2 video, also carrying the PCR */
+    { 0x03, 0xC0 }, /* MPEG audio */
+    { 0x03, 0xC1 },
+    { 0x04, 0xC2 },
+};
+
+static uint16_t bench_ts_PMTPID(unsigned program)
+{
+    return 0x20 + program;
+}
+
+/* Spreads the streams all over the PID range */
+static uint16_t bench_ts_ESPID(unsigned program, unsigned es)
+{
+    return 0x100 + ((program * BENCH_TS_ES + es) * 97) % 0x1E00;
+}
+
+static uint32_t bench_ts_CRC(const uint8_t *p, size_t len)
+{
+    uint32_t crc = 0xffffffff;
+
+    while (len-- > 0)
+    {
+        crc ^= (uint32_t)*(p++) << 24;
+        for (unsigned i = 0; i < 8; i++)
+            crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04c11db7 : 0);
+    }
+    return crc;
+}
+
+/**
+ * Writes a PSI section in a single TS packet.
+ *
+ * @param sec section, with its header, and room for the CRC
+ * @param len section length, CRC included
+ */
+static void bench_ts_WriteSection(uint8_t *pkt, uint16_t pid, uint8_t *cc,
+                                  uint8_t *sec, size_t len)
+{
+    SetWBE(&sec[1], 0xB000 | (len - 3));
+    SetDWBE(&sec[len - 4], bench_ts_CRC(sec, len - 4));
+
+    pkt[0] = 0x47;
+    pkt[1] = 0x40 | (pid >> 8);
+    pkt[2] = pid & 0xff;
+    pkt[3] = 0x10 | ((*cc)++ & 0x0f);
+    pkt[4] = 0; /* pointer field */
+    memcpy(&pkt[5], sec, len);
+    memset(&pkt[5 + len], 0xff, 188 - 5 - len);
+}
+
+static void bench_ts_WritePAT(uint8_t *pkt, uint8_t *cc, unsigned programs)
+{
+    uint8_t sec[183] = { 0x00, 0, 0, 0x00, 0x01, 0xC1, 0, 0 };
+    size_t len = 8;
+
+    for (unsigned i = 0; i < programs; i++)
+    {
+        SetWBE(&sec[len], 1 + i);
+        SetWBE(&sec[len + 2], 0xE000 | bench_ts_PMTPID(i));
+        len += 4;
+    }
+    bench_ts_WriteSection(pkt, 0, cc, sec, len + 4);
+}
+
+static void bench_ts_WritePMT(uint8_t *pkt, uint8_t *cc, unsigned program)
+{
+    uint8_t sec[183] = { 0x02, 0, 0, 0, 0, 0xC1, 0, 0, 0, 0, 0xF0, 0x00 };
+    size_t len = 12;
+
+    SetWBE(&sec[3], 1 + program);
+    SetWBE(&sec[8], 0xE000 | bench_ts_ESPID(program, 0));
+    for (unsigned i = 0; i < BENCH_TS_ES; i++)
+    {
+        sec[len] = bench_ts_es[i].type;
+        SetWBE(&sec[len + 1], 0xE000 | bench_ts_ESPID(program, i));
+        SetWBE(&sec[len + 3], 0xF000);
+        len += 5;
+    }
+    bench_ts_WriteSection(pkt, bench_ts_PMTPID(program), cc, sec, len + 4);
+}
+
+static void bench_ts_WriteES(uint8_t *pkt, uint16_t pid, uint8_t *cc,
+                             uint8_t stream_id, bool start, bool pcr,
+                             uint64_t clock, uint32_t *restrict seed)
+{
+    size_t i = 4;
+
+    pkt[0] = 0x47;
+    pkt[1] = (start ? 0x40 : 0) | (pid >> 8);
+    pkt[2] = pid & 0xff;
+    pkt[3] = (pcr ? 0x30 : 0x10) | ((*cc)++ & 0x0f);
+
+    if (pcr)
+    {
+        pkt[i++] = 7; /* adaptation field length */
+        pkt[i++] = 0x10; /* PCR flag */
+        pkt[i++] = clock >> 25;
+        pkt[i++] = clock >> 17;
+        pkt[i++] = clock >> 9;
+        pkt[i++] = clock >> 1;
+        pkt[i++] = ((clock & 1) << 7) | 0x7E;
+        pkt[i++] = 0;
+    }
+
+    if (start)
+    {
+        const uint64_t pts = clock + 9000;
+
+        memcpy(&pkt[i], (const uint8_t[]){ 0, 0, 1, stream_id, 0, 0,
+                                           0x80, 0x80, 5 }, 9);
+        i += 9;
+        pkt[i++] = 0x21 | ((pts >> 29) & 0x0e);
+        pkt[i++] = pts >> 22;
+        pkt[i++] = (pts >> 14) | 1;
+        pkt[i++] = pts >> 7;
+        pkt[i++] = (pts << 1) | 1;
+    }
+
+    for (; i < 188; i++)
+    {
+        *seed = *seed * 1664525 + 1013904223;
+        pkt[i] = *seed >> 24;
+    }
+}
+
+/**
+ * Generates a multiple program transport stream, with PAT and PMT
+ * repeated, and the packets of all elementary streams interleaved in
+ * pseudo-random order, as in a broadcast multiplex capture.
+ */
+static uint8_t *bench_ts_Data(unsigned programs, size_t *restrict size)
+{
+    uint8_t *data = malloc(BENCH_TS_PACKETS * 188);
+    if (data == NULL)
+        return NULL;
+
+    const unsigned count = programs * BENCH_TS_ES;
+    uint8_t pat_cc = 0;
+    uint8_t pmt_cc[programs];
+    uint8_t es_cc[count];
+    unsigned es_packets[count];
+    unsigned psi = 0;
+    uint32_t seed = 0x12345678;
+
+    memset(pmt_cc, 0, sizeof (pmt_cc));
+    memset(es_cc, 0, sizeof (es_cc));
+    memset(es_packets, 0, sizeof (es_packets));
+
+    for (unsigned k = 0; k < BENCH_TS_PACKETS; k++)
+    {
+        uint8_t *pkt = &data[k * 188];
+        const uint64_t clock = k * 27 / 4; /* about 20 Mb/s */
+
+        if (k % BENCH_TS_PSI_INTERVAL == 0)
+        {
+            /* PAT, then each PMT in turn */
+            if (psi == 0)
+                bench_ts_WritePAT(pkt, &pat_cc, programs);
+            else
+                bench_ts_WritePMT(pkt, &pmt_cc[psi - 1], psi - 1);
+            psi = (psi + 1) % (programs + 1);
+            continue;
+        }
+
+        seed = seed * 1664525 + 1013904223;
+        const unsigned idx = (uint64_t)seed * count >> 32;
+        const unsigned program = idx / BENCH_TS_ES, es = idx % BENCH_TS_ES;
+        const bool start = es_packets[idx]++ % BENCH_TS_PES_PACKETS == 0;
+
+        bench_ts_WriteES(pkt, bench_ts_ESPID(program, es), &es_cc[idx],
+                         bench_ts_es[es].stream_id, start, start && es == 0,
+                         clock, &seed);
+    }
+
+    *size = BENCH_TS_PACKETS * 188;
+    return data;
+}
+
+static es_out_id_t *bench_es_out_Add(es_out_t *out, input_source_t *in,
+                                     const es_format_t *fmt)
+{
+    static char id;
+
+    (void) out; (void) in; (void) fmt;
+    return (es_out_id_t *)&id;
+}
+
+static int bench_es_out_Send(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    (void) out; (void) id;
+    block_ChainRelease(block);
+    return VLC_SUCCESS;
+}
+
+static void bench_es_out_Del(es_out_t *out, es_out_id_t *id)
+{
+    (void) out; (void) id;
+}
+
+static int bench_es_out_Control(es_out_t *out, input_source_t *in, int query,
+                                va_list args)
+{
+    (void) out; (void) in;
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static const struct es_out_callbacks bench_es_out_cbs = {
+    .add = bench_es_out_Add,
+    .send = bench_es_out_Send,
+    .del = bench_es_out_Del,
+    .control = bench_es_out_Control,
+};
+
+static int bench_demux_ts(struct vlc_bench *b, const void *arg)
+{
+    const struct bench_ts_mux *mux = arg;
+    es_out_t out = { .cbs = &bench_es_out_cbs };
+    size_t size;
+
+    bench_StopTimer(b);
+    uint8_t *data = bench_ts_Data(mux->programs, &size);
+    if (data == NULL)
+        abort();
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        stream_t *s = vlc_stream_MemoryNew(b->obj, data, size, true);
+        if (s == NULL)
+            abort();
+
+        demux_t *demux = demux_New(b->obj, "ts", s, &out);
+        if (demux == NULL)
+        {
+            vlc_stream_Delete(s);
+            free(data);
+            return -1;
+        }
+
+        bench_StartTimer(b);
+        while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+        bench_StopTimer(b);
+        demux_Delete(demux);
+    }
+
+    free(data);
+    b->bytes = size;
+    return 0;
+}
+
+static const struct bench_ts_mux ts_program = { 1 };
+static const struct bench_ts_mux ts_fullmux = { 16 };
+
+const struct vlc_bench_case bench_demux_cases[] = {
+    { "demux/ts/program", bench_demux_ts, &ts_program },
+    { "demux/ts/fullmux", bench_demux_ts, &ts_fullmux },
+    { NULL, NULL, NULL }
+};
@@ -0,0 +1,142 @@
+/*****************************************************************************
+ * packetizer.c: packetizer helpers micro-benchmarks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+
+#include "../../modules/packetizer/startcode_helper.h"
+#include "bench.h"
+
+#define BENCH_ES_SIZE (1 << 20)
+
+typedef const uint8_t *(*startcode_finder)(const uint8_t *, const uint8_t *);
+
+/**
+ * Generates an Annex B elementary stream with NAL units of pseudo-random
+ * sizes (about 4 KiB on average), with many zero bytes but no emulated
+ * start codes within the payloads.
+ */
+static uint8_t *bench_annexb_Data(unsigned *restrict count)
+{
+    uint8_t *buf = malloc(BENCH_ES_SIZE);
+    if (buf == NULL)
+        return NULL;
+
+    uint32_t seed = 0x12345678;
+    size_t next = 0;
+
+    *count = 0;
+    for (size_t i = 0; i < BENCH_ES_SIZE; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+
+        if (i == next && i + 4 <= BENCH_ES_SIZE)
+        {
+            memcpy(buf + i, (const uint8_t[]){ 0, 0, 0, 1 }, 4);
+            i += 3;
+            next += 4 + (seed >> 19);
+            (*count)++;
+        }
+        else /* 1 in 8 bytes is zero; never two zeroes in a row */
+            buf[i] = ((seed >> 29) == 0 && i > 0 && buf[i - 1] != 0)
+                   ? 0 : 1 + (seed >> 24) % 255;
+    }
+    return buf;
+}
+
+static bool bench_startcode_Supported(startcode_finder find)
+{
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    if (find == startcode_FindAnnexB_SSE2)
+        return vlc_CPU_SSE2();
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    if (find == startcode_FindAnnexB_AVX2)
+        return vlc_CPU_AVX2();
+#endif
+#if defined(HAVE_AVX512_INTRINSICS) && defined(__x86_64__)
+    if (find == startcode_FindAnnexB_AVX512)
+        return vlc_CPU_AVX512();
+#endif
+    return true;
+}
+
+static int bench_startcode(struct vlc_bench *b, const void *arg)
+{
+    startcode_finder find = (startcode_finder)arg;
+    unsigned expected;
+
+    if (!bench_startcode_Supported(find))
+        return -1;
+
+    bench_StopTimer(b);
+    uint8_t *buf = bench_annexb_Data(&expected);
+    if (buf == NULL)
+        abort();
+    bench_StartTimer(b);
+
+    const uint8_t *end = buf + BENCH_ES_SIZE;
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        unsigned count = 0;
+
+        for (const uint8_t *p = find(buf, end); p != NULL;
+             p = find(p + 3, end))
+            count++;
+        if (unlikely(count != expected))
+            abort();
+    }
+
+    bench_StopTimer(b);
+    free(buf);
+    b->bytes = BENCH_ES_SIZE;
+    return 0;
+}
+
+#define FINDER(f) ((const void *)(uintptr_t)(f))
+
+const struct vlc_bench_case bench_packetizer_cases[] = {
+    { "startcode/annexb", bench_startcode, FINDER(startcode_FindAnnexB) },
+    { "startcode/annexb/bits", bench_startcode,
+      FINDER(startcode_FindAnnexB_Bits) },
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    { "startcode/annexb/sse2", bench_startcode,
+      FINDER(startcode_FindAnnexB_SSE2) },
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    { "startcode/annexb/avx2", bench_startcode,
+      FINDER(startcode_FindAnnexB_AVX2) },
+#endif
+#if defined(HAVE_AVX512_INTRINSICS) && defined(__x86_64__)
+    { "startcode/annexb/avx512", bench_startcode,
+      FINDER(startcode_FindAnnexB_AVX512) },
+#endif
+#if defined(__ARM_NEON)
+    { "startcode/annexb/neon", bench_startcode,
+      FINDER(startcode_FindAnnexB_NEON) },
+#endif
+    { NULL, NULL, NULL }
+};
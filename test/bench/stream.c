@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * stream.c: byte stream micro-benchmarks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+#include <vlc_variables.h>
+
+#include "bench.h"
+
+#define BENCH_STREAM_SIZE (8 << 20)
+#define BENCH_CHUNK 1316 /* 7 TS packets, as in a typical UDP datagram */
+
+struct bench_stream_op
+{
+    bool file; /**< Whether to read from a file (or from memory) */
+    bool peek; /**< Whether to peek the data before skipping it */
+    bool mmap; /**< Whether to memory-map the file */
+};
+
+static uint8_t *bench_stream_Data(void)
+{
+    uint8_t *data = malloc(BENCH_STREAM_SIZE);
+
+    if (data != NULL)
+        for (size_t i = 0; i < BENCH_STREAM_SIZE; i++)
+            data[i] = i * 0x9E3779B1u >> 24;
+    return data;
+}
+
+static stream_t *bench_stream_OpenFile(vlc_object_t *obj, char **restrict pp)
+{
+    char path[] = "/tmp/vlc-bench-XXXXXX";
+    int fd = vlc_mkstemp(path);
+    if (fd == -1)
+        return NULL;
+
+    uint8_t *data = bench_stream_Data();
+    stream_t *s = NULL;
+
+    if (data != NULL && write(fd, data, BENCH_STREAM_SIZE) == BENCH_STREAM_SIZE)
+    {
+        char *url = vlc_path2uri(path, "file");
+        if (url != NULL)
+        {
+            s = vlc_stream_NewURL(obj, url);
+            free(url);
+        }
+    }
+    free(data);
+    vlc_close(fd);
+
+    if (s == NULL)
+    {
+        unlink(path);
+        return NULL;
+    }
+
+    *pp = strdup(path);
+    return s;
+}
+
+static int bench_stream(struct vlc_bench *b, const void *arg)
+{
+    const struct bench_stream_op *op = arg;
+    char *path = NULL;
+    stream_t *s;
+
+    bench_StopTimer(b);
+    var_Create(b->obj, "file-mmap", VLC_VAR_BOOL);
+    var_SetBool(b->obj, "file-mmap", op->mmap);
+
+    if (op->file)
+        s = bench_stream_OpenFile(b->obj, &path);
+    else
+    {
+        uint8_t *data = bench_stream_Data();
+        s = (data != NULL)
+            ? vlc_stream_MemoryNew(b->obj, data, BENCH_STREAM_SIZE, false)
+            : NULL;
+        if (s == NULL)
+            free(data);
+    }
+    if (s == NULL)
+        return -1;
+
+    uint8_t buf[BENCH_CHUNK];
+    bench_StartTimer(b);
+
+    for (uint64_t i = 0; i < b->n; i++)
+    {
+        ssize_t val;
+
+        if (op->peek)
+        {
+            const uint8_t *p;
+
+            val = vlc_stream_Peek(s, &p, BENCH_CHUNK);
+            if (val == BENCH_CHUNK)
+                val = vlc_stream_Read(s, NULL, BENCH_CHUNK);
+        }
+        else
+            val = vlc_stream_Read(s, buf, BENCH_CHUNK);
+
+        if (val < BENCH_CHUNK && vlc_stream_Seek(s, 0))
+            abort();
+    }
+
+    bench_StopTimer(b);
+    vlc_stream_Delete(s);
+    var_Destroy(b->obj, "file-mmap");
+    if (path != NULL)
+    {
+        unlink(path);
+        free(path);
+    }
+    b->bytes = BENCH_CHUNK;
+    return 0;
+}
+
+static const struct bench_stream_op memory_read = { false, false, false };
+static const struct bench_stream_op memory_peek = { false, true, false };
+static const struct bench_stream_op file_read = { true, false, false };
+static const struct bench_stream_op file_peek = { true, true, false };
+static const struct bench_stream_op mmap_read = { true, false, true };
+static const struct bench_stream_op mmap_peek = { true, true, true };
+
+const struct vlc_bench_case bench_stream_cases[] = {
+    { "stream/memory/read", bench_stream, &memory_read },
+    { "stream/memory/peek", bench_stream, &memory_peek },
+    { "stream/file/read", bench_stream, &file_read },
+    { "stream/file/peek", bench_stream, &file_peek },
+    { "stream/file/mmap/read", bench_stream, &mmap_read },
+    { "stream/file/mmap/peek", bench_stream, &mmap_peek },
+    { NULL, NULL, NULL }
+};
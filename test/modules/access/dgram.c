@@ -0,0 +1,147 @@
+/*****************************************************************************
+ * dgram.c: datagram receive ring tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_block.h>
+#include <vlc_network.h>
+
+#include "../../../modules/access/dgram.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+const char vlc_module_name[] = "test_dgram";
+
+#define MRU 1472
+
+static void SendDatagram(int fd, size_t size, unsigned seq)
+{
+    uint8_t *buf = malloc(size);
+    assert(buf != NULL);
+
+    for (size_t i = 0; i < size; i++)
+        buf[i] = seq + i * 7;
+
+    assert(send(fd, buf, size, 0) == (ssize_t)size);
+    free(buf);
+}
+
+static void CheckDatagram(const block_t *block, size_t size, unsigned seq)
+{
+    assert(block->i_buffer == size);
+    assert(!(block->i_flags & BLOCK_FLAG_CORRUPTED));
+
+    for (size_t i = 0; i < size; i++)
+        assert(block->p_buffer[i] == (uint8_t)(seq + i * 7));
+}
+
+static void test_ring(vlc_object_t *obj, unsigned count)
+{
+    /* Sizes around the MRU, and up to the largest UDP payload */
+    static const size_t sizes[] = {
+        188 * 7, 1, MRU - 1, MRU, MRU + 1, 9000, 1316, 65507, 4000, 65507,
+        188,
+    };
+    int fds[2];
+
+    test_log("Receiving with %u slot(s)\n", count);
+
+    int val = socketpair(AF_UNIX, SOCK_DGRAM, 0, fds);
+    assert(val == 0);
+    val = setsockopt(fds[0], SOL_SOCKET, SO_RCVBUF, &(int){ 1 << 20 },
+                     sizeof (int));
+    assert(val == 0);
+    val = setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &(int){ 1 << 20 },
+                     sizeof (int));
+    assert(val == 0);
+
+    dgram_ring_t *ring = dgram_ring_New(obj, fds[0], count, MRU, false);
+    assert(ring != NULL);
+
+    /* Queue all datagrams first, so that they are received in batches. */
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+        SendDatagram(fds[1], sizes[i], i);
+
+    size_t i = 0;
+    while (i < ARRAY_SIZE(sizes))
+    {
+        block_t *chain = dgram_ring_Recv(ring);
+        unsigned received = 0;
+
+        assert(chain != NULL);
+        for (block_t *block = chain; block != NULL; block = block->p_next)
+        {
+            assert(i < ARRAY_SIZE(sizes));
+            CheckDatagram(block, sizes[i], i);
+            received++;
+            i++;
+        }
+        assert(received <= count);
+        block_ChainRelease(chain);
+    }
+
+    /* Later datagrams go through the grown blocks. */
+    SendDatagram(fds[1], 65507, 42);
+    SendDatagram(fds[1], 100, 43);
+    for (unsigned seq = 42; seq < 44; )
+    {
+        block_t *chain = dgram_ring_Recv(ring);
+
+        assert(chain != NULL);
+        for (block_t *block = chain; block != NULL; block = block->p_next)
+        {
+            CheckDatagram(block, (seq == 42) ? 65507 : 100, seq);
+            seq++;
+        }
+        block_ChainRelease(chain);
+    }
+
+    dgram_ring_LogStats(ring);
+    dgram_ring_Delete(ring);
+    vlc_close(fds[1]);
+    vlc_close(fds[0]);
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    test_ring(obj, 1);
+    test_ring(obj, 4);
+    test_ring(obj, 32);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,200 @@
+/*****************************************************************************
+ * mp4_fragments.c: MP4 fragments index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_variables.h>
+
+#include "../../../modules/demux/mp4/fragments.h"
+#include "../../../modules/demux/index_cache.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+const char vlc_module_name[] = "test_mp4_fragments";
+
+#define FRAGMENTS 4000
+#define TRACKS 2
+
+/* 2s fragments of 1 MiB, the second track starting 100ms later */
+static mp4_fragments_index_t *create_index(void)
+{
+    mp4_fragments_index_t *index = MP4_Fragments_Index_New(TRACKS, FRAGMENTS);
+    assert(index != NULL);
+
+    for (unsigned i = 0; i < FRAGMENTS; i++)
+    {
+        index->pi_pos[i] = 4096 + ((uint64_t)i << 20);
+        index->p_times[i * TRACKS] = 2000 * i;
+        index->p_times[i * TRACKS + 1] = 2000 * i + 100;
+    }
+    index->i_last_time = 2000 * FRAGMENTS;
+    return index;
+}
+
+static void check_lookup(mp4_fragments_index_t *index, unsigned track,
+                         stime_t time, stime_t entry_time, uint64_t entry_pos)
+{
+    uint64_t pos;
+
+    assert(MP4_Fragments_Index_Lookup(index, &time, &pos, track));
+    assert(time == entry_time);
+    assert(pos == entry_pos);
+}
+
+static void check_index(mp4_fragments_index_t *index)
+{
+    check_lookup(index, 0, 0, 0, 4096);
+    check_lookup(index, 0, 1999, 0, 4096);
+    check_lookup(index, 0, 2000, 2000, 4096 + (1 << 20));
+    check_lookup(index, 0, 2001234, 2000000, 4096 + ((uint64_t)1000 << 20));
+    check_lookup(index, 0, 7999999, 7998000, 4096 + ((uint64_t)3999 << 20));
+    /* before the first fragment of that track */
+    check_lookup(index, 1, 50, 100, 4096);
+    check_lookup(index, 1, 2099, 100, 4096);
+    check_lookup(index, 1, 2100, 2100, 4096 + (1 << 20));
+
+    stime_t time = 8000000;
+    uint64_t pos;
+    assert(!MP4_Fragments_Index_Lookup(index, &time, &pos, 0));
+    time = 0;
+    assert(!MP4_Fragments_Index_Lookup(index, &time, &pos, TRACKS));
+
+    assert(MP4_Fragment_Index_GetTrackStartTime(index, 1, 0) == 100);
+    assert(MP4_Fragment_Index_GetTrackStartTime(index, 0, 4096) == 0);
+    assert(MP4_Fragment_Index_GetTrackStartTime(index, 1, 4097) == 2100);
+    assert(MP4_Fragment_Index_GetTrackStartTime(index, 0,
+                                      4096 + ((uint64_t)3999 << 20)) == 7998000);
+    assert(MP4_Fragment_Index_GetTrackStartTime(index, 0,
+                                      4097 + ((uint64_t)3999 << 20)) == 0);
+    assert(MP4_Fragment_Index_GetTrackDuration(index, 1) == 7998100);
+}
+
+static void test_lookup(void)
+{
+    test_log("Looking up fragments\n");
+
+    mp4_fragments_index_t *index = create_index();
+    check_index(index);
+    MP4_Fragments_Index_Delete(index);
+}
+
+/* Removes a cache file, and the cache directories up to the test directory
+ * once they are empty */
+static void remove_cache(const char *path, const char *tag, const char *dir)
+{
+    char *cache = index_cache_GetPath(path, tag);
+    assert(cache != NULL);
+    vlc_unlink(cache);
+
+    for (char *sep = strrchr(cache, DIR_SEP_CHAR);
+         sep != NULL && sep > cache + strlen(dir);
+         sep = strrchr(cache, DIR_SEP_CHAR))
+    {
+        *sep = '\0';
+        rmdir(cache);
+    }
+    free(cache);
+}
+
+static void test_cache(vlc_object_t *obj, const char *dir)
+{
+    char *path;
+    assert(asprintf(&path, "%s" DIR_SEP "media.mp4", dir) != -1);
+
+    test_log("Caching the fragments index of %s\n", path);
+
+    /* Large enough to be cached, and for the positions to be valid */
+    int fd = vlc_open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    assert(fd != -1);
+    assert(ftruncate(fd, (off_t)FRAGMENTS << 20) == 0);
+
+    assert(MP4_Fragments_Index_Load(obj, path, TRACKS) == NULL);
+
+    mp4_fragments_index_t *index = create_index();
+    MP4_Fragments_Index_Save(obj, path, index);
+    MP4_Fragments_Index_Delete(index);
+
+    index = MP4_Fragments_Index_Load(obj, path, TRACKS);
+    assert(index != NULL);
+    assert(index->i_entries == FRAGMENTS);
+    assert(index->i_tracks == TRACKS);
+    assert(index->i_last_time == 2000 * FRAGMENTS);
+    check_index(index);
+    MP4_Fragments_Index_Delete(index);
+
+    /* Not the same tracks */
+    assert(MP4_Fragments_Index_Load(obj, path, TRACKS + 1) == NULL);
+
+    /* Outdated when the file changes */
+    assert(ftruncate(fd, ((off_t)FRAGMENTS << 20) + 1) == 0);
+    assert(MP4_Fragments_Index_Load(obj, path, TRACKS) == NULL);
+
+    /* Not cached when disabled */
+    index = create_index();
+    MP4_Fragments_Index_Save(obj, path, index);
+    var_Create(obj, "demux-seek-index", VLC_VAR_BOOL);
+    var_SetBool(obj, "demux-seek-index", false);
+    mp4_fragments_index_t *loaded = MP4_Fragments_Index_Load(obj, path, TRACKS);
+    assert(loaded == NULL);
+    var_Destroy(obj, "demux-seek-index");
+    loaded = MP4_Fragments_Index_Load(obj, path, TRACKS);
+    assert(loaded != NULL);
+    MP4_Fragments_Index_Delete(loaded);
+    MP4_Fragments_Index_Delete(index);
+
+    vlc_close(fd);
+    remove_cache(path, "mp4frag", dir);
+    vlc_unlink(path);
+    free(path);
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    test_init();
+
+    char dir[] = "/tmp/vlc-test-mp4-fragments-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return 77;
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    test_lookup();
+    test_cache(VLC_OBJECT(vlc->p_libvlc_int), dir);
+
+    libvlc_release(vlc);
+
+    if (rmdir(dir))
+        test_log("Cannot remove %s\n", dir);
+    return 0;
+}
@@ -0,0 +1,508 @@
+/*****************************************************************************
+ * mp4_samples.c: MP4 sample tables lookup tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <assert.h>
+
+const char vlc_module_name[] = "test_mp4_samples";
+
+#define SAMPLES 25
+#define TIMESCALE 1000
+
+/* (count, value) pairs, with empty entries at the start, in the middle and
+ * at the end, and runs spanning chunk boundaries. */
+static const uint32_t stts[][2] = {
+    { 0, 999 }, { 4, 1000 }, { 0, 7 }, { 3, 500 }, { 7, 1500 }, { 0, 1 },
+    { 6, 2000 }, { 5, 250 }, { 0, 3 },
+};
+static const int32_t ctts[][2] = {
+    { 0, 42 }, { 2, 0 }, { 0, 9 }, { 5, 3000 }, { 1, -1000 }, { 9, 2000 },
+    { 8, 500 },
+};
+/* (first chunk, samples per chunk): 9 chunks of 3, 3, 1, 5, 5, 2, 2, 2, 2 */
+static const uint32_t stsc[][2] = {
+    { 1, 3 }, { 3, 1 }, { 4, 5 }, { 6, 2 },
+};
+#define CHUNKS 9
+
+/* Expanded reference */
+static struct
+{
+    uint32_t dts;
+    uint32_t duration;
+    int32_t offset;
+    uint32_t size;
+    uint64_t pos;
+} ref[SAMPLES];
+
+static uint32_t SampleSize(unsigned i)
+{
+    return 4 + (i * 37) % 61;
+}
+
+static void ExpandReference(void)
+{
+    unsigned i = 0;
+    uint32_t dts = 0;
+
+    for (size_t e = 0; e < ARRAY_SIZE(stts); e++)
+        for (uint32_t j = 0; j < stts[e][0]; j++, i++)
+        {
+            assert(i < SAMPLES);
+            ref[i].dts = dts;
+            ref[i].duration = stts[e][1];
+            dts += stts[e][1];
+        }
+    assert(i == SAMPLES);
+
+    i = 0;
+    for (size_t e = 0; e < ARRAY_SIZE(ctts); e++)
+        for (int32_t j = 0; j < ctts[e][0]; j++, i++)
+            ref[i].offset = ctts[e][1];
+    assert(i == SAMPLES);
+
+    for (i = 0; i < SAMPLES; i++)
+        ref[i].size = SampleSize(i);
+}
+
+struct buffer
+{
+    uint8_t *data;
+    size_t size;
+    size_t alloc;
+};
+
+static void PutBytes(struct buffer *b, const void *data, size_t size)
+{
+    if (b->size + size > b->alloc)
+    {
+        b->alloc = (b->size + size) * 2;
+        b->data = realloc(b->data, b->alloc);
+        assert(b->data != NULL);
+    }
+    memcpy(&b->data[b->size], data, size);
+    b->size += size;
+}
+
+static void Put8(struct buffer *b, uint8_t v)
+{
+    PutBytes(b, &v, 1);
+}
+
+static void Put16(struct buffer *b, uint16_t v)
+{
+    uint8_t buf[2];
+    SetWBE(buf, v);
+    PutBytes(b, buf, 2);
+}
+
+static void Put32(struct buffer *b, uint32_t v)
+{
+    uint8_t buf[4];
+    SetDWBE(buf, v);
+    PutBytes(b, buf, 4);
+}
+
+static void Put64(struct buffer *b, uint64_t v)
+{
+    uint8_t buf[8];
+    SetQWBE(buf, v);
+    PutBytes(b, buf, 8);
+}
+
+static void PutZeros(struct buffer *b, size_t size)
+{
+    while (size-- > 0)
+        Put8(b, 0);
+}
+
+/* Starts a box, returns its offset for BoxEnd() */
+static size_t BoxStart(struct buffer *b, const char *type)
+{
+    size_t offset = b->size;
+    Put32(b, 0);
+    PutBytes(b, type, 4);
+    return offset;
+}
+
+static size_t FullBoxStart(struct buffer *b, const char *type,
+                           uint8_t version, uint32_t flags)
+{
+    size_t offset = BoxStart(b, type);
+    Put32(b, ((uint32_t)version << 24) | flags);
+    return offset;
+}
+
+static void BoxEnd(struct buffer *b, size_t offset)
+{
+    SetDWBE(&b->data[offset], b->size - offset);
+}
+
+static void PutMatrix(struct buffer *b)
+{
+    static const uint32_t matrix[9] = {
+        0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000,
+    };
+    for (unsigned i = 0; i < 9; i++)
+        Put32(b, matrix[i]);
+}
+
+static void PutSampleTable(struct buffer *b, const uint64_t *chunks,
+                           bool co64)
+{
+    size_t stbl = BoxStart(b, "stbl");
+
+    size_t box = FullBoxStart(b, "stsd", 0, 0);
+    Put32(b, 1);
+    size_t entry = BoxStart(b, "jpeg");
+    PutZeros(b, 6);
+    Put16(b, 1); /* data reference index */
+    PutZeros(b, 16);
+    Put16(b, 64);
+    Put16(b, 48);
+    Put32(b, 0x480000);
+    Put32(b, 0x480000);
+    Put32(b, 0);
+    Put16(b, 1);
+    PutZeros(b, 32);
+    Put16(b, 24);
+    Put16(b, 0xffff);
+    BoxEnd(b, entry);
+    BoxEnd(b, box);
+
+    box = FullBoxStart(b, "stts", 0, 0);
+    Put32(b, ARRAY_SIZE(stts));
+    for (size_t i = 0; i < ARRAY_SIZE(stts); i++)
+    {
+        Put32(b, stts[i][0]);
+        Put32(b, stts[i][1]);
+    }
+    BoxEnd(b, box);
+
+    /* version 1 for the negative offset */
+    box = FullBoxStart(b, "ctts", 1, 0);
+    Put32(b, ARRAY_SIZE(ctts));
+    for (size_t i = 0; i < ARRAY_SIZE(ctts); i++)
+    {
+        Put32(b, ctts[i][0]);
+        Put32(b, ctts[i][1]);
+    }
+    BoxEnd(b, box);
+
+    box = FullBoxStart(b, "stsc", 0, 0);
+    Put32(b, ARRAY_SIZE(stsc));
+    for (size_t i = 0; i < ARRAY_SIZE(stsc); i++)
+    {
+        Put32(b, stsc[i][0]);
+        Put32(b, stsc[i][1]);
+        Put32(b, 1);
+    }
+    BoxEnd(b, box);
+
+    box = FullBoxStart(b, "stsz", 0, 0);
+    Put32(b, 0);
+    Put32(b, SAMPLES);
+    for (unsigned i = 0; i < SAMPLES; i++)
+        Put32(b, ref[i].size);
+    BoxEnd(b, box);
+
+    box = FullBoxStart(b, co64 ? "co64" : "stco", 0, 0);
+    Put32(b, CHUNKS);
+    for (unsigned i = 0; i < CHUNKS; i++)
+    {
+        if (co64)
+            Put64(b, chunks[i]);
+        else
+            Put32(b, chunks[i]);
+    }
+    BoxEnd(b, box);
+
+    BoxEnd(b, stbl);
+}
+
+/* Writes a single video track file, the samples first */
+static uint8_t *CreateFile(bool co64, size_t *size)
+{
+    struct buffer b = { NULL, 0, 0 };
+    uint64_t chunks[CHUNKS];
+
+    size_t box = BoxStart(&b, "ftyp");
+    PutBytes(&b, "isom", 4);
+    Put32(&b, 0);
+    PutBytes(&b, "isom", 4);
+    BoxEnd(&b, box);
+
+    /* Chunks separated by some garbage */
+    size_t mdat = BoxStart(&b, "mdat");
+    unsigned sample = 0;
+    for (unsigned chunk = 0; chunk < CHUNKS; chunk++)
+    {
+        uint32_t count = 0;
+        for (size_t i = 0; i < ARRAY_SIZE(stsc); i++)
+            if (stsc[i][0] <= chunk + 1)
+                count = stsc[i][1];
+
+        for (unsigned i = 0; i < chunk % 3 * 7; i++)
+            Put8(&b, 0xA5);
+
+        chunks[chunk] = b.size;
+        for (uint32_t i = 0; i < count; i++, sample++)
+        {
+            assert(sample < SAMPLES);
+            ref[sample].pos = b.size;
+            Put32(&b, sample);
+            for (uint32_t j = 4; j < ref[sample].size; j++)
+                Put8(&b, sample);
+        }
+    }
+    assert(sample == SAMPLES);
+    BoxEnd(&b, mdat);
+
+    size_t moov = BoxStart(&b, "moov");
+
+    box = FullBoxStart(&b, "mvhd", 0, 0);
+    Put32(&b, 0);
+    Put32(&b, 0);
+    Put32(&b, TIMESCALE);
+    Put32(&b, ref[SAMPLES - 1].dts + ref[SAMPLES - 1].duration);
+    Put32(&b, 0x10000);
+    Put16(&b, 0x100);
+    PutZeros(&b, 10);
+    PutMatrix(&b);
+    PutZeros(&b, 24);
+    Put32(&b, 2);
+    BoxEnd(&b, box);
+
+    size_t trak = BoxStart(&b, "trak");
+
+    box = FullBoxStart(&b, "tkhd", 0, 1 /* enabled */);
+    Put32(&b, 0);
+    Put32(&b, 0);
+    Put32(&b, 1);
+    Put32(&b, 0);
+    Put32(&b, ref[SAMPLES - 1].dts + ref[SAMPLES - 1].duration);
+    PutZeros(&b, 16);
+    PutMatrix(&b);
+    Put32(&b, 64 << 16);
+    Put32(&b, 48 << 16);
+    BoxEnd(&b, box);
+
+    size_t mdia = BoxStart(&b, "mdia");
+
+    box = FullBoxStart(&b, "mdhd", 0, 0);
+    Put32(&b, 0);
+    Put32(&b, 0);
+    Put32(&b, TIMESCALE);
+    Put32(&b, ref[SAMPLES - 1].dts + ref[SAMPLES - 1].duration);
+    Put16(&b, 0x55c4); /* und */
+    Put16(&b, 0);
+    BoxEnd(&b, box);
+
+    box = FullBoxStart(&b, "hdlr", 0, 0);
+    Put32(&b, 0);
+    PutBytes(&b, "vide", 4);
+    PutZeros(&b, 12);
+    PutBytes(&b, "test", 5);
+    BoxEnd(&b, box);
+
+    size_t minf = BoxStart(&b, "minf");
+    box = FullBoxStart(&b, "vmhd", 0, 1);
+    PutZeros(&b, 8);
+    BoxEnd(&b, box);
+    PutSampleTable(&b, chunks, co64);
+    BoxEnd(&b, minf);
+
+    BoxEnd(&b, mdia);
+    BoxEnd(&b, trak);
+    BoxEnd(&b, moov);
+
+    *size = b.size;
+    return b.data;
+}
+
+/* Checks the samples sent by the demuxer against the reference, in order
+ * from the expected one */
+struct test_es_out
+{
+    es_out_t out;
+    unsigned next;
+    unsigned received;
+    bool discontinuity;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    (void) in;
+    assert(fmt->i_cat == VIDEO_ES);
+    return (es_out_id_t *)out;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct test_es_out *ctx = container_of(out, struct test_es_out, out);
+    const unsigned i = ctx->next;
+
+    assert(id == (es_out_id_t *)out);
+    assert(i < SAMPLES);
+
+    /* position and size */
+    assert(block->i_buffer == ref[i].size);
+    assert(GetDWBE(block->p_buffer) == i);
+    for (size_t j = 4; j < block->i_buffer; j++)
+        assert(block->p_buffer[j] == (uint8_t)i);
+
+    assert(block->i_dts == VLC_TICK_0 + VLC_TICK_FROM_MS(ref[i].dts));
+    assert(block->i_pts == block->i_dts + VLC_TICK_FROM_MS(ref[i].offset));
+    assert(block->i_length == VLC_TICK_FROM_MS(ref[i].duration));
+    assert(!!(block->i_flags & BLOCK_FLAG_DISCONTINUITY) ==
+           ctx->discontinuity);
+
+    ctx->discontinuity = false;
+    ctx->next++;
+    ctx->received++;
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    assert(id == (es_out_id_t *)out);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    (void) out; (void) in;
+
+    switch (query)
+    {
+        case ES_OUT_GET_ES_STATE:
+            (void) va_arg(args, es_out_id_t *);
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_NEXT_DISPLAY_TIME:
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static const struct es_out_callbacks es_out_cbs = {
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+};
+
+/* Seeks, and reads a few samples from there */
+static void SeekAndRead(demux_t *demux, struct test_es_out *ctx,
+                        uint32_t time, unsigned count)
+{
+    /* the sample being decoded at that time */
+    unsigned i = SAMPLES - 1;
+    while (ref[i].dts > time)
+        i--;
+
+    assert(demux_Control(demux, DEMUX_SET_TIME, VLC_TICK_FROM_MS(time),
+                         false) == VLC_SUCCESS);
+    ctx->next = i;
+    ctx->received = 0;
+    ctx->discontinuity = true;
+
+    while (ctx->received < count)
+    {
+        int ret = demux_Demux(demux);
+        if (ret != VLC_DEMUXER_SUCCESS)
+        {
+            assert(ret == VLC_DEMUXER_EOF);
+            break;
+        }
+    }
+    assert(ctx->received >= count || ctx->next == SAMPLES);
+    assert(ctx->received > 0);
+}
+
+static void test_samples(vlc_object_t *obj, bool co64)
+{
+    test_log("Reading samples with %s chunk offsets\n",
+             co64 ? "64 bits" : "32 bits");
+
+    size_t size;
+    uint8_t *data = CreateFile(co64, &size);
+    stream_t *s = vlc_stream_MemoryNew(obj, data, size, true);
+    assert(s != NULL);
+
+    struct test_es_out ctx = { .out = { .cbs = &es_out_cbs } };
+    demux_t *demux = demux_New(obj, "mp4", s, &ctx.out);
+    assert(demux != NULL);
+
+    /* Every sample, in order */
+    int ret;
+    while ((ret = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS);
+    assert(ret == VLC_DEMUXER_EOF);
+    assert(ctx.next == SAMPLES);
+
+    /* Backwards, to another chunk */
+    SeekAndRead(demux, &ctx, 9000, 2);
+    /* Backwards inside the same chunk, from a later lookup */
+    SeekAndRead(demux, &ctx, 5600, 3);
+    /* Forward, inside a chunk, and across runs of durations */
+    SeekAndRead(demux, &ctx, 17234, 4);
+    /* At a chunk start, and at the first and last samples */
+    SeekAndRead(demux, &ctx, 5500, 1);
+    SeekAndRead(demux, &ctx, 4200, 6);
+    SeekAndRead(demux, &ctx, 0, SAMPLES);
+    SeekAndRead(demux, &ctx, ref[SAMPLES - 1].dts + 10, 1);
+
+    demux_Delete(demux);
+    free(data);
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    test_init();
+    ExpandReference();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    test_samples(obj, false);
+    test_samples(obj, true);
+
+    libvlc_release(vlc);
+    return 0;
+}
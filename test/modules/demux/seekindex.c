@@ -0,0 +1,260 @@
+/*****************************************************************************
+ * seekindex.c: MPEG demuxers seek index tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_variables.h>
+
+#include "../../../modules/demux/mpeg/seekindex.h"
+#include "../../../modules/demux/index_cache.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char vlc_module_name[] = "test_seekindex";
+
+static void check_entry(const seek_index_t *index, vlc_tick_t time,
+                        vlc_tick_t entry_time, uint64_t entry_pos)
+{
+    vlc_tick_t found_time;
+    uint64_t found_pos;
+
+    assert(seek_index_Lookup(index, time, &found_time, &found_pos) == VLC_SUCCESS);
+    assert(found_time == entry_time);
+    assert(found_pos == entry_pos);
+}
+
+static void check_none(const seek_index_t *index, vlc_tick_t time)
+{
+    vlc_tick_t found_time;
+    uint64_t found_pos;
+
+    assert(seek_index_Lookup(index, time, &found_time, &found_pos) != VLC_SUCCESS);
+}
+
+static void test_lookup(vlc_object_t *obj)
+{
+    seek_index_t *index = seek_index_New(obj, NULL, "test");
+    assert(index != NULL);
+
+    test_log("Adding and looking up entries\n");
+
+    check_none(index, VLC_TICK_FROM_SEC(1));
+
+    /* Every 100ms, as PCRs, while playing the first 10s */
+    for (unsigned i = 0; i < 100; i++)
+        seek_index_Add(index, VLC_TICK_FROM_MS(100 * i), 1000 * i);
+
+    check_entry(index, 0, 0, 0);
+    check_entry(index, VLC_TICK_FROM_MS(500), 0, 0);
+    check_entry(index, VLC_TICK_FROM_SEC(1), VLC_TICK_FROM_SEC(1), 10000);
+    check_entry(index, VLC_TICK_FROM_MS(9999), VLC_TICK_FROM_SEC(9), 90000);
+    check_none(index, -1);
+    /* Too far after the last entry */
+    check_entry(index, VLC_TICK_FROM_MS(10900), VLC_TICK_FROM_SEC(9), 90000);
+    check_none(index, VLC_TICK_FROM_SEC(11));
+
+    /* Then from 60s on, after a seek */
+    for (unsigned i = 600; i < 700; i++)
+        seek_index_Add(index, VLC_TICK_FROM_MS(100 * i), 1000 * i);
+    check_none(index, VLC_TICK_FROM_SEC(30));
+    check_entry(index, VLC_TICK_FROM_MS(61500), VLC_TICK_FROM_SEC(61), 610000);
+
+    /* In between, too close to existing entries, or inconsistent */
+    seek_index_Add(index, VLC_TICK_FROM_SEC(30), 300000);
+    check_entry(index, VLC_TICK_FROM_MS(30500), VLC_TICK_FROM_SEC(30), 300000);
+    seek_index_Add(index, VLC_TICK_FROM_MS(30500), 305000);
+    check_entry(index, VLC_TICK_FROM_MS(30500), VLC_TICK_FROM_SEC(30), 300000);
+    seek_index_Add(index, VLC_TICK_FROM_SEC(40), 200000);
+    check_none(index, VLC_TICK_FROM_SEC(40));
+    seek_index_Add(index, VLC_TICK_FROM_SEC(40), 400000);
+    check_entry(index, VLC_TICK_FROM_SEC(40), VLC_TICK_FROM_SEC(40), 400000);
+
+    seek_index_Delete(index);
+}
+
+/* Removes a cache file, and the cache directories up to the test directory
+ * once they are empty */
+static void remove_cache(const char *path, const char *tag, const char *dir)
+{
+    char *cache = index_cache_GetPath(path, tag);
+    assert(cache != NULL);
+    vlc_unlink(cache);
+
+    for (char *sep = strrchr(cache, DIR_SEP_CHAR);
+         sep != NULL && sep > cache + strlen(dir);
+         sep = strrchr(cache, DIR_SEP_CHAR))
+    {
+        *sep = '\0';
+        rmdir(cache);
+    }
+    free(cache);
+}
+
+static void test_cache(vlc_object_t *obj, const char *dir)
+{
+    char *path;
+    assert(asprintf(&path, "%s" DIR_SEP "media.ts", dir) != -1);
+
+    test_log("Caching the index of %s\n", path);
+
+    /* Large enough to be cached */
+    int fd = vlc_open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    assert(fd != -1);
+    assert(ftruncate(fd, SEEK_INDEX_MIN_FILESIZE) == 0);
+
+    seek_index_t *index = seek_index_New(obj, path, "test");
+    assert(index != NULL);
+    check_none(index, 0);
+    for (unsigned i = 0; i < 3600; i++)
+        seek_index_Add(index, VLC_TICK_FROM_SEC(i), 4096 * i);
+    seek_index_Delete(index);
+
+    index = seek_index_New(obj, path, "test");
+    assert(index != NULL);
+    check_entry(index, VLC_TICK_FROM_MS(1234500), VLC_TICK_FROM_SEC(1234),
+                4096 * 1234);
+    check_entry(index, VLC_TICK_FROM_SEC(3599), VLC_TICK_FROM_SEC(3599),
+                4096 * 3599);
+    seek_index_Delete(index);
+
+    /* Separate index for another format of the same file */
+    index = seek_index_New(obj, path, "other");
+    assert(index != NULL);
+    check_none(index, VLC_TICK_FROM_SEC(1234));
+    seek_index_Delete(index);
+
+    /* Outdated when the file changes */
+    assert(ftruncate(fd, SEEK_INDEX_MIN_FILESIZE + 188) == 0);
+    index = seek_index_New(obj, path, "test");
+    assert(index != NULL);
+    check_none(index, VLC_TICK_FROM_SEC(1234));
+    seek_index_Delete(index);
+
+    /* Small files are not cached */
+    assert(ftruncate(fd, 188) == 0);
+    index = seek_index_New(obj, path, "test");
+    assert(index != NULL);
+    seek_index_Add(index, 0, 0);
+    seek_index_Delete(index);
+    assert(ftruncate(fd, SEEK_INDEX_MIN_FILESIZE + 188) == 0);
+    index = seek_index_New(obj, path, "test");
+    assert(index != NULL);
+    check_none(index, VLC_TICK_FROM_SEC(1234));
+    seek_index_Delete(index);
+
+    vlc_close(fd);
+    remove_cache(path, "test", dir);
+    remove_cache(path, "other", dir);
+    vlc_unlink(path);
+    free(path);
+}
+
+static void test_evict(vlc_object_t *obj, const char *dir)
+{
+    const unsigned count = INDEX_CACHE_MAX_FILES + 4;
+    char name[32], *cache = NULL;
+
+    test_log("Writing %u cache files\n", count);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        snprintf(name, sizeof (name), "media%u.ts", i);
+        free(cache);
+        cache = index_cache_GetPath(name, "test");
+        assert(cache != NULL);
+
+        char *tmp;
+        FILE *file = index_cache_OpenWrite(obj, cache, &tmp);
+        assert(file != NULL);
+        assert(fputs("index", file) >= 0);
+        assert(index_cache_CloseWrite(obj, file, false, cache, tmp)
+               == VLC_SUCCESS);
+
+        /* The file just written is kept */
+        struct stat st;
+        assert(vlc_stat(cache, &st) == 0);
+    }
+
+    /* The oldest files were removed */
+    *strrchr(cache, DIR_SEP_CHAR) = '\0';
+    DIR *cachedir = vlc_opendir(cache);
+    assert(cachedir != NULL);
+
+    unsigned left = 0;
+    const char *entry;
+    while ((entry = vlc_readdir(cachedir)) != NULL)
+        if (strchr(entry, '.') == NULL)
+            left++;
+    closedir(cachedir);
+    assert(left == INDEX_CACHE_MAX_FILES);
+    free(cache);
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        snprintf(name, sizeof (name), "media%u.ts", i);
+        remove_cache(name, "test", dir);
+    }
+}
+
+static void test_disabled(vlc_object_t *obj)
+{
+    var_Create(obj, "demux-seek-index", VLC_VAR_BOOL);
+    var_SetBool(obj, "demux-seek-index", false);
+    assert(seek_index_New(obj, NULL, "test") == NULL);
+    var_Destroy(obj, "demux-seek-index");
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    test_init();
+
+    char dir[] = "/tmp/vlc-test-seekindex-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return 77;
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    test_lookup(obj);
+    test_cache(obj, dir);
+    test_evict(obj, dir);
+    test_disabled(obj);
+
+    libvlc_release(vlc);
+
+    if (rmdir(dir))
+        test_log("Cannot remove %s\n", dir);
+    return 0;
+}
@@ -23,6 +23,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <assert.h>
 
 #include "../../../modules/demux/mpeg/ts_streams.h"
 #include "../../../modules/demux/mpeg/ts_pid_fwd.h"
@@ -36,7 +37,8 @@ static void Parse(vlc_object_t *obj, void *priv, block_t *data)
     VLC_UNUSED(obj);
     block_t **pp_append = (block_t **) priv;
     fprintf(stderr, "recv: ");
-    data = block_ChainGather(data);
+    /* gathered in a single buffer */
+    assert(data->p_next == NULL);
     for(size_t i=0; i<data->i_buffer; i++)
         fprintf(stderr, "%2.2x ", data->p_buffer[i]);
     fprintf(stderr, "\n");
@@ -49,7 +51,6 @@ static void Parse(vlc_object_t *obj, void *priv, block_t *data)
     block_ChainRelease(pes.gather.p_data);\
     memset(&pes, 0, sizeof(pes));\
     pes.transport = TS_TRANSPORT_PES;\
-    pes.gather.pp_last = &pes.gather.p_data;\
     } while(0)
 
 #define ASSERT(a) do {\
@@ -87,7 +88,6 @@ int main()
     ts_stream_t pes;
     memset(&pes, 0, sizeof(pes));
     pes.transport = TS_TRANSPORT_PES;
-    pes.gather.pp_last = &pes.gather.p_data;
 
     /* General case, aligned payloads */
     /* payload == 0 */
@@ -64,32 +64,127 @@ static int check_set( const uint8_t *p_set, const uint8_t *p_end,
     return 0;
 }
 
+typedef const uint8_t *(*startcode_finder)(const uint8_t *, const uint8_t *);
+
+static const struct
+{
+    const char *name;
+    startcode_finder pf_find;
+} finders[] = {
+    { "bits", startcode_FindAnnexB_Bits },
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    { "sse2", startcode_FindAnnexB_SSE2 },
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    { "avx2", startcode_FindAnnexB_AVX2 },
+#endif
+#if defined(HAVE_AVX512_INTRINSICS) && defined(__x86_64__)
+    { "avx512", startcode_FindAnnexB_AVX512 },
+#endif
+#if defined(__ARM_NEON)
+    { "neon", startcode_FindAnnexB_NEON },
+#endif
+    { "dispatch", startcode_FindAnnexB },
+};
+
+static bool finder_supported( startcode_finder pf_find )
+{
+#if defined(CAN_COMPILE_SSE2) || defined(HAVE_SSE2_INTRINSICS)
+    if( pf_find == startcode_FindAnnexB_SSE2 )
+        return vlc_CPU_SSE2();
+#endif
+#if defined(HAVE_AVX2_INTRINSICS)
+    if( pf_find == startcode_FindAnnexB_AVX2 )
+        return vlc_CPU_AVX2();
+#endif
+#if defined(HAVE_AVX512_INTRINSICS) && defined(__x86_64__)
+    if( pf_find == startcode_FindAnnexB_AVX512 )
+        return vlc_CPU_AVX512();
+#endif
+    VLC_UNUSED(pf_find);
+    return true;
+}
+
 static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
                             const struct results_s *p_results, size_t i_results,
                             ssize_t i_results_offset )
 {
-    int i_ret;
-
-    printf("checking bits code:\n");
-    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                       startcode_FindAnnexB_Bits );
-    if( i_ret != 0 )
-        return i_ret;
-
-    /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+    for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
     {
-        printf("checking asm:\n");
-        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+        if( !finder_supported( finders[i].pf_find ) )
+        {
+            printf("%s code not supported by the CPU, skipping test\n",
+                   finders[i].name);
+            continue;
+        }
+
+        printf("checking %s code:\n", finders[i].name);
+        int i_ret = check_set( p_set, p_end, p_results, i_results,
+                               i_results_offset, finders[i].pf_find );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
 
     return 0;
 }
 
+static const uint8_t * startcode_FindAnnexB_Ref( const uint8_t *p, const uint8_t *end )
+{
+    for( ; end - p >= 3; p++ )
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 )
+            return p;
+    return NULL;
+}
+
+/* Compares every code path with the byte-wise reference on random data with
+ * many zeroes, for all buffer alignments and many buffer lengths. */
+static int run_annexb_random( void )
+{
+    const size_t i_size = 4096;
+    uint8_t *p_data = malloc( i_size + 64 );
+    if( !p_data )
+        return 0;
+
+    uint32_t seed = 0xdeadbeef;
+    for( size_t i = 0; i < i_size + 64; i++ )
+    {
+        seed = seed * 1664525 + 1013904223;
+        /* Zeroes are frequent, ones somewhat less, other values rare. */
+        p_data[i] = (seed >> 30) < 2 ? 0 : (seed >> 30) == 2 ? 1 : seed >> 24;
+    }
+
+    for( size_t i = 0; i < ARRAY_SIZE(finders); i++ )
+    {
+        if( !finder_supported( finders[i].pf_find ) )
+            continue;
+
+        printf("checking %s code on random data\n", finders[i].name);
+        for( size_t i_align = 0; i_align < 64; i_align++ )
+            for( size_t i_len = 0; i_len < i_size; i_len += 1 + i_len / 8 )
+            {
+                const uint8_t *p = &p_data[i_align], *end = p + i_len;
+
+                for( ;; )
+                {
+                    const uint8_t *p_ref = startcode_FindAnnexB_Ref( p, end );
+                    if( finders[i].pf_find( p, end ) != p_ref )
+                    {
+                        printf("mismatch at %zu/%zu/%td\n",
+                               i_align, i_len, p - p_data);
+                        free( p_data );
+                        return 1;
+                    }
+                    if( p_ref == NULL )
+                        break;
+                    p = p_ref + 1;
+                }
+            }
+    }
+
+    free( p_data );
+    return 0;
+}
+
 int main( void )
 {
     const uint8_t test1_annexbdata[] = { 0, 0, 0, 1, 0x55, 0x55, 0x55, 0x55, 0x55, // 9
@@ -134,5 +229,6 @@ int main( void )
             return i_ret;
     }
 
-    return 0;
+    printf("* Running tests on random data:\n");
+    return run_annexb_random();
 }
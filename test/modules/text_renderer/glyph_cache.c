@@ -0,0 +1,262 @@
+/*****************************************************************************
+ * glyph_cache.c: FreeType glyph cache tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <vlc_common.h>
+
+#include "../../../modules/text_renderer/freetype/glyph_cache.h"
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <assert.h>
+#include FT_BITMAP_H
+
+const char vlc_module_name[] = "test_glyph_cache";
+
+/* 16 kiB bitmaps: 8 fit in the cache, 9 do not. */
+#define BITMAP_SIZE 128
+#define CACHE_SIZE  (8 * BITMAP_SIZE * BITMAP_SIZE + 8 * 1024)
+
+static FT_Library library;
+
+static glyph_cache_key_t Key(uintptr_t face, unsigned index)
+{
+    glyph_cache_key_t key;
+
+    memset(&key, 0, sizeof (key));
+    key.p_face = (FT_Face)face;
+    key.i_index = index;
+    return key;
+}
+
+/* Creates a bitmap glyph, tagged with its horizontal bearing */
+static FT_Glyph NewBitmap(int tag)
+{
+    FT_Glyph glyph;
+    FT_Bitmap bitmap;
+    unsigned char *buf = calloc(BITMAP_SIZE, BITMAP_SIZE);
+
+    assert(buf != NULL);
+    FT_Bitmap_Init(&bitmap);
+    bitmap.rows = bitmap.width = bitmap.pitch = BITMAP_SIZE;
+    bitmap.pixel_mode = FT_PIXEL_MODE_GRAY;
+    bitmap.num_grays = 256;
+    bitmap.buffer = buf;
+
+    assert(FT_New_Glyph(library, FT_GLYPH_FORMAT_BITMAP, &glyph) == 0);
+    FT_BitmapGlyph bg = (FT_BitmapGlyph)glyph;
+    assert(FT_Bitmap_Copy(library, &bitmap, &bg->bitmap) == 0);
+    bg->left = tag;
+    bg->top = -tag;
+    free(buf);
+    return glyph;
+}
+
+static bool HasBitmap(glyph_cache_t *cache, const glyph_cache_key_t *key,
+                      bool outline, FT_Pos x, FT_Pos y, int tag)
+{
+    const FT_Vector origin = { x, y };
+    FT_Glyph glyph = GlyphCacheGetBitmap(cache, key, outline, &origin);
+
+    if (glyph == NULL)
+        return false;
+
+    FT_BitmapGlyph bg = (FT_BitmapGlyph)glyph;
+    assert(bg->left == tag + x / 64);
+    assert(bg->top == -tag + y / 64);
+    assert(bg->bitmap.rows == BITMAP_SIZE);
+    FT_Done_Glyph(glyph);
+    return true;
+}
+
+static void PutBitmap(glyph_cache_t *cache, const glyph_cache_key_t *key,
+                      bool outline, FT_Pos x, FT_Pos y, int tag)
+{
+    const FT_Vector origin = { x, y };
+    FT_Glyph glyph = NewBitmap(tag);
+
+    /* The bitmap is rendered at the pen position */
+    ((FT_BitmapGlyph)glyph)->left += x / 64;
+    ((FT_BitmapGlyph)glyph)->top += y / 64;
+    GlyphCachePutBitmap(cache, key, outline, &origin, glyph);
+    FT_Done_Glyph(glyph);
+}
+
+static void test_lookup(vlc_object_t *obj)
+{
+    test_log("Looking up glyphs\n");
+
+    glyph_cache_t *cache = GlyphCacheNew(CACHE_SIZE);
+    assert(cache != NULL);
+
+    glyph_cache_key_t key = Key(1, 42);
+    FT_Glyph glyph, outline;
+    FT_Vector advance;
+
+    /* Outlines */
+    assert(GlyphCacheGetOutlines(cache, &key, &glyph, &outline,
+                                 &advance) != VLC_SUCCESS);
+    assert(FT_New_Glyph(library, FT_GLYPH_FORMAT_OUTLINE, &glyph) == 0);
+    GlyphCachePutOutlines(cache, &key, glyph, NULL,
+                          &(FT_Vector){ 640, 0 });
+    FT_Done_Glyph(glyph);
+    assert(GlyphCacheGetOutlines(cache, &key, &glyph, &outline,
+                                 &advance) == VLC_SUCCESS);
+    assert(glyph->format == FT_GLYPH_FORMAT_OUTLINE);
+    assert(outline == NULL);
+    assert(advance.x == 640 && advance.y == 0);
+    FT_Done_Glyph(glyph);
+
+    /* Bitmaps, moved to the whole pixel part of the pen position */
+    PutBitmap(cache, &key, false, 3 * 64 + 5, 2 * 64 + 7, 1);
+    assert(HasBitmap(cache, &key, false, 3 * 64 + 5, 2 * 64 + 7, 1));
+    assert(HasBitmap(cache, &key, false, 10 * 64 + 5, 7, 1));
+    assert(!HasBitmap(cache, &key, false, 3 * 64 + 6, 2 * 64 + 7, 1));
+    assert(!HasBitmap(cache, &key, false, 3 * 64 + 5, 2 * 64 + 8, 1));
+    assert(!HasBitmap(cache, &key, true, 3 * 64 + 5, 2 * 64 + 7, 1));
+
+    /* Every key field matters. */
+    glyph_cache_key_t other = Key(2, 42);
+    assert(!HasBitmap(cache, &other, false, 5, 7, 1));
+    other = Key(1, 43);
+    assert(!HasBitmap(cache, &other, false, 5, 7, 1));
+    other = Key(1, 42);
+    other.i_flags = STYLE_BOLD;
+    assert(!HasBitmap(cache, &other, false, 5, 7, 1));
+    assert(GlyphCacheGetOutlines(cache, &other, &glyph, &outline,
+                                 &advance) != VLC_SUCCESS);
+    other = Key(1, 42);
+    other.i_radius = 64;
+    assert(!HasBitmap(cache, &other, false, 5, 7, 1));
+
+    /* Same key, built separately */
+    other = Key(1, 42);
+    assert(HasBitmap(cache, &other, false, 5, 7, 1));
+
+    GlyphCacheFlush(cache);
+    assert(!HasBitmap(cache, &key, false, 5, 7, 1));
+    assert(GlyphCacheGetOutlines(cache, &key, &glyph, &outline,
+                                 &advance) != VLC_SUCCESS);
+
+    GlyphCacheDelete(obj, cache);
+}
+
+static void test_runs(vlc_object_t *obj)
+{
+    test_log("Looking up shaped runs\n");
+
+    glyph_cache_t *cache = GlyphCacheNew(CACHE_SIZE);
+    assert(cache != NULL);
+
+    static const char key[] = "face/script/direction/text";
+    static const char glyphs[] = "shaped glyphs";
+    void *data;
+    size_t size;
+
+    assert(GlyphCacheGetRun(cache, key, sizeof (key), &data,
+                            &size) != VLC_SUCCESS);
+    data = strdup(glyphs);
+    assert(data != NULL);
+    GlyphCachePutRun(cache, key, sizeof (key), data, sizeof (glyphs));
+
+    /* Every lookup returns its own copy of the shaper output */
+    for (unsigned i = 0; i < 2; i++)
+    {
+        assert(GlyphCacheGetRun(cache, key, sizeof (key), &data,
+                                &size) == VLC_SUCCESS);
+        assert(size == sizeof (glyphs));
+        assert(memcmp(data, glyphs, size) == 0);
+        free(data);
+    }
+
+    /* Keys are compared over their whole length */
+    assert(GlyphCacheGetRun(cache, key, sizeof (key) - 1, &data,
+                            &size) != VLC_SUCCESS);
+    assert(GlyphCacheGetRun(cache, "face/script/direction/texT",
+                            sizeof (key), &data, &size) != VLC_SUCCESS);
+
+    GlyphCacheFlush(cache);
+    assert(GlyphCacheGetRun(cache, key, sizeof (key), &data,
+                            &size) != VLC_SUCCESS);
+
+    GlyphCacheDelete(obj, cache);
+}
+
+static void test_eviction(vlc_object_t *obj)
+{
+    test_log("Evicting glyphs\n");
+
+    glyph_cache_t *cache = GlyphCacheNew(CACHE_SIZE);
+    assert(cache != NULL);
+
+    for (unsigned i = 0; i < 8; i++)
+    {
+        glyph_cache_key_t key = Key(1, i);
+        PutBitmap(cache, &key, false, 0, 0, i);
+    }
+    for (unsigned i = 0; i < 8; i++)
+    {
+        glyph_cache_key_t key = Key(1, i);
+        assert(HasBitmap(cache, &key, false, 0, 0, i));
+    }
+
+    /* Use the first glyph again: the second one is now the least recently
+     * used, and is evicted by the next one. */
+    glyph_cache_key_t key = Key(1, 0);
+    assert(HasBitmap(cache, &key, false, 0, 0, 0));
+    key = Key(1, 8);
+    PutBitmap(cache, &key, false, 0, 0, 8);
+
+    key = Key(1, 1);
+    assert(!HasBitmap(cache, &key, false, 0, 0, 1));
+    for (unsigned i = 0; i < 9; i++)
+    {
+        key = Key(1, i);
+        if (i != 1)
+            assert(HasBitmap(cache, &key, false, 0, 0, i));
+    }
+
+    GlyphCacheDelete(obj, cache);
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    assert(FT_Init_FreeType(&library) == 0);
+
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+    test_lookup(obj);
+    test_runs(obj);
+    test_eviction(obj);
+
+    FT_Done_FreeType(library);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,333 @@
+/*****************************************************************************
+ * chroma_convert.c: test for the table-driven video converter
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+
+static picture_t *NewPicture(filter_t *filter)
+{
+    return picture_NewFromFormat(&filter->fmt_out.video);
+}
+
+static const struct filter_video_callbacks cbs = {
+    .buffer_new = NewPicture,
+};
+
+static picture_t *Convert(vlc_object_t *obj, picture_t *src,
+                          vlc_fourcc_t chroma)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, src->format.i_chroma);
+    video_format_Copy(&filter->fmt_in.video, &src->format);
+    es_format_Init(&filter->fmt_out, VIDEO_ES, chroma);
+    video_format_Copy(&filter->fmt_out.video, &src->format);
+    filter->fmt_out.video.i_chroma = chroma;
+    filter->owner.video = &cbs;
+
+    filter->p_module = module_need(filter, "video converter",
+                                   "chroma_convert", true);
+    assert(filter->p_module != NULL);
+
+    picture_t *dst = filter->pf_video_filter(filter, picture_Hold(src));
+    assert(dst != NULL);
+
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+    return dst;
+}
+
+/* Checks whether the converter accepts a format pair */
+static bool CanConvert(vlc_object_t *obj, vlc_fourcc_t a,
+                       video_color_range_t a_range, vlc_fourcc_t b,
+                       video_color_range_t b_range)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, a);
+    video_format_Setup(&filter->fmt_in.video, a, 64, 32, 64, 32, 1, 1);
+    filter->fmt_in.video.color_range = a_range;
+    es_format_Init(&filter->fmt_out, VIDEO_ES, b);
+    video_format_Setup(&filter->fmt_out.video, b, 64, 32, 64, 32, 1, 1);
+    filter->fmt_out.video.color_range = b_range;
+    filter->owner.video = &cbs;
+
+    filter->p_module = module_need(filter, "video converter",
+                                   "chroma_convert", true);
+    bool ok = filter->p_module != NULL;
+    if (ok)
+        module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+    return ok;
+}
+
+/* Fills a picture with random samples, with only the given bits set. */
+static picture_t *NewRandom(vlc_fourcc_t chroma, unsigned width,
+                            unsigned height, uint16_t mask)
+{
+    video_format_t fmt;
+
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_visible_lines; y++)
+        {
+            uint8_t *line = p->p_pixels + y * p->i_pitch;
+
+            for (int x = 0; x < p->i_visible_pitch; x++)
+                line[x] = rand();
+            if (mask > 0xff)
+                for (int x = 0; x < p->i_visible_pitch / 2; x++)
+                    ((uint16_t *)line)[x] &= mask;
+        }
+    }
+    return pic;
+}
+
+static void AssertEqual(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+        for (int y = 0; y < a->p[i].i_visible_lines; y++)
+            assert(memcmp(a->p[i].p_pixels + y * a->p[i].i_pitch,
+                          b->p[i].p_pixels + y * b->p[i].i_pitch,
+                          a->p[i].i_visible_pitch) == 0);
+}
+
+/* Converts a picture to another format and back. The intermediate format
+ * must have at least the same precision and chroma resolution. */
+static void test_roundtrip(vlc_object_t *obj, vlc_fourcc_t a, vlc_fourcc_t b,
+                           uint16_t mask, unsigned width, unsigned height)
+{
+    test_log("  %4.4s -> %4.4s -> %4.4s (%ux%u)\n", (const char *)&a,
+             (const char *)&b, (const char *)&a, width, height);
+
+    picture_t *src = NewRandom(a, width, height, mask);
+    picture_t *tmp = Convert(obj, src, b);
+    picture_t *dst = Convert(obj, tmp, a);
+
+    AssertEqual(src, dst);
+    picture_Release(dst);
+    picture_Release(tmp);
+    picture_Release(src);
+}
+
+struct rgb_layout
+{
+    vlc_fourcc_t chroma;
+    unsigned r, g, b, a;
+};
+
+static const struct rgb_layout rgb_layouts[] = {
+    { VLC_CODEC_RGBA, 0, 1, 2, 3 },
+    { VLC_CODEC_BGRA, 2, 1, 0, 3 },
+    { VLC_CODEC_ARGB, 1, 2, 3, 0 },
+    { VLC_CODEC_RGB32, 2, 1, 0, 3 }, /* default masks, little endian */
+};
+
+static void AssertComponent(double expected, uint8_t value)
+{
+    long ref = lround(expected);
+
+    if (ref < 0)
+        ref = 0;
+    if (ref > 255)
+        ref = 255;
+    assert(labs(ref - value) <= 1);
+}
+
+/* Compares a YUV to RGB conversion against a floating point reference. */
+static void test_rgb(vlc_object_t *obj, vlc_fourcc_t chroma, unsigned bits,
+                     video_color_space_t space, video_color_range_t range,
+                     const struct rgb_layout *layout,
+                     unsigned width, unsigned height)
+{
+    test_log("  %4.4s -> %4.4s (space %d, range %d, %ux%u)\n",
+             (const char *)&chroma, (const char *)&layout->chroma,
+             space, range, width, height);
+
+    picture_t *src = NewRandom(chroma, width, height, (1 << bits) - 1);
+    src->format.space = space;
+    src->format.color_range = range;
+
+    picture_t *dst = Convert(obj, src, layout->chroma);
+    const double kr = (space == COLOR_SPACE_BT709) ? 0.2126
+                    : (space == COLOR_SPACE_BT2020) ? 0.2627 : 0.299;
+    const double kb = (space == COLOR_SPACE_BT709) ? 0.0722
+                    : (space == COLOR_SPACE_BT2020) ? 0.0593 : 0.114;
+    const double kg = 1. - kr - kb;
+    const bool full = range == COLOR_RANGE_FULL;
+    const double ys = full ? 1. : 255. / 219.;
+    const double cs = full ? 1. : 255. / 224.;
+    const double scale = 1 << (bits - 8);
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        const uint8_t *line = dst->p[0].p_pixels + y * dst->p[0].i_pitch;
+
+        for (unsigned x = 0; x < width; x++)
+        {
+            const unsigned cx = x / 2, cy = y / 2;
+            double l, u, v;
+
+            if (bits > 8)
+            {
+                l = ((const uint16_t *)(src->p[0].p_pixels
+                        + y * src->p[0].i_pitch))[x];
+                u = ((const uint16_t *)(src->p[1].p_pixels
+                        + cy * src->p[1].i_pitch))[cx];
+                v = ((const uint16_t *)(src->p[2].p_pixels
+                        + cy * src->p[2].i_pitch))[cx];
+            }
+            else
+            {
+                l = src->p[0].p_pixels[y * src->p[0].i_pitch + x];
+                u = src->p[1].p_pixels[cy * src->p[1].i_pitch + cx];
+                v = src->p[2].p_pixels[cy * src->p[2].i_pitch + cx];
+            }
+
+            l = (l / scale - (full ? 0. : 16.)) * ys;
+            u = (u / scale - 128.) * cs;
+            v = (v / scale - 128.) * cs;
+
+            const uint8_t *px = line + 4 * x;
+
+            AssertComponent(l + 2. * (1. - kr) * v, px[layout->r]);
+            AssertComponent(l - 2. * (1. - kb) * kb / kg * u
+                              - 2. * (1. - kr) * kr / kg * v, px[layout->g]);
+            AssertComponent(l + 2. * (1. - kb) * u, px[layout->b]);
+            assert(px[layout->a] == 0xff);
+        }
+    }
+    picture_Release(dst);
+    picture_Release(src);
+}
+
+/* YUV samples are not rescaled, so the ranges must match. */
+static void test_range(vlc_object_t *obj)
+{
+    assert(!CanConvert(obj, VLC_CODEC_J420, COLOR_RANGE_UNDEF,
+                       VLC_CODEC_I420, COLOR_RANGE_UNDEF));
+    assert(!CanConvert(obj, VLC_CODEC_I420, COLOR_RANGE_LIMITED,
+                       VLC_CODEC_J444, COLOR_RANGE_UNDEF));
+    assert(!CanConvert(obj, VLC_CODEC_J422, COLOR_RANGE_UNDEF,
+                       VLC_CODEC_NV12, COLOR_RANGE_LIMITED));
+    assert(!CanConvert(obj, VLC_CODEC_NV12, COLOR_RANGE_FULL,
+                       VLC_CODEC_YUYV, COLOR_RANGE_LIMITED));
+
+    assert(CanConvert(obj, VLC_CODEC_J420, COLOR_RANGE_UNDEF,
+                      VLC_CODEC_J444, COLOR_RANGE_UNDEF));
+    assert(CanConvert(obj, VLC_CODEC_J420, COLOR_RANGE_UNDEF,
+                      VLC_CODEC_I420, COLOR_RANGE_FULL));
+    assert(CanConvert(obj, VLC_CODEC_I420, COLOR_RANGE_FULL,
+                      VLC_CODEC_J422, COLOR_RANGE_UNDEF));
+    assert(CanConvert(obj, VLC_CODEC_NV12, COLOR_RANGE_FULL,
+                      VLC_CODEC_I420, COLOR_RANGE_FULL));
+    assert(CanConvert(obj, VLC_CODEC_I420, COLOR_RANGE_LIMITED,
+                      VLC_CODEC_NV12, COLOR_RANGE_UNDEF));
+    /* RGB is converted from either range */
+    assert(CanConvert(obj, VLC_CODEC_J420, COLOR_RANGE_UNDEF,
+                      VLC_CODEC_RGBA, COLOR_RANGE_UNDEF));
+    assert(CanConvert(obj, VLC_CODEC_I420, COLOR_RANGE_LIMITED,
+                      VLC_CODEC_RGBA, COLOR_RANGE_UNDEF));
+}
+
+static void test_convert(vlc_object_t *obj)
+{
+    /* Odd multiples of 2 exercise the non-vectorized tails. */
+    static const unsigned sizes[][2] = { { 46, 10 }, { 640, 360 } };
+
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        const unsigned w = sizes[i][0], h = sizes[i][1];
+
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_NV12, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_NV21, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_YV12, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_I444, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_YUYV, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_UYVY, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_I420_10L, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420, VLC_CODEC_P010, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I422, VLC_CODEC_VYUY, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I422, VLC_CODEC_NV16, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_NV12, VLC_CODEC_I444, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420_10L, VLC_CODEC_P010, 0x3ff, w, h);
+        test_roundtrip(obj, VLC_CODEC_I420_10L, VLC_CODEC_I444_16L, 0x3ff,
+                       w, h);
+        test_roundtrip(obj, VLC_CODEC_P010, VLC_CODEC_I422_12L, 0xffc0,
+                       w, h);
+        test_roundtrip(obj, VLC_CODEC_P016, VLC_CODEC_I420_16L, 0xffff,
+                       w, h);
+        test_roundtrip(obj, VLC_CODEC_GREY, VLC_CODEC_I420, 0xff, w, h);
+        test_roundtrip(obj, VLC_CODEC_J420, VLC_CODEC_J444, 0xff, w, h);
+
+        for (size_t j = 0; j < ARRAY_SIZE(rgb_layouts); j++)
+            test_rgb(obj, VLC_CODEC_I420, 8, COLOR_SPACE_BT601,
+                     COLOR_RANGE_LIMITED, &rgb_layouts[j], w, h);
+        test_rgb(obj, VLC_CODEC_I420, 8, COLOR_SPACE_BT709,
+                 COLOR_RANGE_LIMITED, &rgb_layouts[0], w, h);
+        test_rgb(obj, VLC_CODEC_I420, 8, COLOR_SPACE_BT709,
+                 COLOR_RANGE_FULL, &rgb_layouts[0], w, h);
+        test_rgb(obj, VLC_CODEC_I420_10L, 10, COLOR_SPACE_BT2020,
+                 COLOR_RANGE_LIMITED, &rgb_layouts[1], w, h);
+        test_rgb(obj, VLC_CODEC_I420_10L, 10, COLOR_SPACE_BT2020,
+                 COLOR_RANGE_FULL, &rgb_layouts[1], w, h);
+    }
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+        "--filter-threads=4",
+    };
+
+    test_init();
+
+    test_log("Testing the table-driven video converter\n");
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    test_range(VLC_OBJECT(vlc->p_libvlc_int));
+    test_convert(VLC_OBJECT(vlc->p_libvlc_int));
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,311 @@
+/*****************************************************************************
+ * blend.c: test for the picture blending module
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+
+#define DST_WIDTH  200
+#define DST_HEIGHT 120
+
+static unsigned div255(unsigned v)
+{
+    return ((v >> 8) + v + 1) >> 8;
+}
+
+static void merge(void *p, unsigned bytes, unsigned s, unsigned f)
+{
+    if (bytes == 1)
+    {
+        uint8_t *d = p;
+        *d = div255((255 - f) * *d + s * f);
+    }
+    else
+    {
+        uint16_t *d = p;
+        *d = div255((255 - f) * *d + s * f);
+    }
+}
+
+static picture_t *NewRandom(vlc_fourcc_t chroma, unsigned width,
+                            unsigned height)
+{
+    video_format_t fmt;
+
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+    picture_t *pic = picture_NewFromFormat(&fmt);
+    assert(pic != NULL);
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *line = p->p_pixels + y * p->i_pitch;
+
+            for (int x = 0; x < p->i_pitch; x++)
+                line[x] = rand();
+            if (chroma == VLC_CODEC_I420_10L)
+                for (int x = 0; x < p->i_pitch / 2; x++)
+                    ((uint16_t *)line)[x] &= 0x3ff;
+        }
+    }
+    return pic;
+}
+
+/* Makes some blocks of the source fully transparent, and some opaque */
+static void SetAlpha(picture_t *src, unsigned width, unsigned height,
+                     video_palette_t *palette)
+{
+    for (unsigned y = 0; y < height; y++)
+        for (unsigned x = 0; x < width; x++)
+        {
+            unsigned block = (y / 8 + x / 40) % 4;
+            uint8_t *a;
+
+            switch (src->format.i_chroma)
+            {
+                case VLC_CODEC_YUVA:
+                    a = &src->p[A_PLANE].p_pixels[y * src->p[A_PLANE].i_pitch + x];
+                    break;
+                case VLC_CODEC_RGBA:
+                    a = &src->p[0].p_pixels[y * src->p[0].i_pitch + 4 * x + 3];
+                    break;
+                default:
+                    a = &src->p[0].p_pixels[y * src->p[0].i_pitch + x];
+                    /* Index of a transparent or an opaque entry */
+                    if (block < 2)
+                        *a = block;
+                    continue;
+            }
+            if (block < 2)
+                *a = block ? 255 : 0;
+        }
+
+    if (palette != NULL)
+    {
+        palette->i_entries = 256;
+        for (unsigned i = 0; i < 256; i++)
+            for (unsigned c = 0; c < 4; c++)
+                palette->palette[i][c] = rand();
+        palette->palette[0][3] = 0;
+        palette->palette[1][3] = 255;
+    }
+}
+
+static void GetSource(const picture_t *src, const video_palette_t *palette,
+                      unsigned x, unsigned y, unsigned px[4])
+{
+    switch (src->format.i_chroma)
+    {
+        case VLC_CODEC_YUVA:
+            for (unsigned c = 0; c < 4; c++)
+                px[c] = src->p[c].p_pixels[y * src->p[c].i_pitch + x];
+            break;
+        case VLC_CODEC_RGBA:
+            for (unsigned c = 0; c < 4; c++)
+                px[c] = src->p[0].p_pixels[y * src->p[0].i_pitch + 4 * x + c];
+            break;
+        default:
+        {
+            unsigned index = src->p[0].p_pixels[y * src->p[0].i_pitch + x];
+
+            for (unsigned c = 0; c < 4; c++)
+                px[c] = palette->palette[index][c];
+        }
+    }
+}
+
+/* Reference blending, pixel by pixel */
+static void Blend(picture_t *dst, const picture_t *src,
+                  const video_palette_t *palette, unsigned dx, unsigned dy,
+                  unsigned width, unsigned height, unsigned alpha)
+{
+    const vlc_fourcc_t chroma = dst->format.i_chroma;
+    const unsigned bytes = chroma == VLC_CODEC_I420_10L ? 2 : 1;
+
+    for (unsigned y = 0; y < height; y++)
+        for (unsigned x = 0; x < width; x++)
+        {
+            const unsigned ax = dx + x, ay = dy + y;
+            unsigned px[4];
+
+            GetSource(src, palette, x, y, px);
+
+            unsigned f = div255(alpha * px[3]);
+            if (f == 0)
+                continue;
+
+            if (chroma == VLC_CODEC_RGBA || chroma == VLC_CODEC_BGRA)
+            {
+                uint8_t *p = &dst->p[0].p_pixels[ay * dst->p[0].i_pitch + 4 * ax];
+                const unsigned r = chroma == VLC_CODEC_BGRA ? 2 : 0;
+                const unsigned da = p[3];
+
+                merge(&p[r], 1, px[0], 255 - da);
+                merge(&p[1], 1, px[1], 255 - da);
+                merge(&p[2 - r], 1, px[2], 255 - da);
+                merge(&p[r], 1, px[0], f);
+                merge(&p[1], 1, px[1], f);
+                merge(&p[2 - r], 1, px[2], f);
+                merge(&p[3], 1, 255, f);
+                continue;
+            }
+
+            if (bytes == 2)
+                for (unsigned c = 0; c < 3; c++)
+                    px[c] = px[c] * 1023 / 255;
+
+            merge(&dst->p[0].p_pixels[ay * dst->p[0].i_pitch + bytes * ax],
+                  bytes, px[0], f);
+            if ((ax % 2) || (ay % 2))
+                continue;
+
+            if (chroma == VLC_CODEC_NV12)
+            {
+                uint8_t *p = &dst->p[1].p_pixels[ay / 2 * dst->p[1].i_pitch + ax];
+
+                merge(&p[0], 1, px[1], f);
+                merge(&p[1], 1, px[2], f);
+            }
+            else
+            {
+                const unsigned u = chroma == VLC_CODEC_YV12 ? 2 : 1;
+
+                merge(&dst->p[u].p_pixels[ay / 2 * dst->p[u].i_pitch + bytes * ax / 2],
+                      bytes, px[1], f);
+                merge(&dst->p[3 - u].p_pixels[ay / 2 * dst->p[3 - u].i_pitch + bytes * ax / 2],
+                      bytes, px[2], f);
+            }
+        }
+}
+
+static void AssertEqual(const picture_t *a, const picture_t *b)
+{
+    assert(a->i_planes == b->i_planes);
+    for (int i = 0; i < a->i_planes; i++)
+        for (int y = 0; y < a->p[i].i_visible_lines; y++)
+            assert(memcmp(a->p[i].p_pixels + y * a->p[i].i_pitch,
+                          b->p[i].p_pixels + y * b->p[i].i_pitch,
+                          a->p[i].i_visible_pitch) == 0);
+}
+
+static void test_blend(vlc_object_t *obj, vlc_fourcc_t dst_chroma,
+                       vlc_fourcc_t src_chroma, unsigned width,
+                       unsigned height, unsigned x, unsigned y,
+                       unsigned alpha)
+{
+    test_log("  %4.4s onto %4.4s, %ux%u at %u,%u, alpha %u\n",
+             (const char *)&src_chroma, (const char *)&dst_chroma,
+             width, height, x, y, alpha);
+
+    picture_t *dst = NewRandom(dst_chroma, DST_WIDTH, DST_HEIGHT);
+    picture_t *ref = picture_NewFromFormat(&dst->format);
+    assert(ref != NULL);
+    picture_CopyPixels(ref, dst);
+
+    picture_t *src = NewRandom(src_chroma, width, height);
+    video_palette_t palette;
+    bool palettized = src_chroma == VLC_CODEC_YUVP;
+
+    SetAlpha(src, width, height, palettized ? &palette : NULL);
+    if (palettized)
+        src->format.p_palette = &palette;
+
+    vlc_blender_t *blend = filter_NewBlend(obj, &dst->format);
+    assert(blend != NULL);
+    assert(filter_ConfigureBlend(blend, DST_WIDTH, DST_HEIGHT,
+                                 &src->format) == VLC_SUCCESS);
+    assert(filter_Blend(blend, dst, x, y, src, alpha) == VLC_SUCCESS);
+    filter_DeleteBlend(blend);
+
+    /* The source is clipped by the destination. */
+    if (width > DST_WIDTH - x)
+        width = DST_WIDTH - x;
+    if (height > DST_HEIGHT - y)
+        height = DST_HEIGHT - y;
+    Blend(ref, src, &palette, x, y, width, height, alpha);
+    AssertEqual(dst, ref);
+
+    src->format.p_palette = NULL;
+    picture_Release(src);
+    picture_Release(ref);
+    picture_Release(dst);
+}
+
+static void test_blends(libvlc_int_t *libvlc)
+{
+    static const vlc_fourcc_t yuv[] = {
+        VLC_CODEC_I420, VLC_CODEC_YV12, VLC_CODEC_NV12, VLC_CODEC_I420_10L,
+    };
+    static const vlc_fourcc_t sources[] = {
+        VLC_CODEC_YUVA, VLC_CODEC_YUVP,
+    };
+    static const unsigned areas[][4] = {
+        /* width, height, x, y */
+        { 160, 100,  0,  0 },
+        { 101,  37, 17,  9 },
+        {  64,  64, 30, 20 },
+        { 150,  90, 80, 50 }, /* clipped */
+        {   3,   3,  1,  1 },
+        {  63,   7,  2,  1 }, /* odd width, 32 chroma samples */
+    };
+    vlc_object_t *obj = VLC_OBJECT(libvlc);
+
+    for (size_t i = 0; i < ARRAY_SIZE(yuv); i++)
+        for (size_t j = 0; j < ARRAY_SIZE(sources); j++)
+            for (size_t k = 0; k < ARRAY_SIZE(areas); k++)
+                for (unsigned alpha = 127; alpha <= 255; alpha += 128)
+                    test_blend(obj, yuv[i], sources[j], areas[k][0],
+                               areas[k][1], areas[k][2], areas[k][3], alpha);
+
+    for (size_t k = 0; k < ARRAY_SIZE(areas); k++)
+        for (unsigned alpha = 127; alpha <= 255; alpha += 128)
+        {
+            test_blend(obj, VLC_CODEC_RGBA, VLC_CODEC_RGBA, areas[k][0],
+                       areas[k][1], areas[k][2], areas[k][3], alpha);
+            test_blend(obj, VLC_CODEC_BGRA, VLC_CODEC_RGBA, areas[k][0],
+                       areas[k][1], areas[k][2], areas[k][3], alpha);
+        }
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    test_init();
+
+    test_log("Testing picture blending\n");
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    test_blends(vlc->p_libvlc_int);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,206 @@
+/*****************************************************************************
+ * deinterlace.c: test for the deinterlacer SIMD kernels
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "../../../modules/video_filter/deinterlace/common.h"
+#include "../../../modules/video_filter/deinterlace/merge.h"
+#include "../../../modules/video_filter/deinterlace/yadif.h"
+
+const char vlc_module_name[] = "test_deinterlace";
+
+#ifdef HAVE_AVX2_INTRINSICS
+
+/* Odd widths exercise the C tail after the vector loop. */
+static const int widths[] = { 1, 7, 15, 16, 17, 31, 33, 45, 63, 1921 };
+
+#define LINES  8
+#define MARGIN 32 /* pixels read left and right of the line by the filters */
+
+/**
+ * Fills a buffer with either noise or a smooth ramp with little noise, so
+ * that both the spatial and the temporal predictions of yadif get picked.
+ */
+static void Fill(void *buf, size_t count, unsigned bits, bool smooth)
+{
+    const unsigned max = (1u << bits) - 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        unsigned v = smooth ? (i * 3 + rand() % 8) % (max + 1)
+                            : (unsigned)rand() & max;
+        if (bits > 8)
+            ((uint16_t *)buf)[i] = v;
+        else
+            ((uint8_t *)buf)[i] = v;
+    }
+}
+
+static void test_merge(void)
+{
+    uint8_t s1[2048], s2[2048], ref[2048], out[2048];
+
+    for (size_t bytes = 1; bytes <= 300; bytes++)
+    {
+        for (unsigned smooth = 0; smooth < 2; smooth++)
+        {
+            Fill(s1, sizeof (s1), 8, smooth);
+            Fill(s2, sizeof (s2), 8, smooth);
+            memset(ref, 0xAA, sizeof (ref));
+            memset(out, 0xAA, sizeof (out));
+
+            Merge8BitGeneric(ref, s1, s2, bytes);
+            Merge8BitAVX2(out, s1, s2, bytes);
+            assert(memcmp(ref, out, sizeof (ref)) == 0);
+
+            if (bytes & 1)
+                continue;
+
+            Fill(s1, sizeof (s1) / 2, 16, smooth);
+            Fill(s2, sizeof (s2) / 2, 16, smooth);
+            memset(ref, 0xAA, sizeof (ref));
+            memset(out, 0xAA, sizeof (out));
+
+            Merge16BitGeneric(ref, s1, s2, bytes);
+            Merge16BitAVX2(out, s1, s2, bytes);
+            assert(memcmp(ref, out, sizeof (ref)) == 0);
+        }
+    }
+    test_log("merge: OK\n");
+}
+
+typedef void (*yadif_line_t)(uint8_t *, uint8_t *, uint8_t *, uint8_t *,
+                             int, int, int, int, int);
+
+/**
+ * Filters a field with both line functions, with the same edge handling as
+ * YadifSlice(): the first and last filtered lines mirror the missing
+ * reference line and use the spatial check only.
+ */
+static void test_yadif_width(int w, unsigned bits, bool smooth,
+                             yadif_line_t ref_line, yadif_line_t avx2_line)
+{
+    const size_t pixel = bits > 8 ? 2 : 1;
+    const int pitch = (w + 2 * MARGIN) * pixel;
+    const size_t size = (size_t)pitch * LINES;
+    uint8_t *prev = malloc(size), *cur = malloc(size), *next = malloc(size);
+    uint8_t *ref = malloc(size), *out = malloc(size);
+
+    assert(prev != NULL && cur != NULL && next != NULL);
+    assert(ref != NULL && out != NULL);
+
+    Fill(prev, size / pixel, bits, smooth);
+    Fill(cur, size / pixel, bits, smooth);
+    Fill(next, size / pixel, bits, smooth);
+
+    for (int parity = 0; parity < 2; parity++)
+    {
+        memset(ref, 0xAA, size);
+        memset(out, 0xAA, size);
+
+        for (int y = 1; y < LINES - 1; y++)
+        {
+            const int mode = (y > 1 && y < LINES - 2) ? 0 : 2;
+            const int prefs = y < LINES - 2 ? pitch : -pitch;
+            const int mrefs = y > 1 ? -pitch : pitch;
+            const size_t offset = (size_t)y * pitch + MARGIN * pixel;
+
+            ref_line(ref + offset, prev + offset, cur + offset,
+                     next + offset, w, prefs, mrefs, parity, mode);
+            avx2_line(out + offset, prev + offset, cur + offset,
+                      next + offset, w, prefs, mrefs, parity, mode);
+        }
+        assert(memcmp(ref, out, size) == 0);
+
+        /* Spatial check only, on every line */
+        memset(ref, 0xAA, size);
+        memset(out, 0xAA, size);
+
+        for (int y = 1; y < LINES - 1; y++)
+        {
+            const size_t offset = (size_t)y * pitch + MARGIN * pixel;
+
+            ref_line(ref + offset, prev + offset, cur + offset,
+                     next + offset, w, pitch, -pitch, parity, 2);
+            avx2_line(out + offset, prev + offset, cur + offset,
+                      next + offset, w, pitch, -pitch, parity, 2);
+        }
+        assert(memcmp(ref, out, size) == 0);
+    }
+
+    free(out);
+    free(ref);
+    free(next);
+    free(cur);
+    free(prev);
+}
+
+static void test_yadif(void)
+{
+    static const unsigned depths[] = { 8, 10, 16 };
+
+    for (size_t i = 0; i < ARRAY_SIZE(depths); i++)
+    {
+        const unsigned bits = depths[i];
+
+        for (size_t j = 0; j < ARRAY_SIZE(widths); j++)
+            for (unsigned smooth = 0; smooth < 2; smooth++)
+            {
+                if (bits > 8)
+                    test_yadif_width(widths[j], bits, smooth,
+                                     yadif_filter_line_c_16bit,
+                                     yadif_filter_line_avx2_16bit);
+                else
+                    test_yadif_width(widths[j], bits, smooth,
+                                     yadif_filter_line_c,
+                                     yadif_filter_line_avx2);
+            }
+        test_log("yadif %u-bit: OK\n", bits);
+    }
+}
+
+int main(void)
+{
+    test_init();
+
+    if (!vlc_CPU_AVX2())
+    {
+        test_log("AVX2 not supported, skipping\n");
+        return 77;
+    }
+
+    srand(0);
+    test_merge();
+    test_yadif();
+    return 0;
+}
+
+#else
+int main(void)
+{
+    return 77;
+}
+#endif
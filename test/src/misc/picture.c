@@ -0,0 +1,219 @@
+/*****************************************************************************
+ * picture.c: test for picture allocation and recycling
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_picture.h>
+#include <vlc_subpicture.h>
+
+const char vlc_module_name[] = "test_picture";
+
+static void test_recycle(void)
+{
+    picture_t *a = picture_New(VLC_CODEC_I420, 640, 360, 1, 1);
+    picture_t *b = picture_New(VLC_CODEC_I420, 640, 360, 1, 1);
+    assert(a != NULL && b != NULL);
+
+    void *pa = a->p[0].p_pixels;
+    void *pb = b->p[0].p_pixels;
+    assert(pa != pb);
+
+    /* A released buffer is reused for a picture of the same format, most
+     * recently released first. */
+    picture_Release(a);
+    picture_Release(b);
+
+    picture_t *c = picture_New(VLC_CODEC_I420, 640, 360, 1, 1);
+    assert(c != NULL);
+    assert(c->p[0].p_pixels == pb);
+    assert(c->p[1].p_pixels > c->p[0].p_pixels);
+
+    /* but not for a different size. */
+    picture_t *d = picture_New(VLC_CODEC_I420, 320, 180, 1, 1);
+    assert(d != NULL);
+    assert(d->p[0].p_pixels != pa);
+
+    picture_t *e = picture_New(VLC_CODEC_I420, 640, 360, 1, 1);
+    assert(e != NULL);
+    assert(e->p[0].p_pixels == pa);
+
+    picture_Release(c);
+    picture_Release(d);
+    picture_Release(e);
+}
+
+static bool is_clear(const picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+                if (p->p_pixels[y * p->i_pitch + x] != 0)
+                    return false;
+    }
+    return true;
+}
+
+static void fill(picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+        memset(pic->p[i].p_pixels, 0xA5,
+               (size_t)pic->p[i].i_pitch * pic->p[i].i_lines);
+}
+
+static void test_clear(void)
+{
+    picture_t *a = picture_New(VLC_CODEC_RGBA, 320, 200, 1, 1);
+    assert(a != NULL);
+    assert(is_clear(a));
+
+    /* Recycled buffers are cleared, as new ones. */
+    void *pa = a->p[0].p_pixels;
+    fill(a);
+    picture_Release(a);
+
+    picture_t *b = picture_New(VLC_CODEC_RGBA, 320, 200, 1, 1);
+    assert(b != NULL);
+    assert(b->p[0].p_pixels == pa);
+    assert(is_clear(b));
+
+    /* Subpicture regions are drawn over a transparent picture. */
+    fill(b);
+    picture_Release(b);
+
+    video_format_t fmt;
+    video_format_Setup(&fmt, VLC_CODEC_RGBA, 320, 200, 320, 200, 1, 1);
+
+    subpicture_region_t *region = subpicture_region_New(&fmt);
+    assert(region != NULL);
+    assert(region->p_picture->p[0].p_pixels == pa);
+    assert(is_clear(region->p_picture));
+    subpicture_region_Delete(region);
+}
+
+static void test_limits(void)
+{
+    picture_t *pics[64];
+    void *last;
+
+    /* More pictures than the cache can hold */
+    for (unsigned i = 0; i < ARRAY_SIZE(pics); i++) {
+        pics[i] = picture_New(VLC_CODEC_RGBA, 256 + 16 * i, 64, 1, 1);
+        assert(pics[i] != NULL);
+    }
+    last = pics[ARRAY_SIZE(pics) - 1]->p[0].p_pixels;
+    for (unsigned i = 0; i < ARRAY_SIZE(pics); i++)
+        picture_Release(pics[i]);
+
+    /* Pictures larger than the cache are not kept */
+    for (unsigned i = 0; i < 2; i++) {
+        pics[i] = picture_New(VLC_CODEC_RGBA, 8192, 4320, 1, 1);
+        assert(pics[i] != NULL);
+    }
+    for (unsigned i = 0; i < 2; i++)
+        picture_Release(pics[i]);
+
+    /* The most recently released buffers are still there */
+    picture_t *pic = picture_New(VLC_CODEC_RGBA, 256 + 16 * 63, 64, 1, 1);
+    assert(pic != NULL);
+    assert(pic->p[0].p_pixels == last);
+    picture_Release(pic);
+}
+
+struct cache_stats
+{
+    bool logged;
+    uint64_t reused;
+    uint64_t allocated;
+};
+
+static void log_cache_stats(void *data, int level, const libvlc_log_t *ctx,
+                            const char *fmt, va_list ap)
+{
+    struct cache_stats *stats = data;
+    char msg[256];
+
+    vsnprintf(msg, sizeof (msg), fmt, ap);
+    if (sscanf(msg, "picture buffers: %"SCNu64" reused, %"SCNu64" allocated",
+               &stats->reused, &stats->allocated) == 2)
+        stats->logged = true;
+    (void) level; (void) ctx;
+}
+
+static libvlc_instance_t *test_instance_New(struct cache_stats *stats)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+    if (stats != NULL)
+    {
+        stats->logged = false;
+        libvlc_log_set(vlc, log_cache_stats, stats);
+    }
+    return vlc;
+}
+
+static void test_release_last(void)
+{
+    struct cache_stats stats;
+    libvlc_instance_t *vlc = test_instance_New(&stats);
+
+    picture_t *pic = picture_New(VLC_CODEC_RGBA, 320, 200, 1, 1);
+    assert(pic != NULL);
+    libvlc_release(vlc);
+    assert(stats.logged);
+
+    /* Released after the last instance: freed, not kept in the cache */
+    picture_Release(pic);
+
+    vlc = test_instance_New(&stats);
+    pic = picture_New(VLC_CODEC_RGBA, 320, 200, 1, 1);
+    assert(pic != NULL);
+    picture_Release(pic);
+    libvlc_release(vlc);
+    assert(stats.logged);
+    assert(stats.reused == 0);
+    assert(stats.allocated >= 1);
+}
+
+int main(void)
+{
+    test_init();
+
+    /* Buffers are only recycled while an instance holds the cache */
+    libvlc_instance_t *vlc = test_instance_New(NULL);
+    test_recycle();
+    test_clear();
+    test_limits();
+    libvlc_release(vlc);
+
+    test_release_last();
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*****************************************************************************
+ * slices.c: test for slice-parallel processing
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_slices.h>
+
+#define LINES 1080
+
+struct slices_test
+{
+    vlc_object_t *obj;
+    atomic_uint calls;
+    atomic_uchar lines[LINES];
+    bool nested;
+};
+
+static void test_slice(void *opaque, unsigned slice, unsigned count)
+{
+    struct slices_test *t = opaque;
+    unsigned first, end;
+
+    assert(slice < count);
+    atomic_fetch_add(&t->calls, 1);
+
+    vlc_slice_Lines(slice, count, LINES, 2, &first, &end);
+    assert(first <= end);
+    assert(end <= LINES);
+    assert((first % 2) == 0);
+
+    for (unsigned i = first; i < end; i++)
+        atomic_fetch_add(&t->lines[i], 1);
+
+    if (t->nested)
+    {
+        struct slices_test sub = { .obj = t->obj, .nested = false };
+
+        atomic_init(&sub.calls, 0);
+        for (unsigned i = 0; i < LINES; i++)
+            atomic_init(&sub.lines[i], 0);
+
+        vlc_slices_Run(t->obj, 3, test_slice, &sub);
+        assert(atomic_load(&sub.calls) == 3);
+    }
+}
+
+static void test_run(vlc_object_t *obj, unsigned count, bool nested)
+{
+    struct slices_test t = { .obj = obj, .nested = nested };
+
+    atomic_init(&t.calls, 0);
+    for (unsigned i = 0; i < LINES; i++)
+        atomic_init(&t.lines[i], 0);
+
+    vlc_slices_Run(obj, count, test_slice, &t);
+
+    assert(atomic_load(&t.calls) == count);
+    /* Every line is processed exactly once. */
+    for (unsigned i = 0; i < LINES; i++)
+        assert(atomic_load(&t.lines[i]) == 1);
+}
+
+static void test_slices(libvlc_int_t *libvlc)
+{
+    vlc_object_t *obj = VLC_OBJECT(libvlc);
+    unsigned count = vlc_slices_Count(obj, LINES);
+
+    test_log("Using %u slices\n", count);
+    assert(count >= 1);
+    assert(vlc_slices_Count(obj, 1) == 1);
+
+    for (unsigned n = 1; n <= 17; n++)
+        test_run(obj, n, false);
+    for (unsigned i = 0; i < 100; i++)
+        test_run(obj, count, false);
+
+    test_log("Testing nested slices\n");
+    test_run(obj, count, true);
+}
+
+int main(void)
+{
+    static const char *const argv[] = {
+        "-v", "--ignore-config", "-Idummy", "--no-media-library",
+        "--filter-threads=4",
+    };
+
+    test_init();
+
+    test_log("Testing slice-parallel processing\n");
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(argv), argv);
+    assert(vlc != NULL);
+
+    test_slices(vlc->p_libvlc_int);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,227 @@
+/*****************************************************************************
+ * hints.c: test for the module probing hints
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#define MODULE_NAME test_hints
+#define MODULE_STRING "test_hints"
+#undef __PLUGIN__
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_modules.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+
+enum
+{
+    PROBED_NONE  = 1 << 0,
+    PROBED_EXT   = 1 << 1,
+    PROBED_MIME  = 1 << 2,
+    PROBED_MAGIC = 1 << 3,
+    PROBED_ALL   = 1 << 4,
+};
+
+#define PROBED_ANY \
+    (PROBED_NONE | PROBED_EXT | PROBED_MIME | PROBED_MAGIC | PROBED_ALL)
+
+/* Every module fails to open, so that all matching modules are probed. */
+#define OPEN(name, flag) \
+static int Open##name(unsigned *probed) \
+{ \
+    *probed |= flag; \
+    return VLC_EGENERIC; \
+}
+
+OPEN(None, PROBED_NONE)
+OPEN(Ext, PROBED_EXT)
+OPEN(Mime, PROBED_MIME)
+OPEN(Magic, PROBED_MAGIC)
+OPEN(All, PROBED_ALL)
+
+static int Probe(void *func, bool forced, va_list ap)
+{
+    int (*open)(unsigned *) = func;
+    unsigned *probed = va_arg(ap, unsigned *);
+
+    (void) forced;
+    return open(probed);
+}
+
+static unsigned Load(libvlc_int_t *obj, const char *name,
+                     const char *ext, const char *mime,
+                     const char *peek, size_t peek_size)
+{
+    const struct vlc_module_hint hint = {
+        ext, mime, (const uint8_t *)peek, peek_size,
+    };
+    unsigned probed = 0;
+
+    module_t *module = vlc_module_load_hinted(VLC_OBJECT(obj), "test hints",
+                                              name, name != NULL, &hint,
+                                              Probe, &probed);
+    assert(module == NULL);
+    return probed;
+}
+
+static void test_hints(libvlc_int_t *obj)
+{
+    unsigned probed;
+
+    /* Without hints, every module is probed */
+    probed = 0;
+    assert(vlc_module_load_hinted(VLC_OBJECT(obj), "test hints", NULL, false,
+                                  NULL, Probe, &probed) == NULL);
+    assert(probed == PROBED_ANY);
+
+    /* Without data, magic numbers cannot be ruled out */
+    assert(Load(obj, NULL, NULL, NULL, NULL, 0)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MAGIC | PROBED_ALL));
+
+    /* Extensions */
+    probed = Load(obj, NULL, "bar", NULL, "xxxxxxxx", 8);
+    assert(probed == (PROBED_NONE | PROBED_EXT));
+    assert(Load(obj, NULL, "FOO", NULL, "xxxxxxxx", 8) == probed);
+    assert(Load(obj, NULL, "ba", NULL, "xxxxxxxx", 8) == PROBED_NONE);
+    assert(Load(obj, NULL, "foobar", NULL, "xxxxxxxx", 8) == PROBED_NONE);
+    assert(Load(obj, NULL, "baz", NULL, "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_ALL));
+
+    /* Without an extension, modules with only extension hints are probed */
+    assert(Load(obj, NULL, NULL, NULL, "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT));
+
+    /* MIME types */
+    assert(Load(obj, NULL, NULL, "video/x-foo", "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MIME));
+    assert(Load(obj, NULL, NULL, "Audio/X-Foo", "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MIME));
+    assert(Load(obj, NULL, NULL, "video/x-fo", "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT));
+    assert(Load(obj, NULL, NULL, "application/x-baz", "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT | PROBED_ALL));
+
+    /* Magic numbers */
+    assert(Load(obj, NULL, NULL, NULL, "xxxxMAGC", 8)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MAGIC));
+    assert(Load(obj, NULL, NULL, NULL, "xxxMAGCx", 8)
+           == (PROBED_NONE | PROBED_EXT));
+    assert(Load(obj, NULL, NULL, NULL, "BAZxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT | PROBED_ALL));
+
+    /* A magic number beyond the peeked data counts as a match */
+    assert(Load(obj, NULL, NULL, NULL, "xxxxMAG", 7)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MAGIC));
+    assert(Load(obj, NULL, NULL, NULL, "BA", 2)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MAGIC | PROBED_ALL));
+
+    /* Any matching hint is enough */
+    assert(Load(obj, NULL, "bar", "video/x-foo", "xxxxMAGC", 8)
+           == (PROBED_NONE | PROBED_EXT | PROBED_MIME | PROBED_MAGIC));
+
+    /* Modules forced by name are probed regardless of their hints */
+    assert(Load(obj, "ext", NULL, NULL, "xxxxxxxx", 8) == PROBED_EXT);
+    assert(Load(obj, "magic,all", "bar", NULL, "xxxxxxxx", 8)
+           == (PROBED_MAGIC | PROBED_ALL));
+    assert(Load(obj, "ext,any", NULL, NULL, "xxxxxxxx", 8)
+           == (PROBED_NONE | PROBED_EXT));
+}
+
+static bool demux_probed;
+
+static int OpenDemux(vlc_object_t *obj)
+{
+    (void) obj;
+    demux_probed = true;
+    return VLC_SUCCESS;
+}
+
+static void test_demux_hints(libvlc_int_t *obj, const char *url)
+{
+    static const uint8_t data[16];
+    stream_t *s = vlc_stream_MemoryNew(obj, (uint8_t *)data, sizeof (data),
+                                       true);
+    assert(s != NULL);
+    s->psz_url = strdup(url);
+    assert(s->psz_url != NULL);
+
+    demux_probed = false;
+    demux_t *demux = demux_New(VLC_OBJECT(obj), "any", s, NULL);
+    assert(demux != NULL);
+    assert(demux_probed);
+    demux_Delete(demux);
+}
+
+vlc_module_begin()
+    set_capability("test hints", 50)
+    set_callback(OpenNone)
+    add_shortcut("none")
+    add_submodule()
+        set_capability("test hints", 40)
+        set_callback(OpenExt)
+        set_probe_extensions("foo,bar")
+        add_shortcut("ext")
+    add_submodule()
+        set_capability("test hints", 30)
+        set_callback(OpenMime)
+        set_probe_mime_types("audio/x-foo,video/x-foo")
+        add_shortcut("mime")
+    add_submodule()
+        set_capability("test hints", 20)
+        set_callback(OpenMagic)
+        set_probe_magic(4, "MAGC")
+        add_shortcut("magic")
+    add_submodule()
+        set_capability("test hints", 10)
+        set_callback(OpenAll)
+        set_probe_extensions("baz")
+        set_probe_mime_types("application/x-baz")
+        set_probe_magic(0, "BAZ")
+        add_shortcut("all")
+    add_submodule()
+        set_capability("demux", 100000)
+        set_callback(OpenDemux)
+        set_probe_extensions("dv")
+        add_shortcut("testdv")
+vlc_module_end()
+
+typedef int (*vlc_plugin_cb)(int (*)(void *, void *, int, ...), void *);
+
+__attribute__((visibility("default")))
+vlc_plugin_cb vlc_static_modules[] = { VLC_SYMBOL(vlc_entry), NULL };
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    assert(vlc != NULL);
+
+    test_hints(vlc->p_libvlc_int);
+    /* Non-file URLs take the extension from the location */
+    test_demux_hints(vlc->p_libvlc_int, "http://example.com/media/x.dv");
+    test_demux_hints(vlc->p_libvlc_int, "file:///tmp/x.dv");
+    /* Without an extension, the demuxer is not ruled out */
+    test_demux_hints(vlc->p_libvlc_int, "http://example.com/media/x");
+    libvlc_release(vlc);
+    return 0;
+}